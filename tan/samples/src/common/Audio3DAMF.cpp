@@ -673,10 +673,10 @@ AMF_RESULT Audio3DAMF::Process(int16_t *pOut, int16_t *pChan[MAX_SOURCES], uint3
             outputFloatBufRight[src] = mOutputFloatBufs[src * 2 + 1];// Odd indexed channels for right ear input
         }
 
-        ret = mMixer->Mix(outputFloatBufLeft, mOutputMixFloatBufs[0]);
+        ret = mMixer->Mix(outputFloatBufLeft, mOutputMixFloatBufs[0], sampleCount, false);
         AMF_RETURN_IF_FAILED(ret);
 
-        ret = mMixer->Mix(outputFloatBufRight, mOutputMixFloatBufs[1]);
+        ret = mMixer->Mix(outputFloatBufRight, mOutputMixFloatBufs[1], sampleCount, false);
         AMF_RETURN_IF_FAILED(ret);
 
         ret = mConverter->Convert(mOutputMixFloatBufs[0], 1, sampleCount, pOut, 2, 1.f);
@@ -648,8 +648,8 @@ AMF_RESULT Audio3DOpenCL::Process(int16_t *pOut, int16_t *pChan[MAX_SOURCES], ui
         //PrintFloatArray("::outputBufLeft", outputFloatBufLeft[0], sampleCount * sizeof(float));
         //PrintFloatArray("::outputBufRight", outputFloatBufRight[0], sampleCount * sizeof(float));
 
-        AMF_RETURN_IF_FAILED(mMixer->Mix(outputFloatBufLeft, mOutputMixFloatBufs[0]));
-        AMF_RETURN_IF_FAILED(mMixer->Mix(outputFloatBufRight, mOutputMixFloatBufs[1]));
+        AMF_RETURN_IF_FAILED(mMixer->Mix(outputFloatBufLeft, mOutputMixFloatBufs[0], sampleCount, false));
+        AMF_RETURN_IF_FAILED(mMixer->Mix(outputFloatBufRight, mOutputMixFloatBufs[1], sampleCount, false));
 
         //PrintFloatArray("::Mixer->Mix[0]", mOutputMixFloatBufs[0], sampleCount * sizeof(float));
         //PrintFloatArray("::Mixer->Mix[1]", mOutputMixFloatBufs[1], sampleCount * sizeof(float));
@@ -38,6 +38,7 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <algorithm>
 
 // rotation, translation matrix
 class TransRotMtx
@@ -203,15 +204,6 @@ public:
 
             if(content.ReadWaveFile(fileName))
             {
-                if(content.SamplesPerSecond != FILTER_SAMPLE_RATE)
-                {
-                    mLastError = std::string()
-                        + "Error: file " + fileName + " has an unsupported frequency! Currently only "
-                        + std::to_string(FILTER_SAMPLE_RATE) + " frequency is supported!";
-
-                    return AMF_FAIL;
-                }
-
                 bool converted = content.Convert2Stereo16Bit();
 
                 if(!converted && content.BitsPerSample != 16)
@@ -230,6 +222,15 @@ public:
                     return AMF_FAIL;
                 }
 
+                if(content.SamplesPerSecond != FILTER_SAMPLE_RATE && !ResampleWav(content))
+                {
+                    mLastError = std::string()
+                        + "Error: file " + fileName + " could not be resampled to "
+                        + std::to_string(FILTER_SAMPLE_RATE) + " Hz!";
+
+                    return AMF_FAIL;
+                }
+
                 if(content.SamplesCount < mBufferSizeInSamples)
                 {
                     mLastError = std::string()
@@ -549,6 +550,95 @@ protected:
     PrioritizedThread           mProcessThread;
     PrioritizedThread           mUpdateThread;
 
+    // Converts 16 bit stereo content to FILTER_SAMPLE_RATE on the CPU.
+    static bool ResampleWav(WavContent & content)
+    {
+        const amf_size block = 4096;
+
+        amf::TANContextPtr context;
+        amf::TANConverterPtr converter;
+        amf::TANResamplerPtr resampler;
+
+        if(TANCreateContext(TAN_FULL_VERSION, &context, nullptr) != AMF_OK
+            || TANCreateConverter(context, &converter) != AMF_OK
+            || converter->Init() != AMF_OK
+            || TANCreateResampler(context, &resampler) != AMF_OK
+            || resampler->Init(content.SamplesPerSecond, FILTER_SAMPLE_RATE, STEREO_CHANNELS_COUNT, block) != AMF_OK)
+        {
+            return false;
+        }
+
+        // the input is followed by the filter latency of zeros, so the end comes out too
+        const amf_size inputFrames = content.SamplesCount + resampler->GetLatency();
+        const amf_size outputFrames = amf_size(uint64_t(content.SamplesCount) * FILTER_SAMPLE_RATE / content.SamplesPerSecond);
+
+        std::vector<float> input[STEREO_CHANNELS_COUNT];
+        std::vector<float> output[STEREO_CHANNELS_COUNT];
+        float * planes[STEREO_CHANNELS_COUNT];
+
+        for(int c = 0; c < STEREO_CHANNELS_COUNT; c++)
+        {
+            input[c].resize(inputFrames, 0.0f);
+            output[c].resize(outputFrames + 1);
+            planes[c] = input[c].data();
+        }
+
+        if(converter->ConvertInterleaved(content.Data.data(), amf::TAN_SAMPLE_TYPE_SHORT, STEREO_CHANNELS_COUNT,
+            content.SamplesCount, planes, 1.0f) != AMF_OK)
+        {
+            return false;
+        }
+
+        amf_size produced = 0;
+
+        for(amf_size frame = 0; frame < inputFrames && produced < outputFrames; frame += block)
+        {
+            amf_size count = (std::min)(block, inputFrames - frame);
+            amf_size outputs = resampler->GetOutputSampleCount(count);
+            float * in[STEREO_CHANNELS_COUNT];
+
+            for(int c = 0; c < STEREO_CHANNELS_COUNT; c++)
+            {
+                if(output[c].size() < produced + outputs)
+                {
+                    output[c].resize(produced + outputs);
+                }
+
+                in[c] = input[c].data() + frame;
+                planes[c] = output[c].data() + produced;
+            }
+
+            if(resampler->Process(in, count, planes, outputs, &outputs) != AMF_OK)
+            {
+                return false;
+            }
+
+            produced += outputs;
+        }
+
+        const amf_size frames = (std::min)(produced, outputFrames);
+        std::vector<uint8_t> data(frames * STEREO_CHANNELS_COUNT * sizeof(int16_t));
+
+        for(int c = 0; c < STEREO_CHANNELS_COUNT; c++)
+        {
+            planes[c] = output[c].data();
+        }
+
+        bool clipped = false;
+
+        if(converter->ConvertInterleaved(planes, STEREO_CHANNELS_COUNT, frames, data.data(),
+            amf::TAN_SAMPLE_TYPE_SHORT, 1.0f, &clipped) != AMF_OK)
+        {
+            return false;
+        }
+
+        content.Data.swap(data);
+        content.SamplesCount = uint32_t(frames);
+        content.SamplesPerSecond = FILTER_SAMPLE_RATE;
+
+        return true;
+    }
+
     virtual int                 ProcessProc() = 0;
     virtual int                 UpdateProc() = 0;
     virtual AMF_RESULT          Process(int16_t * pOut, int16_t * pChan[MAX_SOURCES], uint32_t sampleCount) = 0;
@@ -71,6 +71,38 @@
 #endif // #ifdef _WIN32
 
 #define TAN_OUTPUT_MEMORY_TYPE         L"OutputMemoryType" // Values : AMF_MEMORY_OPENCL or AMF_MEMORY_METAL or AMF_MEMORY_HOST
+#define TAN_CONVOLUTION_OVERLAP_SAVE   L"ConvolutionOverlapSave" // bool, default false: CPU partitioned convolution uses overlap-save instead of overlap-add, read by Init
+#define TAN_CONVERTER_DITHER           L"ConverterDither" // TAN_DITHER_MODE, default TAN_DITHER_NONE: dither of float to short conversion in host memory, read by Init
+
+// Internal threads of TANConvolution (the IR update thread). Set on the TANContext for all of its
+// convolutions, or on a TANConvolution with TAN_THREAD_SCHEDULING other than
+// TAN_THREAD_SCHEDULING_CONTEXT to override all four. Read by Init, which fails if they can't be
+// applied, e.g. real time scheduling without CAP_SYS_NICE or an RLIMIT_RTPRIO on Linux. The
+// worker threads of a TANContext take the ones of the context, read by InitThreadPool.
+#define TAN_THREAD_SCHEDULING          L"ThreadScheduling" // TAN_THREAD_SCHEDULING_CLASS, default TAN_THREAD_SCHEDULING_CONTEXT on TANConvolution, TAN_THREAD_SCHEDULING_NORMAL on TANContext
+#define TAN_THREAD_PRIORITY            L"ThreadPriority" // int64, default 0: real time priority, 0 for the lowest of the scheduling class, ignored on Windows
+#define TAN_THREAD_AFFINITY            L"ThreadAffinity" // int64, default 0: mask of the processors the threads may run on, 0 for all
+#define TAN_THREAD_LOCK_MEMORY         L"ThreadLockMemory" // bool, default false: lock all current and future memory of the process (mlockall), Linux only
+
+// Statistics of TANConvolution, TANFFT, TANIIRfilter and TANMath since they were created or
+// reset, read only int64. Blocks are the calls of Process, Transform and the host memory
+// operations of TANMath; a block of a TANConvolution or TANIIRfilter overruns when it takes
+// longer than its samples last at TAN_STATS_SAMPLE_RATE. Times are in ns.
+#define TAN_STATS_RESET                L"StatsReset" // bool, default false: write true to zero all statistics
+#define TAN_STATS_SAMPLE_RATE          L"StatsSampleRate" // int64, default 48000: sample rate of the overrun deadline
+#define TAN_STATS_BLOCKS               L"StatsBlocks"
+#define TAN_STATS_OVERRUNS             L"StatsOverruns" // TANConvolution and TANIIRfilter
+#define TAN_STATS_IR_UPDATES           L"StatsIRUpdates" // TANConvolution: responses transformed by the update thread
+#define TAN_STATS_IR_DROPPED           L"StatsIRDropped" // TANConvolution: updates replaced by a later one before the update thread took them
+#define TAN_STATS_CROSSFADES           L"StatsCrossfades" // TANConvolution
+#define TAN_STATS_STAGE_TIMES          L"StatsStageTimes" // TANConvolution, bool, default false: time the stages within the blocks too
+// Duration of a stage: L"Block", and for TANConvolution on CPU with TAN_STATS_STAGE_TIMES
+// L"InputFFT", L"MAC", L"Tail", L"IFFT", L"Crossfade" and L"IRUpdate"; statistic is L"P50",
+// L"P99" or L"Max".
+#define TAN_STATS_STAGE_TIME(stage, statistic) L"Stats" stage L"Time" statistic
+#define TAN_STATS_BLOCK_TIME_P50       TAN_STATS_STAGE_TIME(L"Block", L"P50")
+#define TAN_STATS_BLOCK_TIME_P99       TAN_STATS_STAGE_TIME(L"Block", L"P99")
+#define TAN_STATS_BLOCK_TIME_MAX       TAN_STATS_STAGE_TIME(L"Block", L"Max")
 
 static const amf::AMFEnumDescriptionEntry AMF_MEMORY_ENUM_DESCRIPTION[] =
 {
@@ -90,6 +122,41 @@ namespace amf
     {
         TAN_SAMPLE_TYPE_FLOAT       = 0,
         TAN_SAMPLE_TYPE_SHORT       = 1,
+        TAN_SAMPLE_TYPE_INT32       = 2,    // full scale 32 bit, also 24 bit samples left aligned in 32 bit words
+        TAN_SAMPLE_TYPE_INT24_IN_32 = 3,    // 24 bit samples in the low three bytes of 32 bit words
+        TAN_SAMPLE_TYPE_INT24       = 4,    // packed little endian 24 bit samples, 3 bytes each
+    };
+
+    enum TAN_DITHER_MODE
+    {
+        TAN_DITHER_NONE             = 0,    // round to nearest
+        TAN_DITHER_TRIANGULAR       = 1,    // triangular (TPDF) dither of +-1 LSB
+        TAN_DITHER_NOISE_SHAPED     = 2,    // triangular dither with first order noise shaping
+    };
+
+    static const AMFEnumDescriptionEntry TAN_DITHER_ENUM_DESCRIPTION[] =
+    {
+        {TAN_DITHER_NONE,           L"None"},
+        {TAN_DITHER_TRIANGULAR,     L"Triangular"},
+        {TAN_DITHER_NOISE_SHAPED,   L"Noise shaped"},
+        {0,                         0}  // This is end of description mark
+    };
+
+    enum TAN_THREAD_SCHEDULING_CLASS
+    {
+        TAN_THREAD_SCHEDULING_CONTEXT   = -1,   // TANConvolution only: the thread properties of the context
+        TAN_THREAD_SCHEDULING_NORMAL    = 0,    // time shared, SCHED_OTHER
+        TAN_THREAD_SCHEDULING_FIFO      = 1,    // real time SCHED_FIFO, THREAD_PRIORITY_TIME_CRITICAL on Windows
+        TAN_THREAD_SCHEDULING_RR        = 2,    // real time SCHED_RR, THREAD_PRIORITY_TIME_CRITICAL on Windows
+    };
+
+    static const AMFEnumDescriptionEntry TAN_THREAD_SCHEDULING_ENUM_DESCRIPTION[] =
+    {
+        {TAN_THREAD_SCHEDULING_CONTEXT, L"Context"},
+        {TAN_THREAD_SCHEDULING_NORMAL,  L"Normal"},
+        {TAN_THREAD_SCHEDULING_FIFO,    L"Real time FIFO"},
+        {TAN_THREAD_SCHEDULING_RR,      L"Real time round robin"},
+        {0,                             0}  // This is end of description mark
     };
 
     class TANContext;
@@ -328,7 +395,7 @@ namespace amf
             // Initialization function.
             //
             // Note: this method allocates internal buffers and initializes internal structures. Should
-            // only be called once.
+            // only be called once. channels can be 0, channels are then added with AddChannel.
             virtual	AMF_RESULT	AMF_STD_CALL	Init(
             amf_uint32 numInputTaps,
             amf_uint32 numOutputTaps,
@@ -338,6 +405,8 @@ namespace amf
         virtual AMF_RESULT  AMF_STD_CALL    Terminate() = 0;
         virtual TANContext* AMF_STD_CALL    GetContext() = 0;
 
+        // A channel whose ppInputResponse entry is NULL keeps its responses, responses longer
+        // than the taps of a channel are cut to them.
         virtual AMF_RESULT AMF_STD_CALL UpdateIIRResponses(
             float* ppInputResponse[],
             float* ppOutputResponse[],
@@ -380,6 +449,43 @@ namespace amf
            ) = 0;
 #endif
 
+        // Second order sections initialization, instead of Init: every channel is a cascade of
+        // numSections biquads in transposed direct form II, all passing their input through
+        // until UpdateSections. Process and ProcessDirect with host memory filter on the CPU,
+        // channels side by side in SIMD lanes.
+        virtual AMF_RESULT  AMF_STD_CALL    InitSections(
+            amf_uint32 numSections,
+            amf_uint32 bufferSizeInSamples,
+            amf_uint32 channels) = 0;
+
+        // ppSections[channel] holds numSections rows of b0, b1, b2, a0, a1, a2, the sos
+        // layout of scipy and MATLAB, a0 must not be 0. The filter state is kept, so the
+        // sections can be changed while a stream runs.
+        virtual AMF_RESULT  AMF_STD_CALL    UpdateSections(float* ppSections[]) = 0;
+
+        // Taps mode channels, after Init: AddChannel appends a channel with its own tap counts,
+        // numInputTaps at least 1, as the last entry of the buffer arrays. It starts silent, with
+        // zero taps and history. RemoveChannel moves the channels after it down by one. The other
+        // channels keep their taps and history either way.
+        virtual AMF_RESULT  AMF_STD_CALL    AddChannel(amf_uint32 numInputTaps, amf_uint32 numOutputTaps) = 0;
+        virtual AMF_RESULT  AMF_STD_CALL    RemoveChannel(amf_uint32 channel) = 0;
+        virtual amf_uint32  AMF_STD_CALL    GetChannelCount() = 0;
+
+        // Second order sections mode for a few channels of long buffers, as in offline rendering:
+        // every channel's buffer is cut into chunks that are filtered side by side from zero
+        // state, in SIMD lanes and on all OpenMP threads, and then corrected with the response
+        // to the state each chunk really starts from. The output is that of serial filtering,
+        // for about 1.5 times the arithmetic; buffers shorter than 4096 samples are filtered
+        // serially. With 16 channels or more the lanes are full anyway, leave it off.
+        virtual AMF_RESULT  AMF_STD_CALL    SetBlockParallel(bool enable) = 0;
+
+        // As UpdateSections, but the sections glide from the current ones to these over the next
+        // Process call instead of switching at once, for parameter automation without clicks
+        // or zipper noise. The glide runs in state variable filter parameters, every filter on
+        // the way is stable; the current and the new sections must be stable. A later
+        // UpdateSections or RampSections replaces a glide that hasn't run yet.
+        virtual AMF_RESULT  AMF_STD_CALL    RampSections(float* ppSections[]) = 0;
+
     };
 
 	//----------------------------------------------------------------------------------------------
@@ -401,6 +507,7 @@ namespace amf
     // TANConverter interface
     //
     // Provides conversion between normalized FLOAT and SHORT representations.
+    // The typed overloads also convert FLOAT to and from 32 bit and 24 bit integers.
     //
     // Converts an array of floats int the range - 1.0 -> + 1.0
     //    to or from
@@ -410,6 +517,9 @@ namespace amf
     //    outputStep	interleave step size for outputBuffer.
     //
     //    conversionGain = 1.0 gives standard - 1.0 -> + 1.0 to / from - 32768 -> + 32768
+    //    and to / from the full scale of the wider integer types likewise.
+    //
+    //    Steps and offsets count samples, not bytes, for every sample type.
     //
     //NOTE: to interleave or deinterleave data : Use step = 1 for mono data, 2 for stereo, etc.
     //----------------------------------------------------------------------------------------------
@@ -444,6 +554,26 @@ namespace amf
                                                     float conversionGain,
                                                     int channels, bool* outputClipped = NULL) = 0;
 
+        // Typed conversion in host memory, one of the two types has to be TAN_SAMPLE_TYPE_FLOAT.
+        virtual AMF_RESULT  AMF_STD_CALL    Convert(const void* inputBuffer, amf_size inputStep,
+                                                    TAN_SAMPLE_TYPE inputType,
+                                                    amf_size numOfSamplesToProcess,
+                                                    void* outputBuffer, amf_size outputStep,
+                                                    TAN_SAMPLE_TYPE outputType,
+                                                    float conversionGain, bool* outputClipped = NULL) = 0;
+
+        // Interleaved buffers in host memory, sample c of frame i is at buffer[i * channels + c].
+        // Every channel is converted in a single pass over the interleaved buffer.
+        virtual AMF_RESULT  AMF_STD_CALL    ConvertInterleaved(const void* inputBuffer,
+                                                    TAN_SAMPLE_TYPE inputType,
+                                                    int channels, amf_size numOfFrames,
+                                                    float** outputBuffers,
+                                                    float conversionGain) = 0;
+        virtual AMF_RESULT  AMF_STD_CALL    ConvertInterleaved(const float* const* inputBuffers,
+                                                    int channels, amf_size numOfFrames,
+                                                    void* outputBuffer,
+                                                    TAN_SAMPLE_TYPE outputType,
+                                                    float conversionGain, bool* outputClipped = NULL) = 0;
 
 #ifndef TAN_NO_OPENCL
         virtual AMF_RESULT  AMF_STD_CALL    Convert(cl_mem inputBuffer,
@@ -509,12 +639,45 @@ namespace amf
     //----------------------------------------------------------------------------------------------
     typedef AMFInterfacePtr_T<TANConverter> TANConverterPtr;
 
+    enum TAN_GAIN_RAMP
+    {
+        TAN_GAIN_RAMP_LINEAR        = 0,    // gain changes by the same amount every sample
+        TAN_GAIN_RAMP_EXPONENTIAL   = 1,    // gain changes by the same ratio (dB) every sample, gains must be > 0
+    };
+
+    enum TAN_COMPLEX_LAYOUT_TYPE
+    {
+        TAN_COMPLEX_LAYOUT_INTERLEAVED  = 0,    // (real, imag) pairs
+        TAN_COMPLEX_LAYOUT_PLANAR       = 1,    // all real parts, the imaginary parts planeSpacing floats later
+    };
+
+    // Memory layout of a complex vector, as produced by TANFFT and consumed by TANMath.
+    // The planar spectra of TANFFT's R2C / C2R transforms use planeSpacing = 2 ^ (log2len - 1) + 8.
+    struct TANComplexLayout
+    {
+        TAN_COMPLEX_LAYOUT_TYPE type;
+        amf_size                planeSpacing;   // in floats, from real[0] to imag[0], planar only
+    };
+
+    inline TANComplexLayout TANInterleavedLayout()
+    {
+        TANComplexLayout layout = { TAN_COMPLEX_LAYOUT_INTERLEAVED, 0 };
+        return layout;
+    }
+
+    inline TANComplexLayout TANPlanarLayout(amf_size planeSpacing)
+    {
+        TANComplexLayout layout = { TAN_COMPLEX_LAYOUT_PLANAR, planeSpacing };
+        return layout;
+    }
+
     //----------------------------------------------------------------------------------------------
     // TANMath interface
     //
     // Provides mathematical utility functions.
     //
     // buffers are arrays of channels pointers to floats, each at least numOfSamplesToProcess long.
+    // CPU buffers need no particular alignment and no padding past the last element.
     //----------------------------------------------------------------------------------------------
     class TANMath : virtual public AMFPropertyStorageEx
     {
@@ -592,6 +755,25 @@ namespace amf
 			amf_uint32 channels,
 			amf_size numOfSamplesToProcess,
 			amf_uint riPlaneSpacing) = 0;
+
+        // accumbuffers += inputBuffers1 * inputBuffers2, every operand in its own layout, so
+        // for instance an interleaved FFT output can be multiplied with planar stored filters.
+        virtual AMF_RESULT ComplexMultiplyAccumulate(	const float* const inputBuffers1[],
+														TANComplexLayout layout1,
+														const float* const inputBuffers2[],
+														TANComplexLayout layout2,
+														float *accumbuffers[],
+														TANComplexLayout accumLayout,
+														amf_uint32 channels,
+														amf_size countOfComplexNumbers) = 0;
+
+        // Rewrites complex vectors in another layout, output must not overlap input.
+        virtual AMF_RESULT ConvertComplexLayout(		const float* const inputBuffers[],
+														TANComplexLayout inputLayout,
+														float *outputBuffers[],
+														TANComplexLayout outputLayout,
+														amf_uint32 channels,
+														amf_size countOfComplexNumbers) = 0;
 #ifdef USE_IPP
 		virtual AMF_RESULT IPPComplexMultiplyAccumulate(const float* const inputBuffers1[],
 			const float* const inputBuffers2[],
@@ -622,6 +804,7 @@ namespace amf
 #endif
 
 
+        // A zero divisor yields zero: |divisor|^2 is clamped to a small epsilon on CPU and GPU.
         virtual AMF_RESULT ComplexDivision(				const float* const inputBuffers1[],
 														const float* const inputBuffers2[],
 														float *outputBuffers[],
@@ -651,6 +834,139 @@ namespace amf
 													    amf_uint32 channels,
 													    amf_size numOfSamplesToProcess) = 0;
 
+#endif
+
+        // Sums the countOfComplexNumbers complex values of each channel,
+        // outputBuffers[channel][0] and [1] receive the real and imaginary sum.
+        virtual AMF_RESULT ComplexSum(					const float* const inputBuffers[],
+														float *outputBuffers[],
+														amf_uint32 channels,
+														amf_size countOfComplexNumbers) = 0;
+
+        // Real vector operations, one gain or result per channel. Host buffers run on the CPU,
+        // device buffers on the context's queue. Outputs may alias the inputs.
+
+        // outputBuffers = gains * inputBuffers
+        virtual AMF_RESULT Scale(						const float* const inputBuffers[],
+														float *outputBuffers[],
+														const float gains[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        // Gain goes from startGains at the first sample towards endGains, which the sample after
+        // the block would get, so consecutive blocks ramp without a step.
+        virtual AMF_RESULT GainRamp(					const float* const inputBuffers[],
+														float *outputBuffers[],
+														const float startGains[],
+														const float endGains[],
+														TAN_GAIN_RAMP ramp,
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        // accumBuffers += gains * inputBuffers
+        virtual AMF_RESULT AccumulateWithGain(			const float* const inputBuffers[],
+														float *accumBuffers[],
+														const float gains[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        // results[channel] = sum of inputBuffers1[channel][i] * inputBuffers2[channel][i]
+        virtual AMF_RESULT DotProduct(					const float* const inputBuffers1[],
+														const float* const inputBuffers2[],
+														float results[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        // Per channel peak (max absolute value) and RMS, either output array can be NULL.
+        virtual AMF_RESULT PeakRms(						const float* const inputBuffers[],
+														float peaks[],
+														float rms[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+#ifndef TAN_NO_OPENCL
+        virtual AMF_RESULT Scale(						const cl_mem inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														cl_mem outputBuffers[],
+														const amf_size outputBuffersOffsetInSamples[],
+														const float gains[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        virtual AMF_RESULT GainRamp(					const cl_mem inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														cl_mem outputBuffers[],
+														const amf_size outputBuffersOffsetInSamples[],
+														const float startGains[],
+														const float endGains[],
+														TAN_GAIN_RAMP ramp,
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        virtual AMF_RESULT AccumulateWithGain(			const cl_mem inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														cl_mem accumBuffers[],
+														const amf_size accumBuffersOffsetInSamples[],
+														const float gains[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        // results, peaks and rms are host arrays, the call waits for the device
+        virtual AMF_RESULT DotProduct(					const cl_mem inputBuffers1[],
+														const amf_size buffers1OffsetInSamples[],
+														const cl_mem inputBuffers2[],
+														const amf_size buffers2OffsetInSamples[],
+														float results[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        virtual AMF_RESULT PeakRms(						const cl_mem inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														float peaks[],
+														float rms[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+#else
+        virtual AMF_RESULT Scale(						const AMFBuffer * inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														AMFBuffer * outputBuffers[],
+														const amf_size outputBuffersOffsetInSamples[],
+														const float gains[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        virtual AMF_RESULT GainRamp(					const AMFBuffer * inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														AMFBuffer * outputBuffers[],
+														const amf_size outputBuffersOffsetInSamples[],
+														const float startGains[],
+														const float endGains[],
+														TAN_GAIN_RAMP ramp,
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        virtual AMF_RESULT AccumulateWithGain(			const AMFBuffer * inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														AMFBuffer * accumBuffers[],
+														const amf_size accumBuffersOffsetInSamples[],
+														const float gains[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        virtual AMF_RESULT DotProduct(					const AMFBuffer * inputBuffers1[],
+														const amf_size buffers1OffsetInSamples[],
+														const AMFBuffer * inputBuffers2[],
+														const amf_size buffers2OffsetInSamples[],
+														float results[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
+
+        virtual AMF_RESULT PeakRms(						const AMFBuffer * inputBuffers[],
+														const amf_size inputBuffersOffsetInSamples[],
+														float peaks[],
+														float rms[],
+														amf_uint32 channels,
+														amf_size numOfSamplesToProcess) = 0;
 #endif
     };
     //----------------------------------------------------------------------------------------------
@@ -697,6 +1013,37 @@ namespace amf
                                                       float* pBufferInput[],
                                                       float* pBufferOutput[]) = 0;
 
+        // Convolution-specialized FFT, skips the work spent on zero padding and discarded output.
+        //
+        // Note: only the first 'nonZeroInputLength' samples of each input channel are read,
+        //       the remaining samples up to 2 ^ log2len must be zero.
+        // Note: only the first 'requiredOutputLength' samples of each output channel are valid
+        //       after the call, the rest of the output buffer is undefined.
+        // Note: lengths are counted in complex values on complex sides and in real values on the
+        //       real input of R2C / real output of C2R transforms, 0 means the full length.
+        // Note: only the built-in CPU transform skips work. FFTW runs the full transform and
+        //       skips the scaling of the discarded output, IPP and GPU run a plain Transform.
+        virtual AMF_RESULT  AMF_STD_CALL    TransformPruned(TAN_FFT_TRANSFORM_DIRECTION direction,
+                                                      amf_uint32 log2len,
+                                                      amf_uint32 channels,
+                                                      float* pBufferInput[],
+                                                      float* pBufferOutput[],
+                                                      amf_uint32 nonZeroInputLength,
+                                                      amf_uint32 requiredOutputLength) = 0;
+
+        // Creates and compiles everything a later transform of this shape needs, so that the
+        // first Transform / TransformBatchGPU call doesn't pay for it. Meant to be called from
+        // Init-time code; on the GPU this bakes the clFFT plan, whose kernels are loaded from
+        // the clFFT binary cache in TANSetCacheFolder's folder when one is set.
+        // Note: 'dataSpacing' must match the one later passed to TransformBatchGPU, 0 for Transform.
+        virtual AMF_RESULT  AMF_STD_CALL    Prepare(TAN_FFT_TRANSFORM_DIRECTION direction,
+                                                      amf_uint32 log2len,
+                                                      amf_uint32 channels,
+                                                      int dataSpacing) = 0;
+
+        // Layout of the complex side of a transform, input of backward and output of forward ones.
+        virtual TANComplexLayout AMF_STD_CALL GetComplexLayout(TAN_FFT_TRANSFORM_DIRECTION direction,
+                                                      amf_uint32 log2len) = 0;
 
 #ifndef TAN_NO_OPENCL
         virtual AMF_RESULT  AMF_STD_CALL    TransformBatchGPU(TAN_FFT_TRANSFORM_DIRECTION direction,
@@ -720,6 +1067,25 @@ namespace amf
 	//----------------------------------------------------------------------------------------------
 	typedef AMFInterfacePtr_T<TANFFT> TANFFTPtr;
 
+    enum TAN_EQ_BAND_TYPE
+    {
+        TAN_EQ_BAND_PEAKING     = 0,    // gainDb around frequency, q sets the bandwidth
+        TAN_EQ_BAND_LOW_SHELF   = 1,    // gainDb below frequency, q sets the slope
+        TAN_EQ_BAND_HIGH_SHELF  = 2,    // gainDb above frequency, q sets the slope
+        TAN_EQ_BAND_LOW_PASS    = 3,    // 12 dB per octave above frequency, q the resonance
+        TAN_EQ_BAND_HIGH_PASS   = 4,    // 12 dB per octave below frequency, q the resonance
+    };
+
+    // One band of a parametric equalizer, the RBJ cookbook biquad of its type. q = 0.7071 is
+    // the flattest pass band and shelf.
+    struct TANEQBand
+    {
+        TAN_EQ_BAND_TYPE    type;
+        float               frequency;  // Hz, below half the sample rate
+        float               q;
+        float               gainDb;     // peaking and shelves only
+    };
+
     class TANFilter : virtual public AMFPropertyStorageEx
     {
     public:
@@ -736,6 +1102,27 @@ namespace amf
                                                              float sampleRate,
                                                              float *impulseResponse,
                                                              float dbLevels[10]) = 0;
+
+        // Parametric equalizers for many channels in one call: the frequency response, magnitude
+        // and phase, of the cascade of bandCounts[channel] bands in ppBands[channel], as the
+        // 2 ^ (log2len - 1) + 1 bins of a 2 ^ log2len point real transform in layout.
+        // The same response goes into each of partitions spectra per channel, partitionStride
+        // floats apart; with planar layout, planeSpacing 2 ^ (log2len - 1) + 8 and
+        // partitionStride 2 ^ log2len + 16, that is the R2C planar layout of TANFFT and of the
+        // partitions of TANConvolution's partitioned methods, padding included, which is zeroed.
+        // With multiply the spectra there are multiplied by the response instead, which
+        // folds the equalizer into a response spectrum; that is exact as long as the equalizer's
+        // impulse response dies out within the zero padded half of the transform.
+        virtual AMF_RESULT  AMF_STD_CALL    generateParametricEQ(amf_uint32 log2len,
+                                                                 float sampleRate,
+                                                                 amf_uint32 channels,
+                                                                 const TANEQBand * const ppBands[],
+                                                                 const amf_uint32 bandCounts[],
+                                                                 float * ppSpectra[],
+                                                                 TANComplexLayout layout,
+                                                                 amf_uint32 partitions,
+                                                                 amf_size partitionStride,
+                                                                 bool multiply) = 0;
      };
 
     //----------------------------------------------------------------------------------------------
@@ -743,6 +1130,21 @@ namespace amf
     //----------------------------------------------------------------------------------------------
     typedef AMFInterfacePtr_T<TANFilter> TANFilterPtr;
 
+    //----------------------------------------------------------------------------------------------
+    // Components whose CPU paths share the worker threads of a context, see
+    // TANContext::SetThreadBudget.
+    //----------------------------------------------------------------------------------------------
+    enum TAN_THREAD_BUDGET_COMPONENT
+    {
+        TAN_THREAD_BUDGET_FFT = 0,
+        TAN_THREAD_BUDGET_MATH,
+        TAN_THREAD_BUDGET_CONVOLUTION,  // with the transforms of convolutions and the TANMath
+                                        // objects on the convolution queue
+        TAN_THREAD_BUDGET_IIR_FILTER,
+        TAN_THREAD_BUDGET_MIXER,
+        TAN_THREAD_BUDGET_COUNT
+    };
+
     //----------------------------------------------------------------------------------------------
     // TANContext interface:
     // TANContext may be initialized for OpenCL using either a cl_context, or one or two
@@ -779,6 +1181,7 @@ namespace amf
 
 #endif
 
+        // Same as InitThreadPool(nThreads, 0), the library no longer uses OpenMP teams.
 		virtual AMF_RESULT  AMF_STD_CALL    InitOpenMP(int nThreads) = 0;
 
 #ifndef TAN_NO_OPENCL
@@ -804,6 +1207,22 @@ namespace amf
 #endif
 
         virtual amf::AMFFactory *           GetFactory() = 0;
+
+        // The CPU paths of the objects created with the context run their loops on the calling
+        // thread and on worker threads owned by the context, instead of OpenMP teams shared with
+        // the rest of the process. threads counts the calling thread, 0 picks a quarter of the
+        // processors, the default; the workers are pinned round robin to the processors in
+        // affinityMask, 0 leaves them to TAN_THREAD_AFFINITY. The workers run with the
+        // TAN_THREAD_* properties the context has now, InitThreadPool fails as the Init of
+        // TANConvolution does if they can't be applied. Workers are otherwise started by the
+        // first object initialized for the CPU, with normal scheduling.
+        virtual AMF_RESULT  AMF_STD_CALL    InitThreadPool(amf_uint32 threads, amf_uint64 affinityMask) = 0;
+
+        // Most threads, the calling one included, that one loop of component takes, 0 for all
+        // of the pool, the default. Loops of different objects don't overlap on the workers: a
+        // loop started while another one runs runs on its calling thread alone.
+        virtual AMF_RESULT  AMF_STD_CALL    SetThreadBudget(TAN_THREAD_BUDGET_COMPONENT component, amf_uint32 threads) = 0;
+        virtual amf_uint32  AMF_STD_CALL    GetThreadBudget(TAN_THREAD_BUDGET_COMPONENT component) = 0;
     };
 
     //----------------------------------------------------------------------------------------------
@@ -817,6 +1236,9 @@ namespace amf
     // Mixes the input audio channels
     //
     // Mixes a set of floating point arrays each representing one channel's audio samples
+    //
+    // In matrix mode every input is routed to every output through its own gain, e.g. to fold
+    // sources down to stereo or 5.1 buses and reverb sends at the same time.
     //----------------------------------------------------------------------------------------------
     class TANMixer : virtual public AMFPropertyStorageEx
     {
@@ -858,11 +1280,137 @@ namespace amf
 
 #endif
 
+        // Matrix mode, num_inputs inputs to num_outputs outputs with all gains 0.
+        // Init(buffer_size, num_channels) is the num_channels x 1 matrix with all gains 1.
+        virtual AMF_RESULT  AMF_STD_CALL    Init(amf_size buffer_size,
+                                                 int num_inputs,
+                                                 int num_outputs
+                                                 ) = 0;
+
+        // gains[output * num_inputs + input]. The next matrix Mix ramps linearly from the current
+        // gains to these over its block, so gains can change every block without zipper noise.
+        virtual AMF_RESULT  AMF_STD_CALL    SetGains(const float * gains) = 0;
+
+        // Matrix mix, every output is the sum of its routes. Routes whose gain is 0 before and
+        // after the block are skipped, so sparse matrices cost only their nonzero routes.
+        virtual AMF_RESULT  AMF_STD_CALL    Mix(float* ppBufferInput[],
+                                                float* ppBufferOutput[]
+                                                ) = 0;
+
+#ifndef TAN_NO_OPENCL
+
+        virtual AMF_RESULT  AMF_STD_CALL    Mix(cl_mem pBufferInput[],
+                                                cl_mem pBufferOutput[]
+                                                ) = 0;
+
+#else
+
+        virtual AMF_RESULT  AMF_STD_CALL    Mix(AMFBuffer * pBufferInput[],
+                                                AMFBuffer * pBufferOutput[]
+                                                ) = 0;
+
+#endif
+
+        // Host memory mixes of count samples, count may differ from buffer_size from call to call
+        // and the buffers need no particular alignment. With accumulate the mix is added to
+        // the output instead of replacing it. A matrix mix ramps its gains over these count samples.
+        virtual AMF_RESULT  AMF_STD_CALL    Mix(float* ppBufferInput[],
+                                                float* ppBufferOutput,
+                                                amf_size count,
+                                                bool accumulate
+                                                ) = 0;
+
+        virtual AMF_RESULT  AMF_STD_CALL    Mix(float* ppBufferInput[],
+                                                float* ppBufferOutput[],
+                                                amf_size count,
+                                                bool accumulate
+                                                ) = 0;
+
     };
     //----------------------------------------------------------------------------------------------
     // smart pointer
     //----------------------------------------------------------------------------------------------
     typedef AMFInterfacePtr_T<TANMixer> TANMixerPtr;
+
+    //----------------------------------------------------------------------------------------------
+    // TANResampler interface
+    //
+    // Multi-channel windowed sinc sample rate converter.
+    //
+    // Rate pairs whose ratio reduces to a small fraction (44.1k, 48k, 96k and the other usual
+    // rates) are converted exactly with a polyphase filter bank. Other pairs, and any stream
+    // after SetRatio, advance a fixed point read position and interpolate between the phases
+    // of a finer filter bank.
+    //
+    // The converter streams: Process consumes all of its input and returns the outputs whose
+    // filter window is complete, the rest follow in later calls. Output sample n is at input
+    // time n * inputRate / outputRate, so output lags input by GetLatency() input samples;
+    // append that many zeros to flush the end of a stream.
+    //
+    // A stream is processed either in host memory or in device memory, the two keep separate
+    // histories.
+    //----------------------------------------------------------------------------------------------
+    class TANResampler : virtual public AMFPropertyStorageEx
+    {
+    public:
+        AMF_DECLARE_IID(0x3f1c9a52, 0x8e47, 0x4b0d, 0x96, 0x2a, 0x5d, 0x71, 0xc4, 0x0e, 0xb8, 0x13)
+
+        // maxInputSamples bounds numOfInputSamples of every Process call.
+        virtual AMF_RESULT  AMF_STD_CALL    Init(amf_uint32 inputRate,
+                                                 amf_uint32 outputRate,
+                                                 amf_uint32 channels,
+                                                 amf_size maxInputSamples) = 0;
+        virtual AMF_RESULT  AMF_STD_CALL    Terminate() = 0;
+        virtual TANContext* AMF_STD_CALL    GetContext() = 0;
+
+        // Clears the history and restarts the stream at output sample 0 with the Init ratio.
+        virtual AMF_RESULT  AMF_STD_CALL    Reset() = 0;
+
+        // Changes the ratio of a running stream to outputRate / inputRate = ratio, e.g. to follow
+        // clock drift. The anti-aliasing filter stays the one designed for the Init rates, so
+        // ratio must be within a factor of two of theirs.
+        virtual AMF_RESULT  AMF_STD_CALL    SetRatio(double ratio) = 0;
+
+        // Input samples between an input and the output at the same time.
+        virtual amf_size    AMF_STD_CALL    GetLatency() = 0;
+
+        // Exact count of outputs the next Process call makes from numOfInputSamples.
+        virtual amf_size    AMF_STD_CALL    GetOutputSampleCount(amf_size numOfInputSamples) = 0;
+
+        // Every channel has outputCapacity samples of room, at least
+        // GetOutputSampleCount(numOfInputSamples).
+        virtual AMF_RESULT  AMF_STD_CALL    Process(float* ppBufferInput[],
+                                                    amf_size numOfInputSamples,
+                                                    float* ppBufferOutput[],
+                                                    amf_size outputCapacity,
+                                                    amf_size *pNumOfOutputSamples // Can be NULL.
+                                                    ) = 0;
+
+#ifndef TAN_NO_OPENCL
+
+        virtual AMF_RESULT  AMF_STD_CALL    Process(cl_mem ppBufferInput[],
+                                                    amf_size numOfInputSamples,
+                                                    cl_mem ppBufferOutput[],
+                                                    amf_size outputCapacity,
+                                                    amf_size *pNumOfOutputSamples // Can be NULL.
+                                                    ) = 0;
+
+#else
+
+        virtual AMF_RESULT  AMF_STD_CALL    Process(AMFBuffer * ppBufferInput[],
+                                                    amf_size numOfInputSamples,
+                                                    AMFBuffer * ppBufferOutput[],
+                                                    amf_size outputCapacity,
+                                                    amf_size *pNumOfOutputSamples // Can be NULL.
+                                                    ) = 0;
+
+#endif
+
+    };
+    //----------------------------------------------------------------------------------------------
+    // smart pointer
+    //----------------------------------------------------------------------------------------------
+    typedef AMFInterfacePtr_T<TANResampler> TANResamplerPtr;
 }
 
 // TAN objects creation functions.
@@ -884,6 +1432,10 @@ extern "C"
     TAN_SDK_LINK AMF_RESULT         AMF_CDECL_CALL TANCreateMixer(
                                                         amf::TANContext* pContext,
                                                         amf::TANMixer** ppMixer);
+    // Create a TANResampler object:
+    TAN_SDK_LINK AMF_RESULT         AMF_CDECL_CALL TANCreateResampler(
+                                                        amf::TANContext* pContext,
+                                                        amf::TANResampler** ppResampler);
     //Create an TANFFT object:
     TAN_SDK_LINK AMF_RESULT         AMF_CDECL_CALL TANCreateFFT(
                                                         amf::TANContext* pContext,
@@ -902,7 +1454,16 @@ extern "C"
                                                         amf::TANContext* pContext,
                                                         amf::TANIIRfilter** ppIIRfilter);
 
-    // Set folder to cache compiled OpenCL kernels:
+    // Set folder to cache compiled OpenCL kernels (TAN's own kernels and clFFT's, under "clFFT").
+    // Takes effect for contexts initialized after the call; CLFFT_CACHE_PATH, when set, wins for clFFT.
     TAN_SDK_LINK AMF_RESULT         AMF_CDECL_CALL TANSetCacheFolder(const wchar_t* path);
     TAN_SDK_LINK const wchar_t*     AMF_CDECL_CALL TANGetCacheFolder();
+
+    // Stage tracing, in libraries built with TAN_STAGE_TRACE only, AMF_NOT_SUPPORTED otherwise.
+    // While enabled, every TAN thread records the begin and end times of the stages of each block
+    // (input FFT, multiply accumulate, tail, IFFT, crossfade, IR update) into a ring of its last
+    // 16K events, with the block and, inside stages that loop over channels, each channel. The
+    // export writes them as Chrome trace JSON, which Perfetto opens as well.
+    TAN_SDK_LINK AMF_RESULT         AMF_CDECL_CALL TANEnableStageTrace(bool enable);
+    TAN_SDK_LINK AMF_RESULT         AMF_CDECL_CALL TANExportStageTrace(const wchar_t* path);
 }
@@ -0,0 +1,304 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// SSE2 kernels and GetTANIIRKernels(), built for plain x86-64, see core/KernelDispatch.h.
+//
+
+#include "IIRKernels.h"
+
+#include "../core/KernelDispatch.h"
+
+#include <emmintrin.h>
+
+#define AMF_FACILITY L"TANIIRKernels"
+
+using namespace amf;
+
+namespace
+{
+    // Registers per row of IIRSectionLanes floats.
+    const amf_size Vectors = IIRSectionLanes / 4;
+
+    // P sections at a time. The recursion of a section is a chain of dependent operations
+    // from frame to frame, the chains of P sections overlap.
+    template<int P>
+    inline void ProcessPass(
+        float * frames,
+        amf_size count,
+        const float * coefficients,
+        float * state)
+    {
+        __m128 b0[P][Vectors], b1[P][Vectors], b2[P][Vectors], a1[P][Vectors], a2[P][Vectors];
+        __m128 s1[P][Vectors], s2[P][Vectors];
+
+        for (int p = 0; p < P; p++)
+        {
+            const float * c = coefficients + p * IIRSectionCoefficients * IIRSectionLanes;
+            const float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                b0[p][v] = _mm_loadu_ps(c + 0 * IIRSectionLanes + 4 * v);
+                b1[p][v] = _mm_loadu_ps(c + 1 * IIRSectionLanes + 4 * v);
+                b2[p][v] = _mm_loadu_ps(c + 2 * IIRSectionLanes + 4 * v);
+                a1[p][v] = _mm_loadu_ps(c + 3 * IIRSectionLanes + 4 * v);
+                a2[p][v] = _mm_loadu_ps(c + 4 * IIRSectionLanes + 4 * v);
+                s1[p][v] = _mm_loadu_ps(z + 0 * IIRSectionLanes + 4 * v);
+                s2[p][v] = _mm_loadu_ps(z + 1 * IIRSectionLanes + 4 * v);
+            }
+        }
+
+        for (amf_size n = 0; n < count; n++)
+        {
+            float * frame = frames + n * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                __m128 x = _mm_loadu_ps(frame + 4 * v);
+
+                for (int p = 0; p < P; p++)
+                {
+                    __m128 y = _mm_add_ps(_mm_mul_ps(b0[p][v], x), s1[p][v]);
+
+                    s1[p][v] = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(b1[p][v], x), s2[p][v]), _mm_mul_ps(a1[p][v], y));
+                    s2[p][v] = _mm_sub_ps(_mm_mul_ps(b2[p][v], x), _mm_mul_ps(a2[p][v], y));
+                    x = y;
+                }
+
+                _mm_storeu_ps(frame + 4 * v, x);
+            }
+        }
+
+        for (int p = 0; p < P; p++)
+        {
+            float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                _mm_storeu_ps(z + 0 * IIRSectionLanes + 4 * v, s1[p][v]);
+                _mm_storeu_ps(z + 1 * IIRSectionLanes + 4 * v, s2[p][v]);
+            }
+        }
+    }
+
+    void ProcessSectionsSSE2(
+        float * frames,
+        amf_size count,
+        const float * coefficients,
+        float * state,
+        amf_size sections)
+    {
+        // pairs overlap best, more sections per pass run out of registers
+        amf_size s = 0;
+
+        for (; s + 2 <= sections; s += 2)
+        {
+            ProcessPass<2>(frames, count,
+                coefficients + s * IIRSectionCoefficients * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes);
+        }
+
+        if (s < sections)
+        {
+            ProcessPass<1>(frames, count,
+                coefficients + s * IIRSectionCoefficients * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes);
+        }
+    }
+
+    void AddStateResponseSSE2(
+        float * frames,
+        amf_size count,
+        const float * basis,
+        const float * states,
+        amf_size rows)
+    {
+        for (amf_size n = 0; n < count; n++)
+        {
+            float * frame = frames + n * IIRSectionLanes;
+            const float * response = basis + n * rows;
+            __m128 sum[Vectors];
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                sum[v] = _mm_loadu_ps(frame + 4 * v);
+            }
+
+            for (amf_size r = 0; r < rows; r++)
+            {
+                const __m128 weight = _mm_set1_ps(response[r]);
+                const float * row = states + r * IIRSectionLanes;
+
+                for (amf_size v = 0; v < Vectors; v++)
+                {
+                    sum[v] = _mm_add_ps(sum[v], _mm_mul_ps(weight, _mm_loadu_ps(row + 4 * v)));
+                }
+            }
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                _mm_storeu_ps(frame + 4 * v, sum[v]);
+            }
+        }
+    }
+
+    // P ramped sections at a time, as ProcessPass.
+    template<int P>
+    inline void RampPass(
+        float * frames,
+        amf_size count,
+        const float * from,
+        const float * to,
+        float * state,
+        amf_size first,
+        amf_size total)
+    {
+        const float step = 1.0f / float(total);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+
+        __m128 start[P][Vectors][IIRSvfParameters], delta[P][Vectors][IIRSvfParameters];
+        __m128 ic1[P][Vectors], ic2[P][Vectors];
+
+        for (int p = 0; p < P; p++)
+        {
+            const float * p0 = from + p * IIRSvfParameters * IIRSectionLanes;
+            const float * p1 = to + p * IIRSvfParameters * IIRSectionLanes;
+            const float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                for (amf_size q = 0; q < IIRSvfParameters; q++)
+                {
+                    start[p][v][q] = _mm_loadu_ps(p0 + q * IIRSectionLanes + 4 * v);
+                    delta[p][v][q] = _mm_sub_ps(_mm_loadu_ps(p1 + q * IIRSectionLanes + 4 * v), start[p][v][q]);
+                }
+
+                ic1[p][v] = _mm_loadu_ps(z + 0 * IIRSectionLanes + 4 * v);
+                ic2[p][v] = _mm_loadu_ps(z + 1 * IIRSectionLanes + 4 * v);
+            }
+        }
+
+        for (amf_size n = 0; n < count; n++)
+        {
+            float * frame = frames + n * IIRSectionLanes;
+
+            // the last frame of the ramp is filtered with the target parameters
+            const __m128 t = _mm_set1_ps(float(first + n + 1) * step);
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                __m128 x = _mm_loadu_ps(frame + 4 * v);
+
+                for (int p = 0; p < P; p++)
+                {
+                    const __m128 g = _mm_add_ps(_mm_mul_ps(t, delta[p][v][0]), start[p][v][0]);
+                    const __m128 k = _mm_add_ps(_mm_mul_ps(t, delta[p][v][1]), start[p][v][1]);
+                    const __m128 m0 = _mm_add_ps(_mm_mul_ps(t, delta[p][v][2]), start[p][v][2]);
+                    const __m128 m1 = _mm_add_ps(_mm_mul_ps(t, delta[p][v][3]), start[p][v][3]);
+                    const __m128 m2 = _mm_add_ps(_mm_mul_ps(t, delta[p][v][4]), start[p][v][4]);
+
+                    const __m128 a1 = _mm_div_ps(one, _mm_add_ps(_mm_mul_ps(g, _mm_add_ps(g, k)), one));
+                    const __m128 a2 = _mm_mul_ps(g, a1);
+                    const __m128 a3 = _mm_mul_ps(g, a2);
+
+                    const __m128 v3 = _mm_sub_ps(x, ic2[p][v]);
+                    const __m128 v1 = _mm_add_ps(_mm_mul_ps(a2, v3), _mm_mul_ps(a1, ic1[p][v]));
+                    const __m128 v2 = _mm_add_ps(_mm_mul_ps(a3, v3), _mm_add_ps(_mm_mul_ps(a2, ic1[p][v]), ic2[p][v]));
+
+                    ic1[p][v] = _mm_sub_ps(_mm_mul_ps(two, v1), ic1[p][v]);
+                    ic2[p][v] = _mm_sub_ps(_mm_mul_ps(two, v2), ic2[p][v]);
+                    x = _mm_add_ps(_mm_mul_ps(m2, v2), _mm_add_ps(_mm_mul_ps(m1, v1), _mm_mul_ps(m0, x)));
+                }
+
+                _mm_storeu_ps(frame + 4 * v, x);
+            }
+        }
+
+        for (int p = 0; p < P; p++)
+        {
+            float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                _mm_storeu_ps(z + 0 * IIRSectionLanes + 4 * v, ic1[p][v]);
+                _mm_storeu_ps(z + 1 * IIRSectionLanes + 4 * v, ic2[p][v]);
+            }
+        }
+    }
+
+    void RampSectionsSSE2(
+        float * frames,
+        amf_size count,
+        const float * from,
+        const float * to,
+        float * state,
+        amf_size sections,
+        amf_size first,
+        amf_size total)
+    {
+        amf_size s = 0;
+
+        for (; s + 2 <= sections; s += 2)
+        {
+            RampPass<2>(frames, count,
+                from + s * IIRSvfParameters * IIRSectionLanes, to + s * IIRSvfParameters * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes, first, total);
+        }
+
+        if (s < sections)
+        {
+            RampPass<1>(frames, count,
+                from + s * IIRSvfParameters * IIRSectionLanes, to + s * IIRSvfParameters * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes, first, total);
+        }
+    }
+}
+
+namespace amf
+{
+    const TANIIRKernels TANIIRKernelsSSE2 =
+    {
+        L"SSE2",
+        ProcessSectionsSSE2,
+        AddStateResponseSSE2,
+        RampSectionsSSE2,
+    };
+
+    const TANIIRKernels & GetTANIIRKernels()
+    {
+        const TANKernelSets<TANIIRKernels> sets =
+        {
+            &TANIIRKernelsSSE2,
+            &TANIIRKernelsAVX2,
+            true,
+#ifdef AVX512SUPPORT
+            &TANIIRKernelsAVX512
+#else
+            NULL
+#endif
+        };
+
+        return TANGetKernels(AMF_FACILITY, sets);
+    }
+}
@@ -0,0 +1,101 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   IIRKernels.h
+///  @brief  CPU kernels of TANIIRfilter, one set per instruction set
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    // Channels of a second order sections cascade are filtered IIRSectionLanes at a time, one
+    // channel per SIMD lane. Coefficients, state and samples of such a lane group are stored
+    // channel interleaved: row r of a section is IIRSectionLanes floats, one per channel.
+    const amf_size IIRSectionLanes = 16;
+
+    // Section rows: b0, b1, b2, a1, a2 with a0 divided out, and the s1, s2 state of transposed
+    // direct form II:
+    //   y = b0 * x + s1,  s1 = b1 * x - a1 * y + s2,  s2 = b2 * x - a2 * y
+    const amf_size IIRSectionCoefficients = 5;
+    const amf_size IIRSectionStates = 2;
+
+    // Coefficient ramps run sections as trapezoidal state variable filters with the rows g, k,
+    // m0, m1, m2, interpolated linearly; any g > 0, k > 0 on the way is a stable filter. The
+    // state is ic1, ic2:
+    //   a1 = 1 / (1 + g * (g + k)),  a2 = g * a1,  a3 = g * a2
+    //   v3 = x - ic2,  v1 = a1 * ic1 + a2 * v3,  v2 = ic2 + a2 * ic1 + a3 * v3
+    //   ic1 = 2 * v1 - ic1,  ic2 = 2 * v2 - ic2,  y = m0 * x + m1 * v1 + m2 * v2
+    const amf_size IIRSvfParameters = 5;
+
+    // CPU kernels behind TANIIRfilter.
+    //
+    // One table per instruction set, see core/KernelDispatch.h.
+    struct TANIIRKernels
+    {
+        const wchar_t * name;
+
+        // Filters count frames of IIRSectionLanes channels in place through the cascade of
+        // sections, one section after the other over the whole block. coefficients and state
+        // hold the rows of one section after the other. Any alignment is accepted.
+        void (*ProcessSections)(
+            float * frames,
+            amf_size count,
+            const float * coefficients,
+            float * state,
+            amf_size sections);
+
+        // Adds to every lane the response to its own start state: frames[n][lane] +=
+        // sum of basis[n * rows + r] * states[r * IIRSectionLanes + lane] over the rows.
+        void (*AddStateResponse)(
+            float * frames,
+            amf_size count,
+            const float * basis,
+            const float * states,
+            amf_size rows);
+
+        // As ProcessSections, for state variable filter sections gliding from the parameters
+        // from to the parameters to over total frames, of which count start at frame first.
+        void (*RampSections)(
+            float * frames,
+            amf_size count,
+            const float * from,
+            const float * to,
+            float * state,
+            amf_size sections,
+            amf_size first,
+            amf_size total);
+    };
+
+    // Kernel sets, see IIRKernels*.cpp.
+    extern const TANIIRKernels TANIIRKernelsSSE2;
+    extern const TANIIRKernels TANIIRKernelsAVX2;
+#ifdef AVX512SUPPORT
+    extern const TANIIRKernels TANIIRKernelsAVX512;
+#endif
+
+    // The table for the running CPU, see TANGetKernels.
+    const TANIIRKernels & GetTANIIRKernels();
+}
@@ -0,0 +1,284 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AVX-512F kernels, this file is built with -mavx512f (/arch:AVX512) and only
+// when the compiler supports it (AVX512SUPPORT).
+//
+
+#include "IIRKernels.h"
+
+#include <immintrin.h>
+
+using namespace amf;
+
+namespace
+{
+    // Registers per row of IIRSectionLanes floats.
+    const amf_size Vectors = IIRSectionLanes / 16;
+
+    // P sections at a time. The recursion of a section is a chain of dependent operations
+    // from frame to frame, the chains of P sections overlap.
+    template<int P>
+    inline void ProcessPass(
+        float * frames,
+        amf_size count,
+        const float * coefficients,
+        float * state)
+    {
+        __m512 b0[P][Vectors], b1[P][Vectors], b2[P][Vectors], a1[P][Vectors], a2[P][Vectors];
+        __m512 s1[P][Vectors], s2[P][Vectors];
+
+        for (int p = 0; p < P; p++)
+        {
+            const float * c = coefficients + p * IIRSectionCoefficients * IIRSectionLanes;
+            const float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                b0[p][v] = _mm512_loadu_ps(c + 0 * IIRSectionLanes + 16 * v);
+                b1[p][v] = _mm512_loadu_ps(c + 1 * IIRSectionLanes + 16 * v);
+                b2[p][v] = _mm512_loadu_ps(c + 2 * IIRSectionLanes + 16 * v);
+                a1[p][v] = _mm512_loadu_ps(c + 3 * IIRSectionLanes + 16 * v);
+                a2[p][v] = _mm512_loadu_ps(c + 4 * IIRSectionLanes + 16 * v);
+                s1[p][v] = _mm512_loadu_ps(z + 0 * IIRSectionLanes + 16 * v);
+                s2[p][v] = _mm512_loadu_ps(z + 1 * IIRSectionLanes + 16 * v);
+            }
+        }
+
+        for (amf_size n = 0; n < count; n++)
+        {
+            float * frame = frames + n * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                __m512 x = _mm512_loadu_ps(frame + 16 * v);
+
+                for (int p = 0; p < P; p++)
+                {
+                    __m512 y = _mm512_fmadd_ps(b0[p][v], x, s1[p][v]);
+
+                    s1[p][v] = _mm512_fnmadd_ps(a1[p][v], y, _mm512_fmadd_ps(b1[p][v], x, s2[p][v]));
+                    s2[p][v] = _mm512_fnmadd_ps(a2[p][v], y, _mm512_mul_ps(b2[p][v], x));
+                    x = y;
+                }
+
+                _mm512_storeu_ps(frame + 16 * v, x);
+            }
+        }
+
+        for (int p = 0; p < P; p++)
+        {
+            float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                _mm512_storeu_ps(z + 0 * IIRSectionLanes + 16 * v, s1[p][v]);
+                _mm512_storeu_ps(z + 1 * IIRSectionLanes + 16 * v, s2[p][v]);
+            }
+        }
+    }
+
+    void ProcessSectionsAVX512(
+        float * frames,
+        amf_size count,
+        const float * coefficients,
+        float * state,
+        amf_size sections)
+    {
+        // pairs overlap best, more sections per pass run out of registers
+        amf_size s = 0;
+
+        for (; s + 2 <= sections; s += 2)
+        {
+            ProcessPass<2>(frames, count,
+                coefficients + s * IIRSectionCoefficients * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes);
+        }
+
+        if (s < sections)
+        {
+            ProcessPass<1>(frames, count,
+                coefficients + s * IIRSectionCoefficients * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes);
+        }
+    }
+
+    void AddStateResponseAVX512(
+        float * frames,
+        amf_size count,
+        const float * basis,
+        const float * states,
+        amf_size rows)
+    {
+        for (amf_size n = 0; n < count; n++)
+        {
+            float * frame = frames + n * IIRSectionLanes;
+            const float * response = basis + n * rows;
+            __m512 sum[Vectors];
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                sum[v] = _mm512_loadu_ps(frame + 16 * v);
+            }
+
+            for (amf_size r = 0; r < rows; r++)
+            {
+                const __m512 weight = _mm512_set1_ps(response[r]);
+                const float * row = states + r * IIRSectionLanes;
+
+                for (amf_size v = 0; v < Vectors; v++)
+                {
+                    sum[v] = _mm512_fmadd_ps(weight, _mm512_loadu_ps(row + 16 * v), sum[v]);
+                }
+            }
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                _mm512_storeu_ps(frame + 16 * v, sum[v]);
+            }
+        }
+    }
+
+    // P ramped sections at a time, as ProcessPass.
+    template<int P>
+    inline void RampPass(
+        float * frames,
+        amf_size count,
+        const float * from,
+        const float * to,
+        float * state,
+        amf_size first,
+        amf_size total)
+    {
+        const float step = 1.0f / float(total);
+        const __m512 one = _mm512_set1_ps(1.0f);
+        const __m512 two = _mm512_set1_ps(2.0f);
+
+        __m512 start[P][Vectors][IIRSvfParameters], delta[P][Vectors][IIRSvfParameters];
+        __m512 ic1[P][Vectors], ic2[P][Vectors];
+
+        for (int p = 0; p < P; p++)
+        {
+            const float * p0 = from + p * IIRSvfParameters * IIRSectionLanes;
+            const float * p1 = to + p * IIRSvfParameters * IIRSectionLanes;
+            const float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                for (amf_size q = 0; q < IIRSvfParameters; q++)
+                {
+                    start[p][v][q] = _mm512_loadu_ps(p0 + q * IIRSectionLanes + 16 * v);
+                    delta[p][v][q] = _mm512_sub_ps(_mm512_loadu_ps(p1 + q * IIRSectionLanes + 16 * v), start[p][v][q]);
+                }
+
+                ic1[p][v] = _mm512_loadu_ps(z + 0 * IIRSectionLanes + 16 * v);
+                ic2[p][v] = _mm512_loadu_ps(z + 1 * IIRSectionLanes + 16 * v);
+            }
+        }
+
+        for (amf_size n = 0; n < count; n++)
+        {
+            float * frame = frames + n * IIRSectionLanes;
+
+            // the last frame of the ramp is filtered with the target parameters
+            const __m512 t = _mm512_set1_ps(float(first + n + 1) * step);
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                __m512 x = _mm512_loadu_ps(frame + 16 * v);
+
+                for (int p = 0; p < P; p++)
+                {
+                    const __m512 g = _mm512_fmadd_ps(t, delta[p][v][0], start[p][v][0]);
+                    const __m512 k = _mm512_fmadd_ps(t, delta[p][v][1], start[p][v][1]);
+                    const __m512 m0 = _mm512_fmadd_ps(t, delta[p][v][2], start[p][v][2]);
+                    const __m512 m1 = _mm512_fmadd_ps(t, delta[p][v][3], start[p][v][3]);
+                    const __m512 m2 = _mm512_fmadd_ps(t, delta[p][v][4], start[p][v][4]);
+
+                    const __m512 a1 = _mm512_div_ps(one, _mm512_fmadd_ps(g, _mm512_add_ps(g, k), one));
+                    const __m512 a2 = _mm512_mul_ps(g, a1);
+                    const __m512 a3 = _mm512_mul_ps(g, a2);
+
+                    const __m512 v3 = _mm512_sub_ps(x, ic2[p][v]);
+                    const __m512 v1 = _mm512_fmadd_ps(a2, v3, _mm512_mul_ps(a1, ic1[p][v]));
+                    const __m512 v2 = _mm512_fmadd_ps(a3, v3, _mm512_fmadd_ps(a2, ic1[p][v], ic2[p][v]));
+
+                    ic1[p][v] = _mm512_fmsub_ps(two, v1, ic1[p][v]);
+                    ic2[p][v] = _mm512_fmsub_ps(two, v2, ic2[p][v]);
+                    x = _mm512_fmadd_ps(m2, v2, _mm512_fmadd_ps(m1, v1, _mm512_mul_ps(m0, x)));
+                }
+
+                _mm512_storeu_ps(frame + 16 * v, x);
+            }
+        }
+
+        for (int p = 0; p < P; p++)
+        {
+            float * z = state + p * IIRSectionStates * IIRSectionLanes;
+
+            for (amf_size v = 0; v < Vectors; v++)
+            {
+                _mm512_storeu_ps(z + 0 * IIRSectionLanes + 16 * v, ic1[p][v]);
+                _mm512_storeu_ps(z + 1 * IIRSectionLanes + 16 * v, ic2[p][v]);
+            }
+        }
+    }
+
+    void RampSectionsAVX512(
+        float * frames,
+        amf_size count,
+        const float * from,
+        const float * to,
+        float * state,
+        amf_size sections,
+        amf_size first,
+        amf_size total)
+    {
+        amf_size s = 0;
+
+        for (; s + 2 <= sections; s += 2)
+        {
+            RampPass<2>(frames, count,
+                from + s * IIRSvfParameters * IIRSectionLanes, to + s * IIRSvfParameters * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes, first, total);
+        }
+
+        if (s < sections)
+        {
+            RampPass<1>(frames, count,
+                from + s * IIRSvfParameters * IIRSectionLanes, to + s * IIRSvfParameters * IIRSectionLanes,
+                state + s * IIRSectionStates * IIRSectionLanes, first, total);
+        }
+    }
+}
+
+namespace amf
+{
+    const TANIIRKernels TANIIRKernelsAVX512 =
+    {
+        L"AVX512",
+        ProcessSectionsAVX512,
+        AddStateResponseAVX512,
+        RampSectionsAVX512,
+    };
+}
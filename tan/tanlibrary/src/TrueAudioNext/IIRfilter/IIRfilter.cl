@@ -26,30 +26,30 @@ __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_T
 
 __kernel
 void IIRfilter(
-	__global    float*  bufferInput,	///< [in]
-	__global    float*  inputHistory,	///< [in]
-	__global    float*  outputHistory,	///< [in]
-	__global    float*  inputTaps,		///< [in]
-	__global    float*  outputTaps,		///< [in]
-	__global    float*  bufferOutput,	///< [in]
-	__global    int*  	inOutPos,		///< [in]
-	int     numInputTaps,
-	int     numOutputTaps,
+	__global    const float*  bufferInput,	///< [in] channel buffers, bufferStride floats apart
+	__global    float*  arena,			///< [in/out] per channel: input taps, output taps, input history, output history
+	__global    const uint*  channelTable,	///< [in] per channel: arena offset, input taps, output taps
+	__global    int*  	histPos,		///< [in/out] per channel: input and output history position
+	__global    float*  bufferOutput,	///< [out]
+	int     bufferStride,
 	int		numSamples
 )
 {
-	uint idx = get_global_id(0);
-	uint chan = get_global_id(1);
+	uint chan = get_global_id(0);
 
-	global float* pBufferInput = &bufferInput[chan * numSamples];
-	global float* pInputHistory = &inputHistory[chan * numInputTaps];
-	global float* pOutputHistory = &outputHistory[chan * numOutputTaps];
-	global float* pInputTaps = &inputTaps[chan * numInputTaps];
-	global float* pOutputTaps = &outputTaps[chan * numOutputTaps];
-	global float* pBufferOutput = &bufferOutput[chan * numSamples];
+	uint	offset = channelTable[3 * chan];
+	int		numInputTaps = channelTable[3 * chan + 1];
+	int		numOutputTaps = channelTable[3 * chan + 2];
 
-	int		inputHistPos = inOutPos[0];
-	int		outputHistPos = inOutPos[1];
+	global const float* pBufferInput = &bufferInput[chan * bufferStride];
+	global float* pInputTaps = &arena[offset];
+	global float* pOutputTaps = pInputTaps + numInputTaps;
+	global float* pInputHistory = pOutputTaps + numOutputTaps;
+	global float* pOutputHistory = pInputHistory + numInputTaps;
+	global float* pBufferOutput = &bufferOutput[chan * bufferStride];
+
+	int		inputHistPos = histPos[2 * chan];
+	int		outputHistPos = histPos[2 * chan + 1];
 
 
 	float sample;
@@ -60,24 +60,28 @@ void IIRfilter(
 
 		//FIR part
 		for (int k = 0; k < numInputTaps; k++) {
-			sample += pInputTaps[k] * pInputHistory[(inputHistPos + numInputTaps - k) % numInputTaps];
+			int pos = inputHistPos - k;
+			sample += pInputTaps[k] * pInputHistory[pos < 0 ? pos + numInputTaps : pos];
 		}
 
 		//IIR part
 		for (int l = 0; l < numOutputTaps; l++) {
-			sample += pOutputTaps[l] * pOutputHistory[(outputHistPos + numOutputTaps - l) % numOutputTaps];
+			int pos = outputHistPos - l;
+			sample += pOutputTaps[l] * pOutputHistory[pos < 0 ? pos + numOutputTaps : pos];
 		}
 		pBufferOutput[sn] = sample;
 
-		++inputHistPos;
-		++outputHistPos;
-
-		inputHistPos = (inputHistPos % numInputTaps);
-		outputHistPos = (outputHistPos % numOutputTaps);
-		pOutputHistory[outputHistPos] = pBufferOutput[sn];
-
+		if (++inputHistPos == numInputTaps) {
+			inputHistPos = 0;
+		}
+		if (numOutputTaps > 0) {
+			if (++outputHistPos == numOutputTaps) {
+				outputHistPos = 0;
+			}
+			pOutputHistory[outputHistPos] = sample;
+		}
 	}
 
-	inOutPos[0] = inputHistPos;
-	inOutPos[1] = outputHistPos;
-}
\ No newline at end of file
+	histPos[2 * chan] = inputHistPos;
+	histPos[2 * chan + 1] = outputHistPos;
+}
@@ -26,37 +26,32 @@ __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_T
 
 kernel
 void IIRfilter(
-	device    float*  bufferInput,	///< [in]
-	device    float*  inputHistory,	///< [in]
-	device    float*  outputHistory,	///< [in]
-	device    float*  inputTaps,		///< [in]
-	device    float*  outputTaps,		///< [in]
-	device    float*  bufferOutput,	///< [in]
-	device    int*  	inOutPos,		///< [in]
-	int     numInputTaps,
-	int     numOutputTaps,
+	device    const float*  bufferInput,	///< [in] channel buffers, bufferStride floats apart
+	device    float*  arena,			///< [in/out] per channel: input taps, output taps, input history, output history
+	device    const uint*  channelTable,	///< [in] per channel: arena offset, input taps, output taps
+	device    int*  	histPos,		///< [in/out] per channel: input and output history position
+	device    float*  bufferOutput,	///< [out]
+	int     bufferStride,
 	int		numSamples,
 
-	uint2 				global_id 			[[thread_position_in_grid]],
-	uint2 				local_id 			[[thread_position_in_threadgroup]],
-	uint2 				group_id 			[[threadgroup_position_in_grid]],
-	uint2 				group_size 			[[threads_per_threadgroup]],
-	uint2 				grid_size 			[[threads_per_grid]]
-
+	uint 				global_id 			[[thread_position_in_grid]]
 )
 {
-	uint idx = global_id.x;
-	uint chan = global_id.y;
+	uint chan = global_id;
+
+	uint	offset = channelTable[3 * chan];
+	int		numInputTaps = channelTable[3 * chan + 1];
+	int		numOutputTaps = channelTable[3 * chan + 2];
 
-	global float* pBufferInput = &bufferInput[chan * numSamples];
-	global float* pInputHistory = &inputHistory[chan * numInputTaps];
-	global float* pOutputHistory = &outputHistory[chan * numOutputTaps];
-	global float* pInputTaps = &inputTaps[chan * numInputTaps];
-	global float* pOutputTaps = &outputTaps[chan * numOutputTaps];
-	global float* pBufferOutput = &bufferOutput[chan * numSamples];
+	device const float* pBufferInput = &bufferInput[chan * bufferStride];
+	device float* pInputTaps = &arena[offset];
+	device float* pOutputTaps = pInputTaps + numInputTaps;
+	device float* pInputHistory = pOutputTaps + numOutputTaps;
+	device float* pOutputHistory = pInputHistory + numInputTaps;
+	device float* pBufferOutput = &bufferOutput[chan * bufferStride];
 
-	int		inputHistPos = inOutPos[0];
-	int		outputHistPos = inOutPos[1];
+	int		inputHistPos = histPos[2 * chan];
+	int		outputHistPos = histPos[2 * chan + 1];
 
 
 	float sample;
@@ -67,24 +62,28 @@ void IIRfilter(
 
 		//FIR part
 		for (int k = 0; k < numInputTaps; k++) {
-			sample += pInputTaps[k] * pInputHistory[(inputHistPos + numInputTaps - k) % numInputTaps];
+			int pos = inputHistPos - k;
+			sample += pInputTaps[k] * pInputHistory[pos < 0 ? pos + numInputTaps : pos];
 		}
 
 		//IIR part
 		for (int l = 0; l < numOutputTaps; l++) {
-			sample += pOutputTaps[l] * pOutputHistory[(outputHistPos + numOutputTaps - l) % numOutputTaps];
+			int pos = outputHistPos - l;
+			sample += pOutputTaps[l] * pOutputHistory[pos < 0 ? pos + numOutputTaps : pos];
 		}
 		pBufferOutput[sn] = sample;
 
-		++inputHistPos;
-		++outputHistPos;
-
-		inputHistPos = (inputHistPos % numInputTaps);
-		outputHistPos = (outputHistPos % numOutputTaps);
-		pOutputHistory[outputHistPos] = pBufferOutput[sn];
-
+		if (++inputHistPos == numInputTaps) {
+			inputHistPos = 0;
+		}
+		if (numOutputTaps > 0) {
+			if (++outputHistPos == numOutputTaps) {
+				outputHistPos = 0;
+			}
+			pOutputHistory[outputHistPos] = sample;
+		}
 	}
 
-	inOutPos[0] = inputHistPos;
-	inOutPos[1] = outputHistPos;
-}
\ No newline at end of file
+	histPos[2 * chan] = inputHistPos;
+	histPos[2 * chan + 1] = outputHistPos;
+}
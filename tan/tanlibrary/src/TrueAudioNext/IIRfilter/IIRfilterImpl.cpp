@@ -26,6 +26,7 @@
 #define _USE_MATH_DEFINES
 
 #include "IIRfilterImpl.h"
+#include "IIRKernels.h"
 #include "../core/TANContextImpl.h"
 #include "public/common/AMFFactoryHelper.h"
 #include "OCLHelper.h"
@@ -33,6 +34,8 @@
 #include "Exceptions.h"
 
 #include <math.h>
+#include <algorithm>
+#include <xmmintrin.h>
 
 #ifdef ENABLE_METAL
   #include "MetalKernel_IIRfilter.h"
@@ -40,8 +43,96 @@
   #include "CLKernel_IIRfilter.h"
 #endif
 
+#define AMF_FACILITY L"TANIIRfilterImpl"
+
 using namespace amf;
 
+// Frames per block of the second order sections mode, a block of IIRSectionLanes channels
+// stays in L1 while it runs through all sections.
+static const amf_size SectionBlockFrames = 128;
+
+// MXCSR flush to zero and denormals are zero: a decaying recursion would otherwise spend
+// most of its time in denormal arithmetic.
+static const unsigned int FlushDenormals = 0x8040;
+
+// Shortest chunk of block parallel sections: the start state of every chunk costs
+// (2 * sections)^2 operations, the bases of a chunk length are computed once.
+static const amf_size BlockMinChunkFrames = 256;
+
+// Taps mode channel spans are padded to this many floats, one cache line.
+static const amf_uint32 ArenaAlignment = 16;
+
+// Inside the triangle of stable second order sections, which is where state variable filter
+// parameters exist.
+static bool IsStableSection(double a1, double a2)
+{
+	return fabs(a2) < 1.0 && fabs(a1) < 1.0 + a2;
+}
+
+// Zero input outputs of a state variable filter section over two frames, o[n][i] from unit
+// state i, see IIRKernels.h. parameters points to one lane of the rows.
+static void SvfObservability(const float * parameters, double o[2][2])
+{
+	const double g = parameters[0 * IIRSectionLanes];
+	const double k = parameters[1 * IIRSectionLanes];
+	const double m1 = parameters[3 * IIRSectionLanes];
+	const double m2 = parameters[4 * IIRSectionLanes];
+	const double a1 = 1.0 / (1.0 + g * (g + k));
+	const double a2 = g * a1;
+	const double a3 = g * a2;
+
+	for (int i = 0; i < 2; i++)
+	{
+		double ic1 = (i == 0) ? 1.0 : 0.0;
+		double ic2 = (i == 1) ? 1.0 : 0.0;
+
+		for (int n = 0; n < 2; n++)
+		{
+			const double v1 = a1 * ic1 - a2 * ic2;
+			const double v2 = ic2 + a2 * ic1 - a3 * ic2;
+
+			o[n][i] = m1 * v1 + m2 * v2;
+			ic1 = 2.0 * v1 - ic1;
+			ic2 = 2.0 * v2 - ic2;
+		}
+	}
+}
+
+// State variable filter parameters of stable sections, rows as IIRKernels.h: the bilinear
+// transform of the analog state variable filter matched term by term.
+static void SectionsToSvf(const std::vector<float> & coefficients, std::vector<float> & parameters)
+{
+	const amf_size sections = coefficients.size() / (IIRSectionCoefficients * IIRSectionLanes);
+
+	parameters.resize(sections * IIRSvfParameters * IIRSectionLanes);
+
+	for (amf_size section = 0; section < sections; section++)
+	{
+		const float * c = &coefficients[section * IIRSectionCoefficients * IIRSectionLanes];
+		float * p = &parameters[section * IIRSvfParameters * IIRSectionLanes];
+
+		for (amf_size lane = 0; lane < IIRSectionLanes; lane++)
+		{
+			const double b0 = c[0 * IIRSectionLanes + lane];
+			const double b1 = c[1 * IIRSectionLanes + lane];
+			const double b2 = c[2 * IIRSectionLanes + lane];
+			const double a1 = c[3 * IIRSectionLanes + lane];
+			const double a2 = c[4 * IIRSectionLanes + lane];
+
+			const double g = sqrt((1.0 + a1 + a2) / (1.0 - a1 + a2));
+			const double k = 2.0 * (1.0 - a2) / ((1.0 - a1 + a2) * g);
+			const double a0 = 1.0 + g * (g + k);
+			const double m0 = (b0 - b1 + b2) / (1.0 - a1 + a2);
+
+			p[0 * IIRSectionLanes + lane] = float(g);
+			p[1 * IIRSectionLanes + lane] = float(k);
+			p[2 * IIRSectionLanes + lane] = float(m0);
+			p[3 * IIRSectionLanes + lane] = float((b0 - b2 - m0 * (1.0 - a2)) * a0 / (2.0 * g));
+			p[4 * IIRSectionLanes + lane] = float((b1 - m0 * a1) * a0 / (2.0 * g * g));
+		}
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateIIRfilter(
 	amf::TANContext* pContext,
@@ -57,8 +148,32 @@ TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateIIRfilter(
 
 //-------------------------------------------------------------------------------------------------
 TANIIRfilterImpl::TANIIRfilterImpl(TANContext *pContextTAN) :
-	m_pContextTAN(pContextTAN)
+	m_pContextTAN(pContextTAN),
+	m_pThreadPool(&TANContextImplPtr(pContextTAN)->GetThreadPool())
+{
+	AMFPrimitivePropertyInfoMapBegin
+		TANStatsPropertyInfoBlocks,
+		TANStatsPropertyInfoOverruns,
+	AMFPrimitivePropertyInfoMapEnd
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANIIRfilterImpl::GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const
 {
+	const AMF_RESULT res = AMFPropertyStorageExImpl<TANIIRfilter>::GetProperty(name, pValue);
+
+	if (res == AMF_OK)
+	{
+		m_counters.GetProperty(name, pValue);
+	}
+
+	return res;
+}
+
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL TANIIRfilterImpl::OnPropertyChanged(const wchar_t* name)
+{
+	m_counters.OnPropertyChanged(this, name);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -71,26 +186,25 @@ TANIIRfilterImpl::~TANIIRfilterImpl(void)
 AMF_RESULT  AMF_STD_CALL TANIIRfilterImpl::Terminate()
 {
 	AMFLock lock(&m_sect);
-    if (m_inputTaps != NULL)
-    {
-        delete[] m_inputTaps;
-        m_inputTaps = NULL;
-    }
-    if (m_outputTaps != NULL)
-    {
-        delete[] m_outputTaps;
-        m_outputTaps = NULL;
-    }
-    if (m_inputHistory != NULL)
-    {
-        delete[] m_inputHistory;
-        m_inputHistory = NULL;
-    }
-    if (m_outputHistory != NULL)
-    {
-        delete[] m_outputHistory;
-        m_outputHistory = NULL;
-    }
+    m_sectionMode = false;
+    m_numSections = 0;
+    m_sectionCoefficients.clear();
+    m_sectionState.clear();
+    m_sectionFrames.clear();
+    m_blockParallel = false;
+    m_blockChunkFrames = 0;
+    m_blockChannels.clear();
+    m_blockFrames.clear();
+    m_blockZeroState.clear();
+    m_blockStartState.clear();
+    m_rampPending = false;
+    m_rampTarget.clear();
+    m_rampFrom.clear();
+    m_rampTo.clear();
+
+    m_channels = 0;
+    m_channelTable.clear();
+    m_arena.clear();
 
 #ifndef TAN_NO_OPENCL
     if (m_pContextTAN->GetOpenCLContext() != nullptr)
@@ -101,62 +215,7 @@ AMF_RESULT  AMF_STD_CALL TANIIRfilterImpl::Terminate()
             m_kernel_IIRfilter = NULL;
         }
 
-        if (m_clTempIn)
-        {
-            clReleaseMemObject(m_clTempIn);
-            m_clTempIn = NULL;
-        }
-
-        for (int i = 0; i < m_channels; i++)
-        {
-            if (m_clTempInSubBufs[i] == NULL) continue;
-            clReleaseMemObject(m_clTempInSubBufs[i]);
-            m_clTempInSubBufs[i] = NULL;
-        }
-
-        for (int i = 0; i < m_channels; i++)
-        {
-            if (m_clTempOutSubBufs[i] == NULL) continue;
-            clReleaseMemObject(m_clTempOutSubBufs[i]);
-            m_clTempOutSubBufs[i] = NULL;
-        }
-
-        if (m_clTempOut)
-        {
-            clReleaseMemObject(m_clTempOut);
-            m_clTempOut = NULL;
-        }
-
-        if (m_clInputTaps)
-        {
-            clReleaseMemObject(m_clInputTaps);
-            m_clInputTaps = NULL;
-        }
-
-        if (m_clOutputTaps)
-        {
-            clReleaseMemObject(m_clOutputTaps);
-            m_clOutputTaps = NULL;
-        }
-
-        if (m_clInputHistory)
-        {
-            clReleaseMemObject(m_clInputHistory);
-            m_clInputHistory = NULL;
-        }
-
-        if (m_clOutputHistory)
-        {
-            clReleaseMemObject(m_clOutputHistory);
-            m_clOutputHistory = NULL;
-        }
-
-        if (m_clInOutHistPos)
-        {
-            clReleaseMemObject(m_clInOutHistPos);
-            m_clInOutHistPos = NULL;
-        }
-
+        ReleaseGpuChannels();
     }
     if (m_pCommandQueueCl)
     {
@@ -170,6 +229,7 @@ AMF_RESULT  AMF_STD_CALL TANIIRfilterImpl::Terminate()
 #endif
 
 	m_pContextTAN.Release();
+	m_pThreadPool = nullptr;
 
 	return AMF_OK;
 }
@@ -181,51 +241,28 @@ AMF_RESULT	AMF_STD_CALL	TANIIRfilterImpl::Init(
 	amf_uint32 bufferSizeInSamples,
 	amf_uint32 channels)
 {
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(numInputTaps > 0, AMF_INVALID_ARG, L"numInputTaps == 0");
+
 	m_numSamples = bufferSizeInSamples;
-	m_numInputTaps = numInputTaps;
-	m_numOutputTaps = numOutputTaps;
-	m_channels = channels;
 	m_bufSize = bufferSizeInSamples * sizeof(float);
-	m_inputHistPos = 0;
-	m_outputHistPos = 0;
-
-	if (m_inputTaps != NULL) {
-		delete[] m_inputTaps;
-		m_inputTaps = NULL;
-	}
-	if (m_outputTaps != NULL) {
-		delete[] m_outputTaps;
-		m_outputTaps = NULL;
-	}
-	if (m_inputHistory != NULL) {
-		delete[] m_inputHistory;
-		m_inputHistory = NULL;
-	}
-	if (m_outputHistory != NULL) {
-		delete[] m_outputHistory;
-		m_outputHistory = NULL;
-	}
+	m_sectionMode = false;
 
-	m_inputTaps = new float *[m_channels];
-	m_outputTaps = new float *[m_channels];
-	m_inputHistory = new float *[m_channels];
-	m_outputHistory = new float *[m_channels];
+	// all channels in one allocation, taps and history zero
+	const amf_uint32 span = ChannelSpan(numInputTaps, numOutputTaps);
 
-	for (int i = 0; i < m_channels; i++) {
-		m_inputTaps[i] = new float[m_numInputTaps];
-		m_outputTaps[i] = new float[m_numOutputTaps];
-		m_inputHistory[i] = new float[m_numInputTaps];
-		m_outputHistory[i] = new float[m_numOutputTaps];
-		memset(m_inputTaps[i], 0, m_numInputTaps * sizeof(float));
-		memset(m_outputTaps[i], 0, m_numOutputTaps * sizeof(float));
-		memset(m_inputHistory[i], 0, m_numInputTaps * sizeof(float));
-		memset(m_outputHistory[i], 0, m_numOutputTaps * sizeof(float));
+	m_arena.assign(amf_size(channels) * span, 0.0f);
+	m_channelTable.clear();
+	m_channelTable.reserve(channels);
 
+	for (amf_uint32 chan = 0; chan < channels; chan++)
+	{
+		Channel channel = { chan * span, numInputTaps, numOutputTaps, 0, 0 };
+		m_channelTable.push_back(channel);
 	}
-
+	m_channels = channels;
 
 	// Determine how to initialize based on context, CPU for CPU and GPU for GPU
-	    // Determine how to initialize based on context, CPU for CPU and GPU for GPU
 #ifndef TAN_NO_OPENCL
     if(m_pContextTAN->GetOpenCLContext())
 #else
@@ -267,133 +304,829 @@ AMF_RESULT	AMF_STD_CALL	TANIIRfilterImpl::InitGpu()
 	TANContextImplPtr contextImpl(m_pContextTAN);
 	m_pDeviceAMF = contextImpl->GetGeneralCompute();
 
-	m_clTempIn = clCreateBuffer(
-		m_pContextCl, CL_MEM_READ_WRITE, m_bufSize*m_channels, nullptr, &ret);
-	AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+	// the device copy of the arena starts out as the host one, all zero
+	ReleaseGpuChannels();
+	res = UpdateGpuChannels(0, 0, 0, 0, 0, 0);
+	AMF_RETURN_IF_FAILED(res, L"Failed to create the channel buffers");
 
-	m_clTempOut = clCreateBuffer(
-		m_pContextCl, CL_MEM_READ_WRITE, m_bufSize*m_channels, nullptr, &ret);
-	AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+	//... Preparing OCL Kernel
+	int OCLKenel_Err = GetOclKernel(m_kernel_IIRfilter, m_pDeviceAMF, contextImpl->GetOpenCLGeneralQueue(), "IIRfilter", IIRfilter, IIRfilterCount, "IIRfilter", "");
+	if (!OCLKenel_Err) { printf("Failed to compile IIRFilter Kernel IIR_Filter"); return AMF_FAIL; }
 
-	int pat = 0;
-	m_clInputTaps = clCreateBuffer(
-		m_pContextCl, CL_MEM_READ_WRITE, sizeof(float)*m_channels*m_numInputTaps, nullptr, &ret);
-	AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+    return res;
 
-	m_clOutputTaps = clCreateBuffer(
-		m_pContextCl, CL_MEM_READ_WRITE, sizeof(float)*m_channels*m_numOutputTaps, nullptr, &ret);
-	AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+#else
+    THROW_NOT_IMPLEMENTED;
 
-	m_clInputHistory = clCreateBuffer(
-		m_pContextCl, CL_MEM_READ_WRITE, sizeof(float)*m_channels*m_numInputTaps, nullptr, &ret);
-	AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+    return AMF_NOT_IMPLEMENTED;
+#endif
+}
 
-	FixedEnqueueFillBuffer(m_pContextCl, m_pCommandQueueCl, m_clInputHistory, (const void *)&pat, sizeof(pat), 0, m_channels*m_numInputTaps * sizeof(float));
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT	AMF_STD_CALL	TANIIRfilterImpl::InitCpu()
+{
+	return AMF_OK;
+}
 
-	m_clOutputHistory = clCreateBuffer(
-		m_pContextCl, CL_MEM_READ_WRITE, sizeof(float)*m_channels*m_numOutputTaps, nullptr, &ret);
-	AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+//-------------------------------------------------------------------------------------------------
+amf_uint32 TANIIRfilterImpl::ChannelSpan(amf_uint32 numInputTaps, amf_uint32 numOutputTaps)
+{
+	return (2 * (numInputTaps + numOutputTaps) + ArenaAlignment - 1) / ArenaAlignment * ArenaAlignment;
+}
 
-	FixedEnqueueFillBuffer(m_pContextCl, m_pCommandQueueCl, m_clOutputHistory, (const void *)&pat, sizeof(pat), 0, m_channels*m_numOutputTaps * sizeof(float));
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANIIRfilterImpl::AddChannel(amf_uint32 numInputTaps, amf_uint32 numOutputTaps)
+{
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(!m_sectionMode, AMF_WRONG_STATE, L"Initialized with InitSections");
+	AMF_RETURN_IF_FALSE(numInputTaps > 0, AMF_INVALID_ARG, L"numInputTaps == 0");
 
-	m_clInOutHistPos = clCreateBuffer(
-		m_pContextCl, CL_MEM_READ_WRITE, sizeof(float) * 2, nullptr, &ret);
-	AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+	const amf_size oldArenaSize = m_arena.size();
+	Channel channel = { amf_uint32(oldArenaSize), numInputTaps, numOutputTaps, 0, 0 };
 
-	FixedEnqueueFillBuffer(m_pContextCl, m_pCommandQueueCl, m_clInOutHistPos, (const void *)&pat, sizeof(pat), 0, sizeof(float) * 2);
+	m_arena.resize(oldArenaSize + ChannelSpan(numInputTaps, numOutputTaps), 0.0f);
+	m_channelTable.push_back(channel);
+	m_channels++;
 
-	for (amf_uint32 i = 0; i < m_channels; i++)
+#ifndef TAN_NO_OPENCL
+	if (m_doProcessOnGpu)
 	{
-		cl_buffer_region region;
-		region.origin = i*m_bufSize;
-		region.size = m_bufSize;
-		m_clTempInSubBufs[i] = clCreateSubBuffer(
-			m_clTempIn, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &ret);
+		return UpdateGpuChannels(oldArenaSize, oldArenaSize, 0, m_channels - 1, m_channels - 1, 0);
 	}
+#endif
+
+	return AMF_OK;
+}
 
-	for (amf_uint32 i = 0; i < m_channels; i++)
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANIIRfilterImpl::RemoveChannel(amf_uint32 channel)
+{
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(!m_sectionMode, AMF_WRONG_STATE, L"Initialized with InitSections");
+	AMF_RETURN_IF_FALSE(channel < m_channels, AMF_INVALID_ARG, L"channel %u out of range", channel);
+
+	const amf_size oldArenaSize = m_arena.size();
+	const Channel removed = m_channelTable[channel];
+	const amf_uint32 span = ChannelSpan(removed.inputTaps, removed.outputTaps);
+
+	m_arena.erase(m_arena.begin() + removed.offset, m_arena.begin() + removed.offset + span);
+	m_channelTable.erase(m_channelTable.begin() + channel);
+	m_channels--;
+
+	for (amf_uint32 chan = channel; chan < m_channels; chan++)
 	{
-		cl_buffer_region region;
-		region.origin = i*m_bufSize;
-		region.size = m_bufSize;
-		m_clTempOutSubBufs[i] = clCreateSubBuffer(
-			m_clTempOut, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &ret);
+		m_channelTable[chan].offset -= span;
 	}
 
-	//... Preparing OCL Kernel
-	int OCLKenel_Err = GetOclKernel(m_kernel_IIRfilter, m_pDeviceAMF, contextImpl->GetOpenCLGeneralQueue(), "IIRfilter", IIRfilter, IIRfilterCount, "IIRfilter", "");
-	if (!OCLKenel_Err) { printf("Failed to compile IIRFilter Kernel IIR_Filter"); return AMF_FAIL; }
+#ifndef TAN_NO_OPENCL
+	if (m_doProcessOnGpu)
+	{
+		return UpdateGpuChannels(oldArenaSize, removed.offset, span, m_channels + 1, channel, 1);
+	}
+#endif
 
-    return res;
+	return AMF_OK;
+}
 
-#else
-    THROW_NOT_IMPLEMENTED;
+#ifndef TAN_NO_OPENCL
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANIIRfilterImpl::ResizeGpuBuffer(cl_mem & buffer, amf_size oldSize, amf_size newSize, amf_size keep, amf_size skip)
+{
+	cl_mem resized = nullptr;
+
+	if (newSize)
+	{
+		cl_int ret = CL_SUCCESS;
+
+		resized = clCreateBuffer(m_pContextCl, CL_MEM_READ_WRITE, newSize, nullptr, &ret);
+		AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+
+		const amf_size kept = std::min(keep, newSize);
+		const amf_size moved = std::min(oldSize - keep - skip, newSize - kept);
+
+		if (kept)
+		{
+			ret = clEnqueueCopyBuffer(m_pCommandQueueCl, buffer, resized, 0, 0, kept, 0, NULL, NULL);
+			AMF_RETURN_IF_CL_FAILED(ret, L"Failed to copy buffer");
+		}
+		if (moved)
+		{
+			ret = clEnqueueCopyBuffer(m_pCommandQueueCl, buffer, resized, keep + skip, kept, moved, 0, NULL, NULL);
+			AMF_RETURN_IF_CL_FAILED(ret, L"Failed to copy buffer");
+		}
+		if (kept + moved < newSize)
+		{
+			cl_int zero = 0;
+
+			ret = FixedEnqueueFillBuffer(m_pContextCl, m_pCommandQueueCl, resized, &zero, sizeof(zero), kept + moved, newSize - kept - moved);
+			AMF_RETURN_IF_CL_FAILED(ret, L"Failed to fill buffer");
+		}
+	}
+
+	// released once the copies out of it are done
+	if (buffer)
+	{
+		clReleaseMemObject(buffer);
+	}
+	buffer = resized;
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANIIRfilterImpl::UpdateGpuChannels(amf_size oldArenaSize, amf_size keep, amf_size skip, amf_uint32 oldChannels, amf_uint32 removed, amf_uint32 removedCount)
+{
+	const amf_size positions = 2 * sizeof(cl_int);
+	AMF_RESULT res = AMF_OK;
+
+	// the history on the device is newer than the host one, it's moved on the device
+	res = ResizeGpuBuffer(m_clArena, oldArenaSize * sizeof(float), m_arena.size() * sizeof(float), keep * sizeof(float), skip * sizeof(float));
+	AMF_RETURN_IF_FAILED(res);
+	res = ResizeGpuBuffer(m_clHistPos, oldChannels * positions, m_channels * positions, removed * positions, removedCount * positions);
+	AMF_RETURN_IF_FAILED(res);
+
+	std::vector<cl_uint> table(3 * m_channels);
+
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
+	{
+		table[3 * chan] = m_channelTable[chan].offset;
+		table[3 * chan + 1] = m_channelTable[chan].inputTaps;
+		table[3 * chan + 2] = m_channelTable[chan].outputTaps;
+	}
+
+	res = ResizeGpuBuffer(m_clChannelTable, 0, table.size() * sizeof(cl_uint), 0, 0);
+	AMF_RETURN_IF_FAILED(res);
+
+	if (m_channels)
+	{
+		cl_int ret = clEnqueueWriteBuffer(m_pCommandQueueCl, m_clChannelTable, CL_TRUE, 0, table.size() * sizeof(cl_uint), table.data(), 0, NULL, NULL);
+		AMF_RETURN_IF_CL_FAILED(ret, L"Failed to write the channel table");
+	}
+
+	// staging buffers for host memory Process grow by doubling
+	if (m_channels > m_clTempChannels)
+	{
+		m_clTempChannels = std::max(m_channels, 2 * m_clTempChannels);
+
+		res = ResizeGpuBuffer(m_clTempIn, 0, amf_size(m_bufSize) * m_clTempChannels, 0, 0);
+		AMF_RETURN_IF_FAILED(res);
+		res = ResizeGpuBuffer(m_clTempOut, 0, amf_size(m_bufSize) * m_clTempChannels, 0, 0);
+		AMF_RETURN_IF_FAILED(res);
+	}
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+void TANIIRfilterImpl::ReleaseGpuChannels()
+{
+	cl_mem * buffers[] = { &m_clTempIn, &m_clTempOut, &m_clArena, &m_clChannelTable, &m_clHistPos };
+
+	for (cl_mem * buffer : buffers)
+	{
+		if (*buffer)
+		{
+			clReleaseMemObject(*buffer);
+			*buffer = NULL;
+		}
+	}
+
+	m_clTempChannels = 0;
+}
 
-    return AMF_NOT_IMPLEMENTED;
 #endif
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT	AMF_STD_CALL	TANIIRfilterImpl::InitSections(
+	amf_uint32 numSections,
+	amf_uint32 bufferSizeInSamples,
+	amf_uint32 channels)
+{
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(numSections > 0 && channels > 0, AMF_INVALID_ARG, L"No sections or channels");
+
+	m_numSamples = bufferSizeInSamples;
+	m_bufSize = bufferSizeInSamples * sizeof(float);
+	m_channels = channels;
+	m_numSections = numSections;
+	m_sectionMode = true;
+	m_channelTable.clear();
+	m_arena.clear();
+
+	const amf_size groups = (channels + IIRSectionLanes - 1) / IIRSectionLanes;
+
+	// pass through: b0 = 1, everything else 0
+	m_sectionCoefficients.assign(groups * numSections * IIRSectionCoefficients * IIRSectionLanes, 0.0f);
+	for (amf_size row = 0; row < m_sectionCoefficients.size(); row += IIRSectionCoefficients * IIRSectionLanes)
+	{
+		std::fill(&m_sectionCoefficients[row], &m_sectionCoefficients[row] + IIRSectionLanes, 1.0f);
+	}
+
+	m_sectionState.assign(groups * numSections * IIRSectionStates * IIRSectionLanes, 0.0f);
+	m_sectionFrames.assign(SectionBlockFrames * IIRSectionLanes, 0.0f);
+
+	m_blockParallel = false;
+	m_blockChunkFrames = 0;
+	m_blockChannels.assign(channels, BlockChannel());
+	m_rampPending = false;
+
+	return AMF_OK;
 }
 
 //-------------------------------------------------------------------------------------------------
-AMF_RESULT	AMF_STD_CALL	TANIIRfilterImpl::InitCpu()
+AMF_RESULT TANIIRfilterImpl::PackSections(float* ppSections[], std::vector<float> & coefficients)
 {
+	AMF_RETURN_IF_FALSE(ppSections != NULL, AMF_INVALID_POINTER, L"ppSections == NULL");
+
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
+	{
+		AMF_RETURN_IF_FALSE(ppSections[chan] != NULL, AMF_INVALID_POINTER, L"ppSections[%u] == NULL", chan);
+
+		for (amf_uint32 section = 0; section < m_numSections; section++)
+		{
+			AMF_RETURN_IF_FALSE(ppSections[chan][6 * section + 3] != 0.0f, AMF_INVALID_ARG,
+				L"a0 of section %u of channel %u is 0", section, chan);
+		}
+	}
+
+	const amf_size groupCoefficients = m_numSections * IIRSectionCoefficients * IIRSectionLanes;
+
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
+	{
+		float * group = &coefficients[(chan / IIRSectionLanes) * groupCoefficients];
+		const amf_size lane = chan % IIRSectionLanes;
+
+		for (amf_uint32 section = 0; section < m_numSections; section++)
+		{
+			const float * sos = ppSections[chan] + 6 * section;
+			float * rows = group + section * IIRSectionCoefficients * IIRSectionLanes + lane;
+			const float a0 = sos[3];
+
+			rows[0 * IIRSectionLanes] = sos[0] / a0;
+			rows[1 * IIRSectionLanes] = sos[1] / a0;
+			rows[2 * IIRSectionLanes] = sos[2] / a0;
+			rows[3 * IIRSectionLanes] = sos[4] / a0;
+			rows[4 * IIRSectionLanes] = sos[5] / a0;
+		}
+	}
+
 	return AMF_OK;
 }
 
-AMF_RESULT AMF_STD_CALL TANIIRfilterImpl::UpdateIIRResponses(float* ppInputResponse[], float* ppOutputResponse[],
-	amf_size inResponseSz, amf_size outResponseSz,
-	const amf_uint32 flagMasks[],   // Masks of flags from enum TAN_IIR_CHANNEL_FLAG, can be NULL.
-	const amf_uint32 operationFlags // Mask of flags from enum TAN_IIR_OPERATION_FLAG.
-)
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANIIRfilterImpl::UpdateSections(float* ppSections[])
+{
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(m_sectionMode, AMF_WRONG_STATE, L"Not initialized with InitSections");
+	AMF_RETURN_IF_FAILED(PackSections(ppSections, m_sectionCoefficients));
+
+	// block parallel bases follow on the next Process
+	m_blockChunkFrames = 0;
+	m_rampPending = false;
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANIIRfilterImpl::RampSections(float* ppSections[])
+{
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(m_sectionMode, AMF_WRONG_STATE, L"Not initialized with InitSections");
+
+	// the lanes nobody uses keep passing through
+	m_rampTarget = m_sectionCoefficients;
+	AMF_RETURN_IF_FAILED(PackSections(ppSections, m_rampTarget));
+
+	const amf_size groupCoefficients = m_numSections * IIRSectionCoefficients * IIRSectionLanes;
+
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
+	{
+		for (amf_uint32 section = 0; section < m_numSections; section++)
+		{
+			const amf_size offset = (chan / IIRSectionLanes) * groupCoefficients +
+				section * IIRSectionCoefficients * IIRSectionLanes + chan % IIRSectionLanes;
+
+			AMF_RETURN_IF_FALSE(IsStableSection(m_rampTarget[offset + 3 * IIRSectionLanes], m_rampTarget[offset + 4 * IIRSectionLanes]),
+				AMF_INVALID_ARG, L"section %u of channel %u is unstable", section, chan);
+			AMF_RETURN_IF_FALSE(IsStableSection(m_sectionCoefficients[offset + 3 * IIRSectionLanes], m_sectionCoefficients[offset + 4 * IIRSectionLanes]),
+				AMF_WRONG_STATE, L"current section %u of channel %u is unstable, use UpdateSections", section, chan);
+		}
+	}
+
+	SectionsToSvf(m_sectionCoefficients, m_rampFrom);
+	SectionsToSvf(m_rampTarget, m_rampTo);
+	m_rampPending = true;
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANIIRfilterImpl::SetBlockParallel(bool enable)
+{
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(m_sectionMode, AMF_WRONG_STATE, L"Not initialized with InitSections");
+
+	m_blockParallel = enable;
+
+	// the workers of the context, started now rather than by the first block
+	return enable && m_pThreadPool ? m_pThreadPool->Start() : AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANIIRfilterImpl::ProcessSections(
+	float* ppBufferInput[],
+	float* ppBufferOutput[],
+	amf_size numOfSamplesToProcess,
+	amf_size *pNumOfSamplesProcessed)
 {
-	if (inResponseSz > m_numInputTaps) {
-		inResponseSz = m_numInputTaps;
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(ppBufferInput != NULL && ppBufferOutput != NULL, AMF_INVALID_POINTER);
+
+	// a ramp runs over the whole call, frame by frame
+	const bool ramp = m_rampPending && numOfSamplesToProcess > 0;
+
+	if (m_blockParallel && !ramp && numOfSamplesToProcess >= IIRSectionLanes * BlockMinChunkFrames)
+	{
+		ProcessSectionBlocks(ppBufferInput, ppBufferOutput, numOfSamplesToProcess);
+
+		if (pNumOfSamplesProcessed)
+		{
+			*pNumOfSamplesProcessed = numOfSamplesToProcess;
+		}
+
+		return AMF_OK;
 	}
-	if (outResponseSz > m_numOutputTaps) {
-		outResponseSz = m_numOutputTaps;
+
+	const TANIIRKernels & kernels = GetTANIIRKernels();
+	const amf_size groupCoefficients = m_numSections * IIRSectionCoefficients * IIRSectionLanes;
+	const amf_size groupStates = m_numSections * IIRSectionStates * IIRSectionLanes;
+	const amf_size groupParameters = m_numSections * IIRSvfParameters * IIRSectionLanes;
+	float * frames = m_sectionFrames.data();
+
+	const unsigned int csr = _mm_getcsr();
+	_mm_setcsr(csr | FlushDenormals);
+
+	for (amf_uint32 first = 0; first < m_channels; first += IIRSectionLanes)
+	{
+		const amf_size group = first / IIRSectionLanes;
+		const amf_size lanes = std::min<amf_size>(IIRSectionLanes, m_channels - first);
+
+		if (ramp)
+		{
+			SectionStateToSvf(group);
+		}
+
+		for (amf_size done = 0; done < numOfSamplesToProcess; done += SectionBlockFrames)
+		{
+			const amf_size count = std::min(SectionBlockFrames, numOfSamplesToProcess - done);
+
+			// planar to interleaved, unused lanes of the last group filter silence
+			for (amf_size lane = 0; lane < IIRSectionLanes; lane++)
+			{
+				const float * input = (lane < lanes) ? ppBufferInput[first + lane] + done : NULL;
+
+				for (amf_size n = 0; n < count; n++)
+				{
+					frames[n * IIRSectionLanes + lane] = input ? input[n] : 0.0f;
+				}
+			}
+
+			if (ramp)
+			{
+				kernels.RampSections(frames, count,
+					&m_rampFrom[group * groupParameters], &m_rampTo[group * groupParameters],
+					&m_sectionState[group * groupStates], m_numSections, done, numOfSamplesToProcess);
+			}
+			else
+			{
+				kernels.ProcessSections(frames, count,
+					&m_sectionCoefficients[group * groupCoefficients], &m_sectionState[group * groupStates],
+					m_numSections);
+			}
+
+			for (amf_size lane = 0; lane < lanes; lane++)
+			{
+				float * output = ppBufferOutput[first + lane] + done;
+
+				for (amf_size n = 0; n < count; n++)
+				{
+					output[n] = frames[n * IIRSectionLanes + lane];
+				}
+			}
+		}
+
+		if (ramp)
+		{
+			SectionStateFromSvf(group);
+		}
 	}
 
-	for (int i = 0; i < m_channels; i++) {
-		memset(m_inputTaps[i], 0, m_numInputTaps * sizeof(float));
-		memset(m_outputTaps[i], 0, m_numOutputTaps * sizeof(float));
+	_mm_setcsr(csr);
 
-		memcpy(m_inputTaps[i], ppInputResponse[i], inResponseSz * sizeof(float));
-		memcpy(m_outputTaps[i], ppOutputResponse[i], outResponseSz * sizeof(float));
+	if (ramp)
+	{
+		m_sectionCoefficients.swap(m_rampTarget);
+		m_rampPending = false;
+		m_blockChunkFrames = 0;
 	}
 
-	if (m_doProcessOnGpu)
+	if (pNumOfSamplesProcessed)
+	{
+		*pNumOfSamplesProcessed = numOfSamplesToProcess;
+	}
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+void TANIIRfilterImpl::SectionStateToSvf(amf_size group)
+{
+	// a section's state is what it outputs without input, two frames of which determine it:
+	// the transposed direct form II puts out s1, s2 - a1 * s1, the state variable filter
+	// state that puts out the same is solved for
+	for (amf_size section = 0; section < m_numSections; section++)
 	{
-		float* inputTaps = new float[m_channels*m_numInputTaps];
-		float* outputTaps = new float[m_channels*m_numOutputTaps];
+		const amf_size index = group * m_numSections + section;
+		const float * c = &m_sectionCoefficients[index * IIRSectionCoefficients * IIRSectionLanes];
+		const float * p = &m_rampFrom[index * IIRSvfParameters * IIRSectionLanes];
+		float * s = &m_sectionState[index * IIRSectionStates * IIRSectionLanes];
 
-		for (int chan = 0; chan < m_channels; chan++)
+		for (amf_size lane = 0; lane < IIRSectionLanes; lane++)
 		{
-			for (int i = 0; i < m_numInputTaps; i++)
+			double o[2][2];
+			SvfObservability(p + lane, o);
+
+			const double y0 = s[lane];
+			const double y1 = s[IIRSectionLanes + lane] - c[3 * IIRSectionLanes + lane] * y0;
+			const double det = o[0][0] * o[1][1] - o[0][1] * o[1][0];
+			const double scale = (fabs(o[0][0]) + fabs(o[0][1])) * (fabs(o[1][0]) + fabs(o[1][1]));
+
+			// a section whose poles and zeros cancel has state it doesn't put out, drop it
+			if (fabs(det) > 1e-9 * scale)
+			{
+				s[lane] = float((y0 * o[1][1] - o[0][1] * y1) / det);
+				s[IIRSectionLanes + lane] = float((o[0][0] * y1 - o[1][0] * y0) / det);
+			}
+			else
 			{
-				inputTaps[m_numInputTaps*chan + i] = m_inputTaps[chan][i];
+				s[lane] = 0.0f;
+				s[IIRSectionLanes + lane] = 0.0f;
 			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void TANIIRfilterImpl::SectionStateFromSvf(amf_size group)
+{
+	for (amf_size section = 0; section < m_numSections; section++)
+	{
+		const amf_size index = group * m_numSections + section;
+		const float * c = &m_rampTarget[index * IIRSectionCoefficients * IIRSectionLanes];
+		const float * p = &m_rampTo[index * IIRSvfParameters * IIRSectionLanes];
+		float * s = &m_sectionState[index * IIRSectionStates * IIRSectionLanes];
+
+		for (amf_size lane = 0; lane < IIRSectionLanes; lane++)
+		{
+			double o[2][2];
+			SvfObservability(p + lane, o);
+
+			const double ic1 = s[lane];
+			const double ic2 = s[IIRSectionLanes + lane];
+			const double y0 = o[0][0] * ic1 + o[0][1] * ic2;
+			const double y1 = o[1][0] * ic1 + o[1][1] * ic2;
+
+			s[lane] = float(y0);
+			s[IIRSectionLanes + lane] = float(y1 + c[3 * IIRSectionLanes + lane] * y0);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void TANIIRfilterImpl::UpdateBlockChannel(amf_uint32 chan, amf_size chunkFrames)
+{
+	BlockChannel & block = m_blockChannels[chan];
+	const amf_size rows = m_numSections * IIRSectionStates;
+	const amf_size groupCoefficients = m_numSections * IIRSectionCoefficients * IIRSectionLanes;
+	const float * lane = &m_sectionCoefficients[(chan / IIRSectionLanes) * groupCoefficients + chan % IIRSectionLanes];
+
+	block.coefficients.resize(groupCoefficients);
+
+	for (amf_size row = 0; row < m_numSections * IIRSectionCoefficients; row++)
+	{
+		std::fill(&block.coefficients[row * IIRSectionLanes], &block.coefficients[row * IIRSectionLanes] + IIRSectionLanes,
+			lane[row * IIRSectionLanes]);
+	}
+
+	// the cascade started from one state row at 1, without input: its output is the basis
+	// column of that row, its state after a chunk the transition column
+	std::vector<double> z(rows);
+
+	block.basis.resize(chunkFrames * rows);
+	block.transition.resize(rows * rows);
 
-			for (int i = 0; i < m_numOutputTaps; i++)
+	for (amf_size column = 0; column < rows; column++)
+	{
+		std::fill(z.begin(), z.end(), 0.0);
+		z[column] = 1.0;
+
+		for (amf_size n = 0; n < chunkFrames; n++)
+		{
+			double x = 0.0;
+
+			for (amf_size section = 0; section < m_numSections; section++)
 			{
-				outputTaps[m_numOutputTaps*chan + i] = m_outputTaps[chan][i];
+				const float * c = &block.coefficients[section * IIRSectionCoefficients * IIRSectionLanes];
+				double * s = &z[section * IIRSectionStates];
+				double y = c[0 * IIRSectionLanes] * x + s[0];
+
+				s[0] = c[1 * IIRSectionLanes] * x - c[3 * IIRSectionLanes] * y + s[1];
+				s[1] = c[2 * IIRSectionLanes] * x - c[4 * IIRSectionLanes] * y;
+				x = y;
 			}
+
+			block.basis[n * rows + column] = float(x);
+		}
+
+		for (amf_size row = 0; row < rows; row++)
+		{
+			block.transition[row * rows + column] = z[row];
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void TANIIRfilterImpl::ProcessSectionTail(amf_uint32 chan, const float * input, float * output, amf_size count)
+{
+	const amf_size groupCoefficients = m_numSections * IIRSectionCoefficients * IIRSectionLanes;
+	const amf_size groupStates = m_numSections * IIRSectionStates * IIRSectionLanes;
+	const float * coefficients = &m_sectionCoefficients[(chan / IIRSectionLanes) * groupCoefficients + chan % IIRSectionLanes];
+	float * state = &m_sectionState[(chan / IIRSectionLanes) * groupStates + chan % IIRSectionLanes];
+
+	for (amf_size n = 0; n < count; n++)
+	{
+		float x = input[n];
+
+		for (amf_size section = 0; section < m_numSections; section++)
+		{
+			const float * c = coefficients + section * IIRSectionCoefficients * IIRSectionLanes;
+			float * s = state + section * IIRSectionStates * IIRSectionLanes;
+			float y = c[0 * IIRSectionLanes] * x + s[0];
+
+			s[0] = c[1 * IIRSectionLanes] * x - c[3 * IIRSectionLanes] * y + s[IIRSectionLanes];
+			s[IIRSectionLanes] = c[2 * IIRSectionLanes] * x - c[4 * IIRSectionLanes] * y;
+			x = y;
 		}
 
+		output[n] = x;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void TANIIRfilterImpl::ProcessSectionBlocks(
+	float* ppBufferInput[],
+	float* ppBufferOutput[],
+	amf_size numOfSamplesToProcess)
+{
+	const TANIIRKernels & kernels = GetTANIIRKernels();
+	const amf_size rows = m_numSections * IIRSectionStates;
+	const amf_size groupStates = m_numSections * IIRSectionStates * IIRSectionLanes;
+
+	// a lane group of chunks per thread, as long as the chunks stay long enough; what
+	// doesn't fill the chunks evenly is filtered serially after them
+	const amf_uint32 threads = TANThreadBudget(m_pThreadPool, TAN_THREAD_BUDGET_IIR_FILTER);
+	const amf_size groups = std::max<amf_size>(1, std::min<amf_size>(threads, numOfSamplesToProcess / (IIRSectionLanes * BlockMinChunkFrames)));
+	const amf_size chunks = groups * IIRSectionLanes;
+	const amf_size chunkFrames = numOfSamplesToProcess / chunks;
+	const amf_size blocked = chunks * chunkFrames;
+
+	if (chunkFrames != m_blockChunkFrames)
+	{
+		for (amf_uint32 chan = 0; chan < m_channels; chan++)
+		{
+			UpdateBlockChannel(chan, chunkFrames);
+		}
+		m_blockChunkFrames = chunkFrames;
+	}
+
+	m_blockFrames.resize(blocked);
+	m_blockZeroState.resize(groups * rows * IIRSectionLanes);
+	m_blockStartState.resize(groups * rows * IIRSectionLanes);
+
+	std::vector<double> start(rows), next(rows);
+
+	const unsigned int csr = _mm_getcsr();
+	_mm_setcsr(csr | FlushDenormals);
+
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
+	{
+		const BlockChannel & block = m_blockChannels[chan];
+		const float * input = ppBufferInput[chan];
+		float * output = ppBufferOutput[chan];
+		float * state = &m_sectionState[(chan / IIRSectionLanes) * groupStates + chan % IIRSectionLanes];
+
+		// every chunk from zero state, the chunks of a group side by side in its lanes
+		TANParallelFor(m_pThreadPool, threads, groups, [&](amf_size group)
+		{
+			const unsigned int threadCsr = _mm_getcsr();
+			_mm_setcsr(threadCsr | FlushDenormals);
+
+			float * frames = &m_blockFrames[group * chunkFrames * IIRSectionLanes];
+			float * zeroState = &m_blockZeroState[group * rows * IIRSectionLanes];
+
+			for (amf_size lane = 0; lane < IIRSectionLanes; lane++)
+			{
+				const float * chunk = input + (group * IIRSectionLanes + lane) * chunkFrames;
+
+				for (amf_size n = 0; n < chunkFrames; n++)
+				{
+					frames[n * IIRSectionLanes + lane] = chunk[n];
+				}
+			}
+
+			std::fill(zeroState, zeroState + rows * IIRSectionLanes, 0.0f);
+			kernels.ProcessSections(frames, chunkFrames, block.coefficients.data(), zeroState, m_numSections);
+
+			_mm_setcsr(threadCsr);
+		});
+
+		// a chunk ends in the state it ran into from zero plus its start state carried over
+		// the chunk, which makes the start state of the next one
+		for (amf_size row = 0; row < rows; row++)
+		{
+			start[row] = state[row * IIRSectionLanes];
+		}
+
+		for (amf_size chunk = 0; chunk < chunks; chunk++)
+		{
+			const amf_size offset = (chunk / IIRSectionLanes) * rows * IIRSectionLanes + chunk % IIRSectionLanes;
+			float * startState = &m_blockStartState[offset];
+			const float * zeroState = &m_blockZeroState[offset];
+
+			for (amf_size row = 0; row < rows; row++)
+			{
+				const double * transition = &block.transition[row * rows];
+				double carried = 0.0;
+
+				for (amf_size column = 0; column < rows; column++)
+				{
+					carried += transition[column] * start[column];
+				}
+
+				startState[row * IIRSectionLanes] = float(start[row]);
+				next[row] = zeroState[row * IIRSectionLanes] + carried;
+			}
+
+			start.swap(next);
+		}
+
+		for (amf_size row = 0; row < rows; row++)
+		{
+			state[row * IIRSectionLanes] = float(start[row]);
+		}
+
+		// add the responses to the start states and write the chunks back
+		TANParallelFor(m_pThreadPool, threads, groups, [&](amf_size group)
+		{
+			float * frames = &m_blockFrames[group * chunkFrames * IIRSectionLanes];
+
+			kernels.AddStateResponse(frames, chunkFrames, block.basis.data(),
+				&m_blockStartState[group * rows * IIRSectionLanes], rows);
+
+			for (amf_size lane = 0; lane < IIRSectionLanes; lane++)
+			{
+				float * chunk = output + (group * IIRSectionLanes + lane) * chunkFrames;
+
+				for (amf_size n = 0; n < chunkFrames; n++)
+				{
+					chunk[n] = frames[n * IIRSectionLanes + lane];
+				}
+			}
+		});
+
+		ProcessSectionTail(chan, input + blocked, output + blocked, numOfSamplesToProcess - blocked);
+	}
+
+	_mm_setcsr(csr);
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANIIRfilterImpl::UpdateIIRResponses(float* ppInputResponse[], float* ppOutputResponse[],
+	amf_size inResponseSz, amf_size outResponseSz,
+	const amf_uint32 flagMasks[],   // Masks of flags from enum TAN_IIR_CHANNEL_FLAG, can be NULL.
+	const amf_uint32 operationFlags // Mask of flags from enum TAN_IIR_OPERATION_FLAG.
+)
+{
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(!m_sectionMode, AMF_WRONG_STATE, L"Initialized with InitSections");
+	AMF_RETURN_IF_FALSE(ppInputResponse != NULL && ppOutputResponse != NULL, AMF_INVALID_POINTER);
+
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
+	{
+		if (ppInputResponse[chan] == NULL)
+		{
+			continue;
+		}
+
+		const Channel & channel = m_channelTable[chan];
+		float * inputTaps = &m_arena[channel.offset];
+		float * outputTaps = inputTaps + channel.inputTaps;
+		const amf_size inSize = std::min<amf_size>(inResponseSz, channel.inputTaps);
+		const amf_size outSize = std::min<amf_size>(outResponseSz, channel.outputTaps);
+
+		memset(inputTaps, 0, (channel.inputTaps + channel.outputTaps) * sizeof(float));
+		memcpy(inputTaps, ppInputResponse[chan], inSize * sizeof(float));
+
+		if (outSize && ppOutputResponse[chan] != NULL)
+		{
+			memcpy(outputTaps, ppOutputResponse[chan], outSize * sizeof(float));
+		}
+
+		if (m_doProcessOnGpu)
+		{
 #ifndef TAN_NO_OPENCL
-		clEnqueueWriteBuffer(this->m_pContextTAN->GetOpenCLGeneralQueue(), m_clInputTaps, CL_TRUE, 0, sizeof(float) * m_numInputTaps*m_channels, inputTaps, 0, NULL, NULL);
-		clEnqueueWriteBuffer(this->m_pContextTAN->GetOpenCLGeneralQueue(), m_clOutputTaps, CL_TRUE, 0, sizeof(float) * m_numOutputTaps*m_channels, outputTaps, 0, NULL, NULL);
+			cl_int ret = clEnqueueWriteBuffer(m_pCommandQueueCl, m_clArena, CL_FALSE, channel.offset * sizeof(float),
+				(channel.inputTaps + channel.outputTaps) * sizeof(float), inputTaps, 0, NULL, NULL);
+			AMF_RETURN_IF_CL_FAILED(ret, L"Failed to write taps");
 #else
-        THROW_NOT_IMPLEMENTED;
+			THROW_NOT_IMPLEMENTED;
 
-        return AMF_NOT_IMPLEMENTED;
+			return AMF_NOT_IMPLEMENTED;
 #endif
+		}
+	}
 
-        delete[] inputTaps;
-		delete[] outputTaps;
+#ifndef TAN_NO_OPENCL
+	if (m_doProcessOnGpu)
+	{
+		AMF_RETURN_IF_CL_FAILED(clFinish(m_pCommandQueueCl), L"Failed to write taps");
 	}
+#endif
 
 	return AMF_OK;
 }
 
+//-------------------------------------------------------------------------------------------------
+void TANIIRfilterImpl::FilterChannel(Channel & channel, const float * input, float * output, amf_size count)
+{
+	const amf_uint32 numInputTaps = channel.inputTaps;
+	const amf_uint32 numOutputTaps = channel.outputTaps;
+	const float * inputTaps = &m_arena[channel.offset];
+	const float * outputTaps = inputTaps + numInputTaps;
+	float * inputHistory = &m_arena[channel.offset] + numInputTaps + numOutputTaps;
+	float * outputHistory = inputHistory + numInputTaps;
+	amf_uint32 inputHistPos = channel.inputHistPos;
+	amf_uint32 outputHistPos = channel.outputHistPos;
+
+	for (amf_size sn = 0; sn < count; sn++)
+	{
+		float sample = 0.0f;
+		inputHistory[inputHistPos] = input[sn];
+
+		// the histories run backwards from the current position and wrap around at 0
+
+		//FIR part
+		for (amf_uint32 k = 0; k <= inputHistPos; k++)
+		{
+			sample += inputTaps[k] * inputHistory[inputHistPos - k];
+		}
+		for (amf_uint32 k = inputHistPos + 1; k < numInputTaps; k++)
+		{
+			sample += inputTaps[k] * inputHistory[inputHistPos + numInputTaps - k];
+		}
+
+		//IIR part
+		for (amf_uint32 l = 0; l <= outputHistPos && l < numOutputTaps; l++)
+		{
+			sample += outputTaps[l] * outputHistory[outputHistPos - l];
+		}
+		for (amf_uint32 l = outputHistPos + 1; l < numOutputTaps; l++)
+		{
+			sample += outputTaps[l] * outputHistory[outputHistPos + numOutputTaps - l];
+		}
+
+		output[sn] = sample;
+
+		if (++inputHistPos == numInputTaps)
+		{
+			inputHistPos = 0;
+		}
+		if (numOutputTaps)
+		{
+			if (++outputHistPos == numOutputTaps)
+			{
+				outputHistPos = 0;
+			}
+			outputHistory[outputHistPos] = sample;
+		}
+	}
+
+	channel.inputHistPos = inputHistPos;
+	channel.outputHistPos = outputHistPos;
+}
+
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::ProcessDirect(float* ppBufferInput[],
 	float* ppBufferOutput[],
 	amf_size numOfSamplesToProcess,
@@ -401,36 +1134,25 @@ AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::ProcessDirect(float* ppBufferInput
 	amf_size *pNumOfSamplesProcessed // Can be NULL.
 )
 {
-	if (pNumOfSamplesProcessed)
+	TANBlockTimer blockTimer(m_counters, numOfSamplesToProcess);
+
+	if (m_sectionMode)
 	{
-		*pNumOfSamplesProcessed = 0;
+		return ProcessSections(ppBufferInput, ppBufferOutput, numOfSamplesToProcess, pNumOfSamplesProcessed);
 	}
 
-	//Todo:: move to funcion
-	float sample;
-	for (int sn = 0; sn < numOfSamplesToProcess; sn++) {
-		// compute next sample for each channel
-		for (int chan = 0; chan < m_channels; chan++) {
-			sample = 0.0;
-			m_inputHistory[chan][m_inputHistPos] = ppBufferInput[chan][sn];
-
-			//FIR part
-			for (int k = 0; k < m_numInputTaps; k++) {
-				sample += m_inputTaps[chan][k] * m_inputHistory[chan][(m_inputHistPos + m_numInputTaps - k) % m_numInputTaps];
-			}
-			//IIR part
-			for (int l = 0; l < m_numOutputTaps; l++) {
-				sample += m_outputTaps[chan][l] * m_outputHistory[chan][(m_outputHistPos + m_numOutputTaps - l) % m_numOutputTaps];
-			}
-			ppBufferOutput[chan][sn] = sample;
-		}
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(ppBufferInput != NULL && ppBufferOutput != NULL, AMF_INVALID_POINTER);
 
-		m_inputHistPos = ++m_inputHistPos % m_numInputTaps;
-		m_outputHistPos = ++m_outputHistPos % m_numOutputTaps;
+	if (pNumOfSamplesProcessed)
+	{
+		*pNumOfSamplesProcessed = 0;
+	}
 
-		for (int chan = 0; chan < m_channels; chan++) {
-			m_outputHistory[chan][m_outputHistPos] = ppBufferOutput[chan][sn];
-		}
+	// a channel at a time, its taps and history stay in cache for the whole buffer
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
+	{
+		FilterChannel(m_channelTable[chan], ppBufferInput[chan], ppBufferOutput[chan], numOfSamplesToProcess);
 	}
 
 	if (pNumOfSamplesProcessed)
@@ -441,6 +1163,7 @@ AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::ProcessDirect(float* ppBufferInput
 	return AMF_OK;
 }
 
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::Process(float* ppBufferInput[],
 	float* ppBufferOutput[],
 	amf_size numOfSamplesToProcess,
@@ -448,8 +1171,18 @@ AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::Process(float* ppBufferInput[],
 	amf_size *pNumOfSamplesProcessed // Can be NULL.
 )
 {
+	// sections run on the CPU only, as ProcessDirect
+	if (m_sectionMode || !m_doProcessOnGpu)
+	{
+		return ProcessDirect(ppBufferInput, ppBufferOutput, numOfSamplesToProcess, flagMasks, pNumOfSamplesProcessed);
+	}
+
 #ifndef TAN_NO_OPENCL
-	cl_context context = m_pContextTAN->GetOpenCLContext();
+	TANBlockTimer blockTimer(m_counters, numOfSamplesToProcess);
+
+	AMFLock lock(&m_sect);
+	AMF_RETURN_IF_FALSE(ppBufferInput != NULL && ppBufferOutput != NULL, AMF_INVALID_POINTER);
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess <= m_numSamples, AMF_INVALID_ARG, L"More samples than bufferSizeInSamples");
 
 	if (pNumOfSamplesProcessed)
 	{
@@ -457,21 +1190,23 @@ AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::Process(float* ppBufferInput[],
 	}
 
 	//Copy to temp OCL buffer from host
-	for (int chan = 0; chan < m_channels; chan++)
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
 	{
-		float * ptr = ppBufferInput[chan];
-		clEnqueueWriteBuffer(m_pCommandQueueCl, m_clTempInSubBufs[chan], 1, 0, numOfSamplesToProcess*sizeof(float), ppBufferInput[chan], 0, nullptr, nullptr);
+		cl_int ret = clEnqueueWriteBuffer(m_pCommandQueueCl, m_clTempIn, CL_FALSE, chan * amf_size(m_bufSize), numOfSamplesToProcess * sizeof(float), ppBufferInput[chan], 0, nullptr, nullptr);
+		AMF_RETURN_IF_CL_FAILED(ret, L"Failed to write input");
 	}
 
-	IIRFilterProcessGPU(m_clTempIn, m_clTempOut, m_numSamples, flagMasks, pNumOfSamplesProcessed);
+	AMF_RETURN_IF_FAILED(IIRFilterProcessGPU(m_clTempIn, m_clTempOut, numOfSamplesToProcess, flagMasks, pNumOfSamplesProcessed));
 
 	//Write to host from CL output buffer
-	for (int chan = 0; chan < m_channels; chan++)
+	for (amf_uint32 chan = 0; chan < m_channels; chan++)
 	{
-		float * ptr = ppBufferOutput[chan];
-		clEnqueueReadBuffer(m_pCommandQueueCl, m_clTempOutSubBufs[chan], 1, 0, numOfSamplesToProcess* sizeof(float), ppBufferOutput[chan], 0, nullptr, nullptr);
+		cl_int ret = clEnqueueReadBuffer(m_pCommandQueueCl, m_clTempOut, CL_FALSE, chan * amf_size(m_bufSize), numOfSamplesToProcess * sizeof(float), ppBufferOutput[chan], 0, nullptr, nullptr);
+		AMF_RETURN_IF_CL_FAILED(ret, L"Failed to read output");
 	}
 
+	AMF_RETURN_IF_CL_FAILED(clFinish(m_pCommandQueueCl), L"Failed to read output");
+
 	if (pNumOfSamplesProcessed)
 	{
 		*pNumOfSamplesProcessed = numOfSamplesToProcess;
@@ -485,7 +1220,6 @@ AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::Process(float* ppBufferInput[],
 	return AMF_OK;
 }
 
-
 #ifndef TAN_NO_OPENCL
 
 AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::Process(
@@ -524,30 +1258,32 @@ AMF_RESULT  AMF_STD_CALL    TANIIRfilterImpl::IIRFilterProcessGPU(
 	amf_size *pNumOfSamplesProcessed // Can be NULL.
 )
 {
-	AMF_RESULT res = AMF_OK;
+	if (m_channels == 0)
+	{
+		return AMF_OK;
+	}
 
-	// Create as many work-items as there are conversions needed to be done and execute
-	size_t local[3] = { 128, 1, 0 };
-	size_t global[3] = { 1, m_channels, 0 };
+	// one work-item per channel, each runs the recursion of its channel
+	size_t global[1] = { m_channels };
 
-	int status = 0;
+	cl_int bufferStride = m_numSamples;
+	cl_int numSamples = cl_int(numOfSamplesToProcess);
+	cl_int status = CL_SUCCESS;
 	cl_int argCounter = 0;
 
 	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &inputBuf);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clInputHistory);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clOutputHistory);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clInputTaps);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clOutputTaps);
+	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clArena);
+	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clChannelTable);
+	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clHistPos);
 	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &outputBuf);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_mem), &m_clInOutHistPos);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_int), &m_numInputTaps);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_int), &m_numOutputTaps);
-	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_int), &numOfSamplesToProcess);
-	status = clEnqueueNDRangeKernel(m_pCommandQueueCl, m_kernel_IIRfilter, 2, NULL, global, local, 0, NULL, NULL);
+	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_int), &bufferStride);
+	status |= clSetKernelArg(m_kernel_IIRfilter, argCounter++, sizeof(cl_int), &numSamples);
+	AMF_RETURN_IF_CL_FAILED(status, L"Failed to set OpenCL kernel arguments");
 
+	status = clEnqueueNDRangeKernel(m_pCommandQueueCl, m_kernel_IIRfilter, 1, NULL, global, NULL, 0, NULL, NULL);
 	if (status != CL_SUCCESS) { printf("Failed to enqueue OpenCL kernel\n"); return AMF_FAIL; }
 	return AMF_OK;
 }
 
 #else
-#endif
\ No newline at end of file
+#endif
@@ -30,11 +30,14 @@
 #include "public/include/core/Context.h"        //AMF
 #include "public/include/components/Component.h"//AMF
 #include "public/common/PropertyStorageExImpl.h"
+#include "../core/AlignedAllocator.h"
+#include "../core/PerformanceCounters.h"
+#include "../core/ThreadPool.h"
+
+#include <vector>
 
 namespace amf
 {
-#define MAX_CHANNELS	32
-
     class TANIIRfilterImpl :
         public virtual AMFInterfaceImpl < AMFPropertyStorageExImpl< TANIIRfilter> >    {
     public:
@@ -58,6 +61,11 @@ namespace amf
         virtual AMF_RESULT  AMF_STD_CALL    Terminate();
         virtual TANContext* AMF_STD_CALL    GetContext()	{ return m_pContextTAN; }
 
+        //AMFPropertyStorage interface, for the TAN_STATS_* properties
+        using TANIIRfilter::GetProperty;
+        AMF_RESULT  AMF_STD_CALL    GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const override;
+        void        AMF_STD_CALL    OnPropertyChanged(const wchar_t* name) override;
+
         virtual AMF_RESULT AMF_STD_CALL     UpdateIIRResponses(float* ppInputResponse[], float* ppOutputResponse[],
             amf_size inResponseSz, amf_size outResponseSz,
             const amf_uint32 flagMasks[],   // Masks of flags from enum TAN_IIR_CHANNEL_FLAG, can be NULL.
@@ -96,12 +104,31 @@ namespace amf
             );
 #endif
 
+        virtual AMF_RESULT  AMF_STD_CALL    InitSections(
+            amf_uint32 numSections,
+            amf_uint32 bufferSizeInSamples,
+            amf_uint32 channels);
+
+        virtual AMF_RESULT  AMF_STD_CALL    UpdateSections(float* ppSections[]);
+
+        virtual AMF_RESULT  AMF_STD_CALL    AddChannel(amf_uint32 numInputTaps, amf_uint32 numOutputTaps);
+        virtual AMF_RESULT  AMF_STD_CALL    RemoveChannel(amf_uint32 channel);
+        virtual amf_uint32  AMF_STD_CALL    GetChannelCount()   { return m_channels; }
+        virtual AMF_RESULT  AMF_STD_CALL    SetBlockParallel(bool enable);
+        virtual AMF_RESULT  AMF_STD_CALL    RampSections(float* ppSections[]);
+
     protected:
 
         TANContextPtr               m_pContextTAN;
         AMFComputePtr               m_pDeviceCompute;
 		AMFComputePtr               m_pDeviceAMF;
 
+		// block parallel chunks run on the workers of the context
+		TANThreadPool *             m_pThreadPool = nullptr;
+
+		// TAN_STATS_* properties, a block is a call of Process
+		TANPerformanceCounters      m_counters;
+
 #ifndef TAN_NO_OPENCL
 
 		cl_command_queue			m_pCommandQueueCl = nullptr;
@@ -110,14 +137,11 @@ namespace amf
 		cl_program					m_program = nullptr;
 		cl_kernel					m_kernel_IIRfilter = nullptr;
 		cl_mem						m_clTempIn = nullptr;
-		cl_mem						m_clTempInSubBufs[MAX_CHANNELS] = {nullptr};
-		cl_mem						m_clTempOutSubBufs[MAX_CHANNELS] = {nullptr};
 		cl_mem						m_clTempOut = nullptr;
-		cl_mem						m_clInputTaps = nullptr;
-		cl_mem						m_clOutputTaps = nullptr;
-		cl_mem						m_clInputHistory = nullptr;
-		cl_mem						m_clOutputHistory = nullptr;
-		cl_mem						m_clInOutHistPos = nullptr;
+		amf_uint32					m_clTempChannels = 0;	// channels the temp buffers have room for
+		cl_mem						m_clArena = nullptr;	// same layout as m_arena
+		cl_mem						m_clChannelTable = nullptr;	// arena offset, input taps, output taps per channel
+		cl_mem						m_clHistPos = nullptr;	// input and output history position per channel
 
 #else
 #endif
@@ -134,18 +158,88 @@ namespace amf
 
 #ifndef TAN_NO_OPENCL
 		virtual AMF_RESULT  AMF_STD_CALL IIRFilterProcessGPU(cl_mem hisBuf, cl_mem out, amf_size numOfSamplesToProcess, const amf_uint32 flagMasks[], amf_size *pNumOfSamplesProcessed);
+
+		// Device side of a channel change: buffer is resized to newSize bytes keeping its first
+		// keep bytes, dropping the skip bytes after them and moving the rest down; anything
+		// past the kept bytes is zeroed.
+		AMF_RESULT ResizeGpuBuffer(cl_mem & buffer, amf_size oldSize, amf_size newSize, amf_size keep, amf_size skip);
+		// Same for the arena (keep and skip in floats) and the history positions (removedCount
+		// channels from removed on), the channel table is rewritten.
+		AMF_RESULT UpdateGpuChannels(amf_size oldArenaSize, amf_size keep, amf_size skip,
+			amf_uint32 oldChannels, amf_uint32 removed, amf_uint32 removedCount);
+		void ReleaseGpuChannels();
 #else
 #endif
 
-        amf_uint32 m_numInputTaps = 0;
-        amf_uint32 m_numOutputTaps = 0;
+        // Taps mode channels: every channel owns an arena span of its input taps, output taps,
+        // input history and output history, in that order, padded to whole cache lines of the
+        // cache line aligned arena.
+        struct Channel
+        {
+            amf_uint32 offset;
+            amf_uint32 inputTaps;
+            amf_uint32 outputTaps;
+            amf_uint32 inputHistPos;
+            amf_uint32 outputHistPos;
+        };
+
+        static amf_uint32 ChannelSpan(amf_uint32 numInputTaps, amf_uint32 numOutputTaps);
+        void FilterChannel(Channel & channel, const float * input, float * output, amf_size count);
+
+        // Host memory processing in second order sections mode.
+        AMF_RESULT ProcessSections(float* ppBufferInput[], float* ppBufferOutput[],
+            amf_size numOfSamplesToProcess, amf_size *pNumOfSamplesProcessed);
+
+        // Block parallel second order sections, see SetBlockParallel.
+        void ProcessSectionBlocks(float* ppBufferInput[], float* ppBufferOutput[], amf_size numOfSamplesToProcess);
+        void UpdateBlockChannel(amf_uint32 chan, amf_size chunkFrames);
+        void ProcessSectionTail(amf_uint32 chan, const float * input, float * output, amf_size count);
+
+        // Checks ppSections as UpdateSections and writes them into coefficients.
+        AMF_RESULT PackSections(float* ppSections[], std::vector<float> & coefficients);
+        // Coefficient ramps, see RampSections: the state of a lane group is mapped to the state
+        // variable filter form before the ramp and back after it.
+        void SectionStateToSvf(amf_size group);
+        void SectionStateFromSvf(amf_size group);
+
         amf_uint32 m_channels = 0;
-        float **m_inputTaps = nullptr;
-        float **m_outputTaps = nullptr;
-        float **m_inputHistory = nullptr;
-        float **m_outputHistory = nullptr;
-        amf_uint32 m_inputHistPos = 0;
-        amf_uint32 m_outputHistPos = 0;
+        std::vector<Channel> m_channelTable;
+        std::vector<float, TANAlignedAllocator<float>> m_arena;
 		bool m_doProcessOnGpu = false;
+
+        // Second order sections mode, channels in groups of IIRSectionLanes: coefficients and
+        // state of one group follow each other, see IIRKernels.h. Frames is the interleaved
+        // block the groups are filtered in.
+        bool m_sectionMode = false;
+        amf_uint32 m_numSections = 0;
+        std::vector<float> m_sectionCoefficients;
+        std::vector<float> m_sectionState;
+        std::vector<float> m_sectionFrames;
+
+        // Block parallel sections: per channel the coefficients in every lane, the responses of
+        // the cascade to each state row over a chunk (chunk frames x rows) and the state
+        // transition over a chunk (rows x rows). Chunks of a lane group are laid out like the
+        // channels of one, the start and the zero start end states hold rows for every group.
+        struct BlockChannel
+        {
+            std::vector<float> coefficients;
+            std::vector<float> basis;
+            std::vector<double> transition;
+        };
+
+        bool m_blockParallel = false;
+        amf_size m_blockChunkFrames = 0;    // chunk length of the bases, 0 when stale
+        std::vector<BlockChannel> m_blockChannels;
+        std::vector<float> m_blockFrames;
+        std::vector<float> m_blockZeroState;
+        std::vector<float> m_blockStartState;
+
+        // Coefficient ramp of the next Process: the coefficients it ends on, laid out as
+        // m_sectionCoefficients, and the state variable filter parameters it runs from and to,
+        // numSections x IIRSvfParameters rows per lane group.
+        bool m_rampPending = false;
+        std::vector<float> m_rampTarget;
+        std::vector<float> m_rampFrom;
+        std::vector<float> m_rampTo;
     };
 } //amf
@@ -96,3 +96,138 @@ __kernel void floatToShort(
 
 	outputBuffer[(gid * outputStep) + outputOffset] = convert_short( f );
 }
+
+// Wider integer types. Steps and offsets count samples, packed 24 bit samples take 3 bytes.
+// Integer results are rounded to nearest and saturated, like on the CPU.
+
+#define INT24_MAX 8388607
+#define INT24_MIN (-8388608)
+#define INT32_UPPER 2147483520.0f	// largest float below 2^31
+
+// Saturates f to [lower, upper], NaN to lower (fmax drops it), and flags the overflow.
+float clampSample(float f, float lower, float upper, __global int* overflowError)
+{
+	float c = fmin(fmax(f, lower), upper);
+
+	if (!(c == f))
+	{
+		*overflowError = OVERFLOW_WARNING;
+	}
+
+	return c;
+}
+
+__kernel void floatToInt32(
+	__global	float*	inputBuffer,	///< [in]
+				long	inputStep,		///< [in]
+				long	inputOffset,	///< [in]
+	__global	int*	outputBuffer,	///< [out]
+				long	outputStep,		///< [in]
+				long	outputOffset,	///< [in]
+				float	conversionGain,	///< [in]
+	__global	int*	overflowError	///< [out]
+	)
+{
+	int gid = get_global_id(0);
+
+	float scale = INT32_UPPER * conversionGain;
+	float f = clampSample(inputBuffer[(gid * inputStep) + inputOffset] * scale, INT_MIN, INT32_UPPER, overflowError);
+
+	outputBuffer[(gid * outputStep) + outputOffset] = convert_int_sat_rte( f );
+}
+
+__kernel void floatToInt24In32(
+	__global	float*	inputBuffer,	///< [in]
+				long	inputStep,		///< [in]
+				long	inputOffset,	///< [in]
+	__global	int*	outputBuffer,	///< [out]
+				long	outputStep,		///< [in]
+				long	outputOffset,	///< [in]
+				float	conversionGain,	///< [in]
+	__global	int*	overflowError	///< [out]
+	)
+{
+	int gid = get_global_id(0);
+
+	float scale = INT24_MAX * conversionGain;
+	float f = clampSample(inputBuffer[(gid * inputStep) + inputOffset] * scale, INT24_MIN, INT24_MAX, overflowError);
+
+	outputBuffer[(gid * outputStep) + outputOffset] = convert_int_rte( f );
+}
+
+__kernel void floatToInt24(
+	__global	float*	inputBuffer,	///< [in]
+				long	inputStep,		///< [in]
+				long	inputOffset,	///< [in]
+	__global	uchar*	outputBuffer,	///< [out]
+				long	outputStep,		///< [in]
+				long	outputOffset,	///< [in]
+				float	conversionGain,	///< [in]
+	__global	int*	overflowError	///< [out]
+	)
+{
+	int gid = get_global_id(0);
+
+	float scale = INT24_MAX * conversionGain;
+	float f = clampSample(inputBuffer[(gid * inputStep) + inputOffset] * scale, INT24_MIN, INT24_MAX, overflowError);
+	int value = convert_int_rte( f );
+
+	__global uchar* output = outputBuffer + 3 * ((gid * outputStep) + outputOffset);
+	output[0] = (uchar)value;
+	output[1] = (uchar)(value >> 8);
+	output[2] = (uchar)(value >> 16);
+}
+
+__kernel void int32ToFloat(
+	__global	int*	inputBuffer,	///< [in]
+				long	inputStep,		///< [in]
+				long	inputOffset,	///< [in]
+	__global	float*	outputBuffer,	///< [out]
+				long	outputStep,		///< [in]
+				long	outputOffset,	///< [in]
+				float	conversionGain	///< [in]
+	)
+{
+	float scale = conversionGain / INT32_UPPER;
+
+	int gid = get_global_id(0);
+	outputBuffer[(gid * outputStep) + outputOffset] = convert_float( inputBuffer[(gid * inputStep) + inputOffset] ) * scale;
+}
+
+__kernel void int24In32ToFloat(
+	__global	int*	inputBuffer,	///< [in]
+				long	inputStep,		///< [in]
+				long	inputOffset,	///< [in]
+	__global	float*	outputBuffer,	///< [out]
+				long	outputStep,		///< [in]
+				long	outputOffset,	///< [in]
+				float	conversionGain	///< [in]
+	)
+{
+	float scale = conversionGain / INT24_MAX;
+
+	int gid = get_global_id(0);
+	int value = (inputBuffer[(gid * inputStep) + inputOffset] << 8) >> 8;
+
+	outputBuffer[(gid * outputStep) + outputOffset] = convert_float( value ) * scale;
+}
+
+__kernel void int24ToFloat(
+	__global	uchar*	inputBuffer,	///< [in]
+				long	inputStep,		///< [in]
+				long	inputOffset,	///< [in]
+	__global	float*	outputBuffer,	///< [out]
+				long	outputStep,		///< [in]
+				long	outputOffset,	///< [in]
+				float	conversionGain	///< [in]
+	)
+{
+	float scale = conversionGain / INT24_MAX;
+
+	int gid = get_global_id(0);
+
+	__global uchar* input = inputBuffer + 3 * ((gid * inputStep) + inputOffset);
+	int value = ((int)input[0] << 8 | (int)input[1] << 16 | (int)input[2] << 24) >> 8;
+
+	outputBuffer[(gid * outputStep) + outputOffset] = convert_float( value ) * scale;
+}
@@ -130,4 +130,186 @@ kernel void floatToShort(
 	short outputValue = f;
 
 	outputBuffer[(gid * outputStep) + outputOffset] = outputValue;
-}
\ No newline at end of file
+}
+// Wider integer types. Steps and offsets count samples, packed 24 bit samples take 3 bytes.
+// Integer results are rounded to nearest and saturated, like on the CPU.
+
+#define INT24_MAX 8388607
+#define INT24_MIN (-8388608)
+#define INT32_UPPER 2147483520.0f	// largest float below 2^31
+
+// Saturates f to [lower, upper], NaN to lower (fmax drops it), and flags the overflow.
+float clampSample(float f, float lower, float upper, device int* overflowError)
+{
+	float c = metal::fmin(metal::fmax(f, lower), upper);
+
+	if (!(c == f))
+	{
+		*overflowError = OVERFLOW_WARNING;
+	}
+
+	return c;
+}
+
+kernel void floatToInt32(
+	device	float*		inputBuffer,		///< [in]
+	constant int32_t &	inputStep,			///< [in]
+	constant int32_t &	inputOffset,		///< [in]
+	device	int*		outputBuffer,		///< [out]
+	constant int32_t &	outputStep,			///< [in]
+	constant int32_t &	outputOffset,		///< [in]
+	constant float & 	conversionGain,	///< [in]
+	device	int*		overflowError		///< [out]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	int gid = global_id.x;
+
+	float scale = INT32_UPPER * conversionGain;
+	float f = clampSample(inputBuffer[(gid * inputStep) + inputOffset] * scale, INT_MIN, INT32_UPPER, overflowError);
+	int outputValue = int(metal::rint(f));
+
+	outputBuffer[(gid * outputStep) + outputOffset] = outputValue;
+}
+
+kernel void floatToInt24In32(
+	device	float*		inputBuffer,		///< [in]
+	constant int32_t &	inputStep,			///< [in]
+	constant int32_t &	inputOffset,		///< [in]
+	device	int*		outputBuffer,		///< [out]
+	constant int32_t &	outputStep,			///< [in]
+	constant int32_t &	outputOffset,		///< [in]
+	constant float & 	conversionGain,	///< [in]
+	device	int*		overflowError		///< [out]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	int gid = global_id.x;
+
+	float scale = INT24_MAX * conversionGain;
+	float f = clampSample(inputBuffer[(gid * inputStep) + inputOffset] * scale, INT24_MIN, INT24_MAX, overflowError);
+	int outputValue = int(metal::rint(f));
+
+	outputBuffer[(gid * outputStep) + outputOffset] = outputValue;
+}
+
+kernel void floatToInt24(
+	device	float*		inputBuffer,		///< [in]
+	constant int32_t &	inputStep,			///< [in]
+	constant int32_t &	inputOffset,		///< [in]
+	device	uchar*		outputBuffer,		///< [out]
+	constant int32_t &	outputStep,			///< [in]
+	constant int32_t &	outputOffset,		///< [in]
+	constant float & 	conversionGain,	///< [in]
+	device	int*		overflowError		///< [out]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	int gid = global_id.x;
+
+	float scale = INT24_MAX * conversionGain;
+	float f = clampSample(inputBuffer[(gid * inputStep) + inputOffset] * scale, INT24_MIN, INT24_MAX, overflowError);
+	int outputValue = int(metal::rint(f));
+
+	device uchar* output = outputBuffer + 3 * ((gid * outputStep) + outputOffset);
+	output[0] = uchar(outputValue);
+	output[1] = uchar(outputValue >> 8);
+	output[2] = uchar(outputValue >> 16);
+}
+
+kernel void int32ToFloat(
+	device	int*		inputBuffer,		///< [in]
+	constant int32_t &	inputStep,			///< [in]
+	constant int32_t &	inputOffset,		///< [in]
+	device	float*		outputBuffer,		///< [out]
+	constant int32_t &	outputStep,			///< [in]
+	constant int32_t &	outputOffset,		///< [in]
+	constant float &	conversionGain		///< [in]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	float scale = conversionGain / INT32_UPPER;
+
+	int gid = global_id.x;
+
+	int inputValue = inputBuffer[(gid * inputStep) + inputOffset];
+
+	outputBuffer[(gid * outputStep) + outputOffset] = scale * inputValue;
+}
+
+kernel void int24In32ToFloat(
+	device	int*		inputBuffer,		///< [in]
+	constant int32_t &	inputStep,			///< [in]
+	constant int32_t &	inputOffset,		///< [in]
+	device	float*		outputBuffer,		///< [out]
+	constant int32_t &	outputStep,			///< [in]
+	constant int32_t &	outputOffset,		///< [in]
+	constant float &	conversionGain		///< [in]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	float scale = conversionGain / INT24_MAX;
+
+	int gid = global_id.x;
+
+	int inputValue = (inputBuffer[(gid * inputStep) + inputOffset] << 8) >> 8;
+
+	outputBuffer[(gid * outputStep) + outputOffset] = scale * inputValue;
+}
+
+kernel void int24ToFloat(
+	device	uchar*		inputBuffer,		///< [in]
+	constant int32_t &	inputStep,			///< [in]
+	constant int32_t &	inputOffset,		///< [in]
+	device	float*		outputBuffer,		///< [out]
+	constant int32_t &	outputStep,			///< [in]
+	constant int32_t &	outputOffset,		///< [in]
+	constant float &	conversionGain		///< [in]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	float scale = conversionGain / INT24_MAX;
+
+	int gid = global_id.x;
+
+	device uchar* input = inputBuffer + 3 * ((gid * inputStep) + inputOffset);
+	int inputValue = (int(input[0]) << 8 | int(input[1]) << 16 | int(input[2]) << 24) >> 8;
+
+	outputBuffer[(gid * outputStep) + outputOffset] = scale * inputValue;
+}
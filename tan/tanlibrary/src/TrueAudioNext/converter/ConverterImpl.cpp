@@ -28,6 +28,7 @@
 #include "Debug.h"
 #include "cpucaps.h"
 
+#include <limits.h>
 #include <math.h>
 
 #ifdef ENABLE_METAL
@@ -40,8 +41,6 @@
 
 
 using namespace amf;
-//const InstructionSet::InstructionSet_Internal InstructionSet::CPU_Rep;
-bool TANConverterImpl::useSSE2 = true; // InstructionSet::SSE2();
 
 //-------------------------------------------------------------------------------------------------
 TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateConverter(
@@ -64,10 +63,12 @@ TANConverterImpl::TANConverterImpl(TANContext *pContextTAN, AMFContext* pContext
     m_overflowBuffer(NULL),
 #endif
 
-    m_eOutputMemoryType(AMF_MEMORY_HOST)
+    m_eOutputMemoryType(AMF_MEMORY_HOST),
+    m_eDither(TAN_DITHER_NONE)
 {
     AMFPrimitivePropertyInfoMapBegin
         AMFPropertyInfoEnum(TAN_OUTPUT_MEMORY_TYPE ,  L"Output Memory Type", AMF_MEMORY_HOST, AMF_MEMORY_ENUM_DESCRIPTION, false),
+        AMFPropertyInfoEnum(TAN_CONVERTER_DITHER, L"Dither of 16 bit output", TAN_DITHER_NONE, TAN_DITHER_ENUM_DESCRIPTION, AMF_PROPERTY_ACCESS_FULL),
     AMFPrimitivePropertyInfoMapEnd
 }
 //-------------------------------------------------------------------------------------------------
@@ -90,6 +91,11 @@ AMF_RESULT  AMF_STD_CALL TANConverterImpl::Init()
 
     AMF_RETURN_IF_FALSE((NULL != m_pContextTAN), AMF_WRONG_STATE, L"Cannot initialize after termination");
 
+    amf_int64 dither = TAN_DITHER_NONE;
+    GetProperty(TAN_CONVERTER_DITHER, &dither);
+    m_eDither = (TAN_DITHER_MODE)dither;
+    m_ditherStates.clear();
+
     // Determine how to initialize based on context, CPU for CPU and GPU for GPU
 #ifndef TAN_NO_OPENCL
     if(m_pContextTAN->GetOpenCLContext())
@@ -156,6 +162,18 @@ AMF_RESULT  AMF_STD_CALL TANConverterImpl::InitGpu()
 	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel shortToShort"); return AMF_FAIL; }
 	OCLKenel_Err = GetOclKernel(m_clkShort2Float, m_pDeviceAMF, contextImpl->GetOpenCLConvQueue(), "shortToFloat", Converter, ConverterCount, "shortToFloat", "");
 	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel shortToFloat"); return AMF_FAIL; }
+	OCLKenel_Err = GetOclKernel(m_clkFloat2Int32, m_pDeviceAMF, contextImpl->GetOpenCLConvQueue(), "floatToInt32", Converter, ConverterCount, "floatToInt32", "");
+	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel floatToInt32"); return AMF_FAIL; }
+	OCLKenel_Err = GetOclKernel(m_clkFloat2Int24In32, m_pDeviceAMF, contextImpl->GetOpenCLConvQueue(), "floatToInt24In32", Converter, ConverterCount, "floatToInt24In32", "");
+	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel floatToInt24In32"); return AMF_FAIL; }
+	OCLKenel_Err = GetOclKernel(m_clkFloat2Int24, m_pDeviceAMF, contextImpl->GetOpenCLConvQueue(), "floatToInt24", Converter, ConverterCount, "floatToInt24", "");
+	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel floatToInt24"); return AMF_FAIL; }
+	OCLKenel_Err = GetOclKernel(m_clkInt32_2Float, m_pDeviceAMF, contextImpl->GetOpenCLConvQueue(), "int32ToFloat", Converter, ConverterCount, "int32ToFloat", "");
+	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel int32ToFloat"); return AMF_FAIL; }
+	OCLKenel_Err = GetOclKernel(m_clkInt24In32_2Float, m_pDeviceAMF, contextImpl->GetOpenCLConvQueue(), "int24In32ToFloat", Converter, ConverterCount, "int24In32ToFloat", "");
+	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel int24In32ToFloat"); return AMF_FAIL; }
+	OCLKenel_Err = GetOclKernel(m_clkInt24_2Float, m_pDeviceAMF, contextImpl->GetOpenCLConvQueue(), "int24ToFloat", Converter, ConverterCount, "int24ToFloat", "");
+	if (!OCLKenel_Err){ printf("Failed to compile Converter Kernel int24ToFloat"); return AMF_FAIL; }
 
 #else
 
@@ -245,6 +263,102 @@ AMF_RESULT  AMF_STD_CALL TANConverterImpl::InitGpu()
         AMF_FAIL
         );
 
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mFloat2Int32,
+            m_pDeviceAMF,
+
+            "floatToInt32",
+            (const char *)Converter,
+            ConverterCount,
+            "floatToInt32",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mFloat2Int24In32,
+            m_pDeviceAMF,
+
+            "floatToInt24In32",
+            (const char *)Converter,
+            ConverterCount,
+            "floatToInt24In32",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mFloat2Int24,
+            m_pDeviceAMF,
+
+            "floatToInt24",
+            (const char *)Converter,
+            ConverterCount,
+            "floatToInt24",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mInt32_2Float,
+            m_pDeviceAMF,
+
+            "int32ToFloat",
+            (const char *)Converter,
+            ConverterCount,
+            "int32ToFloat",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mInt24In32_2Float,
+            m_pDeviceAMF,
+
+            "int24In32ToFloat",
+            (const char *)Converter,
+            ConverterCount,
+            "int24In32ToFloat",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mInt24_2Float,
+            m_pDeviceAMF,
+
+            "int24ToFloat",
+            (const char *)Converter,
+            ConverterCount,
+            "int24ToFloat",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
 #endif
 
 	return res;
@@ -262,10 +376,22 @@ AMF_RESULT  AMF_STD_CALL TANConverterImpl::Terminate()
 		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkFloat2Short), L"Failed to release cl kernel");
 		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkShort2Float), L"Failed to release cl kernel");
 		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkShort2Short), L"Failed to release cl kernel");
+		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkFloat2Int32), L"Failed to release cl kernel");
+		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkFloat2Int24In32), L"Failed to release cl kernel");
+		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkFloat2Int24), L"Failed to release cl kernel");
+		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkInt32_2Float), L"Failed to release cl kernel");
+		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkInt24In32_2Float), L"Failed to release cl kernel");
+		AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkInt24_2Float), L"Failed to release cl kernel");
 		m_clkShort2Short = nullptr;
 		m_clkFloat2Float = nullptr;
 		m_clkShort2Float = nullptr;
 		m_clkFloat2Short = nullptr;
+		m_clkFloat2Int32 = nullptr;
+		m_clkFloat2Int24In32 = nullptr;
+		m_clkFloat2Int24 = nullptr;
+		m_clkInt32_2Float = nullptr;
+		m_clkInt24In32_2Float = nullptr;
+		m_clkInt24_2Float = nullptr;
 	}
 
     m_pDeviceCl = NULL;
@@ -296,6 +422,12 @@ AMF_RESULT  AMF_STD_CALL TANConverterImpl::Terminate()
     mShort2Short = nullptr;
     mFloat2Float = nullptr;
     mShort2Float = nullptr;
+    mFloat2Int32 = nullptr;
+    mFloat2Int24In32 = nullptr;
+    mFloat2Int24 = nullptr;
+    mInt32_2Float = nullptr;
+    mInt24In32_2Float = nullptr;
+    mInt24_2Float = nullptr;
 
     mOverflowBuffer = nullptr;
 
@@ -325,16 +457,7 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::Convert(
 
     float scale = conversionGain / SHRT_MAX;
 
-    //ToDo use AVX
-    //__m256i _mm256_cvtps_epi32 (__m256 a)
-    while(numOfSamplesToProcess > 0)
-    {
-        *outputBuffer = *inputBuffer * scale;
-
-        inputBuffer += inputStep;
-        outputBuffer += outputStep;
-        numOfSamplesToProcess--;
-    }
+    GetTANConverterKernels().ShortToFloat(inputBuffer, inputStep, outputBuffer, outputStep, scale, numOfSamplesToProcess);
 
     return AMF_OK;
 }
@@ -396,108 +519,9 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::Convert(
 
     AMFLock lock(&m_sect);
 
-    float scale = SHRT_MAX * conversionGain;
-    bool clip = false;
-
+    bool clip = FloatToShort(inputBuffer, inputStep, outputBuffer, outputStep,
+        SHRT_MAX * conversionGain, numOfSamplesToProcess, 0);
 
-    // Go faster with SSE2
-    if (useSSE2){
-        float fin[8];
-        int iout[8];
-        short sout[8];
-        register __m128 f4a;
-        register __m128 f4b;
-        register __m128i i4a;
-        register __m128i i4b;
-        register __m128i *s8;
-        while (numOfSamplesToProcess > 0) {
-
-            if (numOfSamplesToProcess >= 8) {
-                fin[0] = inputBuffer[0] * scale;
-                fin[1] = inputBuffer[inputStep] * scale;
-                fin[2] = inputBuffer[2 * inputStep] * scale;
-                fin[3] = inputBuffer[3 * inputStep] * scale;
-                fin[4] = inputBuffer[4 * inputStep] * scale;
-                fin[5] = inputBuffer[5 * inputStep] * scale;
-                fin[6] = inputBuffer[6 * inputStep] * scale;
-                fin[7] = inputBuffer[7 * inputStep] * scale;
-
-                f4a = *((__m128 *)&fin[0]);
-                f4b = *((__m128 *)&fin[4]);
-
-                i4a = *((__m128i *)&iout[0]);
-                i4b = *((__m128i *)&iout[4]);
-
-                s8 = (__m128i *)sout;
-
-                // convert with saturation to avoid wrap around
-                i4a = _mm_cvtps_epi32(f4a); // convert 4 floats to 4 int32
-                i4b = _mm_cvtps_epi32(f4b); // convert 4 floats to 4 int32
-                *s8 = _mm_packs_epi32(i4a, i4b); // convert 8 int32 to 8 shorts with saturation
-
-                outputBuffer[0] = sout[0];
-                outputBuffer[outputStep] = sout[1];
-                outputBuffer[2 * outputStep] = sout[2];
-                outputBuffer[3 * outputStep] = sout[3];
-                outputBuffer[4 * outputStep] = sout[4];
-                outputBuffer[5 * outputStep] = sout[5];
-                outputBuffer[6 * outputStep] = sout[6];
-                outputBuffer[7 * outputStep] = sout[7];
-
-                inputBuffer += 8 * inputStep;
-                outputBuffer += 8 * outputStep;
-                numOfSamplesToProcess -= 8;
-            }
-            else {
-                float f;
-                long v;
-                f = *inputBuffer;
-                f *= scale;
-                v = int(f);
-
-                if (v > SHRT_MAX) {
-                    v = SHRT_MAX;
-                    clip |= true;
-                }
-
-                if (v < SHRT_MIN) {
-                    v = SHRT_MIN;
-                    clip |= true;
-                }
-
-                *outputBuffer = (short)v;
-
-                inputBuffer += inputStep;
-                outputBuffer += outputStep;
-                numOfSamplesToProcess--;
-            }
-        }
-    }
-    else {
-        while (numOfSamplesToProcess > 0) {
-            float f;
-            long v;
-            f = *inputBuffer;
-            f *= scale;
-            v = int(f);
-
-            if (v > SHRT_MAX) {
-                v = SHRT_MAX;
-                clip |= true;
-            }
-
-            if (v < SHRT_MIN) {
-                v = SHRT_MIN;
-                clip |= true;
-            }
-
-            *outputBuffer = (short)v;
-
-            inputBuffer += inputStep;
-            outputBuffer += outputStep;
-            numOfSamplesToProcess--;
-        }
-    }
     if (outputClipped != NULL)
     {
         *outputClipped = clip;
@@ -525,19 +549,20 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::Convert(
 
     AMFLock lock(&m_sect);
 
-    AMF_RESULT ret = AMF_OK;
     bool clipResult = false;
 
 
-    // Process an arbitrary number of conversions; record clipping
+    // Process an arbitrary number of conversions; record clipping. Each buffer index keeps its
+    // own dither state.
     for (int i = 0; i < count; i++)
     {
-        bool clip = false;
-        ret = Convert(
+        AMF_RETURN_IF_FALSE(inputBuffers[i] != NULL, AMF_INVALID_ARG, L"inputBuffer == NULL");
+        AMF_RETURN_IF_FALSE(outputBuffers[i] != NULL, AMF_INVALID_ARG, L"outputBuffer == NULL");
+
+        bool clip = FloatToShort(
             inputBuffers[i], inputStep,
-            numOfSamplesToProcess,
             outputBuffers[i], outputStep,
-            conversionGain, (outputClipped != NULL) ? &clip : NULL);
+            SHRT_MAX * conversionGain, numOfSamplesToProcess, i);
         clipResult = clipResult || clip;
 
     }
@@ -548,6 +573,249 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::Convert(
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+// Dither state of the first channels, channels not seen before start with their own seeds.
+TANDitherState * TANConverterImpl::DitherStates(int channels)
+{
+    for (amf_size c = m_ditherStates.size(); c < amf_size(channels); c++)
+    {
+        TANDitherState state = {};
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            // odd multiplier, so no generator starts at zero
+            state.random[lane] = 0x9E3779B9u * amf_uint32(c * 8 + lane + 1);
+        }
+
+        m_ditherStates.push_back(state);
+    }
+
+    return m_ditherStates.data();
+}
+//-------------------------------------------------------------------------------------------------
+bool TANConverterImpl::FloatToShort(
+    const float* inputBuffer,
+    amf_size inputStep,
+    short* outputBuffer,
+    amf_size outputStep,
+    float scale,
+    amf_size numOfSamplesToProcess,
+    int channel
+)
+{
+    if (m_eDither == TAN_DITHER_NONE)
+    {
+        return GetTANConverterKernels().FloatToShort(
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, numOfSamplesToProcess);
+    }
+
+    return GetTANConverterKernels().FloatToShortDithered(
+        inputBuffer, inputStep, outputBuffer, outputStep, scale, m_eDither == TAN_DITHER_NOISE_SHAPED,
+        DitherStates(channel + 1)[channel], numOfSamplesToProcess);
+}
+//-------------------------------------------------------------------------------------------------
+// Integer value of +1.0 at conversionGain = 1.0.
+static float FullScale(TAN_SAMPLE_TYPE sampleType)
+{
+    switch (sampleType)
+    {
+    case TAN_SAMPLE_TYPE_FLOAT:
+        return 1.0f;
+    case TAN_SAMPLE_TYPE_SHORT:
+        return SHRT_MAX;
+    case TAN_SAMPLE_TYPE_INT32:
+        // float(INT_MAX) rounds up to 2^31, +1.0 would overflow
+        return Int32Upper;
+    default:
+        return float((1 << 23) - 1);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANConverterImpl::Convert(
+    const void* inputBuffer,
+    amf_size inputStep,
+    TAN_SAMPLE_TYPE inputType,
+
+    amf_size numOfSamplesToProcess,
+
+    void* outputBuffer,
+    amf_size outputStep,
+    TAN_SAMPLE_TYPE outputType,
+
+    float conversionGain,
+    bool* outputClipped
+)
+{
+    AMF_RETURN_IF_FALSE(inputBuffer != NULL, AMF_INVALID_ARG, L"inputBuffer == NULL");
+    AMF_RETURN_IF_FALSE(outputBuffer != NULL, AMF_INVALID_ARG, L"outputBuffer == NULL");
+    AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess <= 0");
+    AMF_RETURN_IF_FALSE(conversionGain > 0, AMF_INVALID_ARG, L"conversionGain <= 0");
+    AMF_RETURN_IF_FALSE((inputType == TAN_SAMPLE_TYPE_FLOAT) != (outputType == TAN_SAMPLE_TYPE_FLOAT),
+        AMF_NOT_SUPPORTED, L"one of inputType and outputType must be TAN_SAMPLE_TYPE_FLOAT");
+
+    AMFLock lock(&m_sect);
+
+    const TANConverterKernels & kernels = GetTANConverterKernels();
+    bool clip = false;
+
+    if (inputType == TAN_SAMPLE_TYPE_FLOAT)
+    {
+        const float * input = static_cast<const float *>(inputBuffer);
+        float scale = FullScale(outputType) * conversionGain;
+
+        switch (outputType)
+        {
+        case TAN_SAMPLE_TYPE_SHORT:
+            clip = FloatToShort(input, inputStep,
+                static_cast<short *>(outputBuffer), outputStep, scale, numOfSamplesToProcess, 0);
+            break;
+        case TAN_SAMPLE_TYPE_INT32:
+            clip = kernels.FloatToInt32(input, inputStep,
+                static_cast<amf_int32 *>(outputBuffer), outputStep, scale, 32, numOfSamplesToProcess);
+            break;
+        case TAN_SAMPLE_TYPE_INT24_IN_32:
+            clip = kernels.FloatToInt32(input, inputStep,
+                static_cast<amf_int32 *>(outputBuffer), outputStep, scale, 24, numOfSamplesToProcess);
+            break;
+        case TAN_SAMPLE_TYPE_INT24:
+            clip = kernels.FloatToPacked24(input, inputStep,
+                static_cast<amf_uint8 *>(outputBuffer), outputStep, scale, numOfSamplesToProcess);
+            break;
+        default:
+            AMF_RETURN_IF_FAILED(AMF_NOT_SUPPORTED, L"outputType not supported for conversion");
+        }
+    }
+    else
+    {
+        float * output = static_cast<float *>(outputBuffer);
+        float scale = conversionGain / FullScale(inputType);
+
+        switch (inputType)
+        {
+        case TAN_SAMPLE_TYPE_SHORT:
+            kernels.ShortToFloat(static_cast<const short *>(inputBuffer), inputStep,
+                output, outputStep, scale, numOfSamplesToProcess);
+            break;
+        case TAN_SAMPLE_TYPE_INT32:
+            kernels.Int32ToFloat(static_cast<const amf_int32 *>(inputBuffer), inputStep,
+                output, outputStep, scale, 32, numOfSamplesToProcess);
+            break;
+        case TAN_SAMPLE_TYPE_INT24_IN_32:
+            kernels.Int32ToFloat(static_cast<const amf_int32 *>(inputBuffer), inputStep,
+                output, outputStep, scale, 24, numOfSamplesToProcess);
+            break;
+        case TAN_SAMPLE_TYPE_INT24:
+            kernels.Packed24ToFloat(static_cast<const amf_uint8 *>(inputBuffer), inputStep,
+                output, outputStep, scale, numOfSamplesToProcess);
+            break;
+        default:
+            AMF_RETURN_IF_FAILED(AMF_NOT_SUPPORTED, L"inputType not supported for conversion");
+        }
+    }
+
+    if (outputClipped != NULL)
+    {
+        *outputClipped = clip;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+static bool GetSampleFormat(TAN_SAMPLE_TYPE sampleType, TANConverterSampleFormat & format)
+{
+    switch (sampleType)
+    {
+    case TAN_SAMPLE_TYPE_FLOAT:         format = TANConverterSampleFloat;       return true;
+    case TAN_SAMPLE_TYPE_SHORT:         format = TANConverterSampleInt16;       return true;
+    case TAN_SAMPLE_TYPE_INT32:         format = TANConverterSampleInt32;       return true;
+    case TAN_SAMPLE_TYPE_INT24_IN_32:   format = TANConverterSampleInt24In32;   return true;
+    case TAN_SAMPLE_TYPE_INT24:         format = TANConverterSamplePacked24;    return true;
+    default:                            return false;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANConverterImpl::ConvertInterleaved(
+    const void* inputBuffer,
+    TAN_SAMPLE_TYPE inputType,
+    int channels,
+    amf_size numOfFrames,
+
+    float** outputBuffers,
+    float conversionGain
+)
+{
+    AMF_RETURN_IF_FALSE(inputBuffer != NULL, AMF_INVALID_ARG, L"inputBuffer == NULL");
+    AMF_RETURN_IF_FALSE(outputBuffers != NULL, AMF_INVALID_ARG, L"outputBuffers == NULL");
+    AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels <= 0");
+    AMF_RETURN_IF_FALSE(numOfFrames > 0, AMF_INVALID_ARG, L"numOfFrames <= 0");
+    AMF_RETURN_IF_FALSE(conversionGain > 0, AMF_INVALID_ARG, L"conversionGain <= 0");
+
+    for (int c = 0; c < channels; c++)
+    {
+        AMF_RETURN_IF_FALSE(outputBuffers[c] != NULL, AMF_INVALID_ARG, L"outputBuffers[c] == NULL");
+    }
+
+    TANConverterSampleFormat inputFormat;
+    AMF_RETURN_IF_FALSE(GetSampleFormat(inputType, inputFormat), AMF_NOT_SUPPORTED,
+        L"inputType not supported for conversion");
+
+    AMFLock lock(&m_sect);
+
+    GetTANConverterKernels().DeinterleaveToFloat(inputBuffer, inputFormat, outputBuffers, channels,
+        conversionGain / FullScale(inputType), numOfFrames);
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANConverterImpl::ConvertInterleaved(
+    const float* const* inputBuffers,
+    int channels,
+    amf_size numOfFrames,
+
+    void* outputBuffer,
+    TAN_SAMPLE_TYPE outputType,
+
+    float conversionGain,
+    bool* outputClipped
+)
+{
+    AMF_RETURN_IF_FALSE(inputBuffers != NULL, AMF_INVALID_ARG, L"inputBuffers == NULL");
+    AMF_RETURN_IF_FALSE(outputBuffer != NULL, AMF_INVALID_ARG, L"outputBuffer == NULL");
+    AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels <= 0");
+    AMF_RETURN_IF_FALSE(numOfFrames > 0, AMF_INVALID_ARG, L"numOfFrames <= 0");
+    AMF_RETURN_IF_FALSE(conversionGain > 0, AMF_INVALID_ARG, L"conversionGain <= 0");
+
+    for (int c = 0; c < channels; c++)
+    {
+        AMF_RETURN_IF_FALSE(inputBuffers[c] != NULL, AMF_INVALID_ARG, L"inputBuffers[c] == NULL");
+    }
+
+    TANConverterSampleFormat outputFormat;
+    AMF_RETURN_IF_FALSE(GetSampleFormat(outputType, outputFormat), AMF_NOT_SUPPORTED,
+        L"outputType not supported for conversion");
+
+    AMFLock lock(&m_sect);
+
+    float scale = FullScale(outputType) * conversionGain;
+    bool clip = false;
+
+    if (outputType == TAN_SAMPLE_TYPE_SHORT && m_eDither != TAN_DITHER_NONE)
+    {
+        clip = GetTANConverterKernels().InterleaveToShortDithered(inputBuffers, channels,
+            static_cast<short *>(outputBuffer), scale, m_eDither == TAN_DITHER_NOISE_SHAPED,
+            DitherStates(channels), numOfFrames);
+    }
+    else
+    {
+        clip = GetTANConverterKernels().InterleaveFromFloat(inputBuffers, channels, outputBuffer, outputFormat,
+            scale, numOfFrames);
+    }
+
+    if (outputClipped != NULL)
+    {
+        *outputClipped = clip;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL    TANConverterImpl::ConvertGpu(
     amf_handle inputBuffer,
 	amf_size inputStep,
@@ -587,6 +855,24 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::ConvertGpu(
         {
 			clKernel = m_clkFloat2Float;
         }
+        else if (outputType == TAN_SAMPLE_TYPE_INT32)
+        {
+			clKernel = m_clkFloat2Int32;
+            convert = true;
+            canOverflow = true;
+        }
+        else if (outputType == TAN_SAMPLE_TYPE_INT24_IN_32)
+        {
+			clKernel = m_clkFloat2Int24In32;
+            convert = true;
+            canOverflow = true;
+        }
+        else if (outputType == TAN_SAMPLE_TYPE_INT24)
+        {
+			clKernel = m_clkFloat2Int24;
+            convert = true;
+            canOverflow = true;
+        }
     }
     else if (inputType == TAN_SAMPLE_TYPE_SHORT) {
         if (outputType == TAN_SAMPLE_TYPE_FLOAT)
@@ -599,6 +885,23 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::ConvertGpu(
 			clKernel = m_clkShort2Short;
         }
     }
+    else if (outputType == TAN_SAMPLE_TYPE_FLOAT)
+    {
+        // the wider integer types convert to float only
+        if (inputType == TAN_SAMPLE_TYPE_INT32)
+        {
+			clKernel = m_clkInt32_2Float;
+        }
+        else if (inputType == TAN_SAMPLE_TYPE_INT24_IN_32)
+        {
+			clKernel = m_clkInt24In32_2Float;
+        }
+        else if (inputType == TAN_SAMPLE_TYPE_INT24)
+        {
+			clKernel = m_clkInt24_2Float;
+        }
+        convert = true;
+    }
     else {
         AMF_RETURN_IF_FAILED(AMF_NOT_IMPLEMENTED, L"Argument types not supported for conversion");
     }
@@ -684,6 +987,24 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::ConvertGpu(
         {
 			kernel = mFloat2Float;
         }
+        else if (outputType == TAN_SAMPLE_TYPE_INT32)
+        {
+			kernel = mFloat2Int32;
+            convert = true;
+            canOverflow = true;
+        }
+        else if (outputType == TAN_SAMPLE_TYPE_INT24_IN_32)
+        {
+			kernel = mFloat2Int24In32;
+            convert = true;
+            canOverflow = true;
+        }
+        else if (outputType == TAN_SAMPLE_TYPE_INT24)
+        {
+			kernel = mFloat2Int24;
+            convert = true;
+            canOverflow = true;
+        }
     }
     else if (inputType == TAN_SAMPLE_TYPE_SHORT) {
         if (outputType == TAN_SAMPLE_TYPE_FLOAT)
@@ -696,6 +1017,23 @@ AMF_RESULT  AMF_STD_CALL    TANConverterImpl::ConvertGpu(
 			kernel = mShort2Short;
         }
     }
+    else if (outputType == TAN_SAMPLE_TYPE_FLOAT)
+    {
+        // the wider integer types convert to float only
+        if (inputType == TAN_SAMPLE_TYPE_INT32)
+        {
+			kernel = mInt32_2Float;
+        }
+        else if (inputType == TAN_SAMPLE_TYPE_INT24_IN_32)
+        {
+			kernel = mInt24In32_2Float;
+        }
+        else if (inputType == TAN_SAMPLE_TYPE_INT24)
+        {
+			kernel = mInt24_2Float;
+        }
+        convert = true;
+    }
     else
     {
         AMF_RETURN_IF_FAILED(AMF_NOT_IMPLEMENTED, L"Argument types not supported for conversion");
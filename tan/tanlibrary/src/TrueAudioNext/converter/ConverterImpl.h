@@ -27,6 +27,9 @@
 #include "public/include/core/Context.h"        //AMF
 #include "public/include/components/Component.h"//AMF
 #include "public/common/PropertyStorageExImpl.h"//AMF
+#include "ConverterKernels.h"
+
+#include <vector>
 
 namespace amf
 {
@@ -68,6 +71,25 @@ namespace amf
                                             short** outputBuffers, amf_size outputStep,
                                             float conversionGain, int count, bool* outputClipped = NULL) override;
 
+        AMF_RESULT  AMF_STD_CALL    Convert(const void* inputBuffer, amf_size inputStep,
+                                            TAN_SAMPLE_TYPE inputType,
+                                            amf_size numOfSamplesToProcess,
+                                            void* outputBuffer, amf_size outputStep,
+                                            TAN_SAMPLE_TYPE outputType,
+                                            float conversionGain, bool* outputClipped = NULL) override;
+
+        AMF_RESULT  AMF_STD_CALL    ConvertInterleaved(const void* inputBuffer,
+                                            TAN_SAMPLE_TYPE inputType,
+                                            int channels, amf_size numOfFrames,
+                                            float** outputBuffers,
+                                            float conversionGain) override;
+
+        AMF_RESULT  AMF_STD_CALL    ConvertInterleaved(const float* const* inputBuffers,
+                                            int channels, amf_size numOfFrames,
+                                            void* outputBuffer,
+                                            TAN_SAMPLE_TYPE outputType,
+                                            float conversionGain, bool* outputClipped = NULL) override;
+
 #ifndef TAN_NO_OPENCL
 
 		AMF_RESULT  AMF_STD_CALL    Convert(cl_mem inputBuffer, amf_size inputStep,
@@ -136,6 +158,9 @@ namespace amf
         AMF_MEMORY_TYPE             m_eOutputMemoryType;
         AMFCriticalSection          m_sect;
 
+        TAN_DITHER_MODE             m_eDither;
+        std::vector<TANDitherState> m_ditherStates;     // one per channel index of the host conversions
+
 #ifndef TAN_NO_OPENCL
         cl_command_queue			m_pQueueCl = nullptr;
         cl_context					m_pContextCl = nullptr;
@@ -147,6 +172,12 @@ namespace amf
 		cl_kernel					m_clkShort2Short = nullptr;
 		cl_kernel					m_clkFloat2Float = nullptr;
 		cl_kernel					m_clkShort2Float = nullptr;
+		cl_kernel					m_clkFloat2Int32 = nullptr;
+		cl_kernel					m_clkFloat2Int24In32 = nullptr;
+		cl_kernel					m_clkFloat2Int24 = nullptr;
+		cl_kernel					m_clkInt32_2Float = nullptr;
+		cl_kernel					m_clkInt24In32_2Float = nullptr;
+		cl_kernel					m_clkInt24_2Float = nullptr;
 
         cl_mem                      m_overflowBuffer = NULL;
 
@@ -158,14 +189,25 @@ namespace amf
         amf::AMFComputeKernelPtr    mShort2Short;
         amf::AMFComputeKernelPtr    mFloat2Float;
         amf::AMFComputeKernelPtr    mShort2Float;
+        amf::AMFComputeKernelPtr    mFloat2Int32;
+        amf::AMFComputeKernelPtr    mFloat2Int24In32;
+        amf::AMFComputeKernelPtr    mFloat2Int24;
+        amf::AMFComputeKernelPtr    mInt32_2Float;
+        amf::AMFComputeKernelPtr    mInt24In32_2Float;
+        amf::AMFComputeKernelPtr    mInt24_2Float;
 
         amf::AMFBufferPtr           mOverflowBuffer;
 #endif
 
     private:
-        static bool useSSE2;
         AMF_RESULT	AMF_STD_CALL InitCpu();
         AMF_RESULT	AMF_STD_CALL InitGpu();
+
+        TANDitherState *            DitherStates(int channels);
+        bool                        FloatToShort(const float* inputBuffer, amf_size inputStep,
+                                                 short* outputBuffer, amf_size outputStep,
+                                                 float scale, amf_size numOfSamplesToProcess,
+                                                 int channel);
         AMF_RESULT	AMF_STD_CALL ConvertGpu(amf_handle inputBuffer,
                                             amf_size inputOffset,
                                             amf_size inputStep,
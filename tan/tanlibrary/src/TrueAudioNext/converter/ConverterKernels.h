@@ -0,0 +1,188 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   ConverterKernels.h
+///  @brief  CPU kernels of TANConverter, one set per instruction set
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    // Sample formats of the interleaved kernels, numbered like TAN_SAMPLE_TYPE.
+    enum TANConverterSampleFormat
+    {
+        TANConverterSampleFloat     = 0,
+        TANConverterSampleInt16     = 1,
+        TANConverterSampleInt32     = 2,
+        TANConverterSampleInt24In32 = 3,
+        TANConverterSamplePacked24  = 4,
+    };
+
+    // Dither state of one 16 bit output channel, carried from call to call.
+    struct TANDitherState
+    {
+        amf_uint32 random[8];   // xorshift32 generator of every vector lane, never zero
+        float error;            // requantization error of the last sample, fed back when noise shaping
+    };
+
+    // CPU kernels behind TANConverter. In the single channel kernels sample i of a buffer is
+    // at buffer[i * step], any step, count and alignment is accepted and nothing outside
+    // the addressed samples is written. Strides 1, 2, 4, 6 and 8 on the input side are
+    // read with whole vector loads and shuffles, other strides with a gather.
+    //
+    // One table per instruction set, see core/KernelDispatch.h.
+    struct TANConverterKernels
+    {
+        const wchar_t * name;
+
+        // outputBuffer[i] = inputBuffer[i] * scale
+        void (*ShortToFloat)(
+            const short * inputBuffer,
+            amf_size inputStep,
+            float * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count);
+
+        // outputBuffer[i] = inputBuffer[i] * scale rounded to nearest and saturated to
+        // [SHRT_MIN, SHRT_MAX]. Returns true if any scaled sample was outside that range or NaN.
+        // The other float to integer kernels saturate and report the same way.
+        bool (*FloatToShort)(
+            const float * inputBuffer,
+            amf_size inputStep,
+            short * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count);
+
+        // 32 bit integers holding validBits wide samples in their low bits: 32 for full scale
+        // int32, 24 for 24 bit samples in 32 bit words. Bits above validBits are ignored on input
+        // and carry the sign on output.
+        void (*Int32ToFloat)(
+            const amf_int32 * inputBuffer,
+            amf_size inputStep,
+            float * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_uint32 validBits,
+            amf_size count);
+
+        bool (*FloatToInt32)(
+            const float * inputBuffer,
+            amf_size inputStep,
+            amf_int32 * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_uint32 validBits,
+            amf_size count);
+
+        // Packed little endian 24 bit samples, 3 bytes each. Steps count samples, not bytes.
+        void (*Packed24ToFloat)(
+            const amf_uint8 * inputBuffer,
+            amf_size inputStep,
+            float * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count);
+
+        bool (*FloatToPacked24)(
+            const float * inputBuffer,
+            amf_size inputStep,
+            amf_uint8 * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count);
+
+        // Whole interleaved buffers: frame i holds sample c of every channel at
+        // buffer[i * channels + c] in the given format, float planes hold one channel each.
+        // outputBuffers[c][i] = inputBuffer[i * channels + c] * scale
+        void (*DeinterleaveToFloat)(
+            const void * inputBuffer,
+            TANConverterSampleFormat inputFormat,
+            float * const * outputBuffers,
+            amf_size channels,
+            float scale,
+            amf_size frames);
+
+        // outputBuffer[i * channels + c] = inputBuffers[c][i] * scale, saturated and reported like
+        // FloatToShort for the integer formats.
+        bool (*InterleaveFromFloat)(
+            const float * const * inputBuffers,
+            amf_size channels,
+            void * outputBuffer,
+            TANConverterSampleFormat outputFormat,
+            float scale,
+            amf_size frames);
+
+        // FloatToShort with a triangular dither of +-1 LSB added before rounding. With noiseShaping
+        // the requantization error of a sample is taken off the next one. Clipping is reported
+        // for the signal only, not for the dither.
+        bool (*FloatToShortDithered)(
+            const float * inputBuffer,
+            amf_size inputStep,
+            short * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            bool noiseShaping,
+            TANDitherState & state,
+            amf_size count);
+
+        // InterleaveFromFloat to 16 bit with the dither above, states[c] belongs to channel c.
+        bool (*InterleaveToShortDithered)(
+            const float * const * inputBuffers,
+            amf_size channels,
+            short * outputBuffer,
+            float scale,
+            bool noiseShaping,
+            TANDitherState * states,
+            amf_size frames);
+    };
+
+    // LSB per step of the difference of two 16 bit random numbers, and the bound of the fed
+    // back error, which only exceeds 1.5 LSB after clipping.
+    const float DitherScale = 1.0f / 65536;
+    const float MaxShapingError = 1.5f;
+
+    // The interleaved kernels work through the frames in tiles of about this many input bytes,
+    // so every plane is written while its part of the interleaved buffer is still in cache.
+    const amf_size InterleaveTileBytes = 16384;
+
+    // Saturation bounds of the integer outputs. The int32 upper bound is the largest float
+    // below 2^31, so it still converts without overflow.
+    const float Int16Lower = -32768.0f;
+    const float Int16Upper = 32767.0f;
+    const float Int24Lower = -8388608.0f;
+    const float Int24Upper = 8388607.0f;
+    const float Int32Lower = -2147483648.0f;
+    const float Int32Upper = 2147483520.0f;
+
+    // Kernel sets, see ConverterKernels*.cpp.
+    extern const TANConverterKernels TANConverterKernelsSSE2;
+    extern const TANConverterKernels TANConverterKernelsAVX2;
+
+    // The table for the running CPU, see TANGetKernels.
+    const TANConverterKernels & GetTANConverterKernels();
+}
@@ -0,0 +1,1324 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AVX2 kernels, this file is built with -mavx2 (/arch:AVX2).
+//
+
+#include "ConverterKernels.h"
+
+#include <immintrin.h>
+
+#include <cstring>
+#include <utility>
+
+using namespace amf;
+
+namespace
+{
+    // Joins two 128 bit halves, _mm256_set_m128 is missing from older compilers.
+    inline __m256 Join(__m128 lo, __m128 hi)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+    }
+
+    inline __m256i Join(__m128i lo, __m128i hi)
+    {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+
+    // Four floats at p, p + stride, ... for the strides too wide for a 256 bit shuffle.
+    template<amf_size Stride>
+    inline __m128 LoadFloats4(const float * p)
+    {
+        if (Stride == 6)
+        {
+            __m128 s01 = _mm_shuffle_ps(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _MM_SHUFFLE(2, 2, 0, 0));
+            __m128 s23 = _mm_shuffle_ps(_mm_loadu_ps(p + 12), _mm_loadu_ps(p + 16), _MM_SHUFFLE(2, 2, 0, 0));
+
+            return _mm_shuffle_ps(s01, s23, _MM_SHUFFLE(2, 0, 2, 0));
+        }
+
+        __m128 s01 = _mm_unpacklo_ps(_mm_loadu_ps(p), _mm_loadu_ps(p + Stride));
+        __m128 s23 = _mm_unpacklo_ps(_mm_loadu_ps(p + 2 * Stride), _mm_loadu_ps(p + 3 * Stride));
+
+        return _mm_movelh_ps(s01, s23);
+    }
+
+    // Eight floats at p, p + stride, ... The shuffling loaders read whole vectors inside
+    // [p, p + 8 * Stride), Stride 0 gathers any stride exactly. 32 bit integers are loaded
+    // the same way and cast back.
+    template<amf_size Stride>
+    inline __m256 LoadFloats8(const float * p, __m256i gatherIndex)
+    {
+        if (Stride == 1)
+        {
+            return _mm256_loadu_ps(p);
+        }
+        else if (Stride == 2)
+        {
+            // per lane s0 s1 s4 s5 | s2 s3 s6 s7, then the middle 64 bit pairs swap
+            __m256 v = _mm256_shuffle_ps(_mm256_loadu_ps(p), _mm256_loadu_ps(p + 8), _MM_SHUFFLE(2, 0, 2, 0));
+
+            return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        else if (Stride == 4)
+        {
+            // per lane s0 s2 s4 s6 | s1 s3 s5 s7
+            __m256 s02 = _mm256_unpacklo_ps(_mm256_loadu_ps(p), _mm256_loadu_ps(p + 8));
+            __m256 s46 = _mm256_unpacklo_ps(_mm256_loadu_ps(p + 16), _mm256_loadu_ps(p + 24));
+            __m256 v = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(s02), _mm256_castps_pd(s46)));
+
+            return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        }
+        else if (Stride == 6 || Stride == 8)
+        {
+            return Join(LoadFloats4<Stride>(p), LoadFloats4<Stride>(p + 4 * Stride));
+        }
+
+        return _mm256_i32gather_ps(p, gatherIndex, sizeof(float));
+    }
+
+    template<amf_size Stride>
+    inline __m256i LoadInt32s8(const amf_int32 * p, __m256i gatherIndex)
+    {
+        return _mm256_castps_si256(LoadFloats8<Stride>(reinterpret_cast<const float *>(p), gatherIndex));
+    }
+
+    // Low 16 bits of every int32 lane, sign extended.
+    inline __m128i SignExtendLow16(__m128i v)
+    {
+        return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    }
+
+    inline __m256i SignExtendLow16(__m256i v)
+    {
+        return _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+    }
+
+    template<amf_size Stride>
+    inline __m128i LoadShorts4(const short * p)
+    {
+        if (Stride == 6)
+        {
+            __m128 v0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+            __m128 v1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8)));
+            __m128 v2 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16)));
+            __m128 s01 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 2, 3, 0));
+            __m128 s23 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 1, 2, 2));
+
+            return SignExtendLow16(_mm_castps_si128(_mm_shuffle_ps(s01, s23, _MM_SHUFFLE(2, 0, 1, 0))));
+        }
+
+        __m128i s01 = _mm_unpacklo_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8)));
+        __m128i s23 = _mm_unpacklo_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 24)));
+
+        return SignExtendLow16(_mm_unpacklo_epi64(s01, s23));
+    }
+
+    // Eight shorts at p, p + stride, ... widened to int32, same read rules as LoadFloats8.
+    template<amf_size Stride>
+    inline __m256i LoadShorts8(const short * p, amf_size stride)
+    {
+        if (Stride == 1)
+        {
+            return _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        }
+        else if (Stride == 2)
+        {
+            return SignExtendLow16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        }
+        else if (Stride == 4)
+        {
+            // per lane s0 s1 s4 s5 | s2 s3 s6 s7, then the middle 64 bit pairs swap
+            __m256 v0 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+            __m256 v1 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 16)));
+            __m256i v = _mm256_castps_si256(_mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)));
+
+            return SignExtendLow16(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        else if (Stride == 6 || Stride == 8)
+        {
+            return Join(LoadShorts4<Stride>(p), LoadShorts4<Stride>(p + 4 * Stride));
+        }
+
+        // a 32 bit gather could read past the last short, so this one stays scalar
+        return _mm256_setr_epi32(p[0], p[stride], p[2 * stride], p[3 * stride],
+            p[4 * stride], p[5 * stride], p[6 * stride], p[7 * stride]);
+    }
+
+    // Eight packed 24 bit samples at p, p + 3 * stride, ... as int32. The contiguous loader
+    // reads exactly the 24 bytes, the gather reads one byte past the last sample.
+    template<bool Contiguous>
+    inline __m256i LoadPacked24s8(const amf_uint8 * p, __m256i gatherIndex)
+    {
+        if (Contiguous)
+        {
+            // samples 0-3 are bytes 0-11 of the first load, samples 4-7 bytes 4-15 of the second,
+            // each moves to the top three bytes of its int32
+            const __m128i lowSamples = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+            const __m128i highSamples = _mm_setr_epi8(-1, 4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15);
+            __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), lowSamples);
+            __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8)), highSamples);
+
+            return _mm256_srai_epi32(Join(lo, hi), 8);
+        }
+
+        __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int *>(p), gatherIndex, 1);
+
+        return _mm256_srai_epi32(_mm256_slli_epi32(v, 8), 8);
+    }
+
+    inline void StoreFloats4(float * q, amf_size step, __m128 v)
+    {
+        _mm_store_ss(q, v);
+        _mm_store_ss(q + step, _mm_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1)));
+        _mm_store_ss(q + 2 * step, _mm_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2)));
+        _mm_store_ss(q + 3 * step, _mm_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+
+    // Writes the eight lanes to q[0], q[step], ... and nothing in between.
+    template<bool Contiguous>
+    inline void StoreFloats8(float * q, amf_size step, __m256 v)
+    {
+        if (Contiguous)
+        {
+            _mm256_storeu_ps(q, v);
+            return;
+        }
+
+        StoreFloats4(q, step, _mm256_castps256_ps128(v));
+        StoreFloats4(q + 4 * step, step, _mm256_extractf128_ps(v, 1));
+    }
+
+    template<bool Contiguous>
+    inline void StoreInt32s8(amf_int32 * q, amf_size step, __m256i v)
+    {
+        StoreFloats8<Contiguous>(reinterpret_cast<float *>(q), step, _mm256_castsi256_ps(v));
+    }
+
+    template<bool Contiguous>
+    inline void StoreShorts8(short * q, amf_size step, __m128i v)
+    {
+        if (Contiguous)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(q), v);
+            return;
+        }
+
+        q[0] = short(_mm_extract_epi16(v, 0));
+        q[step] = short(_mm_extract_epi16(v, 1));
+        q[2 * step] = short(_mm_extract_epi16(v, 2));
+        q[3 * step] = short(_mm_extract_epi16(v, 3));
+        q[4 * step] = short(_mm_extract_epi16(v, 4));
+        q[5 * step] = short(_mm_extract_epi16(v, 5));
+        q[6 * step] = short(_mm_extract_epi16(v, 6));
+        q[7 * step] = short(_mm_extract_epi16(v, 7));
+    }
+
+    inline void StorePacked24(amf_uint8 * q, amf_int32 v)
+    {
+        q[0] = amf_uint8(v);
+        q[1] = amf_uint8(v >> 8);
+        q[2] = amf_uint8(v >> 16);
+    }
+
+    // Low three bytes of the eight int32 lanes to q, q + 3 * step, ... and nothing in between.
+    template<bool Contiguous>
+    inline void StorePacked24s8(amf_uint8 * q, amf_size step, __m256i v)
+    {
+        __m128i lo = _mm256_castsi256_si128(v);
+        __m128i hi = _mm256_extracti128_si256(v, 1);
+
+        if (Contiguous)
+        {
+            // bytes 0-11 from the low half, 12-23 from the high one
+            const __m128i lowSamples = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            const __m128i highSamplesHead = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 2, 4);
+            const __m128i highSamplesTail = _mm_setr_epi8(5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(q),
+                _mm_or_si128(_mm_shuffle_epi8(lo, lowSamples), _mm_shuffle_epi8(hi, highSamplesHead)));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(q + 16), _mm_shuffle_epi8(hi, highSamplesTail));
+            return;
+        }
+
+        StorePacked24(q, _mm_extract_epi32(lo, 0));
+        StorePacked24(q + 3 * step, _mm_extract_epi32(lo, 1));
+        StorePacked24(q + 6 * step, _mm_extract_epi32(lo, 2));
+        StorePacked24(q + 9 * step, _mm_extract_epi32(lo, 3));
+        StorePacked24(q + 12 * step, _mm_extract_epi32(hi, 0));
+        StorePacked24(q + 15 * step, _mm_extract_epi32(hi, 1));
+        StorePacked24(q + 18 * step, _mm_extract_epi32(hi, 2));
+        StorePacked24(q + 21 * step, _mm_extract_epi32(hi, 3));
+    }
+
+    // Number of samples a vector loop may cover, keeping readAhead samples after it for
+    // loaders that read past their last sample.
+    inline amf_size VectorCount(amf_size count, amf_size readAhead)
+    {
+        return count > readAhead ? (count - readAhead) / 8 * 8 : 0;
+    }
+
+    // The shuffling loaders read up to the end of the last stride of a block.
+    template<amf_size Stride>
+    inline amf_size StridedVectorCount(amf_size count)
+    {
+        return VectorCount(count, Stride > 1 ? 1 : 0);
+    }
+
+    // Element offsets of a gather, valid while 7 * stride fits an int32.
+    inline __m256i GatherIndex(amf_size stride)
+    {
+        return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(amf_int32(stride)));
+    }
+
+    const amf_size MaxGatherStride = 0x7fffffff / 7;
+
+    // Saturates v to [lower, upper], NaN to lower, and flags every lane it changed.
+    inline __m256 Clamp8(__m256 v, __m256 lower, __m256 upper, __m256 & outOfRange)
+    {
+        // max() returns its second operand for NaN
+        __m256 c = _mm256_min_ps(_mm256_max_ps(v, lower), upper);
+
+        outOfRange = _mm256_or_ps(outOfRange, _mm256_cmp_ps(c, v, _CMP_NEQ_UQ));
+
+        return c;
+    }
+
+    inline __m256i FloatToInt8(__m256 v, __m256 lower, __m256 upper, __m256 & outOfRange)
+    {
+        return _mm256_cvtps_epi32(Clamp8(v, lower, upper, outOfRange));
+    }
+
+    inline __m128 Clamp4(__m128 v, __m128 lower, __m128 upper, __m128 & outOfRange)
+    {
+        __m128 c = _mm_min_ps(_mm_max_ps(v, lower), upper);
+
+        outOfRange = _mm_or_ps(outOfRange, _mm_cmp_ps(c, v, _CMP_NEQ_UQ));
+
+        return c;
+    }
+
+    inline float ClampSample(float value, float lower, float upper, bool & clipped)
+    {
+        // NaN ends up at the lower bound and is reported, like in the vector code
+        float clamped = value > lower ? value : lower;
+        clamped = clamped < upper ? clamped : upper;
+        clipped |= !(clamped == value);
+
+        return clamped;
+    }
+
+    inline amf_int32 FloatToIntSample(float value, float lower, float upper, bool & clipped)
+    {
+        return _mm_cvtss_si32(_mm_set_ss(ClampSample(value, lower, upper, clipped)));
+    }
+
+    // One xorshift32 step in every lane, then a triangular dither of +-1 LSB from the
+    // difference of the two 16 bit halves.
+    inline __m256 TriangularDither8(__m256i & random)
+    {
+        random = _mm256_xor_si256(random, _mm256_slli_epi32(random, 13));
+        random = _mm256_xor_si256(random, _mm256_srli_epi32(random, 17));
+        random = _mm256_xor_si256(random, _mm256_slli_epi32(random, 5));
+
+        __m256i d = _mm256_sub_epi32(_mm256_and_si256(random, _mm256_set1_epi32(0xffff)), _mm256_srli_epi32(random, 16));
+
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(d), _mm256_set1_ps(DitherScale));
+    }
+
+    inline __m128 TriangularDither4(__m128i & random)
+    {
+        random = _mm_xor_si128(random, _mm_slli_epi32(random, 13));
+        random = _mm_xor_si128(random, _mm_srli_epi32(random, 17));
+        random = _mm_xor_si128(random, _mm_slli_epi32(random, 5));
+
+        __m128i d = _mm_sub_epi32(_mm_and_si128(random, _mm_set1_epi32(0xffff)), _mm_srli_epi32(random, 16));
+
+        return _mm_mul_ps(_mm_cvtepi32_ps(d), _mm_set1_ps(DitherScale));
+    }
+
+    inline float TriangularDither(amf_uint32 & random)
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+
+        return float(amf_int32(random & 0xffff) - amf_int32(random >> 16)) * DitherScale;
+    }
+
+    // Rounds a clamped 16 bit sample with dither. With noise shaping the error of the previous
+    // sample is taken off first and the new one kept, which pushes the noise to high frequencies.
+    inline amf_int32 DitherSample(float value, float dither, bool noiseShaping, float & error)
+    {
+        float v = noiseShaping ? value - error : value;
+        float w = v + dither;
+        w = w > Int16Lower ? w : Int16Lower;
+        w = w < Int16Upper ? w : Int16Upper;
+
+        amf_int32 q = _mm_cvtss_si32(_mm_set_ss(w));
+
+        if (noiseShaping)
+        {
+            float e = float(q) - v;
+            e = e > -MaxShapingError ? e : -MaxShapingError;
+            error = e < MaxShapingError ? e : MaxShapingError;
+        }
+
+        return q;
+    }
+
+    // Four lanes of DitherSample, one channel per lane.
+    inline __m128i DitherSamples4(__m128 value, __m128 dither, bool noiseShaping, __m128 & error)
+    {
+        const __m128 lower = _mm_set1_ps(Int16Lower);
+        const __m128 upper = _mm_set1_ps(Int16Upper);
+        __m128 v = noiseShaping ? _mm_sub_ps(value, error) : value;
+        __m128i q = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(v, dither), lower), upper));
+
+        if (noiseShaping)
+        {
+            const __m128 maxError = _mm_set1_ps(MaxShapingError);
+            __m128 e = _mm_sub_ps(_mm_cvtepi32_ps(q), v);
+
+            error = _mm_min_ps(_mm_max_ps(e, _mm_sub_ps(_mm_setzero_ps(), maxError)), maxError);
+        }
+
+        return q;
+    }
+
+    inline float IntLower(amf_uint32 validBits)
+    {
+        return validBits == 32 ? Int32Lower : Int24Lower;
+    }
+
+    inline float IntUpper(amf_uint32 validBits)
+    {
+        return validBits == 32 ? Int32Upper : Int24Upper;
+    }
+
+    // Vector loops, Run() returns the number of samples done and leaves the rest to a scalar tail.
+    template<amf_size Stride, bool Contiguous>
+    struct ShortToFloatLoop
+    {
+        static amf_size Run(
+            const short * inputBuffer,
+            amf_size inputStep,
+            float * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count)
+        {
+            const __m256 scale8 = _mm256_set1_ps(scale);
+            const amf_size vectorCount = StridedVectorCount<Stride>(count);
+
+            for (amf_size i = 0; i < vectorCount; i += 8)
+            {
+                __m256 v = _mm256_cvtepi32_ps(LoadShorts8<Stride>(inputBuffer + i * inputStep, inputStep));
+
+                StoreFloats8<Contiguous>(outputBuffer + i * outputStep, outputStep, _mm256_mul_ps(v, scale8));
+            }
+
+            return vectorCount;
+        }
+    };
+
+    template<amf_size Stride, bool Contiguous>
+    struct FloatToShortLoop
+    {
+        static amf_size Run(
+            const float * inputBuffer,
+            amf_size inputStep,
+            short * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count,
+            bool & clipped)
+        {
+            const __m256 scale8 = _mm256_set1_ps(scale);
+            const __m256 lower = _mm256_set1_ps(Int16Lower);
+            const __m256 upper = _mm256_set1_ps(Int16Upper);
+            const __m256i gatherIndex = Stride == 0 ? GatherIndex(inputStep) : _mm256_setzero_si256();
+            const amf_size vectorCount = StridedVectorCount<Stride>(count);
+            __m256 outOfRange = _mm256_setzero_ps();
+
+            for (amf_size i = 0; i < vectorCount; i += 8)
+            {
+                __m256 v = _mm256_mul_ps(LoadFloats8<Stride>(inputBuffer + i * inputStep, gatherIndex), scale8);
+                __m256i s = FloatToInt8(v, lower, upper, outOfRange);
+
+                StoreShorts8<Contiguous>(outputBuffer + i * outputStep, outputStep,
+                    _mm_packs_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)));
+            }
+
+            clipped |= _mm256_movemask_ps(outOfRange) != 0;
+
+            return vectorCount;
+        }
+    };
+
+    template<amf_size Stride, bool Contiguous>
+    struct FloatToShortDitheredLoop
+    {
+        static amf_size Run(
+            const float * inputBuffer,
+            amf_size inputStep,
+            short * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            bool noiseShaping,
+            TANDitherState & state,
+            amf_size count,
+            bool & clipped)
+        {
+            const __m256 scale8 = _mm256_set1_ps(scale);
+            const __m256 lower = _mm256_set1_ps(Int16Lower);
+            const __m256 upper = _mm256_set1_ps(Int16Upper);
+            const __m256i gatherIndex = Stride == 0 ? GatherIndex(inputStep) : _mm256_setzero_si256();
+            const amf_size vectorCount = StridedVectorCount<Stride>(count);
+            __m256i random = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state.random));
+            __m256 outOfRange = _mm256_setzero_ps();
+
+            for (amf_size i = 0; i < vectorCount; i += 8)
+            {
+                __m256 v = Clamp8(_mm256_mul_ps(LoadFloats8<Stride>(inputBuffer + i * inputStep, gatherIndex), scale8),
+                    lower, upper, outOfRange);
+                __m256 d = TriangularDither8(random);
+                __m256i s;
+
+                if (noiseShaping)
+                {
+                    // the error feedback runs from sample to sample
+                    float values[8], dither[8];
+                    amf_int32 samples[8];
+
+                    _mm256_storeu_ps(values, v);
+                    _mm256_storeu_ps(dither, d);
+
+                    for (int k = 0; k < 8; k++)
+                    {
+                        samples[k] = DitherSample(values[k], dither[k], true, state.error);
+                    }
+
+                    s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(samples));
+                }
+                else
+                {
+                    s = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(v, d), lower), upper));
+                }
+
+                StoreShorts8<Contiguous>(outputBuffer + i * outputStep, outputStep,
+                    _mm_packs_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)));
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(state.random), random);
+            clipped |= _mm256_movemask_ps(outOfRange) != 0;
+
+            return vectorCount;
+        }
+    };
+
+    template<amf_size Stride, bool Contiguous>
+    struct Int32ToFloatLoop
+    {
+        static amf_size Run(
+            const amf_int32 * inputBuffer,
+            amf_size inputStep,
+            float * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_uint32 validBits,
+            amf_size count)
+        {
+            const __m256 scale8 = _mm256_set1_ps(scale);
+            const __m128i unusedBits = _mm_cvtsi32_si128(32 - validBits);
+            const __m256i gatherIndex = Stride == 0 ? GatherIndex(inputStep) : _mm256_setzero_si256();
+            const amf_size vectorCount = StridedVectorCount<Stride>(count);
+
+            for (amf_size i = 0; i < vectorCount; i += 8)
+            {
+                __m256i s = LoadInt32s8<Stride>(inputBuffer + i * inputStep, gatherIndex);
+
+                s = _mm256_sra_epi32(_mm256_sll_epi32(s, unusedBits), unusedBits);
+
+                StoreFloats8<Contiguous>(outputBuffer + i * outputStep, outputStep, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale8));
+            }
+
+            return vectorCount;
+        }
+    };
+
+    template<amf_size Stride, bool Contiguous>
+    struct FloatToInt32Loop
+    {
+        static amf_size Run(
+            const float * inputBuffer,
+            amf_size inputStep,
+            amf_int32 * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_uint32 validBits,
+            amf_size count,
+            bool & clipped)
+        {
+            const __m256 scale8 = _mm256_set1_ps(scale);
+            const __m256 lower = _mm256_set1_ps(IntLower(validBits));
+            const __m256 upper = _mm256_set1_ps(IntUpper(validBits));
+            const __m256i gatherIndex = Stride == 0 ? GatherIndex(inputStep) : _mm256_setzero_si256();
+            const amf_size vectorCount = StridedVectorCount<Stride>(count);
+            __m256 outOfRange = _mm256_setzero_ps();
+
+            for (amf_size i = 0; i < vectorCount; i += 8)
+            {
+                __m256 v = _mm256_mul_ps(LoadFloats8<Stride>(inputBuffer + i * inputStep, gatherIndex), scale8);
+
+                StoreInt32s8<Contiguous>(outputBuffer + i * outputStep, outputStep, FloatToInt8(v, lower, upper, outOfRange));
+            }
+
+            clipped |= _mm256_movemask_ps(outOfRange) != 0;
+
+            return vectorCount;
+        }
+    };
+
+    // Packed 24 bit buffers only have a contiguous input loader, Stride 1 or 0.
+    template<amf_size Stride, bool Contiguous>
+    struct Packed24ToFloatLoop
+    {
+        static amf_size Run(
+            const amf_uint8 * inputBuffer,
+            amf_size inputStep,
+            float * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count)
+        {
+            const __m256 scale8 = _mm256_set1_ps(scale);
+            const __m256i gatherIndex = Stride == 0 ? GatherIndex(3 * inputStep) : _mm256_setzero_si256();
+            const amf_size vectorCount = VectorCount(count, Stride == 1 ? 0 : 1);
+
+            for (amf_size i = 0; i < vectorCount; i += 8)
+            {
+                __m256i s = LoadPacked24s8<Stride == 1>(inputBuffer + 3 * i * inputStep, gatherIndex);
+
+                StoreFloats8<Contiguous>(outputBuffer + i * outputStep, outputStep, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale8));
+            }
+
+            return vectorCount;
+        }
+    };
+
+    template<amf_size Stride, bool Contiguous>
+    struct FloatToPacked24Loop
+    {
+        static amf_size Run(
+            const float * inputBuffer,
+            amf_size inputStep,
+            amf_uint8 * outputBuffer,
+            amf_size outputStep,
+            float scale,
+            amf_size count,
+            bool & clipped)
+        {
+            const __m256 scale8 = _mm256_set1_ps(scale);
+            const __m256 lower = _mm256_set1_ps(Int24Lower);
+            const __m256 upper = _mm256_set1_ps(Int24Upper);
+            const __m256i gatherIndex = Stride == 0 ? GatherIndex(inputStep) : _mm256_setzero_si256();
+            const amf_size vectorCount = StridedVectorCount<Stride>(count);
+            __m256 outOfRange = _mm256_setzero_ps();
+
+            for (amf_size i = 0; i < vectorCount; i += 8)
+            {
+                __m256 v = _mm256_mul_ps(LoadFloats8<Stride>(inputBuffer + i * inputStep, gatherIndex), scale8);
+
+                StorePacked24s8<Contiguous>(outputBuffer + 3 * i * outputStep, outputStep, FloatToInt8(v, lower, upper, outOfRange));
+            }
+
+            clipped |= _mm256_movemask_ps(outOfRange) != 0;
+
+            return vectorCount;
+        }
+    };
+
+    // Runs Loop<inputStep, outputStep == 1> with the input strides that have a loader of
+    // their own, other strides run Loop<0, ...> unless they are too wide for a gather.
+    template<template<amf_size, bool> class Loop, bool Contiguous, typename... Args>
+    amf_size RunForInputStep(amf_size inputStep, Args &&... args)
+    {
+        switch (inputStep)
+        {
+        case 1: return Loop<1, Contiguous>::Run(std::forward<Args>(args)...);
+        case 2: return Loop<2, Contiguous>::Run(std::forward<Args>(args)...);
+        case 4: return Loop<4, Contiguous>::Run(std::forward<Args>(args)...);
+        case 6: return Loop<6, Contiguous>::Run(std::forward<Args>(args)...);
+        case 8: return Loop<8, Contiguous>::Run(std::forward<Args>(args)...);
+        default: return inputStep <= MaxGatherStride ? Loop<0, Contiguous>::Run(std::forward<Args>(args)...) : 0;
+        }
+    }
+
+    template<template<amf_size, bool> class Loop, typename... Args>
+    amf_size RunVectorLoop(amf_size inputStep, amf_size outputStep, Args &&... args)
+    {
+        return outputStep == 1 ?
+            RunForInputStep<Loop, true>(inputStep, std::forward<Args>(args)...) :
+            RunForInputStep<Loop, false>(inputStep, std::forward<Args>(args)...);
+    }
+
+    // Same for the packed 24 bit input, which is either contiguous or gathered.
+    template<template<amf_size, bool> class Loop, typename... Args>
+    amf_size RunPackedVectorLoop(amf_size inputStep, amf_size outputStep, Args &&... args)
+    {
+        if (inputStep == 1)
+        {
+            return outputStep == 1 ?
+                Loop<1, true>::Run(std::forward<Args>(args)...) :
+                Loop<1, false>::Run(std::forward<Args>(args)...);
+        }
+        else if (3 * inputStep > MaxGatherStride)
+        {
+            return 0;
+        }
+
+        return outputStep == 1 ?
+            Loop<0, true>::Run(std::forward<Args>(args)...) :
+            Loop<0, false>::Run(std::forward<Args>(args)...);
+    }
+
+    void ShortToFloatAVX2(
+        const short * inputBuffer,
+        amf_size inputStep,
+        float * outputBuffer,
+        amf_size outputStep,
+        float scale,
+        amf_size count)
+    {
+        amf_size i = RunVectorLoop<ShortToFloatLoop>(inputStep, outputStep,
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, count);
+
+        for (; i < count; i++)
+        {
+            outputBuffer[i * outputStep] = inputBuffer[i * inputStep] * scale;
+        }
+    }
+
+    bool FloatToShortAVX2(
+        const float * inputBuffer,
+        amf_size inputStep,
+        short * outputBuffer,
+        amf_size outputStep,
+        float scale,
+        amf_size count)
+    {
+        bool clipped = false;
+
+        amf_size i = RunVectorLoop<FloatToShortLoop>(inputStep, outputStep,
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, count, clipped);
+
+        for (; i < count; i++)
+        {
+            outputBuffer[i * outputStep] = short(FloatToIntSample(inputBuffer[i * inputStep] * scale, Int16Lower, Int16Upper, clipped));
+        }
+
+        return clipped;
+    }
+
+    bool FloatToShortDitheredAVX2(
+        const float * inputBuffer,
+        amf_size inputStep,
+        short * outputBuffer,
+        amf_size outputStep,
+        float scale,
+        bool noiseShaping,
+        TANDitherState & state,
+        amf_size count)
+    {
+        bool clipped = false;
+
+        amf_size i = RunVectorLoop<FloatToShortDitheredLoop>(inputStep, outputStep,
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, noiseShaping, state, count, clipped);
+
+        for (; i < count; i++)
+        {
+            float value = ClampSample(inputBuffer[i * inputStep] * scale, Int16Lower, Int16Upper, clipped);
+
+            outputBuffer[i * outputStep] = short(DitherSample(value, TriangularDither(state.random[0]), noiseShaping, state.error));
+        }
+
+        return clipped;
+    }
+
+    void Int32ToFloatAVX2(
+        const amf_int32 * inputBuffer,
+        amf_size inputStep,
+        float * outputBuffer,
+        amf_size outputStep,
+        float scale,
+        amf_uint32 validBits,
+        amf_size count)
+    {
+        amf_size i = RunVectorLoop<Int32ToFloatLoop>(inputStep, outputStep,
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, validBits, count);
+
+        for (; i < count; i++)
+        {
+            amf_int32 s = amf_int32(amf_uint32(inputBuffer[i * inputStep]) << (32 - validBits)) >> (32 - validBits);
+
+            outputBuffer[i * outputStep] = float(s) * scale;
+        }
+    }
+
+    bool FloatToInt32AVX2(
+        const float * inputBuffer,
+        amf_size inputStep,
+        amf_int32 * outputBuffer,
+        amf_size outputStep,
+        float scale,
+        amf_uint32 validBits,
+        amf_size count)
+    {
+        bool clipped = false;
+
+        amf_size i = RunVectorLoop<FloatToInt32Loop>(inputStep, outputStep,
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, validBits, count, clipped);
+
+        for (; i < count; i++)
+        {
+            outputBuffer[i * outputStep] = FloatToIntSample(inputBuffer[i * inputStep] * scale,
+                IntLower(validBits), IntUpper(validBits), clipped);
+        }
+
+        return clipped;
+    }
+
+    void Packed24ToFloatAVX2(
+        const amf_uint8 * inputBuffer,
+        amf_size inputStep,
+        float * outputBuffer,
+        amf_size outputStep,
+        float scale,
+        amf_size count)
+    {
+        amf_size i = RunPackedVectorLoop<Packed24ToFloatLoop>(inputStep, outputStep,
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, count);
+
+        for (; i < count; i++)
+        {
+            const amf_uint8 * p = inputBuffer + 3 * i * inputStep;
+            amf_int32 s = amf_int32(amf_uint32(p[0]) << 8 | amf_uint32(p[1]) << 16 | amf_uint32(p[2]) << 24) >> 8;
+
+            outputBuffer[i * outputStep] = float(s) * scale;
+        }
+    }
+
+    bool FloatToPacked24AVX2(
+        const float * inputBuffer,
+        amf_size inputStep,
+        amf_uint8 * outputBuffer,
+        amf_size outputStep,
+        float scale,
+        amf_size count)
+    {
+        bool clipped = false;
+
+        amf_size i = RunVectorLoop<FloatToPacked24Loop>(inputStep, outputStep,
+            inputBuffer, inputStep, outputBuffer, outputStep, scale, count, clipped);
+
+        for (; i < count; i++)
+        {
+            StorePacked24(outputBuffer + 3 * i * outputStep,
+                FloatToIntSample(inputBuffer[i * inputStep] * scale, Int24Lower, Int24Upper, clipped));
+        }
+
+        return clipped;
+    }
+
+    // Sample formats of the interleaved kernels. Load4 reads four consecutive samples of a frame
+    // unscaled, Convert8 turns scaled floats into the bits Store4 writes four at a time.
+    struct FloatSamples
+    {
+        static const amf_size Bytes = 4;
+
+        static __m128 Load4(const amf_uint8 * p)
+        {
+            return _mm_loadu_ps(reinterpret_cast<const float *>(p));
+        }
+
+        static float Load(const amf_uint8 * p)
+        {
+            float v;
+            memcpy(&v, p, sizeof(v));
+
+            return v;
+        }
+
+        static __m256 Convert8(__m256 v, __m256 & /*outOfRange*/)
+        {
+            return v;
+        }
+
+        static void Store4(amf_uint8 * p, __m128 bits)
+        {
+            _mm_storeu_ps(reinterpret_cast<float *>(p), bits);
+        }
+
+        static void Store(amf_uint8 * p, float v, bool & /*clipped*/)
+        {
+            memcpy(p, &v, sizeof(v));
+        }
+    };
+
+    struct Int16Samples
+    {
+        static const amf_size Bytes = 2;
+
+        static __m128 Load4(const amf_uint8 * p)
+        {
+            return _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+        }
+
+        static float Load(const amf_uint8 * p)
+        {
+            short v;
+            memcpy(&v, p, sizeof(v));
+
+            return float(v);
+        }
+
+        static __m256 Convert8(__m256 v, __m256 & outOfRange)
+        {
+            return _mm256_castsi256_ps(FloatToInt8(v, _mm256_set1_ps(Int16Lower), _mm256_set1_ps(Int16Upper), outOfRange));
+        }
+
+        static void Store4(amf_uint8 * p, __m128 bits)
+        {
+            __m128i s = _mm_castps_si128(bits);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(s, s));
+        }
+
+        static void Store(amf_uint8 * p, float v, bool & clipped)
+        {
+            short s = short(FloatToIntSample(v, Int16Lower, Int16Upper, clipped));
+            memcpy(p, &s, sizeof(s));
+        }
+    };
+
+    // 32 bit words with ValidBits wide samples in their low bits.
+    template<int ValidBits>
+    struct Int32Samples
+    {
+        static const amf_size Bytes = 4;
+
+        static __m128 Load4(const amf_uint8 * p)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+
+            return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(s, 32 - ValidBits), 32 - ValidBits));
+        }
+
+        static float Load(const amf_uint8 * p)
+        {
+            amf_int32 v;
+            memcpy(&v, p, sizeof(v));
+
+            return float(amf_int32(amf_uint32(v) << (32 - ValidBits)) >> (32 - ValidBits));
+        }
+
+        static __m256 Convert8(__m256 v, __m256 & outOfRange)
+        {
+            return _mm256_castsi256_ps(FloatToInt8(v,
+                _mm256_set1_ps(IntLower(ValidBits)), _mm256_set1_ps(IntUpper(ValidBits)), outOfRange));
+        }
+
+        static void Store4(amf_uint8 * p, __m128 bits)
+        {
+            _mm_storeu_ps(reinterpret_cast<float *>(p), bits);
+        }
+
+        static void Store(amf_uint8 * p, float v, bool & clipped)
+        {
+            amf_int32 s = FloatToIntSample(v, IntLower(ValidBits), IntUpper(ValidBits), clipped);
+            memcpy(p, &s, sizeof(s));
+        }
+    };
+
+    // Loads and stores exactly the twelve bytes of four samples.
+    struct Packed24Samples
+    {
+        static const amf_size Bytes = 3;
+
+        static __m128 Load4(const amf_uint8 * p)
+        {
+            amf_int32 last;
+            memcpy(&last, p + 8, sizeof(last));
+
+            const __m128i samples = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+            __m128i v = _mm_insert_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), last, 2);
+
+            return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_shuffle_epi8(v, samples), 8));
+        }
+
+        static float Load(const amf_uint8 * p)
+        {
+            return float(amf_int32(amf_uint32(p[0]) << 8 | amf_uint32(p[1]) << 16 | amf_uint32(p[2]) << 24) >> 8);
+        }
+
+        static __m256 Convert8(__m256 v, __m256 & outOfRange)
+        {
+            return _mm256_castsi256_ps(FloatToInt8(v, _mm256_set1_ps(Int24Lower), _mm256_set1_ps(Int24Upper), outOfRange));
+        }
+
+        static void Store4(amf_uint8 * p, __m128 bits)
+        {
+            const __m128i samples = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            __m128i v = _mm_shuffle_epi8(_mm_castps_si128(bits), samples);
+            amf_int32 last = _mm_extract_epi32(v, 2);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(p), v);
+            memcpy(p + 8, &last, sizeof(last));
+        }
+
+        static void Store(amf_uint8 * p, float v, bool & clipped)
+        {
+            StorePacked24(p, FloatToIntSample(v, Int24Lower, Int24Upper, clipped));
+        }
+    };
+
+    // Transposes the 4 x 4 blocks in both 128 bit lanes.
+    inline void Transpose4x4Lanes(__m256 & r0, __m256 & r1, __m256 & r2, __m256 & r3)
+    {
+        __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+        __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+        __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+
+        r0 = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(t0), _mm256_castps_pd(t1)));
+        r1 = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(t0), _mm256_castps_pd(t1)));
+        r2 = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(t2), _mm256_castps_pd(t3)));
+        r3 = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(t2), _mm256_castps_pd(t3)));
+    }
+
+    // Frames per tile, a multiple of the eight frames of the vector loop.
+    inline amf_size TileFrames(amf_size frameBytes)
+    {
+        amf_size frames = InterleaveTileBytes / frameBytes / 8 * 8;
+
+        return frames > 8 ? frames : 8;
+    }
+
+    // Groups of four channels are transposed eight frames at a time, frames f and f + 4 sharing
+    // a register, the remaining channels and frames are done one sample at a time in the same
+    // pass over the tile.
+    template<class Samples>
+    void Deinterleave(
+        const amf_uint8 * inputBuffer,
+        float * const * outputBuffers,
+        amf_size channels,
+        float scale,
+        amf_size frames)
+    {
+        const __m256 scale8 = _mm256_set1_ps(scale);
+        const amf_size frameBytes = channels * Samples::Bytes;
+        const amf_size tileFrames = TileFrames(frameBytes);
+
+        for (amf_size tile = 0; tile < frames; tile += tileFrames)
+        {
+            const amf_size tileEnd = tile + tileFrames < frames ? tile + tileFrames : frames;
+            amf_size c = 0;
+
+            for (; c + 4 <= channels; c += 4)
+            {
+                float * out0 = outputBuffers[c];
+                float * out1 = outputBuffers[c + 1];
+                float * out2 = outputBuffers[c + 2];
+                float * out3 = outputBuffers[c + 3];
+                amf_size i = tile;
+
+                for (; i + 8 <= tileEnd; i += 8)
+                {
+                    const amf_uint8 * p = inputBuffer + i * frameBytes + c * Samples::Bytes;
+                    __m256 r0 = Join(Samples::Load4(p), Samples::Load4(p + 4 * frameBytes));
+                    __m256 r1 = Join(Samples::Load4(p + frameBytes), Samples::Load4(p + 5 * frameBytes));
+                    __m256 r2 = Join(Samples::Load4(p + 2 * frameBytes), Samples::Load4(p + 6 * frameBytes));
+                    __m256 r3 = Join(Samples::Load4(p + 3 * frameBytes), Samples::Load4(p + 7 * frameBytes));
+
+                    Transpose4x4Lanes(r0, r1, r2, r3);
+
+                    _mm256_storeu_ps(out0 + i, _mm256_mul_ps(r0, scale8));
+                    _mm256_storeu_ps(out1 + i, _mm256_mul_ps(r1, scale8));
+                    _mm256_storeu_ps(out2 + i, _mm256_mul_ps(r2, scale8));
+                    _mm256_storeu_ps(out3 + i, _mm256_mul_ps(r3, scale8));
+                }
+
+                for (; i < tileEnd; i++)
+                {
+                    const amf_uint8 * p = inputBuffer + i * frameBytes + c * Samples::Bytes;
+
+                    out0[i] = Samples::Load(p) * scale;
+                    out1[i] = Samples::Load(p + Samples::Bytes) * scale;
+                    out2[i] = Samples::Load(p + 2 * Samples::Bytes) * scale;
+                    out3[i] = Samples::Load(p + 3 * Samples::Bytes) * scale;
+                }
+            }
+
+            for (; c < channels; c++)
+            {
+                for (amf_size i = tile; i < tileEnd; i++)
+                {
+                    outputBuffers[c][i] = Samples::Load(inputBuffer + i * frameBytes + c * Samples::Bytes) * scale;
+                }
+            }
+        }
+    }
+
+    template<class Samples>
+    bool Interleave(
+        const float * const * inputBuffers,
+        amf_size channels,
+        amf_uint8 * outputBuffer,
+        float scale,
+        amf_size frames)
+    {
+        const __m256 scale8 = _mm256_set1_ps(scale);
+        const amf_size frameBytes = channels * Samples::Bytes;
+        const amf_size tileFrames = TileFrames(frameBytes);
+        __m256 outOfRange = _mm256_setzero_ps();
+        bool clipped = false;
+
+        for (amf_size tile = 0; tile < frames; tile += tileFrames)
+        {
+            const amf_size tileEnd = tile + tileFrames < frames ? tile + tileFrames : frames;
+            amf_size c = 0;
+
+            for (; c + 4 <= channels; c += 4)
+            {
+                const float * in0 = inputBuffers[c];
+                const float * in1 = inputBuffers[c + 1];
+                const float * in2 = inputBuffers[c + 2];
+                const float * in3 = inputBuffers[c + 3];
+                amf_size i = tile;
+
+                for (; i + 8 <= tileEnd; i += 8)
+                {
+                    amf_uint8 * p = outputBuffer + i * frameBytes + c * Samples::Bytes;
+                    __m256 r0 = Samples::Convert8(_mm256_mul_ps(_mm256_loadu_ps(in0 + i), scale8), outOfRange);
+                    __m256 r1 = Samples::Convert8(_mm256_mul_ps(_mm256_loadu_ps(in1 + i), scale8), outOfRange);
+                    __m256 r2 = Samples::Convert8(_mm256_mul_ps(_mm256_loadu_ps(in2 + i), scale8), outOfRange);
+                    __m256 r3 = Samples::Convert8(_mm256_mul_ps(_mm256_loadu_ps(in3 + i), scale8), outOfRange);
+
+                    Transpose4x4Lanes(r0, r1, r2, r3);
+
+                    Samples::Store4(p, _mm256_castps256_ps128(r0));
+                    Samples::Store4(p + frameBytes, _mm256_castps256_ps128(r1));
+                    Samples::Store4(p + 2 * frameBytes, _mm256_castps256_ps128(r2));
+                    Samples::Store4(p + 3 * frameBytes, _mm256_castps256_ps128(r3));
+                    Samples::Store4(p + 4 * frameBytes, _mm256_extractf128_ps(r0, 1));
+                    Samples::Store4(p + 5 * frameBytes, _mm256_extractf128_ps(r1, 1));
+                    Samples::Store4(p + 6 * frameBytes, _mm256_extractf128_ps(r2, 1));
+                    Samples::Store4(p + 7 * frameBytes, _mm256_extractf128_ps(r3, 1));
+                }
+
+                for (; i < tileEnd; i++)
+                {
+                    amf_uint8 * p = outputBuffer + i * frameBytes + c * Samples::Bytes;
+
+                    Samples::Store(p, in0[i] * scale, clipped);
+                    Samples::Store(p + Samples::Bytes, in1[i] * scale, clipped);
+                    Samples::Store(p + 2 * Samples::Bytes, in2[i] * scale, clipped);
+                    Samples::Store(p + 3 * Samples::Bytes, in3[i] * scale, clipped);
+                }
+            }
+
+            for (; c < channels; c++)
+            {
+                for (amf_size i = tile; i < tileEnd; i++)
+                {
+                    Samples::Store(outputBuffer + i * frameBytes + c * Samples::Bytes, inputBuffers[c][i] * scale, clipped);
+                }
+            }
+        }
+
+        return clipped || _mm256_movemask_ps(outOfRange) != 0;
+    }
+
+    // Groups of four channels run frame by frame with one channel per lane, so the error
+    // feedback of every channel stays in a register. The chain from frame to frame bounds
+    // this loop, wider vectors would only add transposes.
+    bool InterleaveToShortDitheredAVX2(
+        const float * const * inputBuffers,
+        amf_size channels,
+        short * outputBuffer,
+        float scale,
+        bool noiseShaping,
+        TANDitherState * states,
+        amf_size frames)
+    {
+        const __m128 scale4 = _mm_set1_ps(scale);
+        const __m128 lower = _mm_set1_ps(Int16Lower);
+        const __m128 upper = _mm_set1_ps(Int16Upper);
+        const amf_size tileFrames = TileFrames(channels * sizeof(short));
+        __m128 outOfRange = _mm_setzero_ps();
+        bool clipped = false;
+
+        for (amf_size tile = 0; tile < frames; tile += tileFrames)
+        {
+            const amf_size tileEnd = tile + tileFrames < frames ? tile + tileFrames : frames;
+            amf_size c = 0;
+
+            for (; c + 4 <= channels; c += 4)
+            {
+                TANDitherState * state = states + c;
+                const float * in0 = inputBuffers[c];
+                const float * in1 = inputBuffers[c + 1];
+                const float * in2 = inputBuffers[c + 2];
+                const float * in3 = inputBuffers[c + 3];
+                __m128i random = _mm_setr_epi32(state[0].random[0], state[1].random[0], state[2].random[0], state[3].random[0]);
+                __m128 error = _mm_setr_ps(state[0].error, state[1].error, state[2].error, state[3].error);
+                amf_size i = tile;
+
+                for (; i + 4 <= tileEnd; i += 4)
+                {
+                    short * q = outputBuffer + i * channels + c;
+                    __m128 r0 = Clamp4(_mm_mul_ps(_mm_loadu_ps(in0 + i), scale4), lower, upper, outOfRange);
+                    __m128 r1 = Clamp4(_mm_mul_ps(_mm_loadu_ps(in1 + i), scale4), lower, upper, outOfRange);
+                    __m128 r2 = Clamp4(_mm_mul_ps(_mm_loadu_ps(in2 + i), scale4), lower, upper, outOfRange);
+                    __m128 r3 = Clamp4(_mm_mul_ps(_mm_loadu_ps(in3 + i), scale4), lower, upper, outOfRange);
+
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                    __m128i s0 = DitherSamples4(r0, TriangularDither4(random), noiseShaping, error);
+                    __m128i s1 = DitherSamples4(r1, TriangularDither4(random), noiseShaping, error);
+                    __m128i s2 = DitherSamples4(r2, TriangularDither4(random), noiseShaping, error);
+                    __m128i s3 = DitherSamples4(r3, TriangularDither4(random), noiseShaping, error);
+                    __m128i s01 = _mm_packs_epi32(s0, s1);
+                    __m128i s23 = _mm_packs_epi32(s2, s3);
+
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(q), s01);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(q + channels), _mm_unpackhi_epi64(s01, s01));
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(q + 2 * channels), s23);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(q + 3 * channels), _mm_unpackhi_epi64(s23, s23));
+                }
+
+                amf_uint32 lanes[4];
+                float errors[4];
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), random);
+                _mm_storeu_ps(errors, error);
+
+                for (int k = 0; k < 4; k++)
+                {
+                    state[k].random[0] = lanes[k];
+                    state[k].error = errors[k];
+                }
+
+                for (; i < tileEnd; i++)
+                {
+                    for (int k = 0; k < 4; k++)
+                    {
+                        float value = ClampSample(inputBuffers[c + k][i] * scale, Int16Lower, Int16Upper, clipped);
+
+                        outputBuffer[i * channels + c + k] = short(DitherSample(value,
+                            TriangularDither(state[k].random[0]), noiseShaping, state[k].error));
+                    }
+                }
+            }
+
+            for (; c < channels; c++)
+            {
+                for (amf_size i = tile; i < tileEnd; i++)
+                {
+                    float value = ClampSample(inputBuffers[c][i] * scale, Int16Lower, Int16Upper, clipped);
+
+                    outputBuffer[i * channels + c] = short(DitherSample(value,
+                        TriangularDither(states[c].random[0]), noiseShaping, states[c].error));
+                }
+            }
+        }
+
+        return clipped || _mm_movemask_ps(outOfRange) != 0;
+    }
+
+    void DeinterleaveToFloatAVX2(
+        const void * inputBuffer,
+        TANConverterSampleFormat inputFormat,
+        float * const * outputBuffers,
+        amf_size channels,
+        float scale,
+        amf_size frames)
+    {
+        const amf_uint8 * input = static_cast<const amf_uint8 *>(inputBuffer);
+
+        switch (inputFormat)
+        {
+        case TANConverterSampleFloat: Deinterleave<FloatSamples>(input, outputBuffers, channels, scale, frames); break;
+        case TANConverterSampleInt16: Deinterleave<Int16Samples>(input, outputBuffers, channels, scale, frames); break;
+        case TANConverterSampleInt32: Deinterleave<Int32Samples<32> >(input, outputBuffers, channels, scale, frames); break;
+        case TANConverterSampleInt24In32: Deinterleave<Int32Samples<24> >(input, outputBuffers, channels, scale, frames); break;
+        case TANConverterSamplePacked24: Deinterleave<Packed24Samples>(input, outputBuffers, channels, scale, frames); break;
+        }
+    }
+
+    bool InterleaveFromFloatAVX2(
+        const float * const * inputBuffers,
+        amf_size channels,
+        void * outputBuffer,
+        TANConverterSampleFormat outputFormat,
+        float scale,
+        amf_size frames)
+    {
+        amf_uint8 * output = static_cast<amf_uint8 *>(outputBuffer);
+
+        switch (outputFormat)
+        {
+        case TANConverterSampleFloat: return Interleave<FloatSamples>(inputBuffers, channels, output, scale, frames);
+        case TANConverterSampleInt16: return Interleave<Int16Samples>(inputBuffers, channels, output, scale, frames);
+        case TANConverterSampleInt32: return Interleave<Int32Samples<32> >(inputBuffers, channels, output, scale, frames);
+        case TANConverterSampleInt24In32: return Interleave<Int32Samples<24> >(inputBuffers, channels, output, scale, frames);
+        case TANConverterSamplePacked24: return Interleave<Packed24Samples>(inputBuffers, channels, output, scale, frames);
+        }
+
+        return false;
+    }
+}
+
+namespace amf
+{
+    const TANConverterKernels TANConverterKernelsAVX2 =
+    {
+        L"AVX2",
+        ShortToFloatAVX2,
+        FloatToShortAVX2,
+        Int32ToFloatAVX2,
+        FloatToInt32AVX2,
+        Packed24ToFloatAVX2,
+        FloatToPacked24AVX2,
+        DeinterleaveToFloatAVX2,
+        InterleaveFromFloatAVX2,
+        FloatToShortDitheredAVX2,
+        InterleaveToShortDitheredAVX2
+    };
+}
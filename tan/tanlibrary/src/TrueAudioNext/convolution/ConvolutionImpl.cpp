@@ -23,6 +23,7 @@
 //
 #include "ConvolutionImpl.h"
 #include "../core/TANContextImpl.h"
+#include "../core/StageTrace.h"
 #include "../fft/FFTImpl.h"
 #include "../math/MathImpl.h"
 
@@ -44,6 +45,9 @@
   #include <CL/cl.h>
 #endif
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <tuple>
 
 #define AMF_FACILITY L"TANConvolutionImpl"
@@ -96,7 +100,6 @@ TANConvolutionImpl::TANConvolutionImpl(TANContext *pContextTAN)
     m_pUpdateContextAMF = contextImpl->GetGeneralCompute();
     m_pProcContextAMF = contextImpl->GetConvolutionCompute();
 
-    PrintDebug("99 m_xFadeStarted.SetEvent()");
     m_xFadeStarted.SetEvent();
 
     // CPU processing case.
@@ -107,6 +110,23 @@ TANConvolutionImpl::TANConvolutionImpl(TANContext *pContextTAN)
 
     AMFPrimitivePropertyInfoMapBegin
         AMFPropertyInfoEnum(TAN_OUTPUT_MEMORY_TYPE ,  L"Output Memory Type", AMF_MEMORY_HOST, AMF_MEMORY_ENUM_DESCRIPTION, false),
+        AMFPropertyInfoBool(TAN_CONVOLUTION_OVERLAP_SAVE, L"Overlap-save partitioned convolution", false, AMF_PROPERTY_ACCESS_FULL),
+        AMFPropertyInfoEnum(TAN_THREAD_SCHEDULING, L"Scheduling of internal threads", TAN_THREAD_SCHEDULING_CONTEXT, TAN_THREAD_SCHEDULING_ENUM_DESCRIPTION, AMF_PROPERTY_ACCESS_FULL),
+        AMFPropertyInfoInt64(TAN_THREAD_PRIORITY, L"Real time priority of internal threads", 0, 0, 99, AMF_PROPERTY_ACCESS_FULL),
+        AMFPropertyInfoInt64(TAN_THREAD_AFFINITY, L"Processor mask of internal threads", 0, LLONG_MIN, LLONG_MAX, AMF_PROPERTY_ACCESS_FULL),
+        AMFPropertyInfoBool(TAN_THREAD_LOCK_MEMORY, L"Lock the process memory", false, AMF_PROPERTY_ACCESS_FULL),
+        TANStatsPropertyInfoBlocks,
+        TANStatsPropertyInfoOverruns,
+        TANStatsPropertyInfoStages,
+        AMFPropertyInfoInt64(TAN_STATS_IR_UPDATES, L"Responses updated", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoInt64(TAN_STATS_IR_DROPPED, L"Responses replaced before their update", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoInt64(TAN_STATS_CROSSFADES, L"Crossfades started", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        TANStatsPropertyInfoTime(L"InputFFT"),
+        TANStatsPropertyInfoTime(L"MAC"),
+        TANStatsPropertyInfoTime(L"Tail"),
+        TANStatsPropertyInfoTime(L"IFFT"),
+        TANStatsPropertyInfoTime(L"Crossfade"),
+        TANStatsPropertyInfoTime(L"IRUpdate"),
     AMFPrimitivePropertyInfoMapEnd
 
     m_initialized = false;
@@ -150,6 +170,47 @@ TANConvolutionImpl::~TANConvolutionImpl(void)
     Terminate();
 }
 
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANConvolutionImpl::ReadThreadScheduling()
+{
+    TANThreadScheduling scheduling;
+
+    AMF_RETURN_IF_FAILED(TANReadThreadScheduling(this, scheduling));
+
+    // all four from the context unless this convolution overrides them
+    if (scheduling.schedulingClass == TAN_THREAD_SCHEDULING_CONTEXT)
+    {
+        scheduling = TANThreadScheduling();
+
+        AMF_RETURN_IF_FAILED(TANReadThreadScheduling(m_pContextTAN, scheduling));
+        AMF_RETURN_IF_FALSE(scheduling.schedulingClass != TAN_THREAD_SCHEDULING_CONTEXT, AMF_INVALID_ARG,
+            L"TAN_THREAD_SCHEDULING_CONTEXT is not a scheduling class of the context");
+    }
+
+    m_threadScheduling = scheduling;
+
+    return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANConvolutionImpl::GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const
+{
+    const AMF_RESULT res = AMFPropertyStorageExImpl<TANConvolution>::GetProperty(name, pValue);
+
+    if (res == AMF_OK)
+    {
+        m_counters.GetProperty(name, pValue);
+    }
+
+    return res;
+}
+
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL TANConvolutionImpl::OnPropertyChanged(const wchar_t* name)
+{
+    m_counters.OnPropertyChanged(this, name);
+}
+
 //-------------------------------------------------------------------------------------------------
 bool TANConvolutionImpl::ReadyForIRUpdate()
 {
@@ -198,51 +259,97 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Init(
     }
 }
 
-/* Best fft length multiple for non-uniform partitioned convolution CPU implementation
+/* Response span of a level of the non uniform partition ladder,
+TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM CPU implementation.
+
+Level l uses partitions of P = B * 4^l samples. Its input is complete P / B blocks after
+the first sample arrived, the transforms and multiply accumulates are then spread over the
+next P / B blocks, so the level output can't be played earlier than 2 * P - B samples after
+the input. Level 0 runs on every block and starts at the response start.
+*/
+static void NULadderSpan(int level, int levels, int responseLength, int blockLength, int &first, int &end)
+{
+	const int partition = blockLength << (NU_LADDER_GROWTH_LOG2 * level);
+
+	first = level ? 2 * partition - blockLength : 0;
+	end = (level + 1 < levels) ? 2 * (partition << NU_LADDER_GROWTH_LOG2) - blockLength : responseLength;
+	end = std::min(end, responseLength);
+}
+
+/* Best number of ladder levels for non-uniform partitioned convolution CPU implementation
 TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM
 
 Derivation:
-We estimate the sum of time in FFT Tf and time in complex multiply accumulate Tm.
-where:
-M = multiple
+We estimate the worst case work of a single block, in flops.
 B = block size
 R = response length
+P = B * 4^l, partition size of level l
+n = partitions of level l, see NULadderSpan
 
-FFT for convolution is double size so:
-Tf = 2*B*M * log(2*B*M)
+Real FFT of the double size partition:
+Tf = 2.5 * 2P * log2(2P)
 
-we need the new tail calculation only after M blocks, so:
-Tm = 2*R/M
+complex multiply accumulate of a partition:
+Tm = 8 * P
 
-time per block is Tf + Tm, but there are sRate/B blocks per second so
+level 0 runs the forward and inverse FFT and all its multiply accumulates on every block:
+T0 = 2 * Tf + n * Tm
 
-Ttot = 2*M*log(2*M*B) + 2*R/(M*B)
+level l > 0 runs its forward FFT on the first block of a period, its inverse FFT on the last
+one and spreads the multiply accumulates over the P / B - 2 blocks between them:
+Ml = ceil(n / (P / B - 2)) * Tm
 
+buildNULadder shifts the periods of the levels so that no two of them transform on the same
+block, the worst case block runs the transform of one level and the multiply accumulates of
+all others:
+T = T0 + sum(Ml) + max(0, max(Tf - Ml))
 */
+int TANConvolutionImpl::bestNULadderLevels(int responseLength, int blockLength) {
+	int best = 1;
+	double Tmin = std::numeric_limits<double>::max();
 
+	int log2bsz = 0;
+	while ((1 << log2bsz) < blockLength) {
+		++log2bsz;
+	}
 
-int TANConvolutionImpl::bestNUMultiple(int responseLength, int blockLength) {
-	int multiple = 1;
-	// Heuristic to guess best multiple:
+	for (int levels = 1; levels <= NU_LADDER_MAX_LEVELS; ++levels) {
+		int first = 0, end = 0;
+		NULadderSpan(levels - 1, levels, responseLength, blockLength, first, end);
+		if (first >= responseLength ||
+			log2bsz + 1 + NU_LADDER_GROWTH_LOG2 * (levels - 1) >= MAX_CACHE_POWER) {
+			break;
+		}
 
-	multiple = responseLength / (blockLength * 32);
-	if (multiple < 1)
-		multiple = 1;
+		double t = 0;
+		double transform = 0;
+		for (int level = 0; level < levels; ++level) {
+			NULadderSpan(level, levels, responseLength, blockLength, first, end);
+
+			const double P = double(blockLength << (NU_LADDER_GROWTH_LOG2 * level));
+			const int blocks = 1 << (NU_LADDER_GROWTH_LOG2 * level);
+			const int n = int((end - first + P - 1) / P);
+			const double Tf = 2.5 * 2 * P * log2(2 * P);
+			const double Tm = 8 * P;
+
+			if (level == 0) {
+				t += 2 * Tf + n * Tm;
+				continue;
+			}
+
+			const double Ml = ((n + blocks - 3) / (blocks - 2)) * Tm;
+			t += Ml;
+			transform = std::max(transform, Tf - Ml);
+		}
+		t += transform;
 
-	int M = 1;
-	int B = blockLength;
-	int R = responseLength;
-	float  Tmin = std::numeric_limits<float>::max();
-	int maxM = R / (8 * B);
-	for (M = 1; M < maxM; M *= 2) {
-		float t = 2 * M*log(double(2 * B*M)) + 2 * R / (B*M);
 		if (t < Tmin) {
 			Tmin = t;
-			multiple = M;
+			best = levels;
 		}
 	}
 
-	return multiple;
+	return best;
 }
 
 
@@ -254,13 +361,8 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::InitCpu(
     amf_uint32 channels
     )
 {
-	// Heuristic to guess best multiple:
-	if ((convolutionMethod & ~TAN_CONVOLUTION_METHOD_USE_PROCESS_TAILTHREAD) == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM) {
-		m_2ndBufSizeMultiple = bestNUMultiple(responseLengthInSamples, bufferSizeInSamples);
-	}
-	else {
-		m_2ndBufSizeMultiple = 1;
-	}
+	// the non uniform method runs on the partition ladder, see Init
+	m_2ndBufSizeMultiple = 1;
 
     AMF_RETURN_IF_FALSE(m_pContextTAN != NULL, AMF_WRONG_STATE,
         L"Cannot initialize after termination");
@@ -325,7 +427,6 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Terminate()
 {
     //int tID = 0;
     //tID = GetThreadId((HANDLE)m_updThread.getNativeThreadHandle());
-    PrintDebug("328 m_xFadeStarted.SetEvent()");
     m_xFadeStarted.SetEvent();
 
     AMFLock lock(&m_sect);
@@ -335,7 +436,6 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Terminate()
 	deallocateBuffers();
     m_updThread.RequestStop();
 
-    PrintDebug("338 m_procReadyForNewResponsesEvent.SetEvent()");
     m_procReadyForNewResponsesEvent.SetEvent();
 
     // Windows specific:
@@ -347,12 +447,10 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Terminate()
 
 #ifdef USE_TAIL_THREAD
 		m_tailThread.RequestStop();
-        PrintDebug("350 m_runTailEvent.SetEvent()");
 		m_runTailEvent.SetEvent();
 		m_tailThread.WaitForStop();
 #endif
 
-    PrintDebug("354 m_updateFinishedProcessing.SetEvent()");
     m_updateFinishedProcessing.SetEvent();
 
 #ifndef TAN_NO_OPENCL
@@ -509,6 +607,12 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::UpdateResponseTD(
 
         AMF_RESULT ret = AMF_OK;
 
+        // the update thread hasn't taken the previous responses yet, these replace them
+        if (m_accumulatedArgs.updatesCnt != 0)
+        {
+            m_counters.Count(TAN_STATS_COUNTER_IR_DROPPED);
+        }
+
         m_idxUpdateFilterLatest = m_idxUpdateFilter;
 
         switch (m_eConvolutionMethod)
@@ -1127,6 +1231,13 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Process(
 
     AMFLock lock(&m_sectProcess);
 
+    m_block++;
+    TANBlockTimer blockTimer(m_counters, numOfSamplesToProcess);
+    TAN_TRACE_STAGE(TAN_TRACE_STAGE_PROCESS, TANTraceAllChannels, m_block);
+
+    // a new block for the partition ladder
+    m_NULadderBlockConsumed = false;
+
     AMF_RESULT res = AMF_OK;
 
     AMF_RETURN_IF_FALSE(m_idxFilter >= 0, AMF_NOT_INITIALIZED,
@@ -1205,8 +1316,6 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Process(
     m_CrossFading = doCrossFade;
 	if (doCrossFade) //IR_UPDATE_DETECTED_STATE;
 	{
-        PrintDebug("DoCrossfade...");
-
 		AMFLock lock(&m_sectUpdate);
 
 		//m_DelayedUpdate = 0;
@@ -1214,6 +1323,8 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Process(
 		// We've switched to a new filter response, so we need to cross fade from old IR to the new one
 		//advance indices modulo 3:
 		if (m_curCrossFadeSample == 0) {
+			m_counters.Count(TAN_STATS_COUNTER_CROSSFADES);
+
 			m_idxPrevFilter = m_idxFilter; // old filter needed for cross fade
 			m_idxFilter = (m_idxFilter + N_FILTER_STATES + 1) % N_FILTER_STATES; // new (updated) impulse response filter
 																				 //m_idxUpdateFilter = (m_idxUpdateFilter + N_FILTER_STATES + 1) % N_FILTER_STATES; // slot for next update
@@ -1312,8 +1423,6 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Process(
 	}
 	else if (m_doHeadTailXfade) //HEAD_TAIL_CROSS_FADE_STATE
 	{
-        PrintDebug("DoHeadTailXfade...");
-
 		// Only for the head-tail algorithm, crossfade process has started before and will finish when this step is over
 		m_doHeadTailXfade = false; // reset the flag
 		m_DelayedUpdate = false;
@@ -1334,10 +1443,7 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Process(
 	}
 	else //REGULAR_PROCESS_STATE;
     {
-        PrintDebug("REGULAR_PROCESS_STATE...");
-
         // wakeup update thread. New IR updates are allowed after the conv process completely done with crossfade
-        PrintDebug("1429 m_xFadeStarted.SetEvent()");
         m_xFadeStarted.SetEvent();
 
         ret = ProcessInternal(
@@ -1352,9 +1458,8 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::Process(
         //PrintReducedFloatArray("aft ProcessInternal0", pBufferOutput.GetHostBuffers()[0], samplesProcessed * sizeof(float));
         //PrintReducedFloatArray("aft ProcessInternal1", pBufferOutput.GetHostBuffers()[1], samplesProcessed * sizeof(float));
 
-        if (!m_bUseProcessFinalize)
+        if (!m_bUseProcessFinalize && !nuLadderSwitching())
 		{
-            PrintDebug("1442 m_procReadyForNewResponsesEvent.SetEvent()");
             m_procReadyForNewResponsesEvent.SetEvent();
         }
     }
@@ -1373,6 +1478,8 @@ ErrorHandling:
 
 AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::ProcessFinalize()
 {
+    TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_TAIL, TANTraceAllChannels, m_block);
+
     AMF_RESULT ret = AMF_OK;
     switch (m_eConvolutionMethod)
     {
@@ -1380,15 +1487,20 @@ AMF_RESULT  AMF_STD_CALL TANConvolutionImpl::ProcessFinalize()
     case TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM:
     {
 
-        if (m_CrossFading) {
-            // old data tail, new filter
-            ovlNUPProcessTail(m_nupFilterState[m_idxPrevFilter]);
+        if (!m_NULadder.empty()) {
+            ovlNULadderProcessTail();
+        }
+        else {
+            if (m_CrossFading) {
+                // old data tail, new filter
+                ovlNUPProcessTail(m_nupFilterState[m_idxPrevFilter]);
+            }
+            ovlNUPProcessTail(m_nupFilterState[m_idxFilter], m_CrossFading);
         }
-        ovlNUPProcessTail(m_nupFilterState[m_idxFilter], m_CrossFading);
 
-        if (!m_CrossFading)
+        // the ladder levels may still run the previous filter state
+        if (!m_CrossFading && !nuLadderSwitching())
         {
-            PrintDebug("1129 m_procReadyForNewResponsesEvent.SetEvent()");
             m_procReadyForNewResponsesEvent.SetEvent();
         }
     }
@@ -1478,6 +1590,9 @@ AMF_RESULT  TANConvolutionImpl::Init(
 
     AMFLock lock(&m_sect);
 
+    AMF_RETURN_IF_FAILED(ReadThreadScheduling());
+    AMF_RETURN_IF_FAILED(TANLockThreadMemory(m_threadScheduling));
+
 	AMF_RETURN_IF_FAILED(TANCreateMath(m_pContextTAN, &m_pMath, true));
 	AMF_RETURN_IF_FAILED(m_pMath->Init());
 
@@ -1573,6 +1688,23 @@ AMF_RESULT  TANConvolutionImpl::Init(
     GetProperty(TAN_OUTPUT_MEMORY_TYPE, &tmp);
     m_eOutputMemoryType = (AMF_MEMORY_TYPE)tmp;
 
+    // overlap-save keeps the input history instead of the output overlap,
+    // the layout of the data partitions depends on it so it's fixed at Init.
+    bool overlapSave = false;
+    GetProperty(TAN_CONVOLUTION_OVERLAP_SAVE, &overlapSave);
+    m_OverlapSave = overlapSave && !doProcessingOnGpu &&
+        (convolutionMethod == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM ||
+         convolutionMethod == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM);
+    m_OverlapSaveShiftedPartition = -1;
+
+    // the non uniform method runs on the partition ladder on CPU, see bestNULadderLevels
+    m_NULadderLevels = 0;
+    if (convolutionMethod == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM && !doProcessingOnGpu)
+    {
+        m_2ndBufSizeMultiple = 1;
+        m_NULadderLevels = bestNULadderLevels(responseLengthInSamples, bufferSizeInSamples);
+    }
+
     // Initialize TAN FFT objects.
     if (convolutionMethod == TAN_CONVOLUTION_METHOD_FFT_OVERLAP_ADD)
     {
@@ -1625,15 +1757,29 @@ AMF_RESULT  TANConvolutionImpl::Init(
     m_length = len;
     m_log2len = log2len;
 
+    // bake the GPU FFT plans now rather than on the first Process or filter update
+    if (convolutionMethod == TAN_CONVOLUTION_METHOD_FFT_OVERLAP_ADD)
+    {
+        AMF_RETURN_IF_FAILED(m_pUpdateTanFft->Prepare(TAN_FFT_TRANSFORM_DIRECTION_FORWARD, log2len, m_iChannels, 0));
+        AMF_RETURN_IF_FAILED(m_pTanFft->Prepare(TAN_FFT_TRANSFORM_DIRECTION_FORWARD, log2len, m_iChannels, 0));
+        AMF_RETURN_IF_FAILED(m_pTanFft->Prepare(TAN_FFT_TRANSFORM_DIRECTION_BACKWARD, log2len, m_iChannels, 0));
+    }
+
     AMF_RETURN_IF_FAILED(
         allocateBuffers()
         );
 
     m_initialized = true;
 
+    m_updThreadResult = AMF_OK;
     m_updThread.Init();
     m_updThread.Start();
 
+    // a thread that can't be scheduled as asked has stopped already
+    m_updThreadStarted.Lock();
+    m_initialized = m_updThreadResult == AMF_OK;
+    AMF_RETURN_IF_FAILED(m_updThreadResult, L"Failed to schedule the update thread");
+
 #ifdef USE_TAIL_THREAD
 	m_tailThread.Init();
 	m_tailThread.Start();
@@ -1696,36 +1842,11 @@ AMF_RESULT amf::TANConvolutionImpl::Flush(amf_uint32 filterStateId, amf_uint32 c
 	{
         m_FilterState[filterStateId].FlushOverlap(channelId);
 	}
-	else if (m_eConvolutionMethod == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM)
+	else if (m_eConvolutionMethod == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM ||
+		m_eConvolutionMethod == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM)
 	{
-		auto pFilterState = m_upFilterState[filterStateId];
-		float **overlap = pFilterState->m_Overlap;
-		memset(overlap[channelId], 0, m_length * sizeof(float));
-
-		int nParts = (1 << m_log2len) / (1 << m_log2bsz);
-
-		int BZ = 4; // buffer size scale factor
-		int EX = 0;
-		if (m_TransformType == TRANSFORMTYPE_FFTCOMPLEX) {
-			BZ = 4;
-			EX = 0;
-		}
-		else if (m_TransformType == TRANSFORMTYPE_FFTREAL) {
-			BZ = 2;
-			EX = PARTITION_PAD_FFTREAL;
-		}
-		else if (m_TransformType == TRANSFORMTYPE_FFTREAL_PLANAR) {
-			BZ = 2;
-			EX = PARTITION_PAD_FFTREAL_PLANAR;
-		}
-
-		int bufLen = 2 * (BZ * m_length + EX*nParts);
-		memset(pFilterState->m_DataPartitions[channelId], 0, sizeof(float)*bufLen);
-
-	}
-	else if (m_eConvolutionMethod == TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM)
-	{
-		auto pFilterState = m_upFilterState[filterStateId];
+		// both partitioned methods run on the non uniform state, see allocateBuffers
+		auto pFilterState = m_nupFilterState[filterStateId];
 		float **overlap = pFilterState->m_Overlap;
 		memset(overlap[channelId], 0, m_length * sizeof(float));
 
@@ -1737,6 +1858,14 @@ AMF_RESULT amf::TANConvolutionImpl::Flush(amf_uint32 filterStateId, amf_uint32 c
 
 		int bufLen = 2 * (BZ * m_length + EX*nParts);
 		memset(pFilterState->m_DataPartitions[channelId], 0, sizeof(float)*bufLen);
+
+		// the overlap-save input history lives in the sub partitions
+		int partLen = m_2ndBufSizeMultiple*(1 << (m_log2bsz + 1)) + EX;
+		memset(pFilterState->m_SubPartitions[channelId], 0, sizeof(float)*partLen);
+
+		if (!m_NULadder.empty()) {
+			flushNULadder(channelId);
+		}
 	}
 	else if (m_eConvolutionMethod == TAN_CONVOLUTION_METHOD_TIME_DOMAIN)
 	{
@@ -1778,7 +1907,7 @@ AMF_RESULT AMF_FAST_CALL TANConvolutionImpl::Crossfade(
 	int fadeLength
 )
 {
-    PrintDebug(__FUNCTION__);
+    TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_CROSSFADE, TANTraceAllChannels, m_block);
 
     //auto crossfadeQueue = m_pContextTAN->GetGeneralQueue(); //todo: think about reason, kernel was created with general queue?
     auto crossfadeQueue = m_pContextTAN->GetConvQueue();
@@ -1855,6 +1984,7 @@ AMF_RESULT AMF_FAST_CALL TANConvolutionImpl::Crossfade(
 		float step = 1.0 / float(fadeLength);
 		for (int n = 0; n < m_iChannels; n++) {
 			if (!m_availableChannels[n]){ // !available == running
+                TAN_TRACE_STAGE(TAN_TRACE_STAGE_CROSSFADE, n, m_block);
                 float *pFltOut = pBufferOutput.GetHostBuffers()[n];
                 float *pFltFade = m_pXFadeSamples.GetHostBuffers()[n];
 				int j = curFadeSample;
@@ -2142,6 +2272,12 @@ AMF_RESULT TANConvolutionImpl::allocateBuffers()
 
 		int bufLen = 2 * (BZ * m_length + EX*nParts);
 
+		// the partition ladder keeps all level spectra in the filter buffers
+		if (m_NULadderLevels > 0 && !m_doProcessOnGpu) {
+			AMF_RETURN_IF_FAILED(buildNULadder());
+			bufLen = std::max(bufLen, static_cast<int>(m_NULadderFilterLength));
+		}
+
 		m_FilterTD = new float *[m_iChannels];
 
 		for (int n = 0; n < m_iChannels; n++) {
@@ -2532,6 +2668,8 @@ AMF_RESULT TANConvolutionImpl::deallocateBuffers()
 		m_ovlAddLocalInBuffs.clear();
 		m_ovlAddLocalOutBuffs.clear();
 
+		releaseNULadder();
+
 		SAFE_ARR_DELETE(m_FilterTD);
 		SAFE_ARR_DELETE(m_nupFilterState[0]->m_DataPartitions);
 		SAFE_ARR_DELETE(m_nupFilterState[0]->m_SubPartitions);
@@ -2577,15 +2715,15 @@ AMF_RESULT TANConvolutionImpl::deallocateBuffers()
 
 void TANConvolutionImpl::TailThreadProc(AMFThread *pThread)
 {
-	// ToDo legacy - fix this
-	//m_tailThreadHandle = GetCurrentThread();
-	//int tId = GetThreadId(m_tailThreadHandle);
-	//tId = GetCurrentThreadId();
-	//SetThreadPriority(m_tailThreadHandle, THREAD_PRIORITY_TIME_CRITICAL);
+    const AMF_RESULT scheduled = TANApplyThreadScheduling(m_threadScheduling);
+
+    if (scheduled != AMF_OK)
+    {
+        AMFTraceError(AMF_FACILITY, L"Failed to schedule the tail thread, error %d", int(scheduled));
+    }
 
 	do {
 		// Wait for the time to start processing.
-        PrintDebug("2730 m_TailDoneEvent.SetEvent()");
 		m_TailDoneEvent.SetEvent();
 
 		m_runTailEvent.Lock();
@@ -2612,17 +2750,18 @@ void TANConvolutionImpl::TailThreadProc(AMFThread *pThread)
 
 void TANConvolutionImpl::UpdateThreadProc(AMFThread *pThread)
 {
-    //todo: legacy debug code?
-    //m_updThreadHandle = GetCurrentThread();
-    //int tId = GetThreadId(m_updThreadHandle);
-    //tId = GetCurrentThreadId();
+    m_updThreadResult = TANApplyThreadScheduling(m_threadScheduling);
+    m_updThreadStarted.SetEvent();
+
+    if (m_updThreadResult != AMF_OK)
+    {
+        return;
+    }
 
     do
     {
-        PrintDebug("2766 m_procReadyForNewResponsesEvent.Lock()... .SetEvent()");
         // Wait for the time to start processing.
         m_procReadyForNewResponsesEvent.Lock();
-        PrintDebug("2769 m_procReadyForNewResponsesEvent.Locked() .SetEvent()");
 
         //hack
         if (pThread->StopRequested()) {
@@ -2643,6 +2782,9 @@ void TANConvolutionImpl::UpdateThreadProc(AMFThread *pThread)
             m_accumulatedArgs.Clear(m_iChannels);
         }
 
+        m_update++;
+        TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_IR_UPDATE, TANTraceAllChannels, m_update);
+
         // Start processing.
         AMF_RESULT ret = AMF_OK;
         switch (m_eConvolutionMethod) {
@@ -2764,34 +2906,57 @@ void TANConvolutionImpl::UpdateThreadProc(AMFThread *pThread)
 
 
 				int iBuffSizeNU = m_iBufferSizeInSamples*m_2ndBufSizeMultiple;
-				// expand filter
-				for (int i = nParts - 1; i >= 0; i--) {
-					float *pIn;
-					float *pOut;
-					for (int chan = 0; chan < m_iChannels; chan++) {
-						pIn = filter[chan] + i *  iBuffSizeNU;
-						pOut = filter[chan] + i * (2 * iBuffSizeNU + pad);
-						memcpy(pOut, pIn, sizeof(float) * iBuffSizeNU);
-						memset(pOut + iBuffSizeNU, 0, sizeof(float) * (pad + iBuffSizeNU));
 
+				if (!m_NULadder.empty()) {
+					// partition ladder, transform every partition of every level, see buildNULadder
+					for (const nuLadderLevel &level : m_NULadder) {
+						for (int i = 0; i < level.m_Partitions; i++) {
+							const int first = level.m_FirstSample + i * level.m_PartitionSize;
+							const int count = std::max(0, std::min(level.m_PartitionSize, m_length - first));
+
+							for (int chan = 0; chan < m_iChannels; chan++) {
+								filterParts[chan] = filter[chan] + level.m_FilterOffset + i * level.m_Stride;
+								memcpy(filterParts[chan], m_FilterTD[chan] + first, sizeof(float) * count);
+								memset(filterParts[chan] + count, 0, sizeof(float) * (level.m_Stride - count));
+							}
+
+							RETURN_IF_FAILED(ret = m_pUpdateTanFft->Transform(
+								fwdDir,
+								level.m_Log2FFTLen, m_iChannels,
+								filterParts, filterParts));
+						}
 					}
 				}
+				else {
+					// expand filter
+					for (int i = nParts - 1; i >= 0; i--) {
+						float *pIn;
+						float *pOut;
+						for (int chan = 0; chan < m_iChannels; chan++) {
+							pIn = filter[chan] + i *  iBuffSizeNU;
+							pOut = filter[chan] + i * (2 * iBuffSizeNU + pad);
+							memcpy(pOut, pIn, sizeof(float) * iBuffSizeNU);
+							memset(pOut + iBuffSizeNU, 0, sizeof(float) * (pad + iBuffSizeNU));
 
-				for (int i = 0; i < nParts; i++) {
-					for (int chan = 0; chan < m_iChannels; chan++) {
-						filterParts[chan] = filter[chan] + i * (2 * iBuffSizeNU + pad);
+						}
 					}
 
-					int log2FFTLen = m_log2bsz;
-					for (int n = m_2ndBufSizeMultiple; n > 0; n = n / 2) {
-						++log2FFTLen;
-					}
+					for (int i = 0; i < nParts; i++) {
+						for (int chan = 0; chan < m_iChannels; chan++) {
+							filterParts[chan] = filter[chan] + i * (2 * iBuffSizeNU + pad);
+						}
+
+						int log2FFTLen = m_log2bsz;
+						for (int n = m_2ndBufSizeMultiple; n > 0; n = n / 2) {
+							++log2FFTLen;
+						}
 
-					RETURN_IF_FAILED(ret = m_pUpdateTanFft->Transform(
-						fwdDir,
-						log2FFTLen, m_iChannels,
-						filterParts, filterParts));
+						RETURN_IF_FAILED(ret = m_pUpdateTanFft->Transform(
+							fwdDir,
+							log2FFTLen, m_iChannels,
+							filterParts, filterParts));
 
+					}
 				}
 
 				delete [] filterParts; //
@@ -2804,9 +2969,11 @@ void TANConvolutionImpl::UpdateThreadProc(AMFThread *pThread)
 				float **const ppOldOverlap =
 					((_ovlUniformPartitionFilterState *)m_nupFilterState[m_idxFilter])->m_Overlap;
 
+				// the ladder spectra are longer than the response
+				const amf_size filterLength = m_NULadder.empty() ? m_length : m_NULadderFilterLength;
 				for (amf_uint32 argId = 0; argId < m_copyArgs.updatesCnt; argId++) {
 					const amf_uint32 channelId = m_copyArgs.channels[argId];
-					memcpy(filter[channelId], ppOldFilter[channelId], m_length * sizeof(float));
+					memcpy(filter[channelId], ppOldFilter[channelId], filterLength * sizeof(float));
 					memcpy(overlap[channelId], ppOldOverlap[channelId], m_length * sizeof(float));
 				}
 
@@ -2858,14 +3025,14 @@ void TANConvolutionImpl::UpdateThreadProc(AMFThread *pThread)
                 RETURN_IF_FALSE(false, ret, AMF_NOT_IMPLEMENTED);
         }
 
-        PrintDebug("3005 m_updateFinishedProcessing.SetEvent()");
+        m_counters.Count(TAN_STATS_COUNTER_IR_UPDATES);
+
         m_updateFinishedProcessing.SetEvent();
 
         continue;
 
 ErrorHandling:
 
-        PrintDebug("3006 m_updateFinishedProcessing.SetEvent()");
         m_updateFinishedProcessing.SetEvent();
 
     } while (!pThread->StopRequested());
@@ -2968,30 +3135,48 @@ AMF_RESULT TANConvolutionImpl::ovlAddProcess(
             );
     }
 
-    AMF_RETURN_IF_FAILED(
-        m_pTanFft->Transform(
-            TAN_FFT_TRANSFORM_DIRECTION_FORWARD,
-            m_log2len,
-            m_iChannels,
-            m_OutSamples,
-            m_OutSamples
-            )
-        );
+    // only the input block is non-zero, the overlap is needed only when advancing
+    {
+        TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_INPUT_FFT, TANTraceAllChannels, m_block);
+
+        AMF_RETURN_IF_FAILED(
+            m_pTanFft->TransformPruned(
+                TAN_FFT_TRANSFORM_DIRECTION_FORWARD,
+                m_log2len,
+                m_iChannels,
+                m_OutSamples,
+                m_OutSamples,
+                static_cast<amf_uint32>(nSamples),
+                0
+                )
+            );
+    }
 
-    for (amf_uint32 iChan = 0; iChan < n_channels; iChan++)
     {
-        VectorComplexMul(m_OutSamples[iChan], filter[iChan], m_OutSamples[iChan], m_length);
+        TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_MAC, TANTraceAllChannels, m_block);
+
+        for (amf_uint32 iChan = 0; iChan < n_channels; iChan++)
+        {
+            TAN_TRACE_STAGE(TAN_TRACE_STAGE_MAC, iChan, m_block);
+            VectorComplexMul(m_OutSamples[iChan], filter[iChan], m_OutSamples[iChan], m_length);
+        }
     }
 
-    AMF_RETURN_IF_FAILED(
-        m_pTanFft->Transform(
-            TAN_FFT_TRANSFORM_DIRECTION_BACKWARD,
-            m_log2len,
-            m_iChannels,
-            m_OutSamples,
-            m_OutSamples
-            )
-        );
+    {
+        TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_IFFT, TANTraceAllChannels, m_block);
+
+        AMF_RETURN_IF_FAILED(
+            m_pTanFft->TransformPruned(
+                TAN_FFT_TRANSFORM_DIRECTION_BACKWARD,
+                m_log2len,
+                m_iChannels,
+                m_OutSamples,
+                m_OutSamples,
+                0,
+                static_cast<amf_uint32>(advanceOverlap ? m_length : nSamples)
+                )
+            );
+    }
 
     for(amf_uint32 iChannel = 0; iChannel < n_channels; iChannel++)
     {
@@ -3144,6 +3329,10 @@ amf_size TANConvolutionImpl::ovlNUPProcessCPU(
         output = outputExpanded.data();
 	}
 
+	if (!m_NULadder.empty()) {
+		return ovlNULadderProcessCPU(state, inputData, output, nSamples, n_channels, advanceOverlap);
+	}
+
     //PrintReducedFloatArray("ovlNU in0", inputData.GetHostBuffers()[0], nSamples * sizeof(float));
     //PrintReducedFloatArray("ovlNU in1", inputData.GetHostBuffers()[1], nSamples * sizeof(float));
 
@@ -3179,6 +3368,14 @@ amf_size TANConvolutionImpl::ovlNUPProcessCPU(
 	}
 
 	m_2ndBufCurrentSubBuf = (m_2ndBufSizeMultiple*nParts - curPart - 1) % m_2ndBufSizeMultiple;
+
+	// the crossfade runs the same block twice, the input history may only move once per block:
+	bool shiftHistory = false;
+	if (m_OverlapSave && m_2ndBufCurrentSubBuf == 0 && m_OverlapSaveShiftedPartition != curPart) {
+		shiftHistory = true;
+		m_OverlapSaveShiftedPartition = curPart;
+	}
+
 	curPart = curPart / m_2ndBufSizeMultiple;
 
 	int log2FFTLen = m_log2bsz;
@@ -3218,7 +3415,15 @@ amf_size TANConvolutionImpl::ovlNUPProcessCPU(
 		memset(dataParts[iChan], 0, sizeof(float) * (2 * m_iBufferSizeInSamples + pad));
 		//memcpy(dataParts[iChan], inputData.GetHostBuffers()[iChan], nSamples * sizeof(float));
 
-		if (m_2ndBufCurrentSubBuf == 0)
+		if (m_OverlapSave) {
+			// overlap-save frame is [current block | previous block], so that the valid
+			// half of the circular convolution lands at the start of the output
+			if (shiftHistory) {
+				memcpy(subParts[iChan] + iBuffSizeNU, subParts[iChan], sizeof(float) * iBuffSizeNU);
+				memset(subParts[iChan], 0, sizeof(float) * iBuffSizeNU);
+			}
+		}
+		else if (m_2ndBufCurrentSubBuf == 0)
 			memset(subParts[iChan], 0, sizeof(float) * (2 * iBuffSizeNU + pad));
 
 		//// need another buffer to accumulate m_2ndBufSizeMultiple sub bufs....
@@ -3234,25 +3439,49 @@ amf_size TANConvolutionImpl::ovlNUPProcessCPU(
     //PrintReducedFloatArray("ovlNU outSamples0", outSamples[0], nSamples * sizeof(float));
     //PrintReducedFloatArray("ovlNU outSamples1", outSamples[1], nSamples * sizeof(float));
 
+	// sub buffers past the current one are still zero, as is the second half of the frame:
+	const amf_uint32 nonZeroSamples = static_cast<amf_uint32>((m_2ndBufCurrentSubBuf + 1) * nSamples);
+
 	// transform real data to complex:
-	AMF_RETURN_IF_FAILED(m_pTanFft->Transform(fwdDir, log2FFTLen, n_channels,
-		dataParts, dataParts));
+	{
+		TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_INPUT_FFT, TANTraceAllChannels, m_block);
+		AMF_RETURN_IF_FAILED(m_pTanFft->TransformPruned(fwdDir, log2FFTLen, n_channels,
+			dataParts, dataParts, m_OverlapSave ? 0 : nonZeroSamples, 0));
+	}
 
-	switch (m_TransformType) {
-	case TRANSFORMTYPE_FFTREAL_PLANAR:
-		m_pMath->PlanarComplexMultiplyAccumulate(dataParts, filterParts, outSamples, n_channels, iBuffSizeNU + 8, iBuffSizeNU + 8);
-		break;
-	case TRANSFORMTYPE_FFTREAL:
+	{
+		TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_MAC, TANTraceAllChannels, m_block);
 #ifdef USE_IPP
-		m_pMath->IPPComplexMultiplyAccumulate(dataParts, filterParts, outSamples, workBuffer, n_channels, iBuffSizeNU);
-#else
-		m_pMath->ComplexMultiplyAccumulate(dataParts, filterParts, outSamples, n_channels, iBuffSizeNU + pad);
+		if (m_TransformType == TRANSFORMTYPE_FFTREAL) {
+			m_pMath->IPPComplexMultiplyAccumulate(dataParts, filterParts, outSamples, workBuffer, n_channels, iBuffSizeNU);
+		}
+		else
 #endif
-		break;
+		{
+			const TANComplexLayout layout = spectrumLayout(iBuffSizeNU);
+			m_pMath->ComplexMultiplyAccumulate(dataParts, layout, filterParts, layout, outSamples, layout, n_channels, iBuffSizeNU + 1);
+		}
 	}
 
-	AMF_RETURN_IF_FAILED(m_pTanFft->Transform(bwdDir, log2FFTLen, n_channels,
-		outSamples, outSamples));
+	// the overlap is taken from the last sub buffer only, earlier ones need the current slice,
+	// overlap-save discards everything past the current slice:
+	const amf_uint32 requiredSamples = (!m_OverlapSave && m_2ndBufCurrentSubBuf == (m_2ndBufSizeMultiple - 1))
+		? static_cast<amf_uint32>(2 * iBuffSizeNU)
+		: nonZeroSamples;
+
+	{
+		TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_IFFT, TANTraceAllChannels, m_block);
+		AMF_RETURN_IF_FAILED(m_pTanFft->TransformPruned(bwdDir, log2FFTLen, n_channels,
+			outSamples, outSamples, 0, requiredSamples));
+	}
+
+	if (m_OverlapSave) {
+		for (amf_uint32 iChan = 0; iChan < n_channels; iChan++) {
+			memcpy(output[iChan], outSamples[iChan] + m_2ndBufCurrentSubBuf*nSamples, nSamples * sizeof(float));
+		}
+
+		return nSamples;
+	}
 
 	for (amf_uint32 iChan = 0; iChan < n_channels; iChan++) {
 		for (int i = 0; i < nSamples; i++) {
@@ -3367,17 +3596,15 @@ int TANConvolutionImpl::ovlNUPProcessTail(_ovlNonUniformPartitionFilterState *st
 		//#else
 		//		m_pMath->PlanarComplexMultiplyAccumulate(dataParts, filterParts, m_NUTailAccumulator, n_channels, iBuffSizeNU + 8, iBuffSizeNU + 8);
 		//#endif
-		switch (m_TransformType) {
-		case TRANSFORMTYPE_FFTREAL_PLANAR:
-			m_pMath->PlanarComplexMultiplyAccumulate(dataParts, filterParts, m_NUTailAccumulator, n_channels, iBuffSizeNU + 8, iBuffSizeNU + 8);
-			break;
-		case TRANSFORMTYPE_FFTREAL:
 #ifdef USE_IPP
+		if (m_TransformType == TRANSFORMTYPE_FFTREAL) {
 			m_pMath->IPPComplexMultiplyAccumulate(dataParts, filterParts, m_NUTailAccumulator, state->m_workBuffer, n_channels, iBuffSizeNU + 8);
-#else
-			m_pMath->ComplexMultiplyAccumulate(dataParts, filterParts, m_NUTailAccumulator, n_channels, iBuffSizeNU + pad);
+		}
+		else
 #endif
-			break;
+		{
+			const TANComplexLayout layout = spectrumLayout(iBuffSizeNU);
+			m_pMath->ComplexMultiplyAccumulate(dataParts, layout, filterParts, layout, m_NUTailAccumulator, layout, n_channels, iBuffSizeNU + 1);
 		}
 
 
@@ -3405,6 +3632,538 @@ int TANConvolutionImpl::ovlNUPProcessTail(_ovlNonUniformPartitionFilterState *st
 
 
 
+static float **NULadderAlloc(amf_uint32 channels, amf_size length)
+{
+	float **buffers = new float *[channels];
+	for (amf_uint32 n = 0; n < channels; n++) {
+		buffers[n] = (float *)_mm_malloc(length * sizeof(float), 32);
+		memset(buffers[n], 0, length * sizeof(float));
+	}
+	return buffers;
+}
+
+static void NULadderFree(float **&buffers, amf_uint32 channels)
+{
+	if (buffers == nullptr)
+		return;
+	for (amf_uint32 n = 0; n < channels; n++) {
+		_mm_free(buffers[n]);
+	}
+	SAFE_ARR_DELETE(buffers);
+}
+
+// Lays out the partition ladder, see NULadderSpan. The level spectra are stored one level after
+// the other in the filter buffers of the non uniform filter states.
+AMF_RESULT TANConvolutionImpl::buildNULadder()
+{
+	releaseNULadder();
+
+	// the ladder runs on real transforms only
+	if (m_TransformType != TRANSFORMTYPE_FFTREAL) {
+		m_TransformType = TRANSFORMTYPE_FFTREAL_PLANAR;
+	}
+	const int pad = (m_TransformType == TRANSFORMTYPE_FFTREAL) ? PARTITION_PAD_FFTREAL : PARTITION_PAD_FFTREAL_PLANAR;
+
+	m_NULadder.resize(m_NULadderLevels);
+	m_NULadderFilterLength = 0;
+	int maxStride = 0;
+
+	for (int l = 0; l < m_NULadderLevels; ++l) {
+		nuLadderLevel &level = m_NULadder[l];
+
+		int first = 0, end = 0;
+		NULadderSpan(l, m_NULadderLevels, int(m_iLengthInSamples), int(m_iBufferSizeInSamples), first, end);
+
+		level.m_PartitionSize = int(m_iBufferSizeInSamples) << (NU_LADDER_GROWTH_LOG2 * l);
+		level.m_Log2FFTLen = m_log2bsz + 1 + NU_LADDER_GROWTH_LOG2 * l;
+		level.m_Stride = (1 << level.m_Log2FFTLen) + pad;
+		level.m_Blocks = 1 << (NU_LADDER_GROWTH_LOG2 * l);
+		level.m_Partitions = std::max(1, (end - first + level.m_PartitionSize - 1) / level.m_PartitionSize);
+		level.m_FirstSample = first;
+		level.m_FilterOffset = m_NULadderFilterLength;
+		level.m_Head = 0;
+		level.m_Filter = m_idxFilter;
+		level.m_FadeFilter = -1;
+		level.m_FadePeriods = 0;
+		level.m_OutputFades = false;
+
+		AMF_RETURN_IF_FALSE(level.m_Log2FFTLen < MAX_CACHE_POWER, AMF_INVALID_ARG, L"partition ladder is too deep");
+
+		m_NULadderFilterLength += amf_size(level.m_Partitions) * level.m_Stride;
+		maxStride = std::max(maxStride, level.m_Stride);
+
+		level.m_Input = NULadderAlloc(m_iChannels, level.m_Stride);
+		level.m_Spectra = NULadderAlloc(m_iChannels, amf_size(level.m_Partitions) * level.m_Stride);
+		level.m_Accumulator = NULadderAlloc(m_iChannels, level.m_Stride);
+		level.m_Overlap = NULadderAlloc(m_iChannels, level.m_PartitionSize);
+		if (l > 0) {
+			level.m_Output = NULadderAlloc(m_iChannels, level.m_PartitionSize);
+			level.m_FadeAccumulator = NULadderAlloc(m_iChannels, level.m_Stride);
+			level.m_FadeOutput = NULadderAlloc(m_iChannels, level.m_PartitionSize);
+			level.m_FadeOverlap = NULadderAlloc(m_iChannels, level.m_PartitionSize);
+		}
+	}
+
+	// Level l transforms on the blocks b with (b + phase + 2) % blocks < 2. The transforms of
+	// the levels below repeat every blocks / 4 blocks, so a shift below that meets all of them:
+	// take the one that meets the least transform work.
+	std::vector<double> load(1, 0.0);
+	for (int l = 1; l < m_NULadderLevels; ++l) {
+		nuLadderLevel &level = m_NULadder[l];
+		const int lower = static_cast<int>(load.size());
+		const double transform = double(amf_size(1) << level.m_Log2FFTLen) * level.m_Log2FFTLen;
+
+		double least = std::numeric_limits<double>::max();
+		for (int phase = 0; phase < lower; ++phase) {
+			const int inverse = (level.m_Blocks - 2 - phase) % lower;
+			const double met = std::max(load[inverse], load[(inverse + 1) % lower]);
+			if (met < least) {
+				least = met;
+				level.m_Phase = phase;
+			}
+		}
+
+		std::vector<double> periodLoad(level.m_Blocks);
+		for (int b = 0; b < level.m_Blocks; ++b) {
+			periodLoad[b] = load[b % lower];
+		}
+		periodLoad[level.m_Blocks - 2 - level.m_Phase] += transform;
+		periodLoad[level.m_Blocks - 1 - level.m_Phase] += transform;
+		load.swap(periodLoad);
+	}
+
+	m_NULadderTail = NULadderAlloc(m_iChannels, m_iBufferSizeInSamples);
+	m_NULadderWork = NULadderAlloc(m_iChannels, maxStride);
+
+	m_NULadderChannels.assign(m_iChannels, 0);
+	m_NULadderData.assign(m_iChannels, nullptr);
+	m_NULadderFilter.assign(m_iChannels, nullptr);
+	m_NULadderAccum.assign(m_iChannels, nullptr);
+
+	m_NULadderRunning = 0;
+	m_NULadderBlock = -1;
+	m_NULadderBlockConsumed = false;
+	m_NULadderStepsDone = true;
+
+	return AMF_OK;
+}
+
+void TANConvolutionImpl::releaseNULadder()
+{
+	const amf_uint32 channels = static_cast<amf_uint32>(m_NULadderChannels.size());
+
+	for (nuLadderLevel &level : m_NULadder) {
+		NULadderFree(level.m_Input, channels);
+		NULadderFree(level.m_Spectra, channels);
+		NULadderFree(level.m_Accumulator, channels);
+		NULadderFree(level.m_Output, channels);
+		NULadderFree(level.m_Overlap, channels);
+		NULadderFree(level.m_FadeAccumulator, channels);
+		NULadderFree(level.m_FadeOutput, channels);
+		NULadderFree(level.m_FadeOverlap, channels);
+	}
+	m_NULadder.clear();
+
+	NULadderFree(m_NULadderTail, channels);
+	NULadderFree(m_NULadderWork, channels);
+
+	m_NULadderChannels.clear();
+	m_NULadderFilterLength = 0;
+}
+
+void TANConvolutionImpl::flushNULadder(amf_uint32 channelId)
+{
+	for (nuLadderLevel &level : m_NULadder) {
+		memset(level.m_Input[channelId], 0, level.m_Stride * sizeof(float));
+		memset(level.m_Spectra[channelId], 0, amf_size(level.m_Partitions) * level.m_Stride * sizeof(float));
+		memset(level.m_Accumulator[channelId], 0, level.m_Stride * sizeof(float));
+		memset(level.m_Overlap[channelId], 0, level.m_PartitionSize * sizeof(float));
+		if (level.m_Output) {
+			memset(level.m_Output[channelId], 0, level.m_PartitionSize * sizeof(float));
+			memset(level.m_FadeAccumulator[channelId], 0, level.m_Stride * sizeof(float));
+			memset(level.m_FadeOutput[channelId], 0, level.m_PartitionSize * sizeof(float));
+			memset(level.m_FadeOverlap[channelId], 0, level.m_PartitionSize * sizeof(float));
+		}
+	}
+	memset(m_NULadderTail[channelId], 0, m_iBufferSizeInSamples * sizeof(float));
+}
+
+bool TANConvolutionImpl::nuLadderSwitching() const
+{
+	for (size_t l = 1; l < m_NULadder.size(); ++l) {
+		if (m_NULadder[l].m_Filter != m_idxFilter || m_NULadder[l].m_FadeFilter >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+TANComplexLayout TANConvolutionImpl::spectrumLayout(amf_size halfLength)
+{
+	amf_uint32 log2FFTLen = 1;
+	while ((amf_size(1) << log2FFTLen) < 2 * halfLength) {
+		++log2FFTLen;
+	}
+
+	return m_pTanFft->GetComplexLayout(
+		m_TransformType == TRANSFORMTYPE_FFTREAL_PLANAR
+			? TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD
+			: TAN_FFT_R2C_TRANSFORM_DIRECTION_FORWARD,
+		log2FFTLen);
+}
+
+AMF_RESULT TANConvolutionImpl::nuLadderMultiplyAccumulate(
+	const nuLadderLevel &   level,
+	float **                data,
+	float **                filter,
+	float **                accum,
+	amf_uint32              n_channels
+)
+{
+	const amf_size halfLength = amf_size(1) << (level.m_Log2FFTLen - 1);
+
+#ifdef USE_IPP
+	if (m_TransformType == TRANSFORMTYPE_FFTREAL) {
+		return m_pMath->IPPComplexMultiplyAccumulate(data, filter, accum, m_NULadderWork, n_channels, 2 * halfLength);
+	}
+#endif
+
+	const TANComplexLayout layout = spectrumLayout(halfLength);
+	return m_pMath->ComplexMultiplyAccumulate(data, layout, filter, layout, accum, layout, n_channels, halfLength + 1);
+}
+
+// non uniform partition ladder, on CPU
+// Level 0 is convolved with the filter of the call, the levels > 0 only add the output they
+// computed during the previous blocks, their work runs in ovlNULadderProcessTail().
+
+amf_size TANConvolutionImpl::ovlNULadderProcessCPU(
+	ovlNonUniformPartitionFilterState * state,
+	const TANSampleBuffer &             inputData,
+	float * const *                     output,
+	amf_size                            nSamples,
+	amf_uint32                          n_channels,
+	bool                                advanceOverlap
+)
+{
+	m_nupTailState = state;
+
+	// we process in bufSize blocks
+	if (nSamples < m_iBufferSizeInSamples)
+		return 0;
+	// use fixed overlap size:
+	nSamples = m_iBufferSizeInSamples;
+	const int blockSize = static_cast<int>(nSamples);
+
+	float * const * input = inputData.GetHostBuffers();
+	nuLadderLevel &head = m_NULadder[0];
+	const int fftLength = 1 << head.m_Log2FFTLen;
+
+	TAN_FFT_TRANSFORM_DIRECTION fwdDir = TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD;
+	TAN_FFT_TRANSFORM_DIRECTION bwdDir = TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD;
+	if (m_TransformType == TRANSFORMTYPE_FFTREAL) {
+		fwdDir = TAN_FFT_R2C_TRANSFORM_DIRECTION_FORWARD;
+		bwdDir = TAN_FFT_C2R_TRANSFORM_DIRECTION_BACKWARD;
+	}
+
+	// the crossfade runs the same block twice, the input may only be taken once per block:
+	if (!m_NULadderBlockConsumed) {
+		m_NULadderBlockConsumed = true;
+		m_NULadderStepsDone = false;
+		++m_NULadderBlock;
+
+		// running channels are packed in the internal buffers, see ProcessInternal
+		m_NULadderRunning = 0;
+		for (amf_uint32 channelId = 0; channelId < m_iChannels && m_NULadderRunning < n_channels; channelId++) {
+			if (!m_availableChannels[channelId]) {
+				m_NULadderChannels[m_NULadderRunning++] = channelId;
+			}
+		}
+		if (m_NULadderRunning == 0) {
+			return nSamples;
+		}
+
+		for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+			const int channelId = m_NULadderChannels[i];
+
+			// level 0 frame is [current | 0] for overlap-add and [current | 0 | previous] for
+			// overlap-save, so that the valid part of the circular convolution comes first
+			float *frame = head.m_Input[channelId];
+			if (m_OverlapSave) {
+				memcpy(frame + fftLength - blockSize, frame, blockSize * sizeof(float));
+			}
+			memcpy(frame, input[i], blockSize * sizeof(float));
+
+			// the other levels collect P / B blocks before they transform
+			for (size_t l = 1; l < m_NULadder.size(); ++l) {
+				nuLadderLevel &level = m_NULadder[l];
+				const int position = static_cast<int>((m_NULadderBlock + level.m_Phase) % level.m_Blocks);
+				memcpy(level.m_Input[channelId] + position * blockSize, input[i], blockSize * sizeof(float));
+			}
+
+			// levels > 0 output, the period started after the last inverse transform
+			float *tail = m_NULadderTail[channelId];
+			memset(tail, 0, blockSize * sizeof(float));
+			for (size_t l = 1; l < m_NULadder.size(); ++l) {
+				nuLadderLevel &level = m_NULadder[l];
+				const int position = static_cast<int>((m_NULadderBlock + level.m_Phase + 1) % level.m_Blocks);
+				const float *levelOutput = level.m_Output[channelId] + position * blockSize;
+				if (!level.m_OutputFades) {
+					for (int n = 0; n < blockSize; n++) {
+						tail[n] += levelOutput[n];
+					}
+					continue;
+				}
+
+				// fade from the previous filter over the period, as Crossfade()
+				const float *fadeOutput = level.m_FadeOutput[channelId] + position * blockSize;
+				const float step = 1.0f / float(level.m_PartitionSize);
+				int j = position * blockSize;
+				for (int n = 0; n < blockSize; n++, j++) {
+					const float w1 = step * j;
+					const float w2 = step * (level.m_PartitionSize - j);
+					tail[n] += levelOutput[n] * w1 + fadeOutput[n] * w2;
+				}
+			}
+
+		}
+
+		head.m_Head = (head.m_Head + 1) % head.m_Partitions;
+		for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+			const int channelId = m_NULadderChannels[i];
+			m_NULadderData[i] = head.m_Spectra[channelId] + head.m_Head * head.m_Stride;
+			memcpy(m_NULadderData[i], head.m_Input[channelId], fftLength * sizeof(float));
+		}
+
+		TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_INPUT_FFT, TANTraceAllChannels, m_block);
+		AMF_RETURN_IF_FAILED(m_pTanFft->TransformPruned(fwdDir, head.m_Log2FFTLen, m_NULadderRunning,
+			m_NULadderData.data(), m_NULadderData.data(), m_OverlapSave ? 0 : blockSize, 0));
+	}
+
+	if (m_NULadderRunning == 0) {
+		return nSamples;
+	}
+
+	for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+		m_NULadderAccum[i] = head.m_Accumulator[m_NULadderChannels[i]];
+		memset(m_NULadderAccum[i], 0, head.m_Stride * sizeof(float));
+	}
+
+	{
+		TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_MAC, TANTraceAllChannels, m_block);
+		for (int j = 0; j < head.m_Partitions; ++j) {
+			const int slot = (head.m_Head - j + head.m_Partitions) % head.m_Partitions;
+			for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+				const int channelId = m_NULadderChannels[i];
+				m_NULadderData[i] = head.m_Spectra[channelId] + slot * head.m_Stride;
+				m_NULadderFilter[i] = state->m_Filter[channelId] + head.m_FilterOffset + j * head.m_Stride;
+			}
+			AMF_RETURN_IF_FAILED(nuLadderMultiplyAccumulate(head, m_NULadderData.data(), m_NULadderFilter.data(),
+				m_NULadderAccum.data(), m_NULadderRunning));
+		}
+	}
+
+	{
+		TAN_TIME_STAGE(m_counters, TAN_TRACE_STAGE_IFFT, TANTraceAllChannels, m_block);
+		AMF_RETURN_IF_FAILED(m_pTanFft->TransformPruned(bwdDir, head.m_Log2FFTLen, m_NULadderRunning,
+			m_NULadderAccum.data(), m_NULadderAccum.data(), 0, m_OverlapSave ? blockSize : 2 * blockSize));
+	}
+
+	for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+		const int channelId = m_NULadderChannels[i];
+		const float *accum = m_NULadderAccum[i];
+		const float *tail = m_NULadderTail[channelId];
+		float *overlap = head.m_Overlap[channelId];
+
+		if (m_OverlapSave) {
+			for (int n = 0; n < blockSize; n++) {
+				output[i][n] = accum[n] + tail[n];
+			}
+			continue;
+		}
+
+		for (int n = 0; n < blockSize; n++) {
+			output[i][n] = accum[n] + overlap[n] + tail[n];
+		}
+		if (advanceOverlap) {
+			memcpy(overlap, accum + blockSize, blockSize * sizeof(float));
+		}
+	}
+
+	return nSamples;
+}
+
+// Runs the work of the ladder levels > 0 due on the current block, once per block. A period
+// of P / B blocks starts with the forward transform of the input collected in the previous
+// period, spreads the multiply accumulates over the blocks in the middle and ends with the
+// inverse transform that gives the output of the next period. A level takes a new response
+// at the start of a period only, so that all partitions of a period use the same one.
+int TANConvolutionImpl::ovlNULadderProcessTail()
+{
+	if (m_NULadderStepsDone || m_NULadderRunning == 0) {
+		return 0;
+	}
+	m_NULadderStepsDone = true;
+
+	TAN_FFT_TRANSFORM_DIRECTION fwdDir = TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD;
+	TAN_FFT_TRANSFORM_DIRECTION bwdDir = TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD;
+	if (m_TransformType == TRANSFORMTYPE_FFTREAL) {
+		fwdDir = TAN_FFT_R2C_TRANSFORM_DIRECTION_FORWARD;
+		bwdDir = TAN_FFT_C2R_TRANSFORM_DIRECTION_BACKWARD;
+	}
+
+	for (size_t l = 1; l < m_NULadder.size(); ++l) {
+		nuLadderLevel &level = m_NULadder[l];
+		const int fftLength = 1 << level.m_Log2FFTLen;
+		const int partitionSize = level.m_PartitionSize;
+		const int step = static_cast<int>((m_NULadderBlock + level.m_Phase + 1) % level.m_Blocks);
+
+		for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+			m_NULadderAccum[i] = level.m_Accumulator[m_NULadderChannels[i]];
+		}
+
+		if (step == 0) {
+			// the previous filter runs on until the output of the new one is complete, the
+			// overlap-add output of the first period still has the overlap of the previous one
+			if (level.m_Filter != m_idxFilter && level.m_FadeFilter < 0) {
+				level.m_FadeFilter = level.m_Filter;
+				level.m_Filter = m_idxFilter;
+				level.m_FadePeriods = m_OverlapSave ? 1 : 2;
+
+				for (amf_uint32 i = 0; i < m_NULadderRunning && !m_OverlapSave; i++) {
+					const int channelId = m_NULadderChannels[i];
+					memcpy(level.m_FadeOverlap[channelId], level.m_Overlap[channelId], partitionSize * sizeof(float));
+				}
+			}
+
+			level.m_Head = (level.m_Head + 1) % level.m_Partitions;
+
+			for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+				const int channelId = m_NULadderChannels[i];
+				float *frame = level.m_Input[channelId];
+
+				m_NULadderData[i] = level.m_Spectra[channelId] + level.m_Head * level.m_Stride;
+				memcpy(m_NULadderData[i], frame, fftLength * sizeof(float));
+				memset(m_NULadderAccum[i], 0, level.m_Stride * sizeof(float));
+				if (level.m_FadeFilter >= 0) {
+					memset(level.m_FadeAccumulator[channelId], 0, level.m_Stride * sizeof(float));
+				}
+
+				// the collected period becomes the previous one
+				if (m_OverlapSave) {
+					memcpy(frame + fftLength - partitionSize, frame, partitionSize * sizeof(float));
+				}
+			}
+
+			if (m_pTanFft->TransformPruned(fwdDir, level.m_Log2FFTLen, m_NULadderRunning,
+				m_NULadderData.data(), m_NULadderData.data(), m_OverlapSave ? 0 : partitionSize, 0) != AMF_OK) {
+				return -1;
+			}
+		}
+		else if (step < level.m_Blocks - 1) {
+			const int first = level.m_Partitions * (step - 1) / (level.m_Blocks - 2);
+			const int last = level.m_Partitions * step / (level.m_Blocks - 2);
+			float **filter = m_nupFilterState[level.m_Filter]->m_Filter;
+
+			for (int j = first; j < last; ++j) {
+				const int slot = (level.m_Head - j + level.m_Partitions) % level.m_Partitions;
+				for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+					const int channelId = m_NULadderChannels[i];
+					m_NULadderData[i] = level.m_Spectra[channelId] + slot * level.m_Stride;
+					m_NULadderFilter[i] = filter[channelId] + level.m_FilterOffset + j * level.m_Stride;
+				}
+				if (nuLadderMultiplyAccumulate(level, m_NULadderData.data(), m_NULadderFilter.data(),
+					m_NULadderAccum.data(), m_NULadderRunning) != AMF_OK) {
+					return -1;
+				}
+			}
+
+			if (level.m_FadeFilter < 0) {
+				continue;
+			}
+
+			filter = m_nupFilterState[level.m_FadeFilter]->m_Filter;
+			for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+				m_NULadderAccum[i] = level.m_FadeAccumulator[m_NULadderChannels[i]];
+			}
+			for (int j = first; j < last; ++j) {
+				const int slot = (level.m_Head - j + level.m_Partitions) % level.m_Partitions;
+				for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+					const int channelId = m_NULadderChannels[i];
+					m_NULadderData[i] = level.m_Spectra[channelId] + slot * level.m_Stride;
+					m_NULadderFilter[i] = filter[channelId] + level.m_FilterOffset + j * level.m_Stride;
+				}
+				if (nuLadderMultiplyAccumulate(level, m_NULadderData.data(), m_NULadderFilter.data(),
+					m_NULadderAccum.data(), m_NULadderRunning) != AMF_OK) {
+					return -1;
+				}
+			}
+		}
+		else {
+			if (m_pTanFft->TransformPruned(bwdDir, level.m_Log2FFTLen, m_NULadderRunning,
+				m_NULadderAccum.data(), m_NULadderAccum.data(), 0, m_OverlapSave ? partitionSize : 2 * partitionSize) != AMF_OK) {
+				return -1;
+			}
+
+			for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+				const int channelId = m_NULadderChannels[i];
+				const float *accum = m_NULadderAccum[i];
+				float *levelOutput = level.m_Output[channelId];
+				float *overlap = level.m_Overlap[channelId];
+
+				if (m_OverlapSave) {
+					memcpy(levelOutput, accum, partitionSize * sizeof(float));
+					continue;
+				}
+
+				for (int n = 0; n < partitionSize; n++) {
+					levelOutput[n] = accum[n] + overlap[n];
+				}
+				memcpy(overlap, accum + partitionSize, partitionSize * sizeof(float));
+			}
+
+			level.m_OutputFades = false;
+			if (level.m_FadeFilter < 0) {
+				continue;
+			}
+
+			for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+				m_NULadderData[i] = level.m_FadeAccumulator[m_NULadderChannels[i]];
+			}
+			if (m_pTanFft->TransformPruned(bwdDir, level.m_Log2FFTLen, m_NULadderRunning,
+				m_NULadderData.data(), m_NULadderData.data(), 0, m_OverlapSave ? partitionSize : 2 * partitionSize) != AMF_OK) {
+				return -1;
+			}
+
+			const bool complete = --level.m_FadePeriods == 0;
+			for (amf_uint32 i = 0; i < m_NULadderRunning; i++) {
+				const int channelId = m_NULadderChannels[i];
+				const float *accum = m_NULadderData[i];
+				float *fadeOutput = complete ? level.m_FadeOutput[channelId] : level.m_Output[channelId];
+				float *overlap = level.m_FadeOverlap[channelId];
+
+				if (m_OverlapSave) {
+					memcpy(fadeOutput, accum, partitionSize * sizeof(float));
+					continue;
+				}
+
+				for (int n = 0; n < partitionSize; n++) {
+					fadeOutput[n] = accum[n] + overlap[n];
+				}
+				memcpy(overlap, accum + partitionSize, partitionSize * sizeof(float));
+			}
+
+			// until then the previous filter output is played as it is
+			if (complete) {
+				level.m_FadeFilter = -1;
+				level.m_OutputFades = true;
+			}
+		}
+	}
+
+	return 0;
+}
+
+
 amf_size TANConvolutionImpl::ovlTDProcess(
     tdFilterState *state,
     float **inputData,
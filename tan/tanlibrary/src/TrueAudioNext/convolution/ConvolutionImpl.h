@@ -40,6 +40,8 @@
 //#include "tanlibrary/src/Graal2/GraalWrapper.h"
 
 #include "Debug.h"
+#include "../core/PerformanceCounters.h"
+#include "../core/ThreadScheduling.h"
 
 #ifdef AMF_FACILITY
 #  undef AMF_FACILITY
@@ -53,6 +55,9 @@
 #define PARTITION_PAD_FFTREAL_PLANAR 16
 #define PARTITION_PAD_FFTREAL 4 // might break CPU ??? was 2
 
+#define NU_LADDER_GROWTH_LOG2 2     // each level of the non uniform ladder has 4x longer partitions
+#define NU_LADDER_MAX_LEVELS 8
+
 namespace amf
 {
     class TANConvolutionImpl
@@ -206,6 +211,11 @@ namespace amf
 
         virtual TANContext* AMF_STD_CALL GetContext() override {return m_pContextTAN;}
 
+//AMFPropertyStorage interface, for the TAN_STATS_* properties
+        using TANConvolution::GetProperty;
+        AMF_RESULT  AMF_STD_CALL    GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const override;
+        void        AMF_STD_CALL    OnPropertyChanged(const wchar_t* name) override;
+
     protected:
         virtual AMF_RESULT  Init(TAN_CONVOLUTION_METHOD convolutionMethod,
                                  amf_uint32 responseLengthInSamples,
@@ -349,6 +359,8 @@ namespace amf
 
 		int m_2ndBufSizeMultiple = 4;  // default 4
 		int m_2ndBufCurrentSubBuf = 0;  // 0 -> m_2ndBufSizeMultiple - 1
+		bool m_OverlapSave = false;  // TAN_CONVOLUTION_OVERLAP_SAVE, partitioned CPU methods only
+		int m_OverlapSaveShiftedPartition = -1;  // data partition whose input history was shifted last
 		float **m_NUTailAccumulator = nullptr;   // store complex multiply accumulate data calculated in ovlNUPProcessTail
 		float **m_NUTailSaved = nullptr;   // save last complex multiply accumulate results
 		bool m_CrossFading = false;
@@ -365,6 +377,53 @@ namespace amf
         size_t mNUPSize = 0;
         size_t mNUPSize2 = 0;
 
+		// Gardner style partition ladder, TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM on CPU.
+		// Level 0 runs partitions of m_iBufferSizeInSamples on every block, level l > 0 uses
+		// partitions 4^l times longer and spreads its transforms and complex multiply accumulates
+		// over the blocks in which it collects its next input, see ovlNULadderProcessTail().
+		// The periods of the levels are shifted by m_Phase blocks so that their transforms fall
+		// on different blocks.
+		// A level switches to a new response at the start of its own period: it then runs the
+		// previous filter as well until the output of the new one is complete (one period for
+		// overlap-save, two for overlap-add) and fades from one output to the other over a period.
+		typedef struct _nuLadderLevel {
+			int m_PartitionSize = 0;        // P, samples
+			int m_Log2FFTLen = 0;           // FFT length is at least 2 * P
+			int m_Stride = 0;               // floats per partition spectrum
+			int m_Blocks = 1;               // blocks per period, P / m_iBufferSizeInSamples
+			int m_Phase = 0;                // blocks the periods are shifted by
+			int m_Partitions = 0;
+			int m_FirstSample = 0;          // response offset of the first partition
+			amf_size m_FilterOffset = 0;    // offset of the level spectra in the filter buffers, floats
+			int m_Head = 0;                 // delay line slot of the latest input spectrum
+			int m_Filter = 0;               // filter state the multiply accumulates of the period use
+			int m_FadeFilter = -1;          // previous filter state while switching, -1 otherwise
+			int m_FadePeriods = 0;          // periods the previous filter still runs for
+			bool m_OutputFades = false;     // the period output fades from m_FadeOutput to m_Output
+			float **m_Input = nullptr;      // time domain frame being collected
+			float **m_Spectra = nullptr;    // frequency domain delay line
+			float **m_Accumulator = nullptr;
+			float **m_Output = nullptr;     // level output for the current period
+			float **m_Overlap = nullptr;    // overlap-add only
+			float **m_FadeAccumulator = nullptr;    // the same for the previous filter, levels > 0
+			float **m_FadeOutput = nullptr;
+			float **m_FadeOverlap = nullptr;
+		} nuLadderLevel;
+
+		int m_NULadderLevels = 0;                   // 0 if the ladder isn't used
+		std::vector<nuLadderLevel> m_NULadder;
+		amf_size m_NULadderFilterLength = 0;        // floats per channel of all level spectra
+		amf_int64 m_NULadderBlock = -1;             // index of the block being processed
+		bool m_NULadderBlockConsumed = false;       // crossfade processes every block twice
+		bool m_NULadderStepsDone = false;
+		std::vector<int> m_NULadderChannels;        // running channel of each internal buffer
+		amf_uint32 m_NULadderRunning = 0;
+		float **m_NULadderTail = nullptr;           // sum of the level > 0 outputs for the block
+		float **m_NULadderWork = nullptr;           // IPP multiply accumulate scratch
+		std::vector<float *> m_NULadderData;        // per call pointer lists
+		std::vector<float *> m_NULadderFilter;
+		std::vector<float *> m_NULadderAccum;
+
 
 #  define N_FILTER_STATES 3
         ovlAddFilterState m_FilterState[N_FILTER_STATES];
@@ -381,7 +440,11 @@ namespace amf
         int m_idxUpdateFilterLatest = 0;
         int m_first_round_ever = 0;
 
-		int bestNUMultiple(int responseLength, int blockLength);
+		int bestNULadderLevels(int responseLength, int blockLength);
+		AMF_RESULT buildNULadder();
+		void releaseNULadder();
+		void flushNULadder(amf_uint32 channelId);
+		bool nuLadderSwitching() const;            // a level still uses a previous filter state
 
         AMFEvent m_procReadyForNewResponsesEvent;
         AMFEvent m_updateFinishedProcessing;
@@ -397,12 +460,23 @@ namespace amf
         };
         UpdateThread m_updThread;
 
-        //todo: legacy debug code?
-        // HACK Windows specific
-        //HANDLE m_updThreadHandle;
+        // TAN_THREAD_* properties read by Init, applied by the update thread when it starts;
+        // Init waits for m_updThreadStarted and fails with m_updThreadResult.
+        TANThreadScheduling m_threadScheduling;
+        AMFEvent m_updThreadStarted;
+        AMF_RESULT m_updThreadResult = AMF_OK;
 
+        AMF_RESULT ReadThreadScheduling();
         void UpdateThreadProc(AMFThread *pThread);
 
+        // ids of the traced stages: calls of Process so far, updates run by the update thread;
+        // ProcessFinalize and Crossfade read m_block outside m_sectProcess
+        std::atomic<amf_uint64> m_block{ 0 };
+        amf_uint64 m_update = 0;
+
+        // TAN_STATS_* properties, the stages as they are traced
+        TANPerformanceCounters m_counters;
+
         AMF_RESULT VectorComplexMul(float *vA, float *vB, float *out, int count);
 
         AMF_RESULT ovlAddProcess(
@@ -439,6 +513,29 @@ namespace amf
 
 		int ovlNUPProcessTail(_ovlNonUniformPartitionFilterState *state = NULL, bool useXFadeAccumulator = false);
 
+		amf_size ovlNULadderProcessCPU(
+            ovlNonUniformPartitionFilterState *
+                                            state,
+            const TANSampleBuffer &         inputData,
+            float * const *                 output,
+            amf_size                        length,
+			amf_uint32                      n_channels,
+            bool                            advanceOverlap = true
+            );
+
+		int ovlNULadderProcessTail();
+
+		// layout TANFFT gives the real spectra of m_TransformType, for FFTs of 2 * halfLength
+		TANComplexLayout spectrumLayout(amf_size halfLength);
+
+		AMF_RESULT nuLadderMultiplyAccumulate(
+            const nuLadderLevel &           level,
+            float **                        data,
+            float **                        filter,
+            float **                        accum,
+            amf_uint32                      n_channels
+            );
+
 
         amf_size ovlTDProcess(tdFilterState *state, float **inputData, float **outputData, amf_size length,
             amf_uint32 n_channels);
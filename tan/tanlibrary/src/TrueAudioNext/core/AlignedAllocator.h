@@ -0,0 +1,87 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   AlignedAllocator.h
+///  @brief  Allocator of std::vector storage on cache line or wider boundaries
+///-------------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <xmmintrin.h>
+
+namespace amf
+{
+    // _mm_malloc storage, for vectors whose elements are laid out in cache line sized spans.
+    template<typename T, std::size_t Alignment = 64>
+    class TANAlignedAllocator
+    {
+    public:
+        typedef T value_type;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef TANAlignedAllocator<U, Alignment> other;
+        };
+
+        TANAlignedAllocator()
+        {
+        }
+
+        template<typename U>
+        TANAlignedAllocator(const TANAlignedAllocator<U, Alignment> &)
+        {
+        }
+
+        T * allocate(std::size_t count)
+        {
+            void * memory = _mm_malloc(count * sizeof(T), Alignment);
+
+            if (!memory)
+            {
+                throw std::bad_alloc();
+            }
+
+            return static_cast<T *>(memory);
+        }
+
+        void deallocate(T * memory, std::size_t)
+        {
+            _mm_free(memory);
+        }
+    };
+
+    template<typename T, typename U, std::size_t Alignment>
+    bool operator==(const TANAlignedAllocator<T, Alignment> &, const TANAlignedAllocator<U, Alignment> &)
+    {
+        return true;
+    }
+
+    template<typename T, typename U, std::size_t Alignment>
+    bool operator!=(const TANAlignedAllocator<T, Alignment> &, const TANAlignedAllocator<U, Alignment> &)
+    {
+        return false;
+    }
+} // namespace amf
@@ -0,0 +1,84 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   KernelDispatch.h
+///  @brief  Runtime choice between the instruction set variants of a CPU kernel table
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "cpucaps.h"
+
+#include "public/common/TraceAdapter.h"
+
+// The CPU kernels of a component are tables of function pointers, one table per instruction
+// set. Every table lives in its own translation unit built with only that instruction set
+// enabled, so one binary runs on any x86-64 host and still uses AVX2 or AVX-512 where the host
+// and its OS have them.
+//
+// The baseline (SSE2) translation unit of a component also holds its Get...Kernels(), which
+// picks the table through TANGetKernels. It runs before the CPU has been checked for anything
+// newer, so it must be built for plain x86-64; so must everything that includes this header.
+namespace amf
+{
+    // The tables of one component, the wider ones NULL where the component has none.
+    template<typename Kernels>
+    struct TANKernelSets
+    {
+        const Kernels * sse2;
+        const Kernels * avx2;
+        bool            avx2UsesFma;
+        const Kernels * avx512;
+    };
+
+    template<typename Kernels>
+    const Kernels * TANSelectKernels(const wchar_t * facility, const TANKernelSets<Kernels> & sets)
+    {
+        const Kernels * kernels = sets.sse2;
+
+        if (sets.avx2 && InstructionSet::AVX2() && (!sets.avx2UsesFma || InstructionSet::FMA()) &&
+            InstructionSet::OSAVX())
+        {
+            kernels = sets.avx2;
+        }
+
+        if (sets.avx512 && InstructionSet::AVX512F() && InstructionSet::OSAVX512())
+        {
+            kernels = sets.avx512;
+        }
+
+        AMFTraceInfo(facility, L"using %s kernels", kernels->name);
+
+        return kernels;
+    }
+
+    // The best table for the running CPU, picked on the first call for each table type.
+    template<typename Kernels>
+    const Kernels & TANGetKernels(const wchar_t * facility, const TANKernelSets<Kernels> & sets)
+    {
+        // thread safe, filled on the first call only
+        static const Kernels * kernels = TANSelectKernels(facility, sets);
+
+        return *kernels;
+    }
+} // namespace amf
@@ -0,0 +1,282 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "PerformanceCounters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cwchar>
+#include <thread>
+
+using namespace amf;
+
+namespace
+{
+    // names of the stages in TAN_STATS_STAGE_TIME, in TAN_TRACE_STAGE_ID order
+    const wchar_t * const StageNames[TAN_TRACE_STAGE_COUNT] =
+    {
+        L"Block",
+        L"InputFFT",
+        L"MAC",
+        L"Tail",
+        L"IFFT",
+        L"Crossfade",
+        L"IRUpdate",
+    };
+
+    const wchar_t * const CounterNames[TAN_STATS_COUNTER_COUNT] =
+    {
+        TAN_STATS_BLOCKS,
+        TAN_STATS_OVERRUNS,
+        TAN_STATS_IR_UPDATES,
+        TAN_STATS_IR_DROPPED,
+        TAN_STATS_CROSSFADES,
+    };
+
+    double MeasureCyclesPerSecond()
+    {
+#ifdef TAN_CYCLE_COUNTER
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const amf_uint64 first = TANReadCycles();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        const amf_uint64 last = TANReadCycles();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return double(last - first) / seconds;
+#else
+        return 1e9;
+#endif
+    }
+
+    // wcsncmp that also moves name past prefix
+    bool SkipPrefix(const wchar_t *& name, const wchar_t * prefix)
+    {
+        const size_t length = wcslen(prefix);
+
+        if (wcsncmp(name, prefix, length) != 0)
+        {
+            return false;
+        }
+
+        name += length;
+        return true;
+    }
+}
+
+namespace amf
+{
+    double TANCyclesPerSecond()
+    {
+        // thread safe, measured on the first call only
+        static const double cyclesPerSecond = MeasureCyclesPerSecond();
+
+        return cyclesPerSecond;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+    TANTimeHistogram::TANTimeHistogram()
+    {
+        Reset();
+    }
+    //-------------------------------------------------------------------------------------------------
+    amf_uint64 TANTimeHistogram::UpperEdge(amf_uint32 bucket)
+    {
+        if (bucket < SubBuckets)
+        {
+            return bucket;
+        }
+
+        const amf_uint32 octave = bucket / SubBuckets + 2;
+        const amf_uint64 sub = bucket % SubBuckets;
+
+        return ((SubBuckets + sub + 1) << (octave - 3)) - 1;
+    }
+    //-------------------------------------------------------------------------------------------------
+    amf_uint64 TANTimeHistogram::Percentile(double fraction) const
+    {
+        amf_uint64 counts[Buckets];
+        amf_uint64 total = 0;
+
+        for (amf_uint32 bucket = 0; bucket < Buckets; bucket++)
+        {
+            counts[bucket] = m_counts[bucket].load(std::memory_order_relaxed);
+            total += counts[bucket];
+        }
+
+        if (!total)
+        {
+            return 0;
+        }
+
+        const amf_uint64 rank = std::max<amf_uint64>(1, amf_uint64(std::ceil(fraction * double(total))));
+        amf_uint64 seen = 0;
+
+        for (amf_uint32 bucket = 0; bucket < Buckets; bucket++)
+        {
+            seen += counts[bucket];
+
+            if (seen >= rank)
+            {
+                // the upper edge overestimates, never beyond the longest duration
+                return std::min(UpperEdge(bucket), Max());
+            }
+        }
+
+        return Max();
+    }
+    //-------------------------------------------------------------------------------------------------
+    amf_uint64 TANTimeHistogram::Max() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+    //-------------------------------------------------------------------------------------------------
+    void TANTimeHistogram::Reset()
+    {
+        for (amf_uint32 bucket = 0; bucket < Buckets; bucket++)
+        {
+            m_counts[bucket].store(0, std::memory_order_relaxed);
+        }
+
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+    TANPerformanceCounters::TANPerformanceCounters():
+        m_timeStages(false)
+    {
+        SetSampleRate(48000);
+        Reset();
+    }
+    //-------------------------------------------------------------------------------------------------
+    void TANPerformanceCounters::SetSampleRate(amf_int64 sampleRate)
+    {
+        // converted here, blocks only read the result
+        m_cyclesPerSample.store(sampleRate > 0 ? TANCyclesPerSecond() / double(sampleRate) : 0.0,
+            std::memory_order_relaxed);
+    }
+    //-------------------------------------------------------------------------------------------------
+    void TANPerformanceCounters::Reset()
+    {
+        for (amf_uint32 counter = 0; counter < TAN_STATS_COUNTER_COUNT; counter++)
+        {
+            m_counters[counter].store(0, std::memory_order_relaxed);
+        }
+
+        for (amf_uint32 stage = 0; stage < TAN_TRACE_STAGE_COUNT; stage++)
+        {
+            m_stages[stage].Reset();
+        }
+    }
+    //-------------------------------------------------------------------------------------------------
+    bool TANPerformanceCounters::GetProperty(const wchar_t * name, AMFVariantStruct * value) const
+    {
+        for (amf_uint32 counter = 0; counter < TAN_STATS_COUNTER_COUNT; counter++)
+        {
+            if (!wcscmp(name, CounterNames[counter]))
+            {
+                AMFVariantAssignInt64(value, amf_int64(m_counters[counter].load(std::memory_order_relaxed)));
+                return true;
+            }
+        }
+
+        // L"Stats" stage L"Time" statistic, see TAN_STATS_STAGE_TIME
+        const wchar_t * rest = name;
+
+        if (!SkipPrefix(rest, L"Stats"))
+        {
+            return false;
+        }
+
+        for (amf_uint32 stage = 0; stage < TAN_TRACE_STAGE_COUNT; stage++)
+        {
+            const wchar_t * statistic = rest;
+
+            if (!SkipPrefix(statistic, StageNames[stage]) || !SkipPrefix(statistic, L"Time"))
+            {
+                continue;
+            }
+
+            amf_uint64 cycles = 0;
+
+            if (!wcscmp(statistic, L"P50"))
+            {
+                cycles = m_stages[stage].Percentile(0.5);
+            }
+            else if (!wcscmp(statistic, L"P99"))
+            {
+                cycles = m_stages[stage].Percentile(0.99);
+            }
+            else if (!wcscmp(statistic, L"Max"))
+            {
+                cycles = m_stages[stage].Max();
+            }
+            else
+            {
+                return false;
+            }
+
+            AMFVariantAssignInt64(value, amf_int64(double(cycles) * 1e9 / TANCyclesPerSecond()));
+            return true;
+        }
+
+        return false;
+    }
+    //-------------------------------------------------------------------------------------------------
+    void TANPerformanceCounters::OnPropertyChanged(AMFPropertyStorage * storage, const wchar_t * name)
+    {
+        if (!wcscmp(name, TAN_STATS_RESET))
+        {
+            bool reset = false;
+
+            if (storage->GetProperty(TAN_STATS_RESET, &reset) == AMF_OK && reset)
+            {
+                Reset();
+
+                // so that the next write of true is a change again
+                storage->SetProperty(TAN_STATS_RESET, false);
+            }
+        }
+        else if (!wcscmp(name, TAN_STATS_SAMPLE_RATE))
+        {
+            amf_int64 sampleRate = 0;
+
+            if (storage->GetProperty(TAN_STATS_SAMPLE_RATE, &sampleRate) == AMF_OK)
+            {
+                SetSampleRate(sampleRate);
+            }
+        }
+        else if (!wcscmp(name, TAN_STATS_STAGE_TIMES))
+        {
+            bool timeStages = false;
+
+            if (storage->GetProperty(TAN_STATS_STAGE_TIMES, &timeStages) == AMF_OK)
+            {
+                m_timeStages.store(timeStages, std::memory_order_relaxed);
+            }
+        }
+    }
+} // namespace amf
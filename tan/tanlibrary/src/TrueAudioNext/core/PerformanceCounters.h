@@ -0,0 +1,267 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   PerformanceCounters.h
+///  @brief  Statistics of a component, read through its TAN_STATS_* properties
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "StageTrace.h"
+
+#include <atomic>
+#include <climits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  #ifdef _WIN32
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+  #define TAN_CYCLE_COUNTER 1
+#else
+  #include <chrono>
+#endif
+
+// Times the stage into counters if they take stage times, and traces it, up to the end of the
+// enclosing scope.
+#define TAN_TIME_STAGE(counters, stage, channel, block) \
+    amf::TANStageTimer TAN_TIME_STAGE_CONCAT(tanStageTimer, __LINE__)(counters, stage); \
+    TAN_TRACE_STAGE(stage, channel, block)
+#define TAN_TIME_STAGE_CONCAT_(a, b) a##b
+#define TAN_TIME_STAGE_CONCAT(a, b) TAN_TIME_STAGE_CONCAT_(a, b)
+
+// Entries of the property info maps of components with counters: the blocks, their deadline
+// and the durations of a stage.
+#define TANStatsPropertyInfoBlocks \
+    AMFPropertyInfoBool(TAN_STATS_RESET, L"Reset statistics", false, AMF_PROPERTY_ACCESS_FULL), \
+    AMFPropertyInfoInt64(TAN_STATS_BLOCKS, L"Blocks processed", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ), \
+    TANStatsPropertyInfoTime(L"Block")
+#define TANStatsPropertyInfoStages \
+    AMFPropertyInfoBool(TAN_STATS_STAGE_TIMES, L"Time the processing stages", false, AMF_PROPERTY_ACCESS_FULL)
+#define TANStatsPropertyInfoOverruns \
+    AMFPropertyInfoInt64(TAN_STATS_SAMPLE_RATE, L"Sample rate of the block deadline", 48000, 1, 768000, AMF_PROPERTY_ACCESS_FULL), \
+    AMFPropertyInfoInt64(TAN_STATS_OVERRUNS, L"Blocks past their deadline", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ)
+#define TANStatsPropertyInfoTime(stage) \
+    AMFPropertyInfoInt64(TAN_STATS_STAGE_TIME(stage, L"P50"), L"Median " stage L" time, ns", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ), \
+    AMFPropertyInfoInt64(TAN_STATS_STAGE_TIME(stage, L"P99"), L"99th percentile " stage L" time, ns", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ), \
+    AMFPropertyInfoInt64(TAN_STATS_STAGE_TIME(stage, L"Max"), L"Longest " stage L" time, ns", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ)
+
+namespace amf
+{
+    // Time stamp counter of x86 processors, a few ns to read, ns from a clock elsewhere.
+    inline amf_uint64 TANReadCycles()
+    {
+#ifdef TAN_CYCLE_COUNTER
+        return __rdtsc();
+#else
+        return amf_uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Measured against the clock once per process, the first call takes 10 ms. Contexts make it
+    // when they are created, so that no audio thread pays for it.
+    double TANCyclesPerSecond();
+
+    enum TAN_STATS_COUNTER
+    {
+        TAN_STATS_COUNTER_BLOCKS        = 0,
+        TAN_STATS_COUNTER_OVERRUNS,
+        TAN_STATS_COUNTER_IR_UPDATES,
+        TAN_STATS_COUNTER_IR_DROPPED,
+        TAN_STATS_COUNTER_CROSSFADES,
+        TAN_STATS_COUNTER_COUNT
+    };
+
+    // Durations in cycles, in buckets of an eighth of an octave: percentiles come out at most an
+    // eighth too long.
+    class TANTimeHistogram
+    {
+    public:
+        TANTimeHistogram();
+
+        void Add(amf_uint64 cycles)
+        {
+            m_counts[Bucket(cycles)].fetch_add(1, std::memory_order_relaxed);
+
+            amf_uint64 max = m_max.load(std::memory_order_relaxed);
+
+            while (cycles > max && !m_max.compare_exchange_weak(max, cycles, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // Upper edge of the bucket holding the fraction-th duration, 0 before the first.
+        amf_uint64 Percentile(double fraction) const;
+        amf_uint64 Max() const;
+        void Reset();
+
+    private:
+        static const amf_uint32 SubBuckets = 8;
+        static const amf_uint32 Octaves = 48;
+        static const amf_uint32 Buckets = Octaves * SubBuckets;
+
+        static amf_uint32 Bucket(amf_uint64 cycles)
+        {
+            if (cycles < SubBuckets)
+            {
+                return amf_uint32(cycles);
+            }
+
+            // the leading one, cycles is not 0
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long octave;
+            _BitScanReverse64(&octave, cycles);
+#elif defined(__GNUC__)
+            const amf_uint32 octave = 63 - amf_uint32(__builtin_clzll(cycles));
+#else
+            amf_uint32 octave = 63;
+
+            while (!(cycles >> octave))
+            {
+                octave--;
+            }
+#endif
+
+            // octave 3 and up, the three bits below the leading one pick the sub bucket
+            const amf_uint32 bucket = (octave - 2) * SubBuckets + amf_uint32(cycles >> (octave - 3)) % SubBuckets;
+
+            return bucket < Buckets ? bucket : Buckets - 1;
+        }
+
+        static amf_uint64 UpperEdge(amf_uint32 bucket);
+
+        std::atomic<amf_uint64> m_counts[Buckets];
+        std::atomic<amf_uint64> m_max;
+    };
+
+    // Counters and stage times of a component. Any thread may add, with relaxed atomic adds
+    // only; reads and resets may run alongside, additions racing a reset land on either side.
+    // Blocks are always timed, the stages within them only once TAN_STATS_STAGE_TIMES is set.
+    class TANPerformanceCounters
+    {
+    public:
+        TANPerformanceCounters();
+
+        void Count(TAN_STATS_COUNTER counter)
+        {
+            m_counters[counter].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        bool TimesStages() const
+        {
+            return m_timeStages.load(std::memory_order_relaxed);
+        }
+
+        void AddTime(TAN_TRACE_STAGE_ID stage, amf_uint64 cycles)
+        {
+            m_stages[stage].Add(cycles);
+        }
+
+        // A block of samples, an overrun if it took longer than the samples last.
+        void AddBlock(amf_uint64 cycles, amf_size samples)
+        {
+            m_stages[TAN_TRACE_STAGE_PROCESS].Add(cycles);
+            Count(TAN_STATS_COUNTER_BLOCKS);
+
+            const double cyclesPerSample = m_cyclesPerSample.load(std::memory_order_relaxed);
+
+            if (samples && cyclesPerSample > 0.0 && double(cycles) > double(samples) * cyclesPerSample)
+            {
+                Count(TAN_STATS_COUNTER_OVERRUNS);
+            }
+        }
+
+        void SetSampleRate(amf_int64 sampleRate);
+        void Reset();
+
+        // Fills value for a TAN_STATS_* property, false for other names. Components call it from
+        // GetProperty once the property was found, statistics are never stored.
+        bool GetProperty(const wchar_t * name, AMFVariantStruct * value) const;
+
+        // Applies TAN_STATS_RESET, TAN_STATS_SAMPLE_RATE and TAN_STATS_STAGE_TIMES, for
+        // OnPropertyChanged of components.
+        void OnPropertyChanged(AMFPropertyStorage * storage, const wchar_t * name);
+
+    private:
+        std::atomic<amf_uint64> m_counters[TAN_STATS_COUNTER_COUNT];
+        TANTimeHistogram        m_stages[TAN_TRACE_STAGE_COUNT];
+        std::atomic<double>     m_cyclesPerSample;   // of the sample rate, 0 without one
+        std::atomic<bool>       m_timeStages;
+    };
+
+    // Adds the time from construction to destruction to a stage, if counters take stage times.
+    class TANStageTimer
+    {
+    public:
+        TANStageTimer(TANPerformanceCounters & counters, TAN_TRACE_STAGE_ID stage):
+            m_counters(counters),
+            m_stage(stage),
+            m_start(counters.TimesStages() ? TANReadCycles() : 0)
+        {
+        }
+
+        ~TANStageTimer()
+        {
+            // times what began even if stage times stopped in between
+            if (m_start)
+            {
+                m_counters.AddTime(m_stage, TANReadCycles() - m_start);
+            }
+        }
+
+    private:
+        TANStageTimer(const TANStageTimer &) = delete;
+        TANStageTimer & operator=(const TANStageTimer &) = delete;
+
+        TANPerformanceCounters &    m_counters;
+        const TAN_TRACE_STAGE_ID    m_stage;
+        const amf_uint64            m_start;
+    };
+
+    // Adds a block of samples from construction to destruction, see AddBlock.
+    class TANBlockTimer
+    {
+    public:
+        TANBlockTimer(TANPerformanceCounters & counters, amf_size samples):
+            m_counters(counters),
+            m_samples(samples),
+            m_start(TANReadCycles())
+        {
+        }
+
+        ~TANBlockTimer()
+        {
+            m_counters.AddBlock(TANReadCycles() - m_start, m_samples);
+        }
+
+    private:
+        TANBlockTimer(const TANBlockTimer &) = delete;
+        TANBlockTimer & operator=(const TANBlockTimer &) = delete;
+
+        TANPerformanceCounters &    m_counters;
+        const amf_size              m_samples;
+        const amf_uint64            m_start;
+    };
+} // namespace amf
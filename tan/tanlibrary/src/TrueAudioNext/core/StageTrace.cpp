@@ -0,0 +1,281 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+
+#include "StageTrace.h"
+
+#include "public/common/TraceAdapter.h"
+
+#ifdef TAN_STAGE_TRACE
+  #include "public/common/AMFSTL.h"
+
+  #include <algorithm>
+  #include <chrono>
+  #include <cstdio>
+  #include <memory>
+  #include <mutex>
+  #include <vector>
+#endif
+
+#define AMF_FACILITY L"TANStageTrace"
+
+using namespace amf;
+
+#ifdef TAN_STAGE_TRACE
+
+namespace
+{
+    // Events kept per thread, the last ones win: 384 KB a thread, some seconds of a busy thread.
+    const amf_size RingEvents = 1 << 14;
+
+    const char * const StageNames[TAN_TRACE_STAGE_COUNT] =
+    {
+        "process",
+        "input FFT",
+        "MAC",
+        "tail",
+        "IFFT",
+        "crossfade",
+        "IR update",
+    };
+
+    struct Event
+    {
+        amf_uint64  time;       // ns since the first event of the process
+        amf_uint64  block;
+        amf_uint32  channel;
+        amf_uint16  stage;
+        amf_uint16  begin;
+    };
+
+    struct Ring
+    {
+        Event                   events[RingEvents];
+        std::atomic<amf_uint64> head{0};        // events written so far, published with release
+        std::atomic<bool>       owned{false};
+        amf_uint32              id = 0;
+    };
+
+    // Rings are only ever added, a thread that exits hands its ring on to the next new thread.
+    std::mutex                          s_ringsSync;
+    std::vector<std::unique_ptr<Ring>>  s_rings;
+
+    const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+    Ring * AcquireRing()
+    {
+        std::lock_guard<std::mutex> lock(s_ringsSync);
+
+        for (std::unique_ptr<Ring> & ring : s_rings)
+        {
+            bool owned = false;
+
+            if (ring->owned.compare_exchange_strong(owned, true))
+            {
+                return ring.get();
+            }
+        }
+
+        std::unique_ptr<Ring> ring(new Ring);
+        ring->owned = true;
+        ring->id = amf_uint32(s_rings.size()) + 1;
+        s_rings.push_back(std::move(ring));
+
+        return s_rings.back().get();
+    }
+
+    struct RingOwner
+    {
+        Ring * ring = nullptr;
+
+        ~RingOwner()
+        {
+            if (ring)
+            {
+                ring->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local RingOwner t_ringOwner;
+}
+
+std::atomic<bool> amf::g_TANStageTraceEnabled(false);
+
+//-------------------------------------------------------------------------------------------------
+void amf::TANRecordStage(TAN_TRACE_STAGE_ID stage, bool begin, amf_uint32 channel, amf_uint64 block)
+{
+    Ring * ring = t_ringOwner.ring;
+
+    if (!ring)
+    {
+        // the first event of this thread
+        ring = t_ringOwner.ring = AcquireRing();
+    }
+
+    const amf_uint64 head = ring->head.load(std::memory_order_relaxed);
+    Event & event = ring->events[head % RingEvents];
+
+    event.time = amf_uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - s_epoch).count());
+    event.block = block;
+    event.channel = channel;
+    event.stage = amf_uint16(stage);
+    event.begin = begin ? 1 : 0;
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Events of ring still in it after the copy, oldest first. The owner keeps writing meanwhile,
+// the ones it may have overwritten during the copy are dropped.
+static void CopyRing(const Ring & ring, std::vector<Event> & events)
+{
+    const amf_uint64 end = ring.head.load(std::memory_order_acquire);
+    const amf_uint64 first = end > RingEvents ? end - RingEvents : 0;
+
+    events.clear();
+
+    for (amf_uint64 i = first; i < end; i++)
+    {
+        events.push_back(ring.events[i % RingEvents]);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    const amf_uint64 written = ring.head.load(std::memory_order_relaxed);
+    // the slot at written may be half way through its store as well
+    const amf_uint64 overwritten = written + 1 > RingEvents ? written + 1 - RingEvents : 0;
+
+    if (overwritten > first)
+    {
+        events.erase(events.begin(), events.begin() + amf_size(std::min(overwritten, end) - first));
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+static bool WriteChromeTrace(FILE * file)
+{
+    std::lock_guard<std::mutex> lock(s_ringsSync);
+    std::vector<Event> events;
+    const char * separator = "";
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    for (const std::unique_ptr<Ring> & ring : s_rings)
+    {
+        CopyRing(*ring, events);
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"TAN thread %u\"}}",
+            separator, ring->id, ring->id);
+        separator = ",\n";
+
+        // an end without its begin, cut off by the ring, would close an outer stage
+        amf_uint32 depth = 0;
+
+        for (const Event & event : events)
+        {
+            if (!event.begin && depth == 0)
+            {
+                continue;
+            }
+
+            if (event.begin)
+            {
+                depth++;
+            }
+            else
+            {
+                depth--;
+            }
+
+            fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"TAN\",\"ph\":\"%s\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u",
+                separator, StageNames[event.stage], event.begin ? "B" : "E",
+                (unsigned long long)(event.time / 1000), unsigned(event.time % 1000), ring->id);
+
+            if (event.begin)
+            {
+                if (event.channel == TANTraceAllChannels)
+                {
+                    fprintf(file, ",\"args\":{\"block\":%llu}}", (unsigned long long)event.block);
+                }
+                else
+                {
+                    fprintf(file, ",\"args\":{\"channel\":%u,\"block\":%llu}}", event.channel, (unsigned long long)event.block);
+                }
+            }
+            else
+            {
+                fprintf(file, "}");
+            }
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+
+    return ferror(file) == 0;
+}
+
+#endif // TAN_STAGE_TRACE
+
+//-------------------------------------------------------------------------------------------------
+TAN_SDK_LINK AMF_RESULT        AMF_CDECL_CALL TANEnableStageTrace(bool enable)
+{
+#ifdef TAN_STAGE_TRACE
+    g_TANStageTraceEnabled.store(enable, std::memory_order_relaxed);
+
+    return AMF_OK;
+#else
+    (void)enable;
+    AMFTraceError(AMF_FACILITY, L"TAN was built without TAN_STAGE_TRACE");
+
+    return AMF_NOT_SUPPORTED;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+TAN_SDK_LINK AMF_RESULT        AMF_CDECL_CALL TANExportStageTrace(const wchar_t* path)
+{
+#ifdef TAN_STAGE_TRACE
+    AMF_RETURN_IF_FALSE(path != nullptr, AMF_INVALID_ARG, L"path == NULL");
+
+#ifdef _WIN32
+    FILE * file = _wfopen(path, L"w");
+#else
+    FILE * file = fopen(amf_from_unicode_to_utf8(amf_wstring(path)).c_str(), "w");
+#endif
+
+    AMF_RETURN_IF_FALSE(file != nullptr, AMF_FILE_NOT_OPEN, L"Cannot open %s", path);
+
+    const bool written = WriteChromeTrace(file);
+
+    AMF_RETURN_IF_FALSE(fclose(file) == 0 && written, AMF_FAIL, L"Cannot write %s", path);
+
+    return AMF_OK;
+#else
+    (void)path;
+    AMFTraceError(AMF_FACILITY, L"TAN was built without TAN_STAGE_TRACE");
+
+    return AMF_NOT_SUPPORTED;
+#endif
+}
@@ -0,0 +1,105 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   StageTrace.h
+///  @brief  Begin and end times of the processing stages of each block, for TANExportStageTrace
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "TrueAudioNext.h"   //TAN
+
+#include <atomic>
+
+// Every thread records into a ring of its own with plain stores, no locks or atomic
+// read-modify-writes on the audio threads. Builds without TAN_STAGE_TRACE compile
+// TAN_TRACE_STAGE to nothing.
+#ifdef TAN_STAGE_TRACE
+  #define TAN_TRACE_CONCAT_(a, b) a##b
+  #define TAN_TRACE_CONCAT(a, b) TAN_TRACE_CONCAT_(a, b)
+
+  // Records the stage from here to the end of the enclosing scope.
+  #define TAN_TRACE_STAGE(stage, channel, block) \
+      amf::TANStageScope TAN_TRACE_CONCAT(tanStageScope, __LINE__)(stage, channel, block)
+#else
+  #define TAN_TRACE_STAGE(stage, channel, block) ((void)0)
+#endif
+
+namespace amf
+{
+    enum TAN_TRACE_STAGE_ID
+    {
+        TAN_TRACE_STAGE_PROCESS     = 0,    // a whole block
+        TAN_TRACE_STAGE_INPUT_FFT,
+        TAN_TRACE_STAGE_MAC,                // multiply accumulate of the spectra
+        TAN_TRACE_STAGE_TAIL,               // the later partitions, ahead of the blocks that need them
+        TAN_TRACE_STAGE_IFFT,
+        TAN_TRACE_STAGE_CROSSFADE,
+        TAN_TRACE_STAGE_IR_UPDATE,          // transform of new responses on the update thread
+        TAN_TRACE_STAGE_COUNT
+    };
+
+    // channel of the stages that run all channels at once; stages that loop over the channels
+    // record each one inside the whole
+    const amf_uint32 TANTraceAllChannels = ~0u;
+
+#ifdef TAN_STAGE_TRACE
+    extern std::atomic<bool> g_TANStageTraceEnabled;
+
+    void TANRecordStage(TAN_TRACE_STAGE_ID stage, bool begin, amf_uint32 channel, amf_uint64 block);
+
+    class TANStageScope
+    {
+    public:
+        TANStageScope(TAN_TRACE_STAGE_ID stage, amf_uint32 channel, amf_uint64 block):
+            m_stage(stage),
+            m_channel(channel),
+            m_block(block),
+            m_recording(g_TANStageTraceEnabled.load(std::memory_order_relaxed))
+        {
+            if (m_recording)
+            {
+                TANRecordStage(m_stage, true, m_channel, m_block);
+            }
+        }
+
+        ~TANStageScope()
+        {
+            // ends what began even if tracing stopped in between
+            if (m_recording)
+            {
+                TANRecordStage(m_stage, false, m_channel, m_block);
+            }
+        }
+
+    private:
+        TANStageScope(const TANStageScope &) = delete;
+        TANStageScope & operator=(const TANStageScope &) = delete;
+
+        const TAN_TRACE_STAGE_ID    m_stage;
+        const amf_uint32            m_channel;
+        const amf_uint64            m_block;
+        const bool                  m_recording;
+    };
+#endif
+} // namespace amf
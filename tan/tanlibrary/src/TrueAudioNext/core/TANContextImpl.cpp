@@ -23,12 +23,21 @@
 #include "TrueAudioNext.h"   //TAN
 #include "TANContextImpl.h"
 #include "TANTraceAndDebug.h"
+#include "PerformanceCounters.h"
 
 #include "public/common/TraceAdapter.h"         //AMF
 #include "public/common/AMFFactoryHelper.h" 
 
 #include "clFFT.h"
 
+#include <cstdlib>
+#include <string>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
 typedef unsigned int uint;
 #include "GraalConv.hpp"
 
@@ -53,6 +62,10 @@ bool g_AMFFactoryInitialized = false;
 using namespace amf;
 
 amf_long TANContextImpl::m_clfftReferences = 0;
+AMFCriticalSection TANContextImpl::m_clfftCacheSync;
+bool TANContextImpl::m_clfftCacheChecked = false;
+bool TANContextImpl::m_clfftCacheFromEnvironment = false;
+std::wstring TANContextImpl::m_clfftCachePath;
 
 TAN_SDK_LINK AMF_RESULT        AMF_CDECL_CALL TANCreateContext(
     amf_uint64 version,
@@ -137,6 +150,9 @@ TANContextImpl::TANContextImpl(amf::AMFFactory * factory):
         AMF_ASSERT_OK(mFactory->CreateContext(&mContextGeneralAMF), L"CreateContext() failed");
         AMF_ASSERT_OK(mFactory->CreateContext(&mContextConvolutionAMF), L"CreateContext() failed");
     }
+
+    // the statistics of the components convert cycles with it, measure it before they run
+    TANCyclesPerSecond();
 }
 //-------------------------------------------------------------------------------------------------
 TANContextImpl::~TANContextImpl(void)
@@ -197,11 +213,89 @@ AMF_RESULT AMF_STD_CALL TANContextImpl::Terminate()
     mConvolutionDeviceAMF.Release();
 #endif
 
+    // the workers come back with the next loop
+    m_threadPool.Terminate();
+
 	return AMF_OK;
 }
 
+//clFFT only caches its generated kernels on disk when CLFFT_CACHE_PATH is set
+//at clfftSetup time; point it into TAN's cache folder unless the user already
+//chose a location for it. The variable is process wide and getenv is not safe
+//against a concurrent setenv, so it is set once, with m_clfftCacheSync held, by
+//the first context that has a cache folder; the folders of later contexts are
+//ignored.
+void amf::TANContextImpl::EnableClfftBinaryCache()
+{
+    if (!m_clfftCacheChecked)
+    {
+        const char *userPath = getenv("CLFFT_CACHE_PATH");
+        m_clfftCacheFromEnvironment = userPath && userPath[0];
+        m_clfftCacheChecked = true;
+    }
+
+    const wchar_t *cacheFolder = mFactory ? mFactory->GetCacheFolder() : nullptr;
+    if (!cacheFolder || !cacheFolder[0])
+    {
+        return;
+    }
+
+    std::wstring path(cacheFolder);
+    if (path.back() != L'/' && path.back() != L'\\')
+    {
+        path += L'/';
+    }
+    path += L"clFFT";
+
+    if (m_clfftCacheFromEnvironment)
+    {
+        AMFTraceInfo(L"TANContext", L"clFFT kernel cache: CLFFT_CACHE_PATH of the environment, %s is not used", path.c_str());
+        return;
+    }
+
+    if (!m_clfftCachePath.empty())
+    {
+        if (path != m_clfftCachePath)
+        {
+            AMFTraceWarning(L"TANContext", L"clFFT kernel cache stays in %s, %s is ignored",
+                m_clfftCachePath.c_str(), path.c_str());
+        }
+        return;
+    }
+
+#ifdef _WIN32
+    _wmkdir(path.c_str());
+    if (_wputenv_s(L"CLFFT_CACHE_PATH", path.c_str()) != 0)
+    {
+        return;
+    }
+#else
+    std::string narrowPath(path.size() * MB_CUR_MAX + 1, '\0');
+    size_t length = wcstombs(&narrowPath[0], path.c_str(), narrowPath.size());
+    if (length == size_t(-1))
+    {
+        return;
+    }
+    narrowPath.resize(length);
+
+    mkdir(narrowPath.c_str(), S_IRWXU);
+    if (setenv("CLFFT_CACHE_PATH", narrowPath.c_str(), 1) != 0)
+    {
+        return;
+    }
+#endif
+
+    m_clfftCachePath = path;
+    AMFTraceInfo(L"TANContext", L"clFFT kernel cache: %s", path.c_str());
+}
+
 AMF_RESULT amf::TANContextImpl::InitClfft()
 {
+    // clfftSetup reads CLFFT_CACHE_PATH
+    AMFLock lock(&m_clfftCacheSync);
+
+    EnableClfftBinaryCache();
+
     clfftSetupData setupData;
     AMF_RETURN_IF_FALSE(clfftInitSetupData(&setupData) == CLFFT_SUCCESS, AMF_UNEXPECTED,
                         L"Cannot initialize FFT component");
@@ -493,3 +587,32 @@ AMFCompute * AMF_STD_CALL TANContextImpl::GetAMFConvQueue()
     return mComputeConvolutionAMF;
 }
 #endif
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANContextImpl::InitOpenMP(int nThreads)
+{
+    return InitThreadPool(nThreads > 0 ? amf_uint32(nThreads) : 0, 0);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANContextImpl::InitThreadPool(amf_uint32 threads, amf_uint64 affinityMask)
+{
+    TANThreadScheduling scheduling;
+
+    AMF_RETURN_IF_FAILED(TANReadThreadScheduling(this, scheduling));
+    AMF_RETURN_IF_FALSE(scheduling.schedulingClass != TAN_THREAD_SCHEDULING_CONTEXT, AMF_INVALID_ARG,
+        L"TAN_THREAD_SCHEDULING_CONTEXT is not a scheduling class of the context");
+    AMF_RETURN_IF_FAILED(TANLockThreadMemory(scheduling));
+
+    return m_threadPool.Init(threads, affinityMask, scheduling);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL TANContextImpl::SetThreadBudget(TAN_THREAD_BUDGET_COMPONENT component, amf_uint32 threads)
+{
+    return m_threadPool.SetBudget(component, threads);
+}
+//-------------------------------------------------------------------------------------------------
+amf_uint32 AMF_STD_CALL TANContextImpl::GetThreadBudget(TAN_THREAD_BUDGET_COMPONENT component)
+{
+    AMF_RETURN_IF_FALSE(component >= 0 && component < TAN_THREAD_BUDGET_COUNT, 0, L"Invalid component");
+
+    return m_threadPool.GetBudget(component);
+}
@@ -27,9 +27,12 @@
 #include "TrueAudioNext.h"   //TAN
 #include "public/common/PropertyStorageImpl.h"  //AMF
 #include "public/include/core/Context.h"        //AMF
+#include "ThreadPool.h"
 
 #include <CL/cl.h>
 
+#include <string>
+
 namespace amf
 {
     class TANContextImpl :
@@ -77,12 +80,18 @@ namespace amf
         AMFComputePtr GetGeneralCompute() const         { return mComputeGeneralAMF; }
         AMFComputePtr GetConvolutionCompute() const     { return mComputeConvolutionAMF; }
 
-        AMF_RESULT AMF_STD_CALL InitOpenMP(int nThreads) override { return AMF_NOT_IMPLEMENTED; }
+        TANThreadPool & GetThreadPool()                 { return m_threadPool; }
+
+        AMF_RESULT AMF_STD_CALL InitOpenMP(int nThreads) override;
+        AMF_RESULT AMF_STD_CALL InitThreadPool(amf_uint32 threads, amf_uint64 affinityMask) override;
+        AMF_RESULT AMF_STD_CALL SetThreadBudget(TAN_THREAD_BUDGET_COMPONENT component, amf_uint32 threads) override;
+        amf_uint32 AMF_STD_CALL GetThreadBudget(TAN_THREAD_BUDGET_COMPONENT component) override;
 
     protected:
         enum QueueType { eConvQueue, eGeneralQueue };
 
         virtual AMF_RESULT InitClfft();
+        void EnableClfftBinaryCache();
 
 #ifndef TAN_NO_OPENCL
         virtual AMF_RESULT InitOpenCLInt(cl_command_queue pClCommandQueue, QueueType queueType);
@@ -124,7 +133,16 @@ namespace amf
         bool m_clfftInitialized = false;
         static amf_long m_clfftReferences; // Only one instance of the library can exist at a time.
 
+        // CLFFT_CACHE_PATH is process wide: whether the environment had it when the first context
+        // looked, and the path TAN set it to (empty while TAN set none), both under the lock
+        static AMFCriticalSection m_clfftCacheSync;
+        static bool m_clfftCacheChecked;
+        static bool m_clfftCacheFromEnvironment;
+        static std::wstring m_clfftCachePath;
+
         AMFCriticalSection m_sync;
+
+        TANThreadPool               m_threadPool;
     };
     typedef AMFInterfacePtr_T<TANContextImpl> TANContextImplPtr;
 
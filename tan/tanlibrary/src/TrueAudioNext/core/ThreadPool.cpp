@@ -0,0 +1,368 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "ThreadPool.h"
+
+#include "public/common/TraceAdapter.h"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+#ifdef _WIN32
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#define AMF_FACILITY L"TANThreadPool"
+
+using namespace amf;
+
+// Polls of a worker for its next job before it sleeps: longer than the gaps between the loops
+// of one block, much shorter than the gap to the next block. A pause takes from about 10 cycles
+// up to about 140 on Skylake and later cores, so this is roughly 5 to 50 microseconds.
+static const int WorkerSpins = 1024;
+
+// Polls of the calling thread for the workers to finish before it starts yielding.
+static const int CallerSpins = 1 << 16;
+
+// Set on the workers and on a caller while it runs its range, loops started from a loop body
+// run serially there.
+static thread_local bool InLoop = false;
+
+static amf_uint32 DefaultThreads()
+{
+    return std::max(1u, std::thread::hardware_concurrency() / 4);
+}
+
+// Pins thread to the index-th processor of affinityMask, round robin.
+static bool PinThread(std::thread & thread, amf_uint64 affinityMask, amf_uint32 index)
+{
+    amf_uint32 processors[64];
+    amf_uint32 count = 0;
+
+    for (amf_uint32 bit = 0; bit < 64; bit++)
+    {
+        if (affinityMask & (amf_uint64(1) << bit))
+        {
+            processors[count++] = bit;
+        }
+    }
+
+    const amf_uint32 processor = processors[index % count];
+
+#ifdef _WIN32
+    return SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << processor) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(processor, &set);
+
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)processor;
+    return false;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+TANThreadPool::TANThreadPool():
+    m_threads(DefaultThreads()),
+    m_affinityMask(0),
+    m_startFailed(false),
+    m_stop(false),
+    m_task(nullptr),
+    m_body(nullptr),
+    m_count(0),
+    m_ranges(0),
+    m_job(0),
+    m_pending(0)
+{
+    for (amf_uint32 component = 0; component < TAN_THREAD_BUDGET_COUNT; component++)
+    {
+        m_budgets[component] = 0;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+TANThreadPool::~TANThreadPool()
+{
+    Terminate();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANThreadPool::Init(amf_uint32 threads, amf_uint64 affinityMask, const TANThreadScheduling & scheduling)
+{
+    std::lock_guard<std::mutex> lock(m_runSync);
+
+    TerminateLocked();
+
+    m_threads = threads ? threads : DefaultThreads();
+    m_affinityMask = affinityMask;
+    m_scheduling = scheduling;
+    m_startFailed = false;
+
+    // the round robin pinning replaces the affinity of the scheduling
+    if (affinityMask)
+    {
+        m_scheduling.affinityMask = 0;
+    }
+
+    return StartLocked();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANThreadPool::Start()
+{
+    std::lock_guard<std::mutex> lock(m_runSync);
+
+    return m_workers.empty() ? StartLocked() : AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void TANThreadPool::Terminate()
+{
+    std::lock_guard<std::mutex> lock(m_runSync);
+
+    TerminateLocked();
+}
+//-------------------------------------------------------------------------------------------------
+amf_uint32 TANThreadPool::GetThreads() const
+{
+    return m_threads;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANThreadPool::SetBudget(TAN_THREAD_BUDGET_COMPONENT component, amf_uint32 threads)
+{
+    AMF_RETURN_IF_FALSE(component >= 0 && component < TAN_THREAD_BUDGET_COUNT, AMF_INVALID_ARG,
+        L"Invalid component");
+
+    m_budgets[component] = threads;
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+amf_uint32 TANThreadPool::GetBudget(TAN_THREAD_BUDGET_COMPONENT component) const
+{
+    const amf_uint32 threads = m_threads;
+    const amf_uint32 budget = m_budgets[component];
+
+    return (budget && budget < threads) ? budget : threads;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANThreadPool::StartLocked()
+{
+    const amf_uint32 workers = m_threads - 1;
+
+    m_stop = false;
+
+    // all workers exist before the first one runs, m_workers doesn't move under them
+    for (amf_uint32 index = 0; index < workers; index++)
+    {
+        std::unique_ptr<Worker> worker(new Worker);
+        worker->job = 0;
+        worker->started = false;
+        worker->scheduled = AMF_OK;
+        m_workers.push_back(std::move(worker));
+    }
+
+    for (amf_uint32 index = 0; index < workers; index++)
+    {
+        Worker * worker = m_workers[index].get();
+
+        worker->thread = std::thread(&TANThreadPool::WorkerProc, this, index, worker);
+
+        if (m_affinityMask && !PinThread(worker->thread, m_affinityMask, index))
+        {
+            AMFTraceWarning(AMF_FACILITY, L"worker %u could not be pinned", index);
+        }
+    }
+
+    AMF_RESULT result = AMF_OK;
+
+    for (std::unique_ptr<Worker> & worker : m_workers)
+    {
+        std::unique_lock<std::mutex> lock(worker->sync);
+
+        worker->ready.wait(lock, [&] { return worker->started; });
+
+        if (worker->scheduled != AMF_OK)
+        {
+            result = worker->scheduled;
+        }
+    }
+
+    if (result != AMF_OK)
+    {
+        TerminateLocked();
+        m_startFailed = true;
+    }
+
+    AMF_RETURN_IF_FAILED(result, L"Failed to schedule the worker threads");
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void TANThreadPool::TerminateLocked()
+{
+    m_stop = true;
+
+    for (std::unique_ptr<Worker> & worker : m_workers)
+    {
+        {
+            std::lock_guard<std::mutex> lock(worker->sync);
+        }
+        worker->wake.notify_one();
+    }
+
+    for (std::unique_ptr<Worker> & worker : m_workers)
+    {
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+
+    m_workers.clear();
+}
+//-------------------------------------------------------------------------------------------------
+void TANThreadPool::Run(amf_uint32 threads, amf_size count, Task task, const void * body)
+{
+    if (InLoop)
+    {
+        task(body, 0, count);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_runSync, std::try_to_lock);
+
+    if (!lock.owns_lock())
+    {
+        // busy with a loop of another thread
+        task(body, 0, count);
+        return;
+    }
+
+    if (m_workers.empty() && (m_startFailed || StartLocked() != AMF_OK))
+    {
+        task(body, 0, count);
+        return;
+    }
+
+    const amf_uint32 ranges = amf_uint32(std::min<amf_size>(std::min<amf_size>(threads, m_workers.size() + 1), count));
+
+    if (ranges <= 1)
+    {
+        task(body, 0, count);
+        return;
+    }
+
+    m_task = task;
+    m_body = body;
+    m_count = count;
+    m_ranges = ranges;
+    m_pending.store(ranges - 1, std::memory_order_relaxed);
+    m_job++;
+
+    // range r + 1 goes to worker r, the first one stays here
+    for (amf_uint32 index = 0; index + 1 < ranges; index++)
+    {
+        Worker & worker = *m_workers[index];
+
+        {
+            std::lock_guard<std::mutex> wake(worker.sync);
+            worker.job.store(m_job, std::memory_order_release);
+        }
+        worker.wake.notify_one();
+    }
+
+    InLoop = true;
+    task(body, 0, count / ranges);
+    InLoop = false;
+
+    for (int spin = 0; m_pending.load(std::memory_order_acquire) != 0; )
+    {
+        if (spin < CallerSpins)
+        {
+            spin++;
+            _mm_pause();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void TANThreadPool::WorkerProc(amf_uint32 index, Worker * worker)
+{
+    amf_uint64 done = 0;
+
+    const AMF_RESULT scheduled = TANApplyThreadScheduling(m_scheduling);
+
+    {
+        std::lock_guard<std::mutex> lock(worker->sync);
+        worker->started = true;
+        worker->scheduled = scheduled;
+    }
+    worker->ready.notify_one();
+
+    if (scheduled != AMF_OK)
+    {
+        return;
+    }
+
+    InLoop = true;
+
+    for (;;)
+    {
+        amf_uint64 job = worker->job.load(std::memory_order_acquire);
+
+        for (int spin = 0; job == done && spin < WorkerSpins && !m_stop; spin++)
+        {
+            _mm_pause();
+            job = worker->job.load(std::memory_order_acquire);
+        }
+
+        if (job == done)
+        {
+            std::unique_lock<std::mutex> lock(worker->sync);
+
+            worker->wake.wait(lock, [&] { return worker->job.load(std::memory_order_acquire) != done || m_stop; });
+            job = worker->job.load(std::memory_order_acquire);
+        }
+
+        if (job == done)
+        {
+            // stopped, jobs are never pending then
+            return;
+        }
+
+        done = job;
+
+        const amf_size first = m_count * (index + 1) / m_ranges;
+        const amf_size end = m_count * (index + 2) / m_ranges;
+
+        m_task(m_body, first, end);
+        m_pending.fetch_sub(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,163 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   ThreadPool.h
+///  @brief  Worker threads of a TANContext, shared by the CPU paths of its components
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "TrueAudioNext.h"   //TAN
+#include "ThreadScheduling.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace amf
+{
+    // Runs loops over the calling thread and up to threads - 1 persistent workers. The workers
+    // spin for a short while after a loop before they sleep, so that the loops of one audio
+    // block find them awake.
+    //
+    // One loop runs at a time: a loop started while another one runs, from another thread or
+    // from inside a loop body, runs serially on its calling thread instead of waiting.
+    class TANThreadPool
+    {
+    public:
+        TANThreadPool();
+        ~TANThreadPool();
+
+        // threads counts the calling thread, 0 picks a quarter of the processors. Workers are
+        // pinned round robin to the processors in affinityMask, 0 leaves them to the affinity
+        // of scheduling. Each worker applies scheduling to itself when it starts; Init fails,
+        // with no workers left, if one of them can't.
+        AMF_RESULT Init(amf_uint32 threads, amf_uint64 affinityMask, const TANThreadScheduling & scheduling);
+
+        // Starts the workers if they aren't running yet, so that the first loop doesn't. Fails
+        // as Init does, later loops then run serially until the next Init.
+        AMF_RESULT Start();
+        void Terminate();
+
+        amf_uint32 GetThreads() const;
+
+        // Most threads a loop of component takes, 0 for the whole pool.
+        AMF_RESULT SetBudget(TAN_THREAD_BUDGET_COMPONENT component, amf_uint32 threads);
+        amf_uint32 GetBudget(TAN_THREAD_BUDGET_COMPONENT component) const;
+
+        // Calls body(i) for 0 <= i < count, split in contiguous ranges over at most threads
+        // threads, as schedule(static) does.
+        template<typename Body>
+        void ParallelFor(amf_uint32 threads, amf_size count, const Body & body)
+        {
+            if (threads > 1 && count > 1)
+            {
+                Run(threads, count, &RunRange<Body>, &body);
+            }
+            else
+            {
+                for (amf_size i = 0; i < count; i++)
+                {
+                    body(i);
+                }
+            }
+        }
+
+    private:
+        typedef void (*Task)(const void * body, amf_size first, amf_size end);
+
+        template<typename Body>
+        static void RunRange(const void * body, amf_size first, amf_size end)
+        {
+            const Body & run = *static_cast<const Body *>(body);
+
+            for (amf_size i = first; i < end; i++)
+            {
+                run(i);
+            }
+        }
+
+        struct Worker
+        {
+            std::thread                 thread;
+            std::atomic<amf_uint64>     job;
+            std::mutex                  sync;
+            std::condition_variable     wake;
+
+            // set under sync once the worker applied its scheduling
+            std::condition_variable     ready;
+            bool                        started;
+            AMF_RESULT                  scheduled;
+        };
+
+        void Run(amf_uint32 threads, amf_size count, Task task, const void * body);
+        AMF_RESULT StartLocked();
+        void TerminateLocked();
+        void WorkerProc(amf_uint32 index, Worker * worker);
+
+        // held while a loop runs and while the workers are started or stopped
+        std::mutex                              m_runSync;
+
+        std::vector<std::unique_ptr<Worker>>    m_workers;
+        std::atomic<amf_uint32>                 m_threads;
+        amf_uint64                              m_affinityMask;
+        TANThreadScheduling                     m_scheduling;
+        bool                                    m_startFailed;
+        std::atomic<amf_uint32>                 m_budgets[TAN_THREAD_BUDGET_COUNT];
+        std::atomic<bool>                       m_stop;
+
+        // the loop being run, written before the workers are handed a job number
+        Task                                    m_task;
+        const void *                            m_body;
+        amf_size                                m_count;
+        amf_uint32                              m_ranges;
+        amf_uint64                              m_job;
+        std::atomic<amf_uint32>                 m_pending;
+    };
+
+    // Components keep the pool of their context until they are terminated, these run serially
+    // once they have none.
+    inline amf_uint32 TANThreadBudget(const TANThreadPool * pool, TAN_THREAD_BUDGET_COMPONENT component)
+    {
+        return pool ? pool->GetBudget(component) : 1;
+    }
+
+    template<typename Body>
+    inline void TANParallelFor(TANThreadPool * pool, amf_uint32 threads, amf_size count, const Body & body)
+    {
+        if (pool)
+        {
+            pool->ParallelFor(threads, count, body);
+        }
+        else
+        {
+            for (amf_size i = 0; i < count; i++)
+            {
+                body(i);
+            }
+        }
+    }
+} // namespace amf
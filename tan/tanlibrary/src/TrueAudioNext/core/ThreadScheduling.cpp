@@ -0,0 +1,169 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "ThreadScheduling.h"
+
+#include "public/common/TraceAdapter.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <errno.h>
+  #include <pthread.h>
+  #include <sched.h>
+  #include <sys/mman.h>
+#endif
+
+#define AMF_FACILITY L"TANThreadScheduling"
+
+using namespace amf;
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT amf::TANReadThreadScheduling(AMFPropertyStorage * storage, TANThreadScheduling & scheduling)
+{
+    AMF_RETURN_IF_FALSE(storage != nullptr, AMF_INVALID_ARG, L"storage == NULL");
+
+    amf_int64 schedulingClass = scheduling.schedulingClass;
+    amf_int64 priority = scheduling.priority;
+    amf_int64 affinityMask = amf_int64(scheduling.affinityMask);
+    bool lockMemory = scheduling.lockMemory;
+
+    storage->GetProperty(TAN_THREAD_SCHEDULING, &schedulingClass);
+    storage->GetProperty(TAN_THREAD_PRIORITY, &priority);
+    storage->GetProperty(TAN_THREAD_AFFINITY, &affinityMask);
+    storage->GetProperty(TAN_THREAD_LOCK_MEMORY, &lockMemory);
+
+    AMF_RETURN_IF_FALSE(
+        schedulingClass >= TAN_THREAD_SCHEDULING_CONTEXT && schedulingClass <= TAN_THREAD_SCHEDULING_RR,
+        AMF_INVALID_ARG,
+        L"Invalid TAN_THREAD_SCHEDULING %d", int(schedulingClass)
+        );
+    AMF_RETURN_IF_FALSE(priority >= 0 && priority <= 99, AMF_INVALID_ARG,
+        L"Invalid TAN_THREAD_PRIORITY %d", int(priority));
+
+    scheduling.schedulingClass = TAN_THREAD_SCHEDULING_CLASS(schedulingClass);
+    scheduling.priority = amf_int32(priority);
+    scheduling.affinityMask = amf_uint64(affinityMask);
+    scheduling.lockMemory = lockMemory;
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT amf::TANApplyThreadScheduling(const TANThreadScheduling & scheduling)
+{
+    const bool realTime =
+        scheduling.schedulingClass == TAN_THREAD_SCHEDULING_FIFO ||
+        scheduling.schedulingClass == TAN_THREAD_SCHEDULING_RR;
+
+#ifdef _WIN32
+    if (realTime)
+    {
+        AMF_RETURN_IF_FALSE(SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0,
+            AMF_ACCESS_DENIED, L"SetThreadPriority(THREAD_PRIORITY_TIME_CRITICAL) failed, error %u",
+            unsigned(GetLastError()));
+    }
+
+    if (scheduling.affinityMask)
+    {
+        AMF_RETURN_IF_FALSE(SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(scheduling.affinityMask)) != 0,
+            AMF_INVALID_ARG, L"SetThreadAffinityMask(0x%llx) failed, error %u",
+            (unsigned long long)scheduling.affinityMask, unsigned(GetLastError()));
+    }
+#elif defined(__linux__)
+    if (realTime)
+    {
+        const int policy = scheduling.schedulingClass == TAN_THREAD_SCHEDULING_FIFO ? SCHED_FIFO : SCHED_RR;
+        const int lowest = sched_get_priority_min(policy);
+        const int highest = sched_get_priority_max(policy);
+
+        sched_param param = {};
+        param.sched_priority = scheduling.priority ? scheduling.priority : lowest;
+
+        AMF_RETURN_IF_FALSE(param.sched_priority >= lowest && param.sched_priority <= highest, AMF_INVALID_ARG,
+            L"TAN_THREAD_PRIORITY %d is outside %d..%d", param.sched_priority, lowest, highest);
+
+        const int error = pthread_setschedparam(pthread_self(), policy, &param);
+
+        AMF_RETURN_IF_FALSE(error != EPERM, AMF_ACCESS_DENIED,
+            L"Real time scheduling denied, the process needs CAP_SYS_NICE or an RLIMIT_RTPRIO of %d",
+            param.sched_priority);
+        AMF_RETURN_IF_FALSE(error == 0, AMF_FAIL, L"pthread_setschedparam failed, error %d", error);
+    }
+
+    if (scheduling.affinityMask)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        for (int processor = 0; processor < 64; processor++)
+        {
+            if (scheduling.affinityMask & (amf_uint64(1) << processor))
+            {
+                CPU_SET(processor, &set);
+            }
+        }
+
+        const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+        AMF_RETURN_IF_FALSE(error == 0, AMF_INVALID_ARG,
+            L"TAN_THREAD_AFFINITY 0x%llx can't be applied, error %d",
+            (unsigned long long)scheduling.affinityMask, error);
+    }
+#else
+    AMF_RETURN_IF_FALSE(!realTime && !scheduling.affinityMask, AMF_NOT_SUPPORTED,
+        L"Real time scheduling and affinity of internal threads are not supported on this platform");
+#endif
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT amf::TANLockThreadMemory(const TANThreadScheduling & scheduling)
+{
+    if (!scheduling.lockMemory)
+    {
+        return AMF_OK;
+    }
+
+#ifdef __linux__
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        const int error = errno;
+
+        AMF_RETURN_IF_FALSE(error != EPERM, AMF_ACCESS_DENIED,
+            L"Memory locking denied, the process needs CAP_IPC_LOCK");
+        AMF_RETURN_IF_FALSE(error != ENOMEM, AMF_OUT_OF_MEMORY,
+            L"Memory locking failed, the process memory exceeds RLIMIT_MEMLOCK");
+        AMFTraceError(AMF_FACILITY, L"mlockall failed, error %d", error);
+
+        return AMF_FAIL;
+    }
+
+    return AMF_OK;
+#else
+    AMFTraceError(AMF_FACILITY, L"TAN_THREAD_LOCK_MEMORY is supported on Linux only");
+
+    return AMF_NOT_SUPPORTED;
+#endif
+}
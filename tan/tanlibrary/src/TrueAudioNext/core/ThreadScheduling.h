@@ -0,0 +1,52 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   ThreadScheduling.h
+///  @brief  Scheduling class, affinity and memory locking of internal threads
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "TrueAudioNext.h"   //TAN
+
+namespace amf
+{
+    struct TANThreadScheduling
+    {
+        TAN_THREAD_SCHEDULING_CLASS schedulingClass = TAN_THREAD_SCHEDULING_NORMAL;
+        amf_int32                   priority = 0;
+        amf_uint64                  affinityMask = 0;
+        bool                        lockMemory = false;
+    };
+
+    // Reads the TAN_THREAD_* properties of storage, the ones it doesn't have keep their defaults.
+    AMF_RESULT TANReadThreadScheduling(AMFPropertyStorage * storage, TANThreadScheduling & scheduling);
+
+    // Applies the scheduling class, priority and affinity to the calling thread. Fails with
+    // AMF_ACCESS_DENIED when the process isn't allowed to, AMF_NOT_SUPPORTED on platforms
+    // without them.
+    AMF_RESULT TANApplyThreadScheduling(const TANThreadScheduling & scheduling);
+
+    // Locks the current and future memory of the process, if scheduling asks for it.
+    AMF_RESULT TANLockThreadMemory(const TANThreadScheduling & scheduling);
+} // namespace amf
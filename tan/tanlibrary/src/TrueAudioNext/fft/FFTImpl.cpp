@@ -27,10 +27,15 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <memory>
+#include <algorithm>
 #include <immintrin.h>
 
 #ifdef OMP_ENABLED
   #include <omp.h>
+#else
+  // the IPP transforms keep a spec and a work buffer per OpenMP thread, one without OpenMP
+  static inline int omp_get_max_threads() { return 1; }
+  static inline int omp_get_thread_num() { return 0; }
 #endif
 
 #ifdef _WIN32
@@ -71,7 +76,7 @@ TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateFFT(
     )
 {
     TANContextImplPtr contextImpl(pContext);
-    *ppComponent = new TANFFTImpl(pContext, false);
+    *ppComponent = new TANFFTImpl(pContext, false, TAN_THREAD_BUDGET_FFT);
     (*ppComponent)->Acquire();
     return AMF_OK;
 }
@@ -84,19 +89,22 @@ TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateFFT(
     )
 {
     TANContextImplPtr contextImpl(pContext);
-    *ppComponent = new TANFFTImpl(pContext, useConvQueue);
+    *ppComponent = new TANFFTImpl(pContext, useConvQueue, TAN_THREAD_BUDGET_CONVOLUTION);
     (*ppComponent)->Acquire();
     return AMF_OK;
 }
 
 //-------------------------------------------------------------------------------------------------
-TANFFTImpl::TANFFTImpl(TANContext *pContextTAN, bool useConvQueue) :
+TANFFTImpl::TANFFTImpl(TANContext *pContextTAN, bool useConvQueue, TAN_THREAD_BUDGET_COMPONENT threadBudget) :
     m_pContextTAN(pContextTAN),
+    m_pThreadPool(&TANContextImplPtr(pContextTAN)->GetThreadPool()),
+    m_threadBudget(threadBudget),
     m_useConvQueue(useConvQueue)
 {
-   // AMFPrimitivePropertyInfoMapBegin
+    AMFPrimitivePropertyInfoMapBegin
    //     AMFPropertyInfoEnum(TAN_OUTPUT_MEMORY_TYPE ,  L"Output Memory Type", AMF_MEMORY_HOST, AMF_MEMORY_ENUM_DESCRIPTION, false),
-   // AMFPrimitivePropertyInfoMapEnd
+        TANStatsPropertyInfoBlocks,
+    AMFPrimitivePropertyInfoMapEnd
 }
 //-------------------------------------------------------------------------------------------------
 TANFFTImpl::~TANFFTImpl(void)
@@ -104,6 +112,23 @@ TANFFTImpl::~TANFFTImpl(void)
     Terminate();
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANFFTImpl::GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const
+{
+    const AMF_RESULT res = AMFPropertyStorageExImpl<TANFFT>::GetProperty(name, pValue);
+
+    if (res == AMF_OK)
+    {
+        m_counters.GetProperty(name, pValue);
+    }
+
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL TANFFTImpl::OnPropertyChanged(const wchar_t* name)
+{
+    m_counters.OnPropertyChanged(this, name);
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL TANFFTImpl::Init()
 {
     AMF_RETURN_IF_FALSE(m_pContextTAN != NULL, AMF_WRONG_STATE,
@@ -225,18 +250,8 @@ AMF_RESULT  AMF_STD_CALL TANFFTImpl::InitCpu()
 
     AMFLock lock(&m_sect);
 
-	//todo: move to utils
-
-#ifdef OMP_ENABLED
-	int numThreads = 0;
-	int numProcs = 1;
-	numProcs = omp_get_num_procs();
-	numThreads = numProcs / 4;
-	if (numThreads == 0)
-		numThreads = 1;
-	omp_set_num_threads(numThreads);
-	numThreads = omp_get_max_threads();
-#endif
+    // the workers of the context, started now rather than by the first transform
+    AMF_RETURN_IF_FAILED(m_pThreadPool->Start());
 
     m_doProcessingOnGpu = false;
 
@@ -391,6 +406,7 @@ AMF_RESULT  AMF_STD_CALL TANFFTImpl::Terminate()
 	//}
 
     m_pContextTAN.Release();
+    m_pThreadPool = nullptr;
 
     m_pKernelCopy.Release();
 
@@ -490,6 +506,8 @@ AMF_RESULT  AMF_STD_CALL    TANFFTImpl::Transform(
     AMF_RETURN_IF_FALSE(log2len > 0, AMF_INVALID_ARG, L"log2len == 0");
     AMF_RETURN_IF_FALSE(log2len < sizeof(amf_size) * 8, AMF_INVALID_ARG, L"log2len is too big");
 
+    TANBlockTimer blockTimer(m_counters, 0);
+
 	bool useRealFFT = (direction & 2) != 0;
 	//direction = (TAN_FFT_TRANSFORM_DIRECTION)(int(direction) & 1);
 
@@ -579,7 +597,7 @@ AMF_RESULT  AMF_STD_CALL    TANFFTImpl::Transform(
 #ifdef USE_FFTW
     if (amf::TANFFTImpl::mUseIntrinsics)
 	{
-        res = TransformImplCpuOMP(direction, log2len, channels, ppBufferInput, ppBufferOutput);
+        res = TransformImplCpuOMP(direction, log2len, channels, ppBufferInput, ppBufferOutput, 0);
     }
     else
 #endif
@@ -593,6 +611,144 @@ AMF_RESULT  AMF_STD_CALL    TANFFTImpl::Transform(
     return res;
 }
 
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANFFTImpl::TransformPruned(
+    TAN_FFT_TRANSFORM_DIRECTION direction,
+    amf_uint32 log2len,
+    amf_uint32 channels,
+    float* ppBufferInput[],
+    float* ppBufferOutput[],
+    amf_uint32 nonZeroInputLength,
+    amf_uint32 requiredOutputLength
+)
+{
+    AMF_RETURN_IF_FALSE(ppBufferInput != NULL, AMF_INVALID_ARG, L"pBufferInput == NULL");
+    AMF_RETURN_IF_FALSE(ppBufferOutput != NULL, AMF_INVALID_ARG, L"pBufferOutput == NULL");
+    AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+    AMF_RETURN_IF_FALSE(log2len > 0, AMF_INVALID_ARG, L"log2len == 0");
+    AMF_RETURN_IF_FALSE(log2len < sizeof(amf_size) * 8, AMF_INVALID_ARG, L"log2len is too big");
+
+    // clFFT plans are baked for full transforms, nothing to prune on the GPU.
+    if (m_doProcessingOnGpu)
+    {
+        return Transform(direction, log2len, channels, ppBufferInput, ppBufferOutput);
+    }
+
+    AMF_RETURN_IF_FALSE(direction == TAN_FFT_TRANSFORM_DIRECTION_FORWARD || direction == TAN_FFT_TRANSFORM_DIRECTION_BACKWARD
+		|| direction == TAN_FFT_R2C_TRANSFORM_DIRECTION_FORWARD || direction == TAN_FFT_C2R_TRANSFORM_DIRECTION_BACKWARD
+		|| direction == TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD || direction == TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD,
+        AMF_INVALID_ARG, L"Invalid conversion type");
+
+    const amf_size fftLength = amf_size(1) << log2len;
+
+    amf_size nonZeroLength = nonZeroInputLength;
+    if (nonZeroLength == 0 || nonZeroLength > fftLength)
+    {
+        nonZeroLength = fftLength;
+    }
+
+    amf_size requiredLength = requiredOutputLength;
+    if (requiredLength == 0 || requiredLength > fftLength)
+    {
+        requiredLength = fftLength;
+    }
+
+    AMFLock lock(&m_sect);
+    AMF_RESULT res = AMF_OK;
+
+    TANBlockTimer blockTimer(m_counters, 0);
+
+#ifdef USE_IPP
+    // IPP scales the inverse transform internally, there is nothing to prune.
+    res = TransformImplIPP(direction, log2len, channels, ppBufferInput, ppBufferOutput);
+#else
+
+#ifdef USE_FFTW
+    // FFTW plans can't skip stages, only the scaling of the discarded output is saved.
+    if (amf::TANFFTImpl::mUseIntrinsics)
+    {
+        res = TransformImplCpuOMP(direction, log2len, channels, ppBufferInput, ppBufferOutput, requiredLength);
+    }
+    else
+#endif
+    {
+        res = TransformImplCpuPruned(direction, log2len, channels, ppBufferInput, ppBufferOutput, nonZeroLength, requiredLength);
+    }
+#endif
+
+    AMF_RETURN_IF_FAILED(res, L"TransformPruned() failed");
+
+    return res;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANFFTImpl::Prepare(
+    TAN_FFT_TRANSFORM_DIRECTION direction,
+    amf_uint32 log2len,
+    amf_uint32 channels,
+    int dataSpacing
+)
+{
+    AMFLock lock(&m_sect);
+
+    AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+    AMF_RETURN_IF_FALSE(log2len > 0, AMF_INVALID_ARG, L"log2len == 0");
+    AMF_RETURN_IF_FALSE(log2len < sizeof(amf_size) * 8, AMF_INVALID_ARG, L"log2len is too big");
+
+    // CPU transforms have no per-shape setup worth hoisting.
+    if (!m_doProcessingOnGpu)
+    {
+        return AMF_OK;
+    }
+
+    FFT_TRANSFORM_TYPE transformType = FFT_TRANSFORM_COMPLEX;
+    switch (direction)
+    {
+    case TAN_FFT_TRANSFORM_DIRECTION_FORWARD:
+    case TAN_FFT_TRANSFORM_DIRECTION_BACKWARD:
+        transformType = FFT_TRANSFORM_COMPLEX;
+        break;
+
+    case TAN_FFT_R2C_TRANSFORM_DIRECTION_FORWARD:
+        transformType = FFT_TRANSFORM_R2C_FORWARD;
+        break;
+
+    case TAN_FFT_C2R_TRANSFORM_DIRECTION_BACKWARD:
+        transformType = FFT_TRANSFORM_C2R_BACKWARD;
+        break;
+
+    default:
+        AMF_RETURN_IF_FALSE(false, AMF_INVALID_ARG, L"Invalid conversion type");
+    }
+
+    // Transform() stages host data through the internal buffers, size them now as well.
+    if (dataSpacing == 0)
+    {
+        AMF_RETURN_IF_FAILED(AdjustInternalBufferSize(log2len + 1, channels));
+    }
+
+    AMF_RETURN_IF_FALSE(GetFFTPlan(static_cast<int>(log2len), channels, transformType, dataSpacing) != 0,
+        AMF_UNEXPECTED, L"Cannot create FFT plan");
+
+    return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+TANComplexLayout AMF_STD_CALL TANFFTImpl::GetComplexLayout(
+    TAN_FFT_TRANSFORM_DIRECTION direction,
+    amf_uint32 log2len
+    )
+{
+    // same imaginary plane offset as TransformImplFFTWReal and TransformImplCpuPruned
+    if (direction == TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD ||
+        direction == TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD)
+    {
+        return TANPlanarLayout((amf_size(1) << log2len) / 2 + 8);
+    }
+
+    return TANInterleavedLayout();
+}
+
 #ifndef TAN_NO_OPENCL
 AMF_RESULT  AMF_STD_CALL    TANFFTImpl::TransformBatchGPU(
 	TAN_FFT_TRANSFORM_DIRECTION direction,
@@ -616,6 +772,8 @@ AMF_RESULT  AMF_STD_CALL    TANFFTImpl::TransformBatchGPU(
 	}
 	AMFLock lock(&m_sect);
 
+	TANBlockTimer blockTimer(m_counters, 0);
+
 	AMF_RESULT res = AMF_OK;
 	// process
 	res = TransformImplGPUBatched(direction, log2len, channels, pBufferInput, pBufferOutput, dataSpacing);
@@ -647,6 +805,8 @@ AMF_RESULT  AMF_STD_CALL    TANFFTImpl::TransformBatchGPU(
 	}
 	AMFLock lock(&m_sect);
 
+	TANBlockTimer blockTimer(m_counters, 0);
+
 	AMF_RESULT res = AMF_OK;
 	// process
 	res = TransformImplGPUBatched(direction, log2len, channels, pBufferInput, pBufferOutput, dataSpacing);
@@ -1000,6 +1160,348 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplCpu1Chan(
     return AMF_OK;
 }
 
+//-------------------------------------------------------------------------------------------------
+static inline amf_size ReverseBits(amf_size value, amf_size bits)
+{
+    amf_size reversed = 0;
+
+    for (amf_size bit = 0; bit < bits; bit++)
+    {
+        reversed = (reversed << 1) | (value & 1);
+        value >>= 1;
+    }
+
+    return reversed;
+}
+
+// Twiddles of the pruned CPU transforms, e^(-2 pi i j / 2 ^ log2len) for j = 0 .. 2 ^ log2len / 2
+// as (cos, sin) pairs. Transforms of 2 ^ log2len and of any shorter length index the same table.
+const float * TANFFTImpl::PrunedTwiddles(amf_size log2len)
+{
+    if (m_prunedTwiddlesLog2 != log2len)
+    {
+        const amf_size fftFrameSize = amf_size(1) << log2len;
+        const amf_size halfFrameSize = fftFrameSize / 2;
+
+        m_prunedTwiddles.resize(2 * (halfFrameSize + 1));
+        for (amf_size j = 0; j <= halfFrameSize; j++)
+        {
+            const double arg = 2.0 * M_PI * double(j) / double(fftFrameSize);
+
+            m_prunedTwiddles[2 * j] = float(cos(arg));
+            m_prunedTwiddles[2 * j + 1] = float(-sin(arg));
+        }
+        m_prunedTwiddlesLog2 = log2len;
+    }
+
+    return m_prunedTwiddles.data();
+}
+
+// Pruned radix-2 DIT transform of one complex frame.
+// After the bit reversal only every 2 ^ p-th point is fed from the non-zero head, so the first p
+// stages degenerate to copies. The stages wider than twice the required output only produce the
+// upper half of their butterflies. Twiddles come from a PrunedTwiddles table of 2 ^ twiddleLog2
+// points, twiddleLog2 >= log2len.
+AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplCpuPruned1Chan(
+    TAN_FFT_TRANSFORM_DIRECTION direction,
+    amf_size log2len,
+    const float* pBufferInput,
+    float* pBufferOutput,
+    amf_size nonZeroInputLength,
+    amf_size requiredOutputLength,
+    const float* pTwiddles,
+    amf_size twiddleLog2
+    )
+{
+    const amf_size fftFrameSize = amf_size(1) << log2len;
+    const float sign = (direction == TAN_FFT_TRANSFORM_DIRECTION_FORWARD) ? 1.0f : -1.0f;
+
+    amf_size copyStages = 0;
+    while (copyStages < log2len && (fftFrameSize >> (copyStages + 1)) >= nonZeroInputLength)
+    {
+        ++copyStages;
+    }
+    const amf_size inputSpan = fftFrameSize >> copyStages;
+
+    amf_size outputSpan = fftFrameSize;
+    while (outputSpan > 1 && (outputSpan >> 1) >= requiredOutputLength)
+    {
+        outputSpan >>= 1;
+    }
+
+    // bit reversal, touches only the non-zero head
+    if (pBufferInput == pBufferOutput)
+    {
+        for (amf_size i = 0; i < inputSpan; i++)
+        {
+            const amf_size j = ReverseBits(i, log2len);
+
+            if (i < j)
+            {
+                std::swap(pBufferOutput[2 * i], pBufferOutput[2 * j]);
+                std::swap(pBufferOutput[2 * i + 1], pBufferOutput[2 * j + 1]);
+            }
+        }
+    }
+    else
+    {
+        for (amf_size i = 0; i < inputSpan; i++)
+        {
+            const amf_size j = ReverseBits(i, log2len);
+
+            if (i >= nonZeroInputLength)
+            {
+                pBufferOutput[2 * j] = 0.0f;
+                pBufferOutput[2 * j + 1] = 0.0f;
+            }
+            else
+            {
+                pBufferOutput[2 * j] = pBufferInput[2 * i];
+                pBufferOutput[2 * j + 1] = pBufferInput[2 * i + 1];
+            }
+        }
+    }
+
+    // stages with a single non-zero input per butterfly group
+    const amf_size copyGroup = amf_size(1) << copyStages;
+    if (copyGroup > 1)
+    {
+        for (amf_size i = 0; i < fftFrameSize; i += copyGroup)
+        {
+            const float re = pBufferOutput[2 * i];
+            const float im = pBufferOutput[2 * i + 1];
+
+            for (amf_size k = 1; k < copyGroup; k++)
+            {
+                pBufferOutput[2 * (i + k)] = re;
+                pBufferOutput[2 * (i + k) + 1] = im;
+            }
+        }
+    }
+
+    for (amf_size stage = copyStages + 1; stage <= log2len; stage++)
+    {
+        const amf_size span = amf_size(1) << stage;
+        const amf_size half = span >> 1;
+        const bool upperOnly = span > outputSpan;
+        const amf_size butterflies = upperOnly ? outputSpan : half;
+        const amf_size twiddleStride = amf_size(1) << (twiddleLog2 - stage);
+
+        for (amf_size k = 0; k < butterflies; k++)
+        {
+            const float ur = pTwiddles[2 * k * twiddleStride];
+            const float ui = sign * pTwiddles[2 * k * twiddleStride + 1];
+
+            for (amf_size i = k; i < fftFrameSize; i += span)
+            {
+                float *p1 = pBufferOutput + 2 * i;
+                float *p2 = p1 + 2 * half;
+
+                const float tr = p2[0] * ur - p2[1] * ui;
+                const float ti = p2[0] * ui + p2[1] * ur;
+
+                if (!upperOnly)
+                {
+                    p2[0] = p1[0] - tr;
+                    p2[1] = p1[1] - ti;
+                }
+                p1[0] += tr;
+                p1[1] += ti;
+            }
+        }
+    }
+
+    // Riemann sum.
+    if (direction == TAN_FFT_TRANSFORM_DIRECTION_BACKWARD)
+    {
+        const amf_size scaledFloats = 2 * std::min(requiredOutputLength, fftFrameSize);
+        const float scale = 1.0f / float(fftFrameSize);
+
+        for (amf_size k = 0; k < scaledFloats; k++)
+        {
+            pBufferOutput[k] *= scale;
+        }
+    }
+
+    return AMF_OK;
+}
+
+// Real transforms run as a complex transform of half the length: the even samples are the real
+// and the odd ones the imaginary parts of the half length frame, which is exactly the layout of
+// the real samples in memory. The split into the even and odd spectra and the twiddle of the odd
+// one happen in a pass over the half spectrum. Pruning applies to the packed input of R2C and to
+// the packed output of C2R, the other side needs the whole half length frame.
+AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplCpuPruned(
+    TAN_FFT_TRANSFORM_DIRECTION direction,
+    amf_size log2len,
+    amf_size channels,
+    float* ppBufferInput[],
+    float* ppBufferOutput[],
+    amf_size nonZeroInputLength,
+    amf_size requiredOutputLength
+    )
+{
+    const amf_size fftFrameSize = amf_size(1) << log2len;
+    const amf_size halfFrameSize = fftFrameSize / 2;
+    const float *twiddles = PrunedTwiddles(log2len);
+
+    // imaginary plane offset of the planar layout, see TransformImplFFTWReal
+    const amf_size planarOffset = halfFrameSize + 8;
+
+    if (direction == TAN_FFT_TRANSFORM_DIRECTION_FORWARD || direction == TAN_FFT_TRANSFORM_DIRECTION_BACKWARD)
+    {
+        for (amf_size channel = 0; channel < channels; channel++)
+        {
+            AMF_RETURN_IF_FAILED(
+                TransformImplCpuPruned1Chan(
+                    direction,
+                    log2len,
+                    ppBufferInput[channel],
+                    ppBufferOutput[channel],
+                    nonZeroInputLength,
+                    requiredOutputLength,
+                    twiddles,
+                    log2len
+                    )
+                );
+        }
+
+        return AMF_OK;
+    }
+
+    if (m_prunedFrame.size() < fftFrameSize + 2)
+    {
+        m_prunedFrame.resize(fftFrameSize + 2);
+    }
+    float *frame = m_prunedFrame.data();
+
+    for (amf_size channel = 0; channel < channels; channel++)
+    {
+        const float *in = ppBufferInput[channel];
+        float *out = ppBufferOutput[channel];
+
+        switch (direction)
+        {
+        case TAN_FFT_R2C_TRANSFORM_DIRECTION_FORWARD:
+        case TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD:
+        {
+            AMF_RETURN_IF_FAILED(
+                TransformImplCpuPruned1Chan(
+                    TAN_FFT_TRANSFORM_DIRECTION_FORWARD,
+                    log2len - 1,
+                    in,
+                    frame,
+                    (nonZeroInputLength + 1) / 2,
+                    halfFrameSize,
+                    twiddles,
+                    log2len
+                    )
+                );
+            frame[2 * halfFrameSize] = frame[0];
+            frame[2 * halfFrameSize + 1] = frame[1];
+
+            // X[k] = E[k] + W^k O[k], E[k] = (Z[k] + Z*[M - k]) / 2, O[k] = -i (Z[k] - Z*[M - k]) / 2,
+            // k and M - k are done together so that the frame can be overwritten in place
+            const amf_size bins = std::min(requiredOutputLength, halfFrameSize + 1);
+            for (amf_size k = 0; k <= halfFrameSize / 2; k++)
+            {
+                const amf_size m = halfFrameSize - k;
+
+                const float zkr = frame[2 * k], zki = frame[2 * k + 1];
+                const float zmr = frame[2 * m], zmi = frame[2 * m + 1];
+
+                const float ekr = 0.5f * (zkr + zmr), eki = 0.5f * (zki - zmi);
+                const float okr = 0.5f * (zki + zmi), oki = -0.5f * (zkr - zmr);
+                const float wkr = twiddles[2 * k], wki = twiddles[2 * k + 1];
+
+                // E[M - k] = E*[k], O[M - k] = O*[k], W^(M - k) = -W*^k
+                frame[2 * k] = ekr + wkr * okr - wki * oki;
+                frame[2 * k + 1] = eki + wkr * oki + wki * okr;
+                frame[2 * m] = ekr - wkr * okr + wki * oki;
+                frame[2 * m + 1] = -eki + wkr * oki + wki * okr;
+            }
+
+            for (amf_size k = 0; k < bins; k++)
+            {
+                if (direction == TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD)
+                {
+                    out[k] = frame[2 * k];
+                    out[planarOffset + k] = frame[2 * k + 1];
+                }
+                else
+                {
+                    out[2 * k] = frame[2 * k];
+                    out[2 * k + 1] = frame[2 * k + 1];
+                }
+            }
+        }
+            break;
+
+        case TAN_FFT_C2R_TRANSFORM_DIRECTION_BACKWARD:
+        case TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD:
+        {
+            for (amf_size k = 0; k <= halfFrameSize; k++)
+            {
+                if (direction == TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD)
+                {
+                    frame[2 * k] = in[k];
+                    frame[2 * k + 1] = in[planarOffset + k];
+                }
+                else
+                {
+                    frame[2 * k] = in[2 * k];
+                    frame[2 * k + 1] = in[2 * k + 1];
+                }
+            }
+
+            // Z[k] = (E'[k] + i W^-k O'[k]) / 2, E'[k] = X[k] + X*[M - k], O'[k] = X[k] - X*[M - k],
+            // the halving makes up for the 1 / M scaling of the half length transform
+            for (amf_size k = 0; k <= halfFrameSize / 2; k++)
+            {
+                const amf_size m = halfFrameSize - k;
+
+                const float xkr = frame[2 * k], xki = frame[2 * k + 1];
+                const float xmr = frame[2 * m], xmi = frame[2 * m + 1];
+
+                const float ekr = 0.5f * (xkr + xmr), eki = 0.5f * (xki - xmi);
+                const float dkr = 0.5f * (xkr - xmr), dki = 0.5f * (xki + xmi);
+                const float wkr = twiddles[2 * k], wki = -twiddles[2 * k + 1];
+
+                // O' twiddled by W^-k, then multiplied by i
+                const float okr = dkr * wkr - dki * wki, oki = dkr * wki + dki * wkr;
+
+                // E'[M - k] = E'*[k], W^-(M - k) O'[M - k] = -(W^-k O'[k])*
+                frame[2 * k] = ekr - oki;
+                frame[2 * k + 1] = eki + okr;
+                frame[2 * m] = ekr + oki;
+                frame[2 * m + 1] = -eki + okr;
+            }
+
+            AMF_RETURN_IF_FAILED(
+                TransformImplCpuPruned1Chan(
+                    TAN_FFT_TRANSFORM_DIRECTION_BACKWARD,
+                    log2len - 1,
+                    frame,
+                    frame,
+                    halfFrameSize,
+                    (requiredOutputLength + 1) / 2,
+                    twiddles,
+                    log2len
+                    )
+                );
+
+            memcpy(out, frame, std::min(requiredOutputLength, fftFrameSize) * sizeof(float));
+        }
+            break;
+
+        default:
+            return AMF_INVALID_ARG;
+        }
+    }
+
+    return AMF_OK;
+}
+
 #ifdef USE_FFTW
 
 AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplFFTW1Chan(
@@ -1007,7 +1509,8 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplFFTW1Chan(
     amf_size log2len,
     amf_size channel,
     float* pBufferInput[],
-    float* pBufferOutput[]
+    float* pBufferOutput[],
+    amf_size scaledLength
     )
 {
     amf_uint64 key = 0;
@@ -1035,7 +1538,9 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplFFTW1Chan(
     // Riemann sum.
     if (direction == TAN_FFT_TRANSFORM_DIRECTION_BACKWARD)
     {
-        for (int k = 0; k < 2 * fftLength; k++){
+        const amf_size scaledFloats = scaledLength ? 2 * scaledLength : 2 * fftLength;
+
+        for (amf_size k = 0; k < scaledFloats; k++){
             pBufferOutput[channel][k] /= fftLength;
         }
     }
@@ -1124,7 +1629,8 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplFFTWReal1Chan(
 AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplFFTWReal(TAN_FFT_TRANSFORM_DIRECTION direction,
 	amf_size log2len,
 	float* in,
-	float* out
+	float* out,
+	amf_size scaledLength
 	)
 {
 	int fftWDir = 0;
@@ -1174,7 +1680,9 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplFFTWReal(TAN_FFT_TRANSFORM_DIRE
 	// Riemann sum.
 	if (fftWDir == FFTW_BACKWARD)
 	{
-		for (int k = 0; k < 2 * fftLength + 2; k++) {
+		const amf_size scaledFloats = scaledLength ? scaledLength : 2 * fftLength + 2;
+
+		for (amf_size k = 0; k < scaledFloats; k++) {
 			out[k] /= fftLength;
 		}
 	}
@@ -1187,7 +1695,8 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplCpuOMP(
     amf_size log2len,
     amf_size channels,
     float* ppBufferInput[],
-    float* ppBufferOutput[]
+    float* ppBufferOutput[],
+    amf_size scaledLength
     )
 {
     amf_uint fftLength = 1 << log2len;
@@ -1196,7 +1705,8 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplCpuOMP(
 					|| direction == TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD
 					|| direction == TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD);
 
-    int idx(0);
+    const amf_uint32 threads = TANThreadBudget(m_pThreadPool, m_threadBudget);
+
     if (mFFTWavailable){
         fftwf_complex * in = (fftwf_complex *)ppBufferInput[0];
         fftwf_complex * out = (fftwf_complex *)ppBufferOutput[0];
@@ -1215,13 +1725,9 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplCpuOMP(
 				bwdRealPlanarPlans[log2len] = fftwf_plan_guru_split_dft_c2r(1, &iod, 0, NULL, (float *)in, (float *)(in) + (8 + fftLength/2), (float *)out, FFTW_MEASURE);
 			}
 
-// OpenMP doesn't work well for realtime code on Windows :(
-#pragma omp parallel default(none) private(idx) shared(direction, log2len,channels,ppBufferInput,ppBufferOutput)
-#pragma omp for private(idx) schedule(static) // schedule(guided) nowait //schedule(static)
-//__pragma(loop(hint_parallel(8))) // requires VS compiler flag /QPar       {see Enable Parallel Code Generation }
-			for (int idx = 0; idx < (int)channels; idx++) {
-				TransformImplFFTWReal(direction, log2len, ppBufferInput[idx], ppBufferOutput[idx]);
-			}
+			TANParallelFor(m_pThreadPool, threads, channels, [&](amf_size idx) {
+				TransformImplFFTWReal(direction, log2len, ppBufferInput[idx], ppBufferOutput[idx], scaledLength);
+			});
 
 		}
 		else {
@@ -1229,19 +1735,15 @@ AMF_RESULT AMF_STD_CALL TANFFTImpl::TransformImplCpuOMP(
 				fwdPlans[log2len] = fftwf_plan_dft_1d(fftLength, (fftwf_complex *)in, (fftwf_complex *)out, FFTW_FORWARD, FFTW_MEASURE);
 				bwdPlans[log2len] = fftwf_plan_dft_1d(fftLength, (fftwf_complex *)in, (fftwf_complex *)out, FFTW_BACKWARD, FFTW_MEASURE);
 			}
-#pragma omp parallel default(none) private(idx) shared(direction, log2len,channels,ppBufferInput,ppBufferOutput)
-#pragma omp for
-			for (idx = 0; idx < channels; idx++) {
-				TransformImplFFTW1Chan(direction, log2len, idx, ppBufferInput, ppBufferOutput);
-			}
+			TANParallelFor(m_pThreadPool, threads, channels, [&](amf_size idx) {
+				TransformImplFFTW1Chan(direction, log2len, idx, ppBufferInput, ppBufferOutput, scaledLength);
+			});
 		}
     }
     else {
-#pragma omp parallel default(none) private(idx) shared(direction, log2len,channels,ppBufferInput,ppBufferOutput)
-#pragma omp for private(idx)
-		for (idx = 0; idx < channels; idx++){
+		TANParallelFor(m_pThreadPool, threads, channels, [&](amf_size idx) {
             TransformImplCpu1Chan(direction, log2len, ppBufferInput[idx], ppBufferOutput[idx]);
-        }
+        });
 //  todo try this:      res = TransformImplCpu(direction, log2len, channels, ppBufferInput, ppBufferOutput);
 
     }
@@ -55,7 +55,10 @@
 #include "public/include/core/Context.h"        //AMF
 #include "public/include/components/Component.h"//AMF
 #include "public/common/PropertyStorageExImpl.h"
+#include "../core/PerformanceCounters.h"
+#include "../core/ThreadPool.h"
 #include <unordered_map>
+#include <vector>
 
 #ifdef USE_FFTW
   #include "api/fftw3.h"
@@ -77,7 +80,7 @@ namespace amf
 
         typedef AMFInterfacePtr_T<TANFFTImpl> Ptr;
 
-        TANFFTImpl(TANContext *pContextTAN, bool useConvQueue);
+        TANFFTImpl(TANContext *pContextTAN, bool useConvQueue, TAN_THREAD_BUDGET_COMPONENT threadBudget);
         virtual ~TANFFTImpl(void);
 
 // interface access
@@ -100,6 +103,33 @@ namespace amf
                                            		float* ppBufferOutput[]
 												) override;
 
+        AMF_RESULT  AMF_STD_CALL TransformPruned(
+												TAN_FFT_TRANSFORM_DIRECTION direction,
+                                           		amf_uint32 log2len,
+                                           		amf_uint32 channels,
+                                           		float* ppBufferInput[],
+                                           		float* ppBufferOutput[],
+                                           		amf_uint32 nonZeroInputLength,
+                                           		amf_uint32 requiredOutputLength
+												) override;
+
+        AMF_RESULT  AMF_STD_CALL Prepare(
+												TAN_FFT_TRANSFORM_DIRECTION direction,
+                                           		amf_uint32 log2len,
+                                           		amf_uint32 channels,
+                                           		int dataSpacing
+												) override;
+
+        TANComplexLayout AMF_STD_CALL GetComplexLayout(
+												TAN_FFT_TRANSFORM_DIRECTION direction,
+                                           		amf_uint32 log2len
+												) override;
+
+//AMFPropertyStorage interface, for the TAN_STATS_* properties
+        using TANFFT::GetProperty;
+        AMF_RESULT  AMF_STD_CALL GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const override;
+        void        AMF_STD_CALL OnPropertyChanged(const wchar_t* name) override;
+
 #ifndef TAN_NO_OPENCL
         AMF_RESULT  AMF_STD_CALL TransformBatchGPU(TAN_FFT_TRANSFORM_DIRECTION direction,
 											amf_uint32 log2len,
@@ -289,7 +319,8 @@ namespace amf
                                                         amf_size log2len,
                                                         amf_size channels,
                                                         float* ppBufferInput[],
-                                                        float* ppBufferOutput[]);
+                                                        float* ppBufferOutput[],
+                                                        amf_size scaledLength);
 #endif
 
 #ifdef USE_IPP
@@ -304,12 +335,29 @@ namespace amf
                                                         amf_size log2len,
                                                         float* pBufferInput,
                                                         float* pBufferOutput);
+		AMF_RESULT virtual AMF_STD_CALL TransformImplCpuPruned(TAN_FFT_TRANSFORM_DIRECTION direction,
+                                                        amf_size log2len,
+                                                        amf_size channels,
+                                                        float* ppBufferInput[],
+                                                        float* ppBufferOutput[],
+                                                        amf_size nonZeroInputLength,
+                                                        amf_size requiredOutputLength);
+		AMF_RESULT virtual AMF_STD_CALL TransformImplCpuPruned1Chan(TAN_FFT_TRANSFORM_DIRECTION direction,
+                                                        amf_size log2len,
+                                                        const float* pBufferInput,
+                                                        float* pBufferOutput,
+                                                        amf_size nonZeroInputLength,
+                                                        amf_size requiredOutputLength,
+                                                        const float* pTwiddles,
+                                                        amf_size twiddleLog2);
+		const float * PrunedTwiddles(amf_size log2len);
 #ifdef USE_FFTW
         AMF_RESULT virtual AMF_STD_CALL TransformImplFFTW1Chan(TAN_FFT_TRANSFORM_DIRECTION direction,
                                                         amf_size log2len,
                                                         amf_size channel,
                                                         float* pBufferInput[],
-                                                        float* pBufferOutput[]);
+                                                        float* pBufferOutput[],
+                                                        amf_size scaledLength);
 		AMF_RESULT virtual AMF_STD_CALL TransformImplFFTWReal1Chan(TAN_FFT_TRANSFORM_DIRECTION direction,
 														amf_size log2len,
 														amf_size channel,
@@ -318,7 +366,8 @@ namespace amf
 		AMF_RESULT virtual AMF_STD_CALL TransformImplFFTWReal(TAN_FFT_TRANSFORM_DIRECTION direction,
 														amf_size log2len,
 														float* pBufferInput,
-														float* pBufferOutput);
+														float* pBufferOutput,
+														amf_size scaledLength);
 #endif
 
 #ifndef TAN_NO_OPENCL
@@ -354,12 +403,26 @@ namespace amf
 		AMF_RESULT AdjustInternalBufferSize(size_t desireSizeInSampleLog2, size_t numofChannel);
         TANContextPtr               m_pContextTAN;
 
+        // CPU transforms run on the workers of the context, within the thread budget of
+        // convolution for the objects of convolutions
+        TANThreadPool *             m_pThreadPool = nullptr;
+        TAN_THREAD_BUDGET_COMPONENT m_threadBudget = TAN_THREAD_BUDGET_FFT;
+
+        // TAN_STATS_* properties, a block is a call of Transform
+        TANPerformanceCounters      m_counters;
+
         AMFComputeKernelPtr         m_pKernelCopy;
         AMF_MEMORY_TYPE             m_eOutputMemoryType = AMF_MEMORY_HOST;
         AMFCriticalSection          m_sect;
 
 		amf_size m_iInternalBufferSizeInBytes = 0;
 
+        // half length complex frame of the pruned real transforms on CPU and the twiddles of
+        // the pruned transforms, see PrunedTwiddles
+        std::vector<float>          m_prunedFrame;
+        std::vector<float>          m_prunedTwiddles;
+        amf_size                    m_prunedTwiddlesLog2 = 0;
+
 #ifndef TAN_NO_OPENCL
         cl_mem                      m_pInputsOCL = nullptr;
         cl_mem                      m_pOutputsOCL = nullptr;
@@ -372,7 +435,8 @@ namespace amf
         bool                        m_useConvQueue = false;
     };
 
-    // Internal function used only from TANConvolution class.
+    // Internal function used only from TANConvolution class, its objects take the threads of
+    // TAN_THREAD_BUDGET_CONVOLUTION.
     AMF_RESULT TANCreateFFT(amf::TANContext *pContext,
         amf::TANFFT** ppComponent,
         bool useConvQueue);
@@ -25,9 +25,12 @@
 #include <cmath>
 
 #include "FilterImpl.h"
+#include "FilterKernels.h"
 #include "../core/TANContextImpl.h"     //TAN
 
+#include <algorithm>
 #include <memory>
+#include <string.h>
 
 #define AMF_FACILITY L"TANFilterImpl"
 
@@ -86,6 +89,8 @@ AMF_RESULT  AMF_STD_CALL TANFilterImpl::Init()
 
     AMF_RETURN_IF_FAILED(TANCreateFFT(m_pContextTAN, &m_pFft));
     AMF_RETURN_IF_FAILED(m_pFft->Init());
+    AMF_RETURN_IF_FAILED(m_pFft->Prepare(TAN_FFT_TRANSFORM_DIRECTION_FORWARD, EQ_FILTER_LOG2LEN, 1, 0));
+    AMF_RETURN_IF_FAILED(m_pFft->Prepare(TAN_FFT_TRANSFORM_DIRECTION_BACKWARD, EQ_FILTER_LOG2LEN, 1, 0));
 
     m_eqFilter = new float[1 << (EQ_FILTER_LOG2LEN + 1)]; // array of complex numbers
 
@@ -178,3 +183,213 @@ AMF_RESULT  AMF_STD_CALL TANFilterImpl::generate10BandEQ(amf_uint32 log2len,
 
     return AMF_OK;
 }
+
+//-------------------------------------------------------------------------------------------------
+// The RBJ cookbook biquad of a band as the polynomials in u = z^-1 - 1 of FilterKernels.h.
+static void EQBandSection(const TANEQBand & band, double sampleRate, float * section)
+{
+    const double w = 2.0 * M_PI * band.frequency / sampleRate;
+    const double cw = cos(w);
+    const double alpha = sin(w) / (2.0 * band.q);
+    const double a = pow(10.0, band.gainDb / 40.0);
+    const double root = 2.0 * sqrt(a) * alpha;
+    double b[3] = { 1.0, 0.0, 0.0 };
+    double d[3] = { 1.0, 0.0, 0.0 };
+
+    switch (band.type)
+    {
+    case TAN_EQ_BAND_PEAKING:
+        b[0] = 1.0 + alpha * a;
+        b[1] = -2.0 * cw;
+        b[2] = 1.0 - alpha * a;
+        d[0] = 1.0 + alpha / a;
+        d[1] = -2.0 * cw;
+        d[2] = 1.0 - alpha / a;
+        break;
+    case TAN_EQ_BAND_LOW_SHELF:
+        b[0] = a * ((a + 1.0) - (a - 1.0) * cw + root);
+        b[1] = 2.0 * a * ((a - 1.0) - (a + 1.0) * cw);
+        b[2] = a * ((a + 1.0) - (a - 1.0) * cw - root);
+        d[0] = (a + 1.0) + (a - 1.0) * cw + root;
+        d[1] = -2.0 * ((a - 1.0) + (a + 1.0) * cw);
+        d[2] = (a + 1.0) + (a - 1.0) * cw - root;
+        break;
+    case TAN_EQ_BAND_HIGH_SHELF:
+        b[0] = a * ((a + 1.0) + (a - 1.0) * cw + root);
+        b[1] = -2.0 * a * ((a - 1.0) + (a + 1.0) * cw);
+        b[2] = a * ((a + 1.0) + (a - 1.0) * cw - root);
+        d[0] = (a + 1.0) - (a - 1.0) * cw + root;
+        d[1] = 2.0 * ((a - 1.0) - (a + 1.0) * cw);
+        d[2] = (a + 1.0) - (a - 1.0) * cw - root;
+        break;
+    case TAN_EQ_BAND_LOW_PASS:
+        b[0] = (1.0 - cw) / 2.0;
+        b[1] = 1.0 - cw;
+        b[2] = (1.0 - cw) / 2.0;
+        d[0] = 1.0 + alpha;
+        d[1] = -2.0 * cw;
+        d[2] = 1.0 - alpha;
+        break;
+    case TAN_EQ_BAND_HIGH_PASS:
+        b[0] = (1.0 + cw) / 2.0;
+        b[1] = -(1.0 + cw);
+        b[2] = (1.0 + cw) / 2.0;
+        d[0] = 1.0 + alpha;
+        d[1] = -2.0 * cw;
+        d[2] = 1.0 - alpha;
+        break;
+    }
+
+    section[0] = float((b[0] + b[1] + b[2]) / d[0]);
+    section[1] = float((b[1] + 2.0 * b[2]) / d[0]);
+    section[2] = float(b[2] / d[0]);
+    section[3] = float((d[0] + d[1] + d[2]) / d[0]);
+    section[4] = float((d[1] + 2.0 * d[2]) / d[0]);
+    section[5] = float(d[2] / d[0]);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Writes or multiplies the response into the real and imaginary parts of a spectrum, step floats
+// from bin to bin.
+static void StoreResponse(const float * re, const float * im, amf_size bins,
+    float * outRe, float * outIm, amf_size step, bool multiply)
+{
+    for (amf_size k = 0; k < bins; k++)
+    {
+        const float xr = outRe[k * step];
+        const float xi = outIm[k * step];
+
+        outRe[k * step] = multiply ? xr * re[k] - xi * im[k] : re[k];
+        outIm[k * step] = multiply ? xr * im[k] + xi * re[k] : im[k];
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANFilterImpl::generateParametricEQ(amf_uint32 log2len,
+    float sampleRate,
+    amf_uint32 channels,
+    const TANEQBand * const ppBands[],
+    const amf_uint32 bandCounts[],
+    float * ppSpectra[],
+    TANComplexLayout layout,
+    amf_uint32 partitions,
+    amf_size partitionStride,
+    bool multiply)
+{
+    AMFLock lock(&m_sect);
+    AMF_RETURN_IF_FALSE(log2len >= 1 && log2len <= 24, AMF_INVALID_ARG, L"log2len out of range");
+    AMF_RETURN_IF_FALSE(sampleRate > 0.0f, AMF_INVALID_ARG, L"sampleRate <= 0");
+    AMF_RETURN_IF_FALSE(ppBands != NULL && bandCounts != NULL && ppSpectra != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(partitions > 0, AMF_INVALID_ARG, L"partitions == 0");
+
+    const bool planar = (layout.type == TAN_COMPLEX_LAYOUT_PLANAR);
+    const amf_size bins = (amf_size(1) << (log2len - 1)) + 1;
+
+    // floats of one spectrum up to its last imaginary part
+    const amf_size footprint = planar ? layout.planeSpacing + bins : 2 * bins;
+
+    AMF_RETURN_IF_FALSE(!planar || layout.planeSpacing >= bins, AMF_INVALID_ARG, L"planeSpacing < %u bins", amf_uint32(bins));
+    AMF_RETURN_IF_FALSE(partitions == 1 || partitionStride >= footprint, AMF_INVALID_ARG,
+        L"partitionStride < %u floats", amf_uint32(footprint));
+
+    for (amf_uint32 chan = 0; chan < channels; chan++)
+    {
+        AMF_RETURN_IF_FALSE(ppSpectra[chan] != NULL, AMF_INVALID_POINTER, L"ppSpectra[%u] == NULL", chan);
+        AMF_RETURN_IF_FALSE(bandCounts[chan] == 0 || ppBands[chan] != NULL, AMF_INVALID_POINTER, L"ppBands[%u] == NULL", chan);
+
+        for (amf_uint32 band = 0; band < bandCounts[chan]; band++)
+        {
+            const TANEQBand & eq = ppBands[chan][band];
+
+            AMF_RETURN_IF_FALSE(eq.type >= TAN_EQ_BAND_PEAKING && eq.type <= TAN_EQ_BAND_HIGH_PASS, AMF_INVALID_ARG,
+                L"band %u of channel %u has an unknown type", band, chan);
+            AMF_RETURN_IF_FALSE(eq.frequency > 0.0f && eq.frequency < sampleRate / 2 && eq.q > 0.0f, AMF_INVALID_ARG,
+                L"band %u of channel %u: frequency or q out of range", band, chan);
+        }
+    }
+
+    // the bins' points on the unit circle only depend on the transform length; cos(w) - 1 is
+    // taken as -2 sin(w / 2)^2, it would lose its digits near 0 Hz
+    if (m_eqLog2len != log2len)
+    {
+        m_eqPoints.resize(4 * bins);
+
+        float * u1r = &m_eqPoints[0 * bins];
+        float * u1i = &m_eqPoints[1 * bins];
+        float * u2r = &m_eqPoints[2 * bins];
+        float * u2i = &m_eqPoints[3 * bins];
+
+        for (amf_size k = 0; k < bins; k++)
+        {
+            const double w = M_PI * double(k) / double(bins - 1);
+            const double half = sin(w / 2.0);
+            const double ur = -2.0 * half * half;
+            const double ui = -sin(w);
+
+            u1r[k] = float(ur);
+            u1i[k] = float(ui);
+            u2r[k] = float(ur * ur - ui * ui);
+            u2i[k] = float(2.0 * ur * ui);
+        }
+
+        m_eqLog2len = log2len;
+    }
+
+    const TANFilterKernels & kernels = GetTANFilterKernels();
+    const float * points = m_eqPoints.data();
+
+    // a single planar spectrum is written in place, anything else from one response
+    const bool direct = planar && partitions == 1;
+
+    m_eqResponse.resize(2 * bins);
+
+    for (amf_uint32 chan = 0; chan < channels; chan++)
+    {
+        m_eqSections.resize(bandCounts[chan] * FilterSectionCoefficients);
+
+        for (amf_uint32 band = 0; band < bandCounts[chan]; band++)
+        {
+            EQBandSection(ppBands[chan][band], sampleRate, &m_eqSections[band * FilterSectionCoefficients]);
+        }
+
+        float * spectrum = ppSpectra[chan];
+        float * re = direct ? spectrum : m_eqResponse.data();
+        float * im = direct ? spectrum + layout.planeSpacing : m_eqResponse.data() + bins;
+
+        if (!direct || !multiply)
+        {
+            std::fill(re, re + bins, 1.0f);
+            std::fill(im, im + bins, 0.0f);
+        }
+
+        kernels.MultiplySectionResponse(re, im, bins,
+            points + 0 * bins, points + 1 * bins, points + 2 * bins, points + 3 * bins,
+            m_eqSections.data(), bandCounts[chan]);
+
+        for (amf_uint32 partition = 0; partition < partitions; partition++)
+        {
+            float * out = spectrum + partition * partitionStride;
+
+            if (!direct)
+            {
+                // planar parts are planeSpacing apart, interleaved ones next to each other
+                StoreResponse(re, im, bins, out, planar ? out + layout.planeSpacing : out + 1, planar ? 1 : 2, multiply);
+            }
+
+            // padding between the planes and up to the next partition
+            if (!multiply)
+            {
+                if (planar)
+                {
+                    memset(out + bins, 0, (layout.planeSpacing - bins) * sizeof(float));
+                }
+                if (partitions > 1)
+                {
+                    memset(out + footprint, 0, (partitionStride - footprint) * sizeof(float));
+                }
+            }
+        }
+    }
+
+    return AMF_OK;
+}
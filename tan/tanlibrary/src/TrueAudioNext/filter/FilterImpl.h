@@ -29,6 +29,8 @@
 #include "public/include/components/Component.h"//AMF
 #include "public/common/PropertyStorageExImpl.h"
 
+#include <vector>
+
 #define MAX_CACHE_POWER 64
 
 #define EQ_FILTER_LOG2LEN 13
@@ -63,6 +65,17 @@ namespace amf
                                                 float *impulseResponse,
                                                 float dbLevels[10]) override;
 
+        virtual AMF_RESULT  AMF_STD_CALL generateParametricEQ(amf_uint32 log2len,
+                                                float sampleRate,
+                                                amf_uint32 channels,
+                                                const TANEQBand * const ppBands[],
+                                                const amf_uint32 bandCounts[],
+                                                float * ppSpectra[],
+                                                TANComplexLayout layout,
+                                                amf_uint32 partitions,
+                                                amf_size partitionStride,
+                                                bool multiply) override;
+
     protected:
 
 
@@ -75,5 +88,12 @@ namespace amf
         TANFFTPtr m_pFft;
 
         float *m_eqFilter;
+
+        // Parametric equalizers: u = z^-1 - 1 and u^2 at the bins of m_eqLog2len, real and
+        // imaginary rows, see FilterKernels.h; the sections of a channel and its response.
+        amf_uint32 m_eqLog2len = 0;
+        std::vector<float> m_eqPoints;
+        std::vector<float> m_eqSections;
+        std::vector<float> m_eqResponse;
     };
 } //amf
@@ -0,0 +1,71 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   FilterKernels.h
+///  @brief  CPU kernels of TANFilter, one set per instruction set
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    // Equalizer sections are evaluated as polynomials in u = z^-1 - 1 rather than z^-1: near 0 Hz,
+    // where the poles of low bands sit, 1 + a1 z^-1 + a2 z^-2 is a small difference of numbers
+    // around 2 and loses most of its float digits, the same polynomial in u does not. A section
+    // is the rows n0, n1, n2 of its numerator and d0, d1, d2 of its denominator:
+    //   n0 = b0 + b1 + b2, n1 = b1 + 2 * b2, n2 = b2, and the same for a0, a1, a2.
+    const amf_size FilterSectionCoefficients = 6;
+
+    // CPU kernels behind TANFilter. Spectra are planar, real parts and imaginary parts in
+    // separate rows, so that a vector holds the same part of neighbouring bins.
+    // Any count and any alignment is accepted, nothing past the last bin is read or written.
+    //
+    // One table per instruction set, see core/KernelDispatch.h.
+    struct TANFilterKernels
+    {
+        const wchar_t * name;
+
+        // (re + j im)[k] *= H(u[k]) for 0 <= k < bins, H the cascade of count sections
+        // (n0 + n1 u + n2 u^2) / (d0 + d1 u + d2 u^2), u[k] = u1r + j u1i and u[k]^2 = u2r + j u2i
+        // at the bin's point on the unit circle.
+        void (*MultiplySectionResponse)(
+            float * re,
+            float * im,
+            amf_size bins,
+            const float * u1r,
+            const float * u1i,
+            const float * u2r,
+            const float * u2i,
+            const float * sections,
+            amf_size count);
+    };
+
+    // Kernel sets, see FilterKernels*.cpp.
+    extern const TANFilterKernels TANFilterKernelsSSE2;
+    extern const TANFilterKernels TANFilterKernelsAVX2;
+
+    // The table for the running CPU, see TANGetKernels.
+    const TANFilterKernels & GetTANFilterKernels();
+}
@@ -0,0 +1,138 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AVX2 + FMA kernels, this file is built with -mavx2 -mfma (/arch:AVX2).
+//
+
+#include "FilterKernels.h"
+
+#include <immintrin.h>
+
+using namespace amf;
+
+namespace
+{
+    // Bins first <= k < end one at a time, for the tail.
+    inline void MultiplySectionResponseScalar(
+        float * re,
+        float * im,
+        amf_size first,
+        amf_size end,
+        const float * u1r,
+        const float * u1i,
+        const float * u2r,
+        const float * u2i,
+        const float * sections,
+        amf_size count)
+    {
+        for (amf_size k = first; k < end; k++)
+        {
+            float r = re[k];
+            float i = im[k];
+
+            for (amf_size s = 0; s < count; s++)
+            {
+                const float * c = sections + s * FilterSectionCoefficients;
+                const float nr = c[0] + c[1] * u1r[k] + c[2] * u2r[k];
+                const float ni = c[1] * u1i[k] + c[2] * u2i[k];
+                const float dr = c[3] + c[4] * u1r[k] + c[5] * u2r[k];
+                const float di = c[4] * u1i[k] + c[5] * u2i[k];
+                const float scale = 1.0f / (dr * dr + di * di);
+                const float hr = (nr * dr + ni * di) * scale;
+                const float hi = (ni * dr - nr * di) * scale;
+                const float t = r * hr - i * hi;
+
+                i = r * hi + i * hr;
+                r = t;
+            }
+
+            re[k] = r;
+            im[k] = i;
+        }
+    }
+
+    void MultiplySectionResponseAVX2(
+        float * re,
+        float * im,
+        amf_size bins,
+        const float * u1r,
+        const float * u1i,
+        const float * u2r,
+        const float * u2i,
+        const float * sections,
+        amf_size count)
+    {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        amf_size k = 0;
+
+        for (; k + 8 <= bins; k += 8)
+        {
+            // u and u^2 at the bins
+            const __m256 x1r = _mm256_loadu_ps(u1r + k);
+            const __m256 x1i = _mm256_loadu_ps(u1i + k);
+            const __m256 x2r = _mm256_loadu_ps(u2r + k);
+            const __m256 x2i = _mm256_loadu_ps(u2i + k);
+            __m256 r = _mm256_loadu_ps(re + k);
+            __m256 i = _mm256_loadu_ps(im + k);
+
+            for (amf_size s = 0; s < count; s++)
+            {
+                const float * c = sections + s * FilterSectionCoefficients;
+                const __m256 n0 = _mm256_set1_ps(c[0]);
+                const __m256 n1 = _mm256_set1_ps(c[1]);
+                const __m256 n2 = _mm256_set1_ps(c[2]);
+                const __m256 d0 = _mm256_set1_ps(c[3]);
+                const __m256 d1 = _mm256_set1_ps(c[4]);
+                const __m256 d2 = _mm256_set1_ps(c[5]);
+
+                // numerator and denominator at the bins, then (r + j i) * n / d
+                const __m256 nr = _mm256_fmadd_ps(n2, x2r, _mm256_fmadd_ps(n1, x1r, n0));
+                const __m256 ni = _mm256_fmadd_ps(n2, x2i, _mm256_mul_ps(n1, x1i));
+                const __m256 dr = _mm256_fmadd_ps(d2, x2r, _mm256_fmadd_ps(d1, x1r, d0));
+                const __m256 di = _mm256_fmadd_ps(d2, x2i, _mm256_mul_ps(d1, x1i));
+
+                const __m256 scale = _mm256_div_ps(one, _mm256_fmadd_ps(dr, dr, _mm256_mul_ps(di, di)));
+                const __m256 hr = _mm256_mul_ps(_mm256_fmadd_ps(nr, dr, _mm256_mul_ps(ni, di)), scale);
+                const __m256 hi = _mm256_mul_ps(_mm256_fmsub_ps(ni, dr, _mm256_mul_ps(nr, di)), scale);
+
+                const __m256 t = _mm256_fmsub_ps(r, hr, _mm256_mul_ps(i, hi));
+                i = _mm256_fmadd_ps(r, hi, _mm256_mul_ps(i, hr));
+                r = t;
+            }
+
+            _mm256_storeu_ps(re + k, r);
+            _mm256_storeu_ps(im + k, i);
+        }
+
+        MultiplySectionResponseScalar(re, im, k, bins, u1r, u1i, u2r, u2i, sections, count);
+    }
+}
+
+namespace amf
+{
+    const TANFilterKernels TANFilterKernelsAVX2 =
+    {
+        L"AVX2",
+        MultiplySectionResponseAVX2,
+    };
+}
@@ -35,25 +35,68 @@
   #include "CLKernel_VectorComplexMultiply.h"
   #include "CLKernel_VectorComplexSum.h"
   #include "CLKernel_VectorComplexMultiplyAccumulate.h"
+  #include "CLKernel_VectorRealOps.h"
 #endif
 
-#include "cpucaps.h"
-
-#include <immintrin.h>
-
-#ifdef OMP_ENABLED
-  #include <omp.h>
-#endif
+#include "MathKernels.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <memory>
 
 #define AMF_FACILITY L"TANMathImpl"
 
 using namespace amf;
 
-//const InstructionSet::InstructionSet_Internal InstructionSet::CPU_Rep;
-bool TANMathImpl::useAVX256 = true; // InstructionSet::AVX() && InstructionSet::FMA();
-bool TANMathImpl::useAVX512 = true; // InstructionSet::AVX512F() && InstructionSet::FMA();
+// CPU work is split into items of at most this many elements, long enough to amortize
+// the dispatch to the workers and short enough for a few long channels to spread over all threads.
+static const amf_size CpuWorkItemSize = 8192;
+
+static inline amf_size CpuWorkItemsPerChannel(amf_size countPerChannel)
+{
+	return (countPerChannel + CpuWorkItemSize - 1) / CpuWorkItemSize;
+}
+
+// Calls work(channelId, first, count, item) for every (channel, chunk) item, items are
+// numbered channel by channel, on the threads of component in pool. Small batches stay on
+// the calling thread. The batch is a block of counters.
+template<typename Work>
+static void ForEachCpuWorkItem(
+	TANThreadPool * pool,
+	TAN_THREAD_BUDGET_COMPONENT component,
+	TANPerformanceCounters & counters,
+	amf_uint32 channels,
+	amf_size countPerChannel,
+	const Work & work)
+{
+	const amf_size itemsPerChannel = CpuWorkItemsPerChannel(countPerChannel);
+	const amf_size items = channels * itemsPerChannel;
+	const amf_uint32 threads = channels * countPerChannel >= CpuWorkItemSize ? TANThreadBudget(pool, component) : 1;
+
+	TANBlockTimer blockTimer(counters, 0);
+
+	TANParallelFor(pool, threads, items, [&](amf_size item)
+	{
+		const amf_size channelId = item / itemsPerChannel;
+		const amf_size first = (item % itemsPerChannel) * CpuWorkItemSize;
+		const amf_size count = std::min(CpuWorkItemSize, countPerChannel - first);
+
+		work(channelId, first, count, item);
+	});
+}
+
+// planeSpacing of a layout in the convention of the mixed layout kernels, 0 for interleaved.
+static inline amf_size KernelPlaneSpacing(const TANComplexLayout & layout)
+{
+	return layout.type == TAN_COMPLEX_LAYOUT_PLANAR ? layout.planeSpacing : 0;
+}
+
+static inline bool IsValidLayout(const TANComplexLayout & layout, amf_size countOfComplexNumbers)
+{
+	return layout.type == TAN_COMPLEX_LAYOUT_INTERLEAVED ||
+		(layout.type == TAN_COMPLEX_LAYOUT_PLANAR && layout.planeSpacing >= countOfComplexNumbers);
+}
 
 //-------------------------------------------------------------------------------------------------
 //public-------------------------------------------------------------------------------------------
@@ -74,14 +117,34 @@ AMF_RESULT  TANCreateMath(
 //-------------------------------------------------------------------------------------------------
 TANMathImpl::TANMathImpl(TANContext *pContextTAN, bool useConvQueue):
     m_pContextTAN(pContextTAN),
+	m_pThreadPool(&TANContextImplPtr(pContextTAN)->GetThreadPool()),
+	m_threadBudget(useConvQueue ? TAN_THREAD_BUDGET_CONVOLUTION : TAN_THREAD_BUDGET_MATH),
 	m_useConvQueue(useConvQueue)
 	///TODO:AAA     m_pContextAMF(pContextAMF)
 {
     AMFPrimitivePropertyInfoMapBegin
         AMFPropertyInfoEnum(TAN_OUTPUT_MEMORY_TYPE, L"Output Memory Type", AMF_MEMORY_HOST, AMF_MEMORY_ENUM_DESCRIPTION, false),
+        TANStatsPropertyInfoBlocks,
     AMFPrimitivePropertyInfoMapEnd
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANMathImpl::GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const
+{
+    const AMF_RESULT res = AMFPropertyStorageExImpl<TANMath>::GetProperty(name, pValue);
+
+    if (res == AMF_OK)
+    {
+        m_counters.GetProperty(name, pValue);
+    }
+
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL TANMathImpl::OnPropertyChanged(const wchar_t* name)
+{
+    m_counters.OnPropertyChanged(this, name);
+}
+//-------------------------------------------------------------------------------------------------
 TANMathImpl::~TANMathImpl(void)
 {
     Terminate();
@@ -107,22 +170,8 @@ AMF_RESULT  AMF_STD_CALL TANMathImpl::Init()
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL TANMathImpl::InitCpu()
 {
-	//todo: move to utils
-
-	// ToDo use common function with FFTimpl, maybe?
-	// setup OpenMP, if enabled
-#ifdef OMP_ENABLED
-	int numThreads = 0;
-	int numProcs = 1;
-	numProcs = omp_get_num_procs();
-	numThreads = numProcs / 4;
-	if (numThreads == 0)
-		numThreads = 1;
-	omp_set_num_threads(numThreads);
-	numThreads = omp_get_max_threads();
-#endif
-
-	return AMF_OK;
+	// the workers of the context, started now rather than by the first call
+	return m_pThreadPool->Start();
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL TANMathImpl::InitGpu()
@@ -182,6 +231,18 @@ AMF_RESULT  AMF_STD_CALL TANMathImpl::InitGpu()
             "VectorComplexMulAccum", "");
         if (!OCLKernel_Err){ printf("Failed to initialize Kernel\n"); return AMF_FAIL; }
     }
+	if (m_pKernelGain == nullptr)
+	{
+		OCLKernel_Err = GetOclKernel(m_pKernelGain, m_pDeviceCompute, m_clQueue, "VectorRealOps", VectorRealOps_Str, VectorRealOpsCount,
+			"VectorGain", "");
+		if (!OCLKernel_Err){ printf("Failed to initialize Kernel\n"); return AMF_FAIL; }
+	}
+	if (m_pKernelDotPeak == nullptr)
+	{
+		OCLKernel_Err = GetOclKernel(m_pKernelDotPeak, m_pDeviceCompute, m_clQueue, "VectorRealOps", VectorRealOps_Str, VectorRealOpsCount,
+			"VectorDotPeak", "");
+		if (!OCLKernel_Err){ printf("Failed to initialize Kernel\n"); return AMF_FAIL; }
+	}
 
 #else
 
@@ -303,12 +364,42 @@ AMF_RESULT  AMF_STD_CALL TANMathImpl::Terminate()
 {
 	m_pDeviceCompute = nullptr;
     m_pContextTAN = nullptr;
+	m_pThreadPool = nullptr;
 
 #ifndef TAN_NO_OPENCL
 	clReleaseKernel(m_pKernelComplexDiv);
     clReleaseKernel(m_pKernelComplexMul);
 	clReleaseKernel(m_pKernelComplexSum);
     clReleaseKernel(m_pKernelComplexMulAccum);
+
+	if (m_pKernelGain != nullptr)
+	{
+		clReleaseKernel(m_pKernelGain);
+		m_pKernelGain = nullptr;
+	}
+	if (m_pKernelDotPeak != nullptr)
+	{
+		clReleaseKernel(m_pKernelDotPeak);
+		m_pKernelDotPeak = nullptr;
+	}
+	if (m_pInternalBuffer_DotPeak != nullptr)
+	{
+		clReleaseMemObject(m_pInternalBuffer_DotPeak);
+		m_pInternalBuffer_DotPeak = nullptr;
+		m_iInternalBufferSize_DotPeak = 0;
+	}
+	if (m_pInternalBuffer_RealOpsOffsets != nullptr)
+	{
+		clReleaseMemObject(m_pInternalBuffer_RealOpsOffsets);
+		m_pInternalBuffer_RealOpsOffsets = nullptr;
+		m_iInternalBufferSize_RealOpsOffsets = 0;
+	}
+	if (m_pInternalBuffer_RealOpsGains != nullptr)
+	{
+		clReleaseMemObject(m_pInternalBuffer_RealOpsGains);
+		m_pInternalBuffer_RealOpsGains = nullptr;
+		m_iInternalBufferSize_RealOpsGains = 0;
+	}
 #else
 	mKernelComplexDiv = nullptr;
 	mKernelComplexMul = nullptr;
@@ -333,6 +424,8 @@ AMF_RESULT TANMathImpl::ComplexMultiplication(
 	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
     AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
 
+	TANBlockTimer blockTimer(m_counters, 0);
+
 	for (amf_size channelId = 0; channelId < channels; channelId++)
 	{
 		AMF_RETURN_IF_FALSE(inputBuffers1[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers1[%u] == NULL", channelId);
@@ -392,96 +485,20 @@ AMF_RESULT TANMathImpl::PlanarComplexMultiplyAccumulate(const float* const input
 	}
 	else
 	{
-#ifdef AVX512SUPPORT
-	if (useAVX512) {
-			// use AVX and FMA intrinsics to process 8 samples per pass
-			_mm512_setzero_ps();
-
-			int channelId = 0;
-			int id = 0;
-			int k = 0;
-			__m512 *arReg, *aiReg, *brReg, *biReg, *crReg, *ciReg;
-
-			for (channelId = 0; channelId < channels; channelId++)
-			{
-				arReg = (__m512 *)inputBuffers1[channelId];
-				aiReg = (__m512 *)&inputBuffers1[channelId][riPlaneSpacing];
-				brReg = (__m512 *)inputBuffers2[channelId];
-				biReg = (__m512 *)&inputBuffers2[channelId][riPlaneSpacing];
-				crReg = (__m512 *)accumbuffers[channelId];
-				ciReg = (__m512 *)&accumbuffers[channelId][riPlaneSpacing];
-
-				for (id = 0; id < countOfComplexNumbers; id += 16)
-				{
-					*crReg = _mm512_add_ps(_mm512_fmsub_ps(*arReg, *brReg, _mm512_mul_ps(*aiReg, *biReg)), *crReg);
-					*ciReg = _mm512_add_ps(_mm512_fmadd_ps(*arReg, *biReg, _mm512_mul_ps(*aiReg, *brReg)), *ciReg);
-
-					arReg++;
-					aiReg++;
-					brReg++;
-					biReg++;
-					crReg++;
-					ciReg++;
-				}
-			}
-
-		} else
-#endif
-		if (useAVX256) {
-			// use AVX and FMA intrinsics to process 8 samples per pass
-			_mm256_zeroall();
-
-			//int channelId = 0;
-			//int id = 0;
+		const TANMathKernels & kernels = GetTANMathKernels();
 
-//int nThreads = omp_get_num_threads();
-//nThreads = omp_get_max_threads();
+		TANBlockTimer blockTimer(m_counters, 0);
 
-#pragma omp parallel default(none) shared(channels,inputBuffers1,inputBuffers2,accumbuffers,countOfComplexNumbers,riPlaneSpacing)
-#pragma omp for
-		for (int channelId = 0; channelId < (int)channels; channelId++)
-			{
-			__m256 *arReg, *aiReg, *brReg, *biReg, *crReg, *ciReg;
-				arReg = (__m256 *)inputBuffers1[channelId];
-				aiReg = (__m256 *)&inputBuffers1[channelId][riPlaneSpacing];
-				brReg = (__m256 *)inputBuffers2[channelId];
-				biReg = (__m256 *)&inputBuffers2[channelId][riPlaneSpacing];
-				crReg = (__m256 *)accumbuffers[channelId];
-				ciReg = (__m256 *)&accumbuffers[channelId][riPlaneSpacing];
-
-				for (int id = 0; id < countOfComplexNumbers; id += 8)
-				{
-					*crReg = _mm256_add_ps(_mm256_fmsub_ps(*arReg, *brReg, _mm256_mul_ps(*aiReg, *biReg)), *crReg);
-					*ciReg = _mm256_add_ps(_mm256_fmadd_ps(*arReg, *biReg, _mm256_mul_ps(*aiReg, *brReg)), *ciReg);
-
-					arReg++;
-					aiReg++;
-					brReg++;
-					biReg++;
-					crReg++;
-					ciReg++;
-				}
-			}
-		}
-		else {
-#pragma omp parallel default(none) shared(channels,inputBuffers1,inputBuffers2,accumbuffers,riPlaneSpacing,countOfComplexNumbers)
-#pragma omp for
-			for (int channelId = 0; channelId < (int)channels; channelId++)
-			{
-				for (amf_size id = 0; id < countOfComplexNumbers; id++)
-				{
-					float ar, ai, br, bi;
-
-					ar = inputBuffers1[channelId][id];
-					ai = inputBuffers1[channelId][id + riPlaneSpacing];
-					br = inputBuffers2[channelId][id];
-					bi = inputBuffers2[channelId][id + riPlaneSpacing];
-
-					accumbuffers[channelId][id] += (ar*br - ai*bi);
-					accumbuffers[channelId][id + riPlaneSpacing] += (ar*bi + ai*br);
-				}
-			}
-		}
+		TANParallelFor(m_pThreadPool, TANThreadBudget(m_pThreadPool, m_threadBudget), channels, [&](amf_size channelId)
+		{
+			kernels.PlanarComplexMultiplyAccumulate(
+				inputBuffers1[channelId],
+				inputBuffers2[channelId],
+				accumbuffers[channelId],
+				countOfComplexNumbers,
+				riPlaneSpacing
+				);
+		});
 	}
 
 	return AMF_OK;
@@ -507,6 +524,107 @@ AMF_RESULT TANMathImpl::IPPComplexMultiplyAccumulate(const float* const inputBuf
 }
 #endif
 
+//-------------------------------------------------------------------------------------------------
+// Layout aware versions, host data runs on the CPU in every context.
+AMF_RESULT TANMathImpl::ComplexMultiplyAccumulate(
+	const float* const inputBuffers1[],
+	TANComplexLayout layout1,
+	const float* const inputBuffers2[],
+	TANComplexLayout layout2,
+	float *accumbuffers[],
+	TANComplexLayout accumLayout,
+	amf_uint32 channels,
+	amf_size countOfComplexNumbers)
+{
+	AMF_RETURN_IF_FALSE(inputBuffers1 != NULL, AMF_INVALID_ARG, L"inputBuffers1 == NULL");
+	AMF_RETURN_IF_FALSE(inputBuffers2 != NULL, AMF_INVALID_ARG, L"inputBuffers2 == NULL");
+	AMF_RETURN_IF_FALSE(accumbuffers != NULL, AMF_INVALID_ARG, L"accumbuffers == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
+	AMF_RETURN_IF_FALSE(IsValidLayout(layout1, countOfComplexNumbers), AMF_INVALID_ARG, L"invalid layout1");
+	AMF_RETURN_IF_FALSE(IsValidLayout(layout2, countOfComplexNumbers), AMF_INVALID_ARG, L"invalid layout2");
+	AMF_RETURN_IF_FALSE(IsValidLayout(accumLayout, countOfComplexNumbers), AMF_INVALID_ARG, L"invalid accumLayout");
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(inputBuffers1[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers1[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(inputBuffers2[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers2[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(accumbuffers[channelId] != NULL, AMF_INVALID_ARG, L"accumbuffers[%u] == NULL", channelId);
+	}
+
+	const TANMathKernels & kernels = GetTANMathKernels();
+	const amf_size spacing1 = KernelPlaneSpacing(layout1);
+	const amf_size spacing2 = KernelPlaneSpacing(layout2);
+	const amf_size accumSpacing = KernelPlaneSpacing(accumLayout);
+
+	// matching layouts keep their dedicated kernels, which skip the (de)interleaving shuffles
+	const bool interleaved = !spacing1 && !spacing2 && !accumSpacing;
+	const bool planar = spacing1 && spacing1 == spacing2 && spacing1 == accumSpacing;
+
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, countOfComplexNumbers,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size)
+		{
+			const float * in1 = inputBuffers1[channelId] + ComplexRealOffset(first, spacing1);
+			const float * in2 = inputBuffers2[channelId] + ComplexRealOffset(first, spacing2);
+			float * accum = accumbuffers[channelId] + ComplexRealOffset(first, accumSpacing);
+
+			if (interleaved)
+			{
+				kernels.ComplexMultiplyAccumulate(in1, in2, accum, count);
+			}
+			else if (planar)
+			{
+				kernels.PlanarComplexMultiplyAccumulate(in1, in2, accum, count, accumSpacing);
+			}
+			else
+			{
+				kernels.MixedComplexMultiplyAccumulate(in1, spacing1, in2, spacing2, accum, accumSpacing, count);
+			}
+		});
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANMathImpl::ConvertComplexLayout(
+	const float* const inputBuffers[],
+	TANComplexLayout inputLayout,
+	float *outputBuffers[],
+	TANComplexLayout outputLayout,
+	amf_uint32 channels,
+	amf_size countOfComplexNumbers)
+{
+	AMF_RETURN_IF_FALSE(inputBuffers != NULL, AMF_INVALID_ARG, L"inputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(outputBuffers != NULL, AMF_INVALID_ARG, L"outputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
+	AMF_RETURN_IF_FALSE(IsValidLayout(inputLayout, countOfComplexNumbers), AMF_INVALID_ARG, L"invalid inputLayout");
+	AMF_RETURN_IF_FALSE(IsValidLayout(outputLayout, countOfComplexNumbers), AMF_INVALID_ARG, L"invalid outputLayout");
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(inputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(outputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"outputBuffers[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(inputBuffers[channelId] != outputBuffers[channelId], AMF_INVALID_ARG,
+			L"outputBuffers[%u] == inputBuffers[%u], in place conversion is not supported", channelId, channelId);
+	}
+
+	const TANMathKernels & kernels = GetTANMathKernels();
+	const amf_size inputSpacing = KernelPlaneSpacing(inputLayout);
+	const amf_size outputSpacing = KernelPlaneSpacing(outputLayout);
+
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, countOfComplexNumbers,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size)
+		{
+			kernels.ConvertComplexLayout(
+				inputBuffers[channelId] + ComplexRealOffset(first, inputSpacing), inputSpacing,
+				outputBuffers[channelId] + ComplexRealOffset(first, outputSpacing), outputSpacing,
+				count);
+		});
+
+	return AMF_OK;
+}
+
 AMF_RESULT TANMathImpl::ComplexMultiplyAccumulate(
 	const float* const inputBuffers1[],
 	const float* const inputBuffers2[],
@@ -567,75 +685,16 @@ AMF_RESULT TANMathImpl::ComplexMultiplyAccumulate(
 	}
 	else
 	{
-		if (useAVX256) {
-			// use AVX and FMA intrinsics to process 8 samples per pass
-			register __m256 arReg, aiReg, brReg, biReg, crReg, ciReg, zero;
-			register __m128 t1Reg, t2Reg;
-			_mm256_zeroall();
-			///tmp = _mm256_set1_ps(hf);
-
-			float testa[16];
-			//float testb[16];
-			//int idxR[16];
-			//int idxI[16];
-			//for (int k = 0; k < 16; k++) {
-			//	idxR[k] = 4 * (2 * k);
-			//	idxI[k] = 4 * (2 * k + 1);
-			//}
-
-			int channelId = 0;
-			int id = 0;
-			int k = 0;
-			// omp fail ...
-//#pragma omp parallel default(none) shared(channels,inputBuffers1,inputBuffers2)
-//#pragma omp for private(channelId,id,k) schedule(static) // schedule(guided) nowait //schedule(static)
-			for (channelId = 0; channelId < channels; channelId++)
-			{
-				const float *pIn1 = inputBuffers1[channelId];
-				const float *pIn2 = inputBuffers2[channelId];
-				float *pAcc = accumbuffers[channelId];
-
-				for ( id = 0; id < countOfComplexNumbers; id += 8)
-				{
-					for (int k = 0; k < 8; k++) {
-						((float *)&arReg)[k] = pIn1[2 * k];
-						((float *)&aiReg)[k] = pIn1[2 * k + 1];
-						((float *)&brReg)[k] = pIn2[2 * k];
-						((float *)&biReg)[k] = pIn2[2 * k + 1];
-						((float *)&crReg)[k] = pAcc[2 * k];
-						((float *)&ciReg)[k] = pAcc[2 * k + 1];
-					}
-
-					crReg = _mm256_add_ps(_mm256_fmsub_ps(arReg, brReg, _mm256_mul_ps(aiReg, biReg)), crReg);
-					ciReg = _mm256_add_ps(_mm256_fmadd_ps(arReg, biReg, _mm256_mul_ps(aiReg, brReg)), ciReg);
-
-					pIn1 += 16;
-					pIn2 += 16;
-
-					for ( k = 0; k < 8; k++) {
-						pAcc[2 * k] = ((float *)&crReg)[k];
-						pAcc[2 * k + 1] = ((float *)&ciReg)[k];
-					}
-					pAcc += 16;
-				}
-			}
-		}
-		else {
-			for (amf_size channelId = 0; channelId < channels; channelId++)
-			{
-				for (amf_size id = 0; id < countOfComplexNumbers; id++)
-				{
-					amf_size j;
-					float ar, ai, br, bi;
-					j = (id << 1);
-					ar = inputBuffers1[channelId][j];
-					ai = inputBuffers1[channelId][j + 1];
-					br = inputBuffers2[channelId][j];
-					bi = inputBuffers2[channelId][j + 1];
-					accumbuffers[channelId][j] += (ar*br - ai*bi);
-					accumbuffers[channelId][j + 1] += (ar*bi + ai*br);
-				}
-			}
+		const TANMathKernels & kernels = GetTANMathKernels();
+
+		for (amf_size channelId = 0; channelId < channels; channelId++)
+		{
+			kernels.ComplexMultiplyAccumulate(
+				inputBuffers1[channelId],
+				inputBuffers2[channelId],
+				accumbuffers[channelId],
+				countOfComplexNumbers
+				);
 		}
 	}
 
@@ -789,10 +848,34 @@ AMF_RESULT TANMathImpl::ComplexDivision(
 		AMF_RETURN_IF_FALSE(inputBuffers1[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers1[%u] == NULL", channelId);
 		AMF_RETURN_IF_FALSE(inputBuffers2[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers2[%u] == NULL", channelId);
 		AMF_RETURN_IF_FALSE(outputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"outputBuffers[%u] == NULL", channelId);
-		AMF_RESULT result = AMF_FAIL;
-        result = ComplexDivision(inputBuffers1[channelId], inputBuffers2[channelId], outputBuffers[channelId], countOfComplexNumbers);
-		AMF_RETURN_IF_FAILED(result);
 	}
+
+#ifndef TAN_NO_OPENCL
+	if (m_pContextTAN->GetOpenCLContext())
+	{
+		for (amf_size channelId = 0; channelId < channels; channelId++)
+		{
+			AMF_RESULT result = AMF_FAIL;
+			result = ComplexDivision(inputBuffers1[channelId], inputBuffers2[channelId], outputBuffers[channelId], countOfComplexNumbers);
+			AMF_RETURN_IF_FAILED(result);
+		}
+		return AMF_OK;
+	}
+#endif
+
+	// CPU: all channels and bins at once, spread over the worker threads
+	const TANMathKernels & kernels = GetTANMathKernels();
+
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, countOfComplexNumbers,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size)
+		{
+			kernels.ComplexDivision(
+				inputBuffers1[channelId] + 2 * first,
+				inputBuffers2[channelId] + 2 * first,
+				outputBuffers[channelId] + 2 * first,
+				count);
+		});
+
 	return AMF_OK;
 }
 
@@ -860,170 +943,612 @@ AMF_RESULT TANMathImpl::ComplexDivision(
 #endif
 
 //-------------------------------------------------------------------------------------------------
-//protected----------------------------------------------------------------------------------------
-//-------------------------------------------------------------------------------------------------
-
-//-------------------------------------------------------------------------------------------------
-AMF_RESULT TANMathImpl::ComplexMultiplication(
-    const float inputBuffer1[],
-    const float inputBuffer2[],
-    float outputBuffer[],
-    amf_size countOfComplexNumbers
-)
+AMF_RESULT TANMathImpl::ComplexSum(
+	const float* const inputBuffers[],
+	float *outputBuffers[],
+	amf_uint32 channels,
+	amf_size countOfComplexNumbers
+	)
 {
-    AMF_RETURN_IF_FALSE(inputBuffer1 != NULL, AMF_INVALID_ARG, L"inputBuffer1 == NULL");
-    AMF_RETURN_IF_FALSE(inputBuffer2 != NULL, AMF_INVALID_ARG, L"inputBuffer2 == NULL");
-    AMF_RETURN_IF_FALSE(outputBuffer != NULL, AMF_INVALID_ARG, L"outputBuffer == NULL");
-
-    AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
-
-#ifndef TAN_NO_OPENCL
+	AMF_RETURN_IF_FALSE(inputBuffers != NULL, AMF_INVALID_ARG, L"inputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(outputBuffers != NULL, AMF_INVALID_ARG, L"outputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
 
-	// If GPU Context is initialized then run it on GPU
-	if (m_pContextTAN->GetOpenCLContext())
-	{
-		// Adjust internal buffer size
-		cl_int clErr = 0;;
-        amf_size requiredbuffersize = countOfComplexNumbers * sizeof(float) * 2; //2 floats per complex sample
-		AdjustInternalBufferSize(&m_pInternalBufferOut_Multiply, &m_iInternalBufferOutSize_Multiply, requiredbuffersize);
-		AdjustInternalBufferSize(&m_pInternalBufferIn1_Multiply, &m_iInternalBufferIn1Size_Multiply, requiredbuffersize);
-		AdjustInternalBufferSize(&m_pInternalBufferIn2_Multiply, &m_iInternalBufferIn2Size_Multiply, requiredbuffersize);
-		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn1_Multiply, CL_TRUE, 0, requiredbuffersize, inputBuffer1, 0, NULL, NULL);
-		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
-		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn2_Multiply, CL_TRUE, 0, requiredbuffersize, inputBuffer2, 0, NULL, NULL);
-		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
-        ComplexMultiplication(m_pInternalBufferIn1_Multiply, 0, m_pInternalBufferIn2_Multiply, 0, m_pInternalBufferOut_Multiply, 0, countOfComplexNumbers);
-		clErr = clEnqueueReadBuffer(m_clQueue, m_pInternalBufferOut_Multiply, CL_TRUE, 0, requiredbuffersize, outputBuffer, 0, NULL, NULL);
-		if (clErr != CL_SUCCESS){ printf("Failed to copy from OPENCL to HOST memory"); return AMF_FAIL; }
-	}
-	else
+	for (amf_size channelId = 0; channelId < channels; channelId++)
 	{
-        for (amf_size id = 0; id < countOfComplexNumbers; id++)
-		{
-			amf_size j;
-			float ar, ai, br, bi;
-			j = (id << 1);
-			ar = inputBuffer1[j];
-			ai = inputBuffer1[j + 1];
-			br = inputBuffer2[j];
-			bi = inputBuffer2[j + 1];
-			outputBuffer[j] = ar*br - ai*bi;
-			outputBuffer[j + 1] = ar*bi + ai*br;
-		}
+		AMF_RETURN_IF_FALSE(inputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(outputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"outputBuffers[%u] == NULL", channelId);
 	}
 
-    return AMF_OK;
-
-#else
-
-	THROW_NOT_IMPLEMENTED;
-
-	return AMF_NOT_IMPLEMENTED;
-
-#endif
-}
+	// host data is always summed on the CPU, a reduction is not worth the upload
+	const TANMathKernels & kernels = GetTANMathKernels();
+	const amf_size itemsPerChannel = CpuWorkItemsPerChannel(countOfComplexNumbers);
 
-//------------------------------------------------------------------------------------------------
-AMF_RESULT TANMathImpl::ComplexMultiplyAccumulate(
-	const float inputBuffer1[],
-	const float inputBuffer2[],
-	float accumBuffer[],
-    amf_size countOfComplexNumbers)
-{
-	AMF_RETURN_IF_FALSE(inputBuffer1 != NULL, AMF_INVALID_ARG, L"inputBuffer1 == NULL");
-	AMF_RETURN_IF_FALSE(inputBuffer2 != NULL, AMF_INVALID_ARG, L"inputBuffer2 == NULL");
-	AMF_RETURN_IF_FALSE(accumBuffer != NULL, AMF_INVALID_ARG, L"outputBuffer == NULL");
+	AMFLock lock(&m_sect);
 
-    AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
+	m_CpuPartials.resize(2 * channels * itemsPerChannel);
+	float * partials = m_CpuPartials.data();
 
-#ifndef TAN_NO_OPENCL
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, countOfComplexNumbers,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size item)
+		{
+			kernels.ComplexSum(inputBuffers[channelId] + 2 * first, partials + 2 * item, count);
+		});
 
-	if (m_pContextTAN->GetOpenCLContext())
+	// partial sums in a fixed order, the result does not depend on the thread count
+	for (amf_size channelId = 0; channelId < channels; channelId++)
 	{
-		// Adjust internal buffer size
-		cl_int clErr = 0;;
-        amf_size requiredbuffersize = countOfComplexNumbers * sizeof(float)*2;
-		AdjustInternalBufferSize(&m_pInternalBufferIn1_MulAccu, &m_iInternalBufferIn1Size_MulAccu, requiredbuffersize);
-		AdjustInternalBufferSize(&m_pInternalBufferIn2_MulAccu, &m_iInternalBufferIn2Size_MulAccu, requiredbuffersize);
-		AdjustInternalBufferSize(&m_pInternalBufferOut_MulAccu, &m_iInternalBufferOutSize_MulAccu, 2 * sizeof(float));
-		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn1_MulAccu, CL_TRUE, 0, requiredbuffersize, inputBuffer1, 0, NULL, NULL);
-		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
-		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn2_MulAccu, CL_TRUE, 0, requiredbuffersize, inputBuffer2, 0, NULL, NULL);
-		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+		const float * channelPartials = partials + 2 * channelId * itemsPerChannel;
+		float re = 0.0f;
+		float im = 0.0f;
 
-		ComplexMultiplyAccumulate(m_pInternalBufferIn1_MulAccu, 0, m_pInternalBufferIn2_MulAccu, 0, m_pInternalBufferOut_MulAccu, 0, countOfComplexNumbers);
+		for (amf_size i = 0; i < itemsPerChannel; i++)
+		{
+			re += channelPartials[2 * i];
+			im += channelPartials[2 * i + 1];
+		}
 
-		clErr = clEnqueueReadBuffer(m_clQueue, m_pInternalBufferOut_MulAccu, CL_TRUE, 0, 2 * sizeof(float), accumBuffer, 0, NULL, NULL);
-		if (clErr != CL_SUCCESS){ printf("Failed to copy from OPENCL to HOST memory"); return AMF_FAIL; }
-	}
-	else
-    {
-        if (useAVX256){
-            // use AVX and FMA intrinsics to process 8 samples per pass
-            register __m256 arReg, aiReg, brReg, biReg, crReg, ciReg, zero;
-            register __m128 t1Reg, t2Reg;
-            _mm256_zeroall();
-            ///tmp = _mm256_set1_ps(hf);
-
- 			const float *pIn1 = inputBuffer1;
-			const float *pIn2 = inputBuffer2;
-			float *pAcc = accumBuffer;
-
-            for (amf_size id = 0; id < countOfComplexNumbers; id += 8)
-            {
-				for (int k = 0; k < 8; k++){
-				    ((float *)&arReg)[k] = pIn1[ 2 * k];
-				    ((float *)&aiReg)[k] = pIn1[ 2 * k + 1];
-				    ((float *)&brReg)[k] = pIn2[ 2 * k];
-				    ((float *)&biReg)[k] = pIn2[ 2 * k + 1];
-				    ((float *)&crReg)[k] = pAcc[ 2 * k];
-				    ((float *)&ciReg)[k] = pAcc[ 2 * k + 1];
-				}
-
-				pIn1 += 16;
-				pIn2 += 16;
-
-                crReg = _mm256_add_ps(_mm256_fmsub_ps(arReg, brReg, _mm256_mul_ps(aiReg, biReg)),crReg);
-                ciReg = _mm256_add_ps(_mm256_fmadd_ps(arReg, biReg, _mm256_mul_ps(aiReg, brReg)),ciReg);
-
- 				for (int k = 0; k < 8; k++) {
-					pAcc[ 2 * k] = ((float *)&crReg)[k];
-					pAcc[ 2 * k + 1] = ((float *)&ciReg)[k];
-				}
-				pAcc += 16;
-            }
-        }
-        else {
-            for (amf_size id = 0; id < countOfComplexNumbers; id++)
-            {
-                amf_size j;
-                float ar, ai, br, bi;
-                j = (id << 1);
-                ar = inputBuffer1[j];
-                ai = inputBuffer1[j + 1];
-                br = inputBuffer2[j];
-                bi = inputBuffer2[j + 1];
-                accumBuffer[j] += (ar*br - ai*bi);
-                accumBuffer[j + 1] += (ar*bi + ai*br);
-            }
-        }
+		outputBuffers[channelId][0] = re;
+		outputBuffers[channelId][1] = im;
 	}
 
 	return AMF_OK;
+}
 
-#else
+//-------------------------------------------------------------------------------------------------
+// Real vector operations. Host data always runs on the CPU, even in a GPU context, the
+// upload would cost more than the arithmetic.
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANMathImpl::Scale(
+	const float* const inputBuffers[],
+	float *outputBuffers[],
+	const float gains[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(inputBuffers != NULL, AMF_INVALID_ARG, L"inputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(outputBuffers != NULL, AMF_INVALID_ARG, L"outputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(gains != NULL, AMF_INVALID_ARG, L"gains == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess == 0");
 
-	THROW_NOT_IMPLEMENTED;
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(inputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(outputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"outputBuffers[%u] == NULL", channelId);
+	}
 
-	return AMF_NOT_IMPLEMENTED;
+	const TANMathKernels & kernels = GetTANMathKernels();
 
-#endif
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, numOfSamplesToProcess,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size)
+		{
+			kernels.GainLinear(
+				inputBuffers[channelId] + first,
+				outputBuffers[channelId] + first,
+				gains[channelId],
+				0.0f,
+				count);
+		});
+
+	return AMF_OK;
 }
 
 //-------------------------------------------------------------------------------------------------
-#ifndef TAN_NO_OPENCL
+AMF_RESULT TANMathImpl::GainRamp(
+	const float* const inputBuffers[],
+	float *outputBuffers[],
+	const float startGains[],
+	const float endGains[],
+	TAN_GAIN_RAMP ramp,
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(inputBuffers != NULL, AMF_INVALID_ARG, L"inputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(outputBuffers != NULL, AMF_INVALID_ARG, L"outputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(startGains != NULL, AMF_INVALID_ARG, L"startGains == NULL");
+	AMF_RETURN_IF_FALSE(endGains != NULL, AMF_INVALID_ARG, L"endGains == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess == 0");
 
-AMF_RESULT TANMathImpl::ComplexMultiplication(
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(inputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(outputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"outputBuffers[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(ramp != TAN_GAIN_RAMP_EXPONENTIAL || (startGains[channelId] > 0.0f && endGains[channelId] > 0.0f),
+			AMF_INVALID_ARG, L"exponential ramp of channel %u needs positive gains", channelId);
+	}
+
+	const TANMathKernels & kernels = GetTANMathKernels();
+	const double length = double(numOfSamplesToProcess);
+
+	// every item starts from a gain computed from its position, not from the previous item,
+	// so the ramp does not depend on how the channel was split
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, numOfSamplesToProcess,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size)
+		{
+			const double start = startGains[channelId];
+			const double end = endGains[channelId];
+
+			if (ramp == TAN_GAIN_RAMP_EXPONENTIAL)
+			{
+				kernels.GainExponential(
+					inputBuffers[channelId] + first,
+					outputBuffers[channelId] + first,
+					float(start * std::pow(end / start, double(first) / length)),
+					float(std::pow(end / start, 1.0 / length)),
+					count);
+			}
+			else
+			{
+				const double step = (end - start) / length;
+
+				kernels.GainLinear(
+					inputBuffers[channelId] + first,
+					outputBuffers[channelId] + first,
+					float(start + step * double(first)),
+					float(step),
+					count);
+			}
+		});
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANMathImpl::AccumulateWithGain(
+	const float* const inputBuffers[],
+	float *accumBuffers[],
+	const float gains[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(inputBuffers != NULL, AMF_INVALID_ARG, L"inputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(accumBuffers != NULL, AMF_INVALID_ARG, L"accumBuffers == NULL");
+	AMF_RETURN_IF_FALSE(gains != NULL, AMF_INVALID_ARG, L"gains == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess == 0");
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(inputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(accumBuffers[channelId] != NULL, AMF_INVALID_ARG, L"accumBuffers[%u] == NULL", channelId);
+	}
+
+	const TANMathKernels & kernels = GetTANMathKernels();
+
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, numOfSamplesToProcess,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size)
+		{
+			kernels.AccumulateWithGain(
+				inputBuffers[channelId] + first,
+				accumBuffers[channelId] + first,
+				gains[channelId],
+				count);
+		});
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANMathImpl::DotProduct(
+	const float* const inputBuffers1[],
+	const float* const inputBuffers2[],
+	float results[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(inputBuffers1 != NULL, AMF_INVALID_ARG, L"inputBuffers1 == NULL");
+	AMF_RETURN_IF_FALSE(inputBuffers2 != NULL, AMF_INVALID_ARG, L"inputBuffers2 == NULL");
+	AMF_RETURN_IF_FALSE(results != NULL, AMF_INVALID_ARG, L"results == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess == 0");
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(inputBuffers1[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers1[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(inputBuffers2[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers2[%u] == NULL", channelId);
+	}
+
+	const TANMathKernels & kernels = GetTANMathKernels();
+	const amf_size itemsPerChannel = CpuWorkItemsPerChannel(numOfSamplesToProcess);
+
+	AMFLock lock(&m_sect);
+
+	m_CpuPartials.resize(channels * itemsPerChannel);
+	float * partials = m_CpuPartials.data();
+
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, numOfSamplesToProcess,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size item)
+		{
+			partials[item] = kernels.DotProduct(inputBuffers1[channelId] + first, inputBuffers2[channelId] + first, count);
+		});
+
+	// partial results in a fixed order, the result does not depend on the thread count
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		const float * channelPartials = partials + channelId * itemsPerChannel;
+		float sum = 0.0f;
+
+		for (amf_size i = 0; i < itemsPerChannel; i++)
+		{
+			sum += channelPartials[i];
+		}
+
+		results[channelId] = sum;
+	}
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANMathImpl::PeakRms(
+	const float* const inputBuffers[],
+	float peaks[],
+	float rms[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(inputBuffers != NULL, AMF_INVALID_ARG, L"inputBuffers == NULL");
+	AMF_RETURN_IF_FALSE(peaks != NULL || rms != NULL, AMF_INVALID_ARG, L"peaks == NULL && rms == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess == 0");
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(inputBuffers[channelId] != NULL, AMF_INVALID_ARG, L"inputBuffers[%u] == NULL", channelId);
+	}
+
+	const TANMathKernels & kernels = GetTANMathKernels();
+	const amf_size itemsPerChannel = CpuWorkItemsPerChannel(numOfSamplesToProcess);
+
+	AMFLock lock(&m_sect);
+
+	m_CpuPartials.resize(2 * channels * itemsPerChannel);
+	float * partials = m_CpuPartials.data();
+
+	ForEachCpuWorkItem(m_pThreadPool, m_threadBudget, m_counters, channels, numOfSamplesToProcess,
+		[&](amf_size channelId, amf_size first, amf_size count, amf_size item)
+		{
+			kernels.PeakSumOfSquares(inputBuffers[channelId] + first, partials + 2 * item, partials + 2 * item + 1, count);
+		});
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		const float * channelPartials = partials + 2 * channelId * itemsPerChannel;
+		float peak = 0.0f;
+		float sumOfSquares = 0.0f;
+
+		for (amf_size i = 0; i < itemsPerChannel; i++)
+		{
+			peak = std::max(peak, channelPartials[2 * i]);
+			sumOfSquares += channelPartials[2 * i + 1];
+		}
+
+		if (peaks != NULL)
+		{
+			peaks[channelId] = peak;
+		}
+		if (rms != NULL)
+		{
+			rms[channelId] = std::sqrt(sumOfSquares / float(numOfSamplesToProcess));
+		}
+	}
+
+	return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+#ifndef TAN_NO_OPENCL
+
+AMF_RESULT TANMathImpl::Scale(
+	const cl_mem inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	cl_mem outputBuffers[],
+	const amf_size outputBuffersOffsetInSamples[],
+	const float gains[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(gains != NULL, AMF_INVALID_ARG, L"gains == NULL");
+
+	return GainGpu(
+		inputBuffers, inputBuffersOffsetInSamples,
+		outputBuffers, outputBuffersOffsetInSamples,
+		gains, NULL, false, false, channels, numOfSamplesToProcess);
+}
+
+AMF_RESULT TANMathImpl::GainRamp(
+	const cl_mem inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	cl_mem outputBuffers[],
+	const amf_size outputBuffersOffsetInSamples[],
+	const float startGains[],
+	const float endGains[],
+	TAN_GAIN_RAMP ramp,
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(startGains != NULL, AMF_INVALID_ARG, L"startGains == NULL");
+	AMF_RETURN_IF_FALSE(endGains != NULL, AMF_INVALID_ARG, L"endGains == NULL");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess == 0");
+
+	const double length = double(numOfSamplesToProcess);
+	const bool exponential = ramp == TAN_GAIN_RAMP_EXPONENTIAL;
+	std::vector<float> gainSteps(channels);
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		const double start = startGains[channelId];
+		const double end = endGains[channelId];
+
+		AMF_RETURN_IF_FALSE(!exponential || (start > 0.0 && end > 0.0),
+			AMF_INVALID_ARG, L"exponential ramp of channel %u needs positive gains", channelId);
+
+		gainSteps[channelId] = exponential ? float(std::pow(end / start, 1.0 / length)) : float((end - start) / length);
+	}
+
+	return GainGpu(
+		inputBuffers, inputBuffersOffsetInSamples,
+		outputBuffers, outputBuffersOffsetInSamples,
+		startGains, gainSteps.data(), exponential, false, channels, numOfSamplesToProcess);
+}
+
+AMF_RESULT TANMathImpl::AccumulateWithGain(
+	const cl_mem inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	cl_mem accumBuffers[],
+	const amf_size accumBuffersOffsetInSamples[],
+	const float gains[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(gains != NULL, AMF_INVALID_ARG, L"gains == NULL");
+
+	return GainGpu(
+		inputBuffers, inputBuffersOffsetInSamples,
+		accumBuffers, accumBuffersOffsetInSamples,
+		gains, NULL, false, true, channels, numOfSamplesToProcess);
+}
+
+AMF_RESULT TANMathImpl::DotProduct(
+	const cl_mem inputBuffers1[],
+	const amf_size buffers1OffsetInSamples[],
+	const cl_mem inputBuffers2[],
+	const amf_size buffers2OffsetInSamples[],
+	float results[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(results != NULL, AMF_INVALID_ARG, L"results == NULL");
+
+	return DotPeakGpu(
+		inputBuffers1, buffers1OffsetInSamples,
+		inputBuffers2, buffers2OffsetInSamples,
+		results, NULL, channels, numOfSamplesToProcess);
+}
+
+AMF_RESULT TANMathImpl::PeakRms(
+	const cl_mem inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	float peaks[],
+	float rms[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(peaks != NULL || rms != NULL, AMF_INVALID_ARG, L"peaks == NULL && rms == NULL");
+
+	// the dot product of a channel with itself is its sum of squares
+	AMF_RETURN_IF_FAILED(DotPeakGpu(
+		inputBuffers, inputBuffersOffsetInSamples,
+		inputBuffers, inputBuffersOffsetInSamples,
+		rms, peaks, channels, numOfSamplesToProcess));
+
+	for (amf_size channelId = 0; rms != NULL && channelId < channels; channelId++)
+	{
+		rms[channelId] = std::sqrt(rms[channelId] / float(numOfSamplesToProcess));
+	}
+
+	return AMF_OK;
+}
+
+#else
+
+AMF_RESULT TANMathImpl::Scale(
+	const AMFBuffer * inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	AMFBuffer * outputBuffers[],
+	const amf_size outputBuffersOffsetInSamples[],
+	const float gains[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	THROW_NOT_IMPLEMENTED;
+
+	return AMF_NOT_IMPLEMENTED;
+}
+
+AMF_RESULT TANMathImpl::GainRamp(
+	const AMFBuffer * inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	AMFBuffer * outputBuffers[],
+	const amf_size outputBuffersOffsetInSamples[],
+	const float startGains[],
+	const float endGains[],
+	TAN_GAIN_RAMP ramp,
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	THROW_NOT_IMPLEMENTED;
+
+	return AMF_NOT_IMPLEMENTED;
+}
+
+AMF_RESULT TANMathImpl::AccumulateWithGain(
+	const AMFBuffer * inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	AMFBuffer * accumBuffers[],
+	const amf_size accumBuffersOffsetInSamples[],
+	const float gains[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	THROW_NOT_IMPLEMENTED;
+
+	return AMF_NOT_IMPLEMENTED;
+}
+
+AMF_RESULT TANMathImpl::DotProduct(
+	const AMFBuffer * inputBuffers1[],
+	const amf_size buffers1OffsetInSamples[],
+	const AMFBuffer * inputBuffers2[],
+	const amf_size buffers2OffsetInSamples[],
+	float results[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	THROW_NOT_IMPLEMENTED;
+
+	return AMF_NOT_IMPLEMENTED;
+}
+
+AMF_RESULT TANMathImpl::PeakRms(
+	const AMFBuffer * inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	float peaks[],
+	float rms[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	THROW_NOT_IMPLEMENTED;
+
+	return AMF_NOT_IMPLEMENTED;
+}
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//protected----------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANMathImpl::ComplexMultiplication(
+    const float inputBuffer1[],
+    const float inputBuffer2[],
+    float outputBuffer[],
+    amf_size countOfComplexNumbers
+)
+{
+    AMF_RETURN_IF_FALSE(inputBuffer1 != NULL, AMF_INVALID_ARG, L"inputBuffer1 == NULL");
+    AMF_RETURN_IF_FALSE(inputBuffer2 != NULL, AMF_INVALID_ARG, L"inputBuffer2 == NULL");
+    AMF_RETURN_IF_FALSE(outputBuffer != NULL, AMF_INVALID_ARG, L"outputBuffer == NULL");
+
+    AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
+
+#ifndef TAN_NO_OPENCL
+
+	// If GPU Context is initialized then run it on GPU
+	if (m_pContextTAN->GetOpenCLContext())
+	{
+		// Adjust internal buffer size
+		cl_int clErr = 0;;
+        amf_size requiredbuffersize = countOfComplexNumbers * sizeof(float) * 2; //2 floats per complex sample
+		AdjustInternalBufferSize(&m_pInternalBufferOut_Multiply, &m_iInternalBufferOutSize_Multiply, requiredbuffersize);
+		AdjustInternalBufferSize(&m_pInternalBufferIn1_Multiply, &m_iInternalBufferIn1Size_Multiply, requiredbuffersize);
+		AdjustInternalBufferSize(&m_pInternalBufferIn2_Multiply, &m_iInternalBufferIn2Size_Multiply, requiredbuffersize);
+		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn1_Multiply, CL_TRUE, 0, requiredbuffersize, inputBuffer1, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn2_Multiply, CL_TRUE, 0, requiredbuffersize, inputBuffer2, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+        ComplexMultiplication(m_pInternalBufferIn1_Multiply, 0, m_pInternalBufferIn2_Multiply, 0, m_pInternalBufferOut_Multiply, 0, countOfComplexNumbers);
+		clErr = clEnqueueReadBuffer(m_clQueue, m_pInternalBufferOut_Multiply, CL_TRUE, 0, requiredbuffersize, outputBuffer, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS){ printf("Failed to copy from OPENCL to HOST memory"); return AMF_FAIL; }
+	}
+	else
+	{
+        GetTANMathKernels().ComplexMultiplication(inputBuffer1, inputBuffer2, outputBuffer, countOfComplexNumbers);
+	}
+
+    return AMF_OK;
+
+#else
+
+	THROW_NOT_IMPLEMENTED;
+
+	return AMF_NOT_IMPLEMENTED;
+
+#endif
+}
+
+//------------------------------------------------------------------------------------------------
+AMF_RESULT TANMathImpl::ComplexMultiplyAccumulate(
+	const float inputBuffer1[],
+	const float inputBuffer2[],
+	float accumBuffer[],
+    amf_size countOfComplexNumbers)
+{
+	AMF_RETURN_IF_FALSE(inputBuffer1 != NULL, AMF_INVALID_ARG, L"inputBuffer1 == NULL");
+	AMF_RETURN_IF_FALSE(inputBuffer2 != NULL, AMF_INVALID_ARG, L"inputBuffer2 == NULL");
+	AMF_RETURN_IF_FALSE(accumBuffer != NULL, AMF_INVALID_ARG, L"outputBuffer == NULL");
+
+    AMF_RETURN_IF_FALSE(countOfComplexNumbers > 0, AMF_INVALID_ARG, L"countOfComplexNumbers == 0");
+
+#ifndef TAN_NO_OPENCL
+
+	if (m_pContextTAN->GetOpenCLContext())
+	{
+		// Adjust internal buffer size
+		cl_int clErr = 0;;
+        amf_size requiredbuffersize = countOfComplexNumbers * sizeof(float)*2;
+		AdjustInternalBufferSize(&m_pInternalBufferIn1_MulAccu, &m_iInternalBufferIn1Size_MulAccu, requiredbuffersize);
+		AdjustInternalBufferSize(&m_pInternalBufferIn2_MulAccu, &m_iInternalBufferIn2Size_MulAccu, requiredbuffersize);
+		AdjustInternalBufferSize(&m_pInternalBufferOut_MulAccu, &m_iInternalBufferOutSize_MulAccu, 2 * sizeof(float));
+		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn1_MulAccu, CL_TRUE, 0, requiredbuffersize, inputBuffer1, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+		clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBufferIn2_MulAccu, CL_TRUE, 0, requiredbuffersize, inputBuffer2, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS){ printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+
+		ComplexMultiplyAccumulate(m_pInternalBufferIn1_MulAccu, 0, m_pInternalBufferIn2_MulAccu, 0, m_pInternalBufferOut_MulAccu, 0, countOfComplexNumbers);
+
+		clErr = clEnqueueReadBuffer(m_clQueue, m_pInternalBufferOut_MulAccu, CL_TRUE, 0, 2 * sizeof(float), accumBuffer, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS){ printf("Failed to copy from OPENCL to HOST memory"); return AMF_FAIL; }
+	}
+	else
+    {
+        GetTANMathKernels().ComplexMultiplyAccumulate(inputBuffer1, inputBuffer2, accumBuffer, countOfComplexNumbers);
+	}
+
+	return AMF_OK;
+
+#else
+
+	THROW_NOT_IMPLEMENTED;
+
+	return AMF_NOT_IMPLEMENTED;
+
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+#ifndef TAN_NO_OPENCL
+
+AMF_RESULT TANMathImpl::ComplexMultiplication(
 	const cl_mem inputBuffer1,
     const amf_size buffer1OffsetInSamples,
 	const cl_mem inputBuffer2,
@@ -1185,13 +1710,10 @@ AMF_RESULT TANMathImpl::ComplexMultiplyAccumulate(
 	if (clErr != CL_SUCCESS) { printf("Faield to map OCL Buffer"); return AMF_FAIL; }
 	float* outputbufferhost = (float*)clEnqueueMapBuffer(m_clQueue, accumBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, (accumBufferOffsetInSamples) * sizeof(float), 2 * sizeof(float), 0, NULL, NULL, &clErr);
 	if (clErr != CL_SUCCESS) { printf("Faield to map OCL Buffer"); return AMF_FAIL; }
-	for (amf_size index = 0; index < leftOver*4; index++)
-	{
-		amf_size temp = index & 1;
-		float a = resultBufferHost[index];
-		float b = outputbufferhost[temp];
-		outputbufferhost[temp] += resultBufferHost[index];
-	}
+	float partialSum[2];
+	GetTANMathKernels().ComplexSum(resultBufferHost, partialSum, leftOver * 2);
+	outputbufferhost[0] += partialSum[0];
+	outputbufferhost[1] += partialSum[1];
 	clErr = clEnqueueUnmapMemObject(m_clQueue, resultBuffferOCL, resultBufferHost, 0,NULL,NULL);
 	if (clErr != CL_SUCCESS) { printf("Faield to unmap OCL Buffer"); return AMF_FAIL; }
 	clErr = clEnqueueUnmapMemObject(m_clQueue, accumBuffer, outputbufferhost, 0,NULL,NULL);
@@ -1266,19 +1788,7 @@ AMF_RESULT TANMathImpl::ComplexDivision(
 	}
 	else
 	{
-        for (amf_size id = 0; id < countOfComplexNumbers; id++)
-		{
-			amf_size j;
-			float ar, ai, br, bi;
-			j = (id << 1);
-			ar = inputBuffer1[j];
-			ai = inputBuffer1[j + 1];
-			br = inputBuffer2[j];
-			bi = inputBuffer2[j + 1];
-			float d = br*br + bi*bi;
-			outputBuffer[j] = (ar*br + ai*bi) / d;
-			outputBuffer[j + 1] = (-ar*bi + ai*br) / d;
-		}
+        GetTANMathKernels().ComplexDivision(inputBuffer1, inputBuffer2, outputBuffer, countOfComplexNumbers);
 	}
     return AMF_OK;
 
@@ -1368,3 +1878,248 @@ AMF_RESULT TANMathImpl::ComplexDivision(
 }
 
 #endif
+
+//-------------------------------------------------------------------------------------------------
+#ifndef TAN_NO_OPENCL
+
+// Entry checks of the cl_mem real vector operations, the kernels index with an int.
+static AMF_RESULT CheckRealOpsBuffers(
+	const cl_mem buffers1[],
+	const amf_size offsets1[],
+	const cl_mem buffers2[],
+	const amf_size offsets2[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	AMF_RETURN_IF_FALSE(buffers1 != NULL, AMF_INVALID_ARG, L"buffers1 == NULL");
+	AMF_RETURN_IF_FALSE(offsets1 != NULL, AMF_INVALID_ARG, L"offsets1 == NULL");
+	AMF_RETURN_IF_FALSE(buffers2 != NULL, AMF_INVALID_ARG, L"buffers2 == NULL");
+	AMF_RETURN_IF_FALSE(offsets2 != NULL, AMF_INVALID_ARG, L"offsets2 == NULL");
+	AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess > 0, AMF_INVALID_ARG, L"numOfSamplesToProcess == 0");
+	AMF_RETURN_IF_FALSE(numOfSamplesToProcess <= amf_size(INT_MAX), AMF_INVALID_ARG, L"numOfSamplesToProcess is too large");
+
+	// the size of a buffer is only queried again when the next channel uses another one
+	size_t size1 = 0, size2 = 0;
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		AMF_RETURN_IF_FALSE(buffers1[channelId] != NULL, AMF_INVALID_ARG, L"buffers1[%u] == NULL", channelId);
+		AMF_RETURN_IF_FALSE(buffers2[channelId] != NULL, AMF_INVALID_ARG, L"buffers2[%u] == NULL", channelId);
+
+		if (channelId == 0 || buffers1[channelId] != buffers1[channelId - 1])
+		{
+			AMF_RETURN_IF_FALSE(clGetMemObjectInfo(buffers1[channelId], CL_MEM_SIZE, sizeof(size1), &size1, NULL) == CL_SUCCESS,
+				AMF_INVALID_ARG, L"buffers1[%u] is not a buffer", channelId);
+		}
+		if (channelId == 0 || buffers2[channelId] != buffers2[channelId - 1])
+		{
+			AMF_RETURN_IF_FALSE(clGetMemObjectInfo(buffers2[channelId], CL_MEM_SIZE, sizeof(size2), &size2, NULL) == CL_SUCCESS,
+				AMF_INVALID_ARG, L"buffers2[%u] is not a buffer", channelId);
+		}
+
+		AMF_RETURN_IF_FALSE(offsets1[channelId] <= size1 / sizeof(float) && numOfSamplesToProcess <= size1 / sizeof(float) - offsets1[channelId],
+			AMF_INVALID_ARG, L"offsets1[%u] + numOfSamplesToProcess is out of the buffer", channelId);
+		AMF_RETURN_IF_FALSE(offsets2[channelId] <= size2 / sizeof(float) && numOfSamplesToProcess <= size2 / sizeof(float) - offsets2[channelId],
+			AMF_INVALID_ARG, L"offsets2[%u] + numOfSamplesToProcess is out of the buffer", channelId);
+	}
+
+	return AMF_OK;
+}
+
+// Channels c to the end of the run share both buffers of channel c, they go in one launch.
+static amf_uint32 RealOpsRun(const cl_mem buffers1[], const cl_mem buffers2[], amf_uint32 c, amf_uint32 channels)
+{
+	amf_uint32 end = c + 1;
+
+	while (end < channels && buffers1[end] == buffers1[c] && buffers2[end] == buffers2[c])
+	{
+		end++;
+	}
+
+	return end;
+}
+
+AMF_RESULT TANMathImpl::GainGpu(
+	const cl_mem inputBuffers[],
+	const amf_size inputBuffersOffsetInSamples[],
+	cl_mem outputBuffers[],
+	const amf_size outputBuffersOffsetInSamples[],
+	const float gains[],
+	const float gainSteps[],
+	bool exponential,
+	bool accumulate,
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	if (m_pKernelGain == 0)
+	{
+		return AMF_OPENCL_FAILED;
+	}
+
+	AMF_RETURN_IF_FAILED(CheckRealOpsBuffers(inputBuffers, inputBuffersOffsetInSamples,
+		outputBuffers, outputBuffersOffsetInSamples, channels, numOfSamplesToProcess));
+
+	AMFLock lock(&m_sect);
+
+	m_RealOpsOffsets.resize(2 * channels);
+	m_RealOpsGains.resize(2 * channels);
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		m_RealOpsOffsets[2 * channelId] = inputBuffersOffsetInSamples[channelId];
+		m_RealOpsOffsets[2 * channelId + 1] = outputBuffersOffsetInSamples[channelId];
+		m_RealOpsGains[2 * channelId] = gains[channelId];
+		m_RealOpsGains[2 * channelId + 1] = gainSteps ? gainSteps[channelId] : 0.0f;
+	}
+
+	AMF_RETURN_IF_FAILED(AdjustInternalBufferSize(&m_pInternalBuffer_RealOpsOffsets, &m_iInternalBufferSize_RealOpsOffsets, 2 * channels * sizeof(cl_ulong)));
+	AMF_RETURN_IF_FAILED(AdjustInternalBufferSize(&m_pInternalBuffer_RealOpsGains, &m_iInternalBufferSize_RealOpsGains, 2 * channels * sizeof(float)));
+
+	cl_int clErr;
+
+	clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBuffer_RealOpsOffsets, CL_TRUE, 0, 2 * channels * sizeof(cl_ulong), m_RealOpsOffsets.data(), 0, NULL, NULL);
+	if (clErr != CL_SUCCESS) { printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+	clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBuffer_RealOpsGains, CL_TRUE, 0, 2 * channels * sizeof(float), m_RealOpsGains.data(), 0, NULL, NULL);
+	if (clErr != CL_SUCCESS) { printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+
+	const amf_size oclWorkGroupSize = 64;
+	cl_int exponentialArg = exponential ? 1 : 0;
+	cl_int accumulateArg = accumulate ? 1 : 0;
+	cl_int count = static_cast<cl_int>(numOfSamplesToProcess);
+
+	for (amf_uint32 first = 0, end = 0; first < channels; first = end)
+	{
+		end = RealOpsRun(inputBuffers, outputBuffers, first, channels);
+
+		cl_int firstChannel = static_cast<cl_int>(first);
+		cl_uint index = 0;
+
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_mem), &inputBuffers[first]);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_mem), &outputBuffers[first]);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_mem), &m_pInternalBuffer_RealOpsOffsets);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_mem), &m_pInternalBuffer_RealOpsGains);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_int), &firstChannel);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_int), &exponentialArg);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_int), &accumulateArg);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelGain, index++, sizeof(cl_int), &count);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+
+		amf_size global[3] = { (numOfSamplesToProcess + oclWorkGroupSize - 1) / oclWorkGroupSize * oclWorkGroupSize, end - first, 0 };
+		amf_size local[3] = { oclWorkGroupSize, 1, 0 };
+		clErr = clEnqueueNDRangeKernel(m_clQueue, m_pKernelGain, 2, NULL, global, local, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS) { printf("Failed to enqueue OpenCL kernel\n"); return AMF_FAIL; }
+	}
+
+	return AMF_OK;
+}
+
+AMF_RESULT TANMathImpl::DotPeakGpu(
+	const cl_mem inputBuffers1[],
+	const amf_size buffers1OffsetInSamples[],
+	const cl_mem inputBuffers2[],
+	const amf_size buffers2OffsetInSamples[],
+	float sums[],
+	float peaks[],
+	amf_uint32 channels,
+	amf_size numOfSamplesToProcess
+	)
+{
+	if (m_pKernelDotPeak == 0)
+	{
+		return AMF_OPENCL_FAILED;
+	}
+
+	AMF_RETURN_IF_FAILED(CheckRealOpsBuffers(inputBuffers1, buffers1OffsetInSamples,
+		inputBuffers2, buffers2OffsetInSamples, channels, numOfSamplesToProcess));
+
+	AMFLock lock(&m_sect);
+
+	// one pass over the data: at most 64 groups per channel stride over the vector, the host
+	// adds up the groups after a single read of all channels
+	const amf_size oclWorkGroupSize = 64;
+	const amf_size groups = std::min<amf_size>((numOfSamplesToProcess + oclWorkGroupSize - 1) / oclWorkGroupSize, 64);
+
+	m_RealOpsOffsets.resize(2 * channels);
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		m_RealOpsOffsets[2 * channelId] = buffers1OffsetInSamples[channelId];
+		m_RealOpsOffsets[2 * channelId + 1] = buffers2OffsetInSamples[channelId];
+	}
+
+	AMF_RETURN_IF_FAILED(AdjustInternalBufferSize(&m_pInternalBuffer_RealOpsOffsets, &m_iInternalBufferSize_RealOpsOffsets, 2 * channels * sizeof(cl_ulong)));
+	AMF_RETURN_IF_FAILED(AdjustInternalBufferSize(&m_pInternalBuffer_DotPeak, &m_iInternalBufferSize_DotPeak, 2 * channels * groups * sizeof(float)));
+
+	cl_int clErr;
+
+	clErr = clEnqueueWriteBuffer(m_clQueue, m_pInternalBuffer_RealOpsOffsets, CL_TRUE, 0, 2 * channels * sizeof(cl_ulong), m_RealOpsOffsets.data(), 0, NULL, NULL);
+	if (clErr != CL_SUCCESS) { printf("Failed to copy from HOST to OPENCL memory"); return AMF_FAIL; }
+
+	cl_int count = static_cast<cl_int>(numOfSamplesToProcess);
+
+	for (amf_uint32 first = 0, end = 0; first < channels; first = end)
+	{
+		end = RealOpsRun(inputBuffers1, inputBuffers2, first, channels);
+
+		cl_int firstChannel = static_cast<cl_int>(first);
+		cl_uint index = 0;
+
+		clErr = clSetKernelArg(m_pKernelDotPeak, index++, sizeof(cl_mem), &inputBuffers1[first]);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelDotPeak, index++, sizeof(cl_mem), &inputBuffers2[first]);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelDotPeak, index++, sizeof(cl_mem), &m_pInternalBuffer_RealOpsOffsets);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelDotPeak, index++, sizeof(cl_mem), &m_pInternalBuffer_DotPeak);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelDotPeak, index++, sizeof(cl_int), &firstChannel);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+		clErr = clSetKernelArg(m_pKernelDotPeak, index++, sizeof(cl_int), &count);
+		if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+
+		amf_size global[3] = { groups * oclWorkGroupSize, end - first, 0 };
+		amf_size local[3] = { oclWorkGroupSize, 1, 0 };
+		clErr = clEnqueueNDRangeKernel(m_clQueue, m_pKernelDotPeak, 2, NULL, global, local, 0, NULL, NULL);
+		if (clErr != CL_SUCCESS) { printf("Failed to enqueue OpenCL kernel\n"); return AMF_FAIL; }
+	}
+
+	m_CpuPartials.resize(2 * channels * groups);
+	clErr = clEnqueueReadBuffer(m_clQueue, m_pInternalBuffer_DotPeak, CL_TRUE, 0, 2 * channels * groups * sizeof(float), m_CpuPartials.data(), 0, NULL, NULL);
+	if (clErr != CL_SUCCESS) { printf("Failed to read OpenCL buffer"); return AMF_FAIL; }
+
+	for (amf_size channelId = 0; channelId < channels; channelId++)
+	{
+		const float * partials = m_CpuPartials.data() + 2 * channelId * groups;
+		float groupSum = 0.0f;
+		float groupPeak = 0.0f;
+
+		for (amf_size group = 0; group < groups; group++)
+		{
+			groupSum += partials[2 * group];
+			groupPeak = std::max(groupPeak, partials[2 * group + 1]);
+		}
+
+		if (sums != NULL)
+		{
+			sums[channelId] = groupSum;
+		}
+		if (peaks != NULL)
+		{
+			peaks[channelId] = groupPeak;
+		}
+	}
+
+	return AMF_OK;
+}
+
+#endif
@@ -38,6 +38,10 @@
 #include "public/include/core/Context.h"        //AMF
 #include "public/include/components/Component.h"//AMF
 #include "public/common/PropertyStorageExImpl.h"
+#include "../core/PerformanceCounters.h"
+#include "../core/ThreadPool.h"
+
+#include <vector>
 
 namespace amf
 {
@@ -50,9 +54,6 @@ namespace amf
 		TANMathImpl(TANContext *pContextTAN, bool useConvQueue);
 		virtual ~TANMathImpl(void);
 
-        static bool useAVX256;
-		static bool useAVX512;
-
         // interface access
         AMF_BEGIN_INTERFACE_MAP
             AMF_INTERFACE_CHAIN_ENTRY(AMFInterfaceImpl< AMFPropertyStorageExImpl <TANMath> >)
@@ -63,6 +64,11 @@ namespace amf
         virtual AMF_RESULT  AMF_STD_CALL Terminate() override;
         virtual TANContext* AMF_STD_CALL GetContext() override { return m_pContextTAN; }
 
+        //AMFPropertyStorage interface, for the TAN_STATS_* properties
+        using TANMath::GetProperty;
+        AMF_RESULT  AMF_STD_CALL GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const override;
+        void        AMF_STD_CALL OnPropertyChanged(const wchar_t* name) override;
+
         virtual AMF_RESULT ComplexMultiplication(	const float* const inputBuffers1[],
                                                     const float* const inputBuffers2[],
                                                     float *outputBuffers[],
@@ -98,6 +104,24 @@ namespace amf
 													amf_size numOfSamplesToProcess,
 													amf_uint riPlaneSpacing) override;
 
+        virtual AMF_RESULT ComplexMultiplyAccumulate(
+                                                    const float* const inputBuffers1[],
+                                                    TANComplexLayout layout1,
+                                                    const float* const inputBuffers2[],
+                                                    TANComplexLayout layout2,
+                                                    float *accumbuffers[],
+                                                    TANComplexLayout accumLayout,
+                                                    amf_uint32 channels,
+                                                    amf_size countOfComplexNumbers) override;
+
+        virtual AMF_RESULT ConvertComplexLayout(
+                                                    const float* const inputBuffers[],
+                                                    TANComplexLayout inputLayout,
+                                                    float *outputBuffers[],
+                                                    TANComplexLayout outputLayout,
+                                                    amf_uint32 channels,
+                                                    amf_size countOfComplexNumbers) override;
+
         virtual AMF_RESULT ComplexMultiplyAccumulate(
                                                     const float* const inputBuffers1[],
 													const float* const inputBuffers2[],
@@ -165,6 +189,115 @@ namespace amf
                                                     amf_size countOfComplexNumbers) override;
 #endif
 
+        virtual AMF_RESULT ComplexSum(              const float* const inputBuffers[],
+                                                    float *outputBuffers[],
+                                                    amf_uint32 channels,
+                                                    amf_size countOfComplexNumbers) override;
+
+        virtual AMF_RESULT Scale(                   const float* const inputBuffers[],
+                                                    float *outputBuffers[],
+                                                    const float gains[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT GainRamp(                const float* const inputBuffers[],
+                                                    float *outputBuffers[],
+                                                    const float startGains[],
+                                                    const float endGains[],
+                                                    TAN_GAIN_RAMP ramp,
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT AccumulateWithGain(      const float* const inputBuffers[],
+                                                    float *accumBuffers[],
+                                                    const float gains[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT DotProduct(              const float* const inputBuffers1[],
+                                                    const float* const inputBuffers2[],
+                                                    float results[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT PeakRms(                 const float* const inputBuffers[],
+                                                    float peaks[],
+                                                    float rms[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+
+#ifndef TAN_NO_OPENCL
+        virtual AMF_RESULT Scale(                   const cl_mem inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    cl_mem outputBuffers[],
+                                                    const amf_size outputBuffersOffsetInSamples[],
+                                                    const float gains[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT GainRamp(                const cl_mem inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    cl_mem outputBuffers[],
+                                                    const amf_size outputBuffersOffsetInSamples[],
+                                                    const float startGains[],
+                                                    const float endGains[],
+                                                    TAN_GAIN_RAMP ramp,
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT AccumulateWithGain(      const cl_mem inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    cl_mem accumBuffers[],
+                                                    const amf_size accumBuffersOffsetInSamples[],
+                                                    const float gains[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT DotProduct(              const cl_mem inputBuffers1[],
+                                                    const amf_size buffers1OffsetInSamples[],
+                                                    const cl_mem inputBuffers2[],
+                                                    const amf_size buffers2OffsetInSamples[],
+                                                    float results[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT PeakRms(                 const cl_mem inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    float peaks[],
+                                                    float rms[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+#else
+        virtual AMF_RESULT Scale(                   const AMFBuffer * inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    AMFBuffer * outputBuffers[],
+                                                    const amf_size outputBuffersOffsetInSamples[],
+                                                    const float gains[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT GainRamp(                const AMFBuffer * inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    AMFBuffer * outputBuffers[],
+                                                    const amf_size outputBuffersOffsetInSamples[],
+                                                    const float startGains[],
+                                                    const float endGains[],
+                                                    TAN_GAIN_RAMP ramp,
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT AccumulateWithGain(      const AMFBuffer * inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    AMFBuffer * accumBuffers[],
+                                                    const amf_size accumBuffersOffsetInSamples[],
+                                                    const float gains[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT DotProduct(              const AMFBuffer * inputBuffers1[],
+                                                    const amf_size buffers1OffsetInSamples[],
+                                                    const AMFBuffer * inputBuffers2[],
+                                                    const amf_size buffers2OffsetInSamples[],
+                                                    float results[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+        virtual AMF_RESULT PeakRms(                 const AMFBuffer * inputBuffers[],
+                                                    const amf_size inputBuffersOffsetInSamples[],
+                                                    float peaks[],
+                                                    float rms[],
+                                                    amf_uint32 channels,
+                                                    amf_size numOfSamplesToProcess) override;
+#endif
+
     protected:
         virtual AMF_RESULT ComplexMultiplication(
         	const float inputBuffer1[],
@@ -244,15 +377,51 @@ namespace amf
             amf_size countOfComplexNumbers);
 #endif
 
+#ifndef TAN_NO_OPENCL
+        // the real vector operations on all channels, see VectorRealOps.cl: one launch for
+        // every run of channels on the same buffers, gainSteps can be NULL, so can sums and peaks
+        AMF_RESULT GainGpu(
+            const cl_mem inputBuffers[],
+            const amf_size inputBuffersOffsetInSamples[],
+            cl_mem outputBuffers[],
+            const amf_size outputBuffersOffsetInSamples[],
+            const float gains[],
+            const float gainSteps[],
+            bool exponential,
+            bool accumulate,
+            amf_uint32 channels,
+            amf_size numOfSamplesToProcess);
+
+        AMF_RESULT DotPeakGpu(
+            const cl_mem inputBuffers1[],
+            const amf_size buffers1OffsetInSamples[],
+            const cl_mem inputBuffers2[],
+            const amf_size buffers2OffsetInSamples[],
+            float sums[],
+            float peaks[],
+            amf_uint32 channels,
+            amf_size numOfSamplesToProcess);
+#endif
+
     protected:
         TANContextPtr               m_pContextTAN;
         AMFComputePtr               m_pDeviceCompute;
 
+        // CPU loops run on the workers of the context, within the thread budget of
+        // convolution for objects on the convolution queue
+        TANThreadPool *             m_pThreadPool = nullptr;
+        TAN_THREAD_BUDGET_COMPONENT m_threadBudget = TAN_THREAD_BUDGET_MATH;
+
+        // TAN_STATS_* properties, a block is an operation on host memory of all channels
+        TANPerformanceCounters      m_counters;
+
 #ifndef TAN_NO_OPENCL
         cl_kernel			        m_pKernelComplexDiv = nullptr;
         cl_kernel			        m_pKernelComplexMul = nullptr;
 		cl_kernel			        m_pKernelComplexSum = nullptr;
         cl_kernel			        m_pKernelComplexMulAccum = nullptr;
+        cl_kernel                   m_pKernelGain = nullptr;
+        cl_kernel                   m_pKernelDotPeak = nullptr;
 #else
         AMFComputeKernelPtr         mKernelComplexDiv;
 		AMFComputeKernelPtr         mKernelComplexMul;
@@ -264,6 +433,23 @@ namespace amf
 
         AMFCriticalSection          m_sect;
 
+        // per work item partial results of the CPU reductions
+        std::vector<float>          m_CpuPartials;
+
+#ifndef TAN_NO_OPENCL
+        // per work group partial results of VectorDotPeak
+        cl_mem                      m_pInternalBuffer_DotPeak = nullptr;
+        amf_size                    m_iInternalBufferSize_DotPeak = 0;
+
+        // channel tables of the real vector operations: two offsets and two gains per channel
+        cl_mem                      m_pInternalBuffer_RealOpsOffsets = nullptr;
+        amf_size                    m_iInternalBufferSize_RealOpsOffsets = 0;
+        cl_mem                      m_pInternalBuffer_RealOpsGains = nullptr;
+        amf_size                    m_iInternalBufferSize_RealOpsGains = 0;
+        std::vector<cl_ulong>       m_RealOpsOffsets;
+        std::vector<float>          m_RealOpsGains;
+#endif
+
 #ifndef TAN_NO_OPENCL
 
 		// multiply accumulate internal buffer
@@ -0,0 +1,522 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// SSE2 kernels and GetTANMathKernels(), built for plain x86-64, see core/KernelDispatch.h.
+//
+
+#include "MathKernels.h"
+
+#include "../core/KernelDispatch.h"
+
+#include <emmintrin.h>
+
+#define AMF_FACILITY L"TANMathKernels"
+
+using namespace amf;
+
+namespace
+{
+    // (ar, ai) * (br, bi) for the two complex numbers of a register.
+    inline __m128 ComplexMul2(__m128 a, __m128 b)
+    {
+        const __m128 signs = _mm_castsi128_ps(_mm_set_epi32(0, 0x80000000, 0, 0x80000000));
+
+        __m128 aRe = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 aIm = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 bSwap = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+
+        // (ar*br - ai*bi, ar*bi + ai*br)
+        return _mm_add_ps(_mm_mul_ps(aRe, b), _mm_xor_ps(_mm_mul_ps(aIm, bSwap), signs));
+    }
+
+    void ComplexMultiplicationSSE2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * outputBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 2 <= countOfComplexNumbers; id += 2)
+        {
+            __m128 a = _mm_loadu_ps(inputBuffer1 + 2 * id);
+            __m128 b = _mm_loadu_ps(inputBuffer2 + 2 * id);
+
+            _mm_storeu_ps(outputBuffer + 2 * id, ComplexMul2(a, b));
+        }
+
+        for (; id < countOfComplexNumbers; id++)
+        {
+            float ar = inputBuffer1[2 * id], ai = inputBuffer1[2 * id + 1];
+            float br = inputBuffer2[2 * id], bi = inputBuffer2[2 * id + 1];
+
+            outputBuffer[2 * id] = ar * br - ai * bi;
+            outputBuffer[2 * id + 1] = ar * bi + ai * br;
+        }
+    }
+
+    void ComplexMultiplyAccumulateSSE2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * accumBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 2 <= countOfComplexNumbers; id += 2)
+        {
+            __m128 a = _mm_loadu_ps(inputBuffer1 + 2 * id);
+            __m128 b = _mm_loadu_ps(inputBuffer2 + 2 * id);
+            __m128 c = _mm_loadu_ps(accumBuffer + 2 * id);
+
+            _mm_storeu_ps(accumBuffer + 2 * id, _mm_add_ps(c, ComplexMul2(a, b)));
+        }
+
+        for (; id < countOfComplexNumbers; id++)
+        {
+            float ar = inputBuffer1[2 * id], ai = inputBuffer1[2 * id + 1];
+            float br = inputBuffer2[2 * id], bi = inputBuffer2[2 * id + 1];
+
+            accumBuffer[2 * id] += ar * br - ai * bi;
+            accumBuffer[2 * id + 1] += ar * bi + ai * br;
+        }
+    }
+
+    void PlanarComplexMultiplyAccumulateSSE2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * accumBuffer,
+        amf_size countOfComplexNumbers,
+        amf_size riPlaneSpacing)
+    {
+        const float *ar = inputBuffer1, *ai = inputBuffer1 + riPlaneSpacing;
+        const float *br = inputBuffer2, *bi = inputBuffer2 + riPlaneSpacing;
+        float *cr = accumBuffer, *ci = accumBuffer + riPlaneSpacing;
+
+        amf_size id = 0;
+
+        for (; id + 4 <= countOfComplexNumbers; id += 4)
+        {
+            __m128 arReg = _mm_loadu_ps(ar + id);
+            __m128 aiReg = _mm_loadu_ps(ai + id);
+            __m128 brReg = _mm_loadu_ps(br + id);
+            __m128 biReg = _mm_loadu_ps(bi + id);
+
+            __m128 re = _mm_sub_ps(_mm_mul_ps(arReg, brReg), _mm_mul_ps(aiReg, biReg));
+            __m128 im = _mm_add_ps(_mm_mul_ps(arReg, biReg), _mm_mul_ps(aiReg, brReg));
+
+            _mm_storeu_ps(cr + id, _mm_add_ps(_mm_loadu_ps(cr + id), re));
+            _mm_storeu_ps(ci + id, _mm_add_ps(_mm_loadu_ps(ci + id), im));
+        }
+
+        for (; id < countOfComplexNumbers; id++)
+        {
+            cr[id] += ar[id] * br[id] - ai[id] * bi[id];
+            ci[id] += ar[id] * bi[id] + ai[id] * br[id];
+        }
+    }
+
+    void ComplexDivisionSSE2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * outputBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        const __m128 signs = _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0, 0x80000000, 0));
+        const __m128 minD = _mm_set1_ps(ComplexDivisionMinDenominator);
+
+        amf_size id = 0;
+
+        for (; id + 2 <= countOfComplexNumbers; id += 2)
+        {
+            __m128 a = _mm_loadu_ps(inputBuffer1 + 2 * id);
+            __m128 b = _mm_loadu_ps(inputBuffer2 + 2 * id);
+
+            __m128 aRe = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 0, 0));
+            __m128 aIm = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 1, 1));
+            __m128 bSwap = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+
+            // a * conj(b) = (ar*br + ai*bi, ai*br - ar*bi)
+            __m128 num = _mm_add_ps(_mm_mul_ps(aIm, bSwap), _mm_xor_ps(_mm_mul_ps(aRe, b), signs));
+
+            // |b|^2 in both lanes of each complex number
+            __m128 d = _mm_mul_ps(b, b);
+            d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+            d = _mm_max_ps(d, minD);
+
+            _mm_storeu_ps(outputBuffer + 2 * id, _mm_div_ps(num, d));
+        }
+
+        for (; id < countOfComplexNumbers; id++)
+        {
+            float ar = inputBuffer1[2 * id], ai = inputBuffer1[2 * id + 1];
+            float br = inputBuffer2[2 * id], bi = inputBuffer2[2 * id + 1];
+            float d = br * br + bi * bi;
+
+            if (!(d >= ComplexDivisionMinDenominator))
+            {
+                d = ComplexDivisionMinDenominator;
+            }
+
+            outputBuffer[2 * id] = (ar * br + ai * bi) / d;
+            outputBuffer[2 * id + 1] = (-ar * bi + ai * br) / d;
+        }
+    }
+
+    void ComplexSumSSE2(
+        const float * inputBuffer,
+        float * sum,
+        amf_size countOfComplexNumbers)
+    {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 4 <= countOfComplexNumbers; id += 4)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_loadu_ps(inputBuffer + 2 * id));
+            acc1 = _mm_add_ps(acc1, _mm_loadu_ps(inputBuffer + 2 * id + 4));
+        }
+
+        acc0 = _mm_add_ps(acc0, acc1);
+
+        if (id + 2 <= countOfComplexNumbers)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_loadu_ps(inputBuffer + 2 * id));
+            id += 2;
+        }
+
+        // (r0, i0, r1, i1) -> (r0 + r1, i0 + i1)
+        acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+
+        float re = _mm_cvtss_f32(acc0);
+        float im = _mm_cvtss_f32(_mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(1, 1, 1, 1)));
+
+        if (id < countOfComplexNumbers)
+        {
+            re += inputBuffer[2 * id];
+            im += inputBuffer[2 * id + 1];
+        }
+
+        sum[0] = re;
+        sum[1] = im;
+    }
+
+    // Four complex numbers of a buffer as a real and an imaginary register, planeSpacing 0 is interleaved.
+    inline void LoadComplex4(const float * p, amf_size planeSpacing, __m128 & re, __m128 & im)
+    {
+        if (planeSpacing)
+        {
+            re = _mm_loadu_ps(p);
+            im = _mm_loadu_ps(p + planeSpacing);
+        }
+        else
+        {
+            __m128 lo = _mm_loadu_ps(p);
+            __m128 hi = _mm_loadu_ps(p + 4);
+
+            re = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+            im = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+    }
+
+    inline void StoreComplex4(float * p, amf_size planeSpacing, __m128 re, __m128 im)
+    {
+        if (planeSpacing)
+        {
+            _mm_storeu_ps(p, re);
+            _mm_storeu_ps(p + planeSpacing, im);
+        }
+        else
+        {
+            _mm_storeu_ps(p, _mm_unpacklo_ps(re, im));
+            _mm_storeu_ps(p + 4, _mm_unpackhi_ps(re, im));
+        }
+    }
+
+    void MixedComplexMultiplyAccumulateSSE2(
+        const float * inputBuffer1,
+        amf_size planeSpacing1,
+        const float * inputBuffer2,
+        amf_size planeSpacing2,
+        float * accumBuffer,
+        amf_size accumPlaneSpacing,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 4 <= countOfComplexNumbers; id += 4)
+        {
+            __m128 ar, ai, br, bi, cr, ci;
+
+            LoadComplex4(inputBuffer1 + ComplexRealOffset(id, planeSpacing1), planeSpacing1, ar, ai);
+            LoadComplex4(inputBuffer2 + ComplexRealOffset(id, planeSpacing2), planeSpacing2, br, bi);
+            LoadComplex4(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, cr, ci);
+
+            cr = _mm_add_ps(cr, _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi)));
+            ci = _mm_add_ps(ci, _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br)));
+
+            StoreComplex4(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, cr, ci);
+        }
+
+        const amf_size im1 = ComplexImagOffset(planeSpacing1);
+        const amf_size im2 = ComplexImagOffset(planeSpacing2);
+        const amf_size imC = ComplexImagOffset(accumPlaneSpacing);
+
+        for (; id < countOfComplexNumbers; id++)
+        {
+            const float * a = inputBuffer1 + ComplexRealOffset(id, planeSpacing1);
+            const float * b = inputBuffer2 + ComplexRealOffset(id, planeSpacing2);
+            float * c = accumBuffer + ComplexRealOffset(id, accumPlaneSpacing);
+
+            c[0] += a[0] * b[0] - a[im1] * b[im2];
+            c[imC] += a[0] * b[im2] + a[im1] * b[0];
+        }
+    }
+
+    void ConvertComplexLayoutSSE2(
+        const float * inputBuffer,
+        amf_size inputPlaneSpacing,
+        float * outputBuffer,
+        amf_size outputPlaneSpacing,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 4 <= countOfComplexNumbers; id += 4)
+        {
+            __m128 re, im;
+
+            LoadComplex4(inputBuffer + ComplexRealOffset(id, inputPlaneSpacing), inputPlaneSpacing, re, im);
+            StoreComplex4(outputBuffer + ComplexRealOffset(id, outputPlaneSpacing), outputPlaneSpacing, re, im);
+        }
+
+        const amf_size imIn = ComplexImagOffset(inputPlaneSpacing);
+        const amf_size imOut = ComplexImagOffset(outputPlaneSpacing);
+
+        for (; id < countOfComplexNumbers; id++)
+        {
+            const float * in = inputBuffer + ComplexRealOffset(id, inputPlaneSpacing);
+            float * out = outputBuffer + ComplexRealOffset(id, outputPlaneSpacing);
+
+            out[0] = in[0];
+            out[imOut] = in[imIn];
+        }
+    }
+
+    void GainLinearSSE2(
+        const float * inputBuffer,
+        float * outputBuffer,
+        float gain,
+        float gainStep,
+        amf_size count)
+    {
+        const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 g = _mm_set1_ps(gain);
+        const __m128 step = _mm_set1_ps(gainStep);
+
+        amf_size id = 0;
+
+        for (; id + 4 <= count; id += 4)
+        {
+            // from the index every time, no drift over long blocks
+            __m128 gains = _mm_add_ps(g, _mm_mul_ps(step, _mm_add_ps(_mm_set1_ps(float(id)), lanes)));
+
+            _mm_storeu_ps(outputBuffer + id, _mm_mul_ps(gains, _mm_loadu_ps(inputBuffer + id)));
+        }
+
+        for (; id < count; id++)
+        {
+            outputBuffer[id] = (gain + gainStep * float(id)) * inputBuffer[id];
+        }
+    }
+
+    void GainExponentialSSE2(
+        const float * inputBuffer,
+        float * outputBuffer,
+        float gain,
+        float gainRatio,
+        amf_size count)
+    {
+        const float ratio2 = gainRatio * gainRatio;
+        const __m128 ratio4 = _mm_set1_ps(ratio2 * ratio2);
+
+        __m128 gains = _mm_setr_ps(gain, gain * gainRatio, gain * ratio2, gain * ratio2 * gainRatio);
+
+        amf_size id = 0;
+
+        for (; id + 4 <= count; id += 4)
+        {
+            _mm_storeu_ps(outputBuffer + id, _mm_mul_ps(gains, _mm_loadu_ps(inputBuffer + id)));
+
+            gains = _mm_mul_ps(gains, ratio4);
+        }
+
+        float g = _mm_cvtss_f32(gains);
+
+        for (; id < count; id++)
+        {
+            outputBuffer[id] = g * inputBuffer[id];
+            g *= gainRatio;
+        }
+    }
+
+    void AccumulateWithGainSSE2(
+        const float * inputBuffer,
+        float * accumBuffer,
+        float gain,
+        amf_size count)
+    {
+        const __m128 g = _mm_set1_ps(gain);
+
+        amf_size id = 0;
+
+        for (; id + 4 <= count; id += 4)
+        {
+            __m128 acc = _mm_loadu_ps(accumBuffer + id);
+
+            _mm_storeu_ps(accumBuffer + id, _mm_add_ps(acc, _mm_mul_ps(g, _mm_loadu_ps(inputBuffer + id))));
+        }
+
+        for (; id < count; id++)
+        {
+            accumBuffer[id] += gain * inputBuffer[id];
+        }
+    }
+
+    inline float HorizontalSum(__m128 v)
+    {
+        v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+
+        return _mm_cvtss_f32(v);
+    }
+
+    inline float HorizontalMax(__m128 v)
+    {
+        v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_max_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+
+        return _mm_cvtss_f32(v);
+    }
+
+    float DotProductSSE2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        amf_size count)
+    {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 8 <= count; id += 8)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(inputBuffer1 + id), _mm_loadu_ps(inputBuffer2 + id)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(inputBuffer1 + id + 4), _mm_loadu_ps(inputBuffer2 + id + 4)));
+        }
+
+        float sum = HorizontalSum(_mm_add_ps(acc0, acc1));
+
+        for (; id < count; id++)
+        {
+            sum += inputBuffer1[id] * inputBuffer2[id];
+        }
+
+        return sum;
+    }
+
+    void PeakSumOfSquaresSSE2(
+        const float * inputBuffer,
+        float * peak,
+        float * sumOfSquares,
+        amf_size count)
+    {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+        __m128 maxAbs = _mm_setzero_ps();
+        __m128 acc = _mm_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 4 <= count; id += 4)
+        {
+            __m128 x = _mm_loadu_ps(inputBuffer + id);
+
+            maxAbs = _mm_max_ps(maxAbs, _mm_and_ps(x, absMask));
+            acc = _mm_add_ps(acc, _mm_mul_ps(x, x));
+        }
+
+        float p = HorizontalMax(maxAbs);
+        float sum = HorizontalSum(acc);
+
+        for (; id < count; id++)
+        {
+            float x = inputBuffer[id];
+
+            p = (x > p) ? x : ((-x > p) ? -x : p);
+            sum += x * x;
+        }
+
+        *peak = p;
+        *sumOfSquares = sum;
+    }
+}
+
+namespace amf
+{
+    const TANMathKernels TANMathKernelsSSE2 =
+    {
+        L"SSE2",
+        ComplexMultiplicationSSE2,
+        ComplexMultiplyAccumulateSSE2,
+        PlanarComplexMultiplyAccumulateSSE2,
+        ComplexDivisionSSE2,
+        ComplexSumSSE2,
+        MixedComplexMultiplyAccumulateSSE2,
+        ConvertComplexLayoutSSE2,
+        GainLinearSSE2,
+        GainExponentialSSE2,
+        AccumulateWithGainSSE2,
+        DotProductSSE2,
+        PeakSumOfSquaresSSE2
+    };
+
+    const TANMathKernels & GetTANMathKernels()
+    {
+        const TANKernelSets<TANMathKernels> sets =
+        {
+            &TANMathKernelsSSE2,
+            &TANMathKernelsAVX2,
+            true,
+#ifdef AVX512SUPPORT
+            &TANMathKernelsAVX512
+#else
+            NULL
+#endif
+        };
+
+        return TANGetKernels(AMF_FACILITY, sets);
+    }
+}
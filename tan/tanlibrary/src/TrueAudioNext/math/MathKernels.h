@@ -0,0 +1,156 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   MathKernels.h
+///  @brief  CPU kernels of TANMath, one set per instruction set
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    // Single channel CPU kernels behind TANMath. Interleaved buffers hold (real, imag)
+    // pairs, planar buffers hold the imaginary plane riPlaneSpacing floats after the real one.
+    // Any count and any alignment is accepted, nothing past the last element is read or written.
+    //
+    // One table per instruction set, see core/KernelDispatch.h.
+    struct TANMathKernels
+    {
+        const wchar_t * name;
+
+        void (*ComplexMultiplication)(
+            const float * inputBuffer1,
+            const float * inputBuffer2,
+            float * outputBuffer,
+            amf_size countOfComplexNumbers);
+
+        void (*ComplexMultiplyAccumulate)(
+            const float * inputBuffer1,
+            const float * inputBuffer2,
+            float * accumBuffer,
+            amf_size countOfComplexNumbers);
+
+        void (*PlanarComplexMultiplyAccumulate)(
+            const float * inputBuffer1,
+            const float * inputBuffer2,
+            float * accumBuffer,
+            amf_size countOfComplexNumbers,
+            amf_size riPlaneSpacing);
+
+        // |b|^2 is clamped to ComplexDivisionMinDenominator, a zero divisor gives zero, not NaN.
+        void (*ComplexDivision)(
+            const float * inputBuffer1,
+            const float * inputBuffer2,
+            float * outputBuffer,
+            amf_size countOfComplexNumbers);
+
+        // sum[0], sum[1] receive the real and imaginary sums of the input.
+        void (*ComplexSum)(
+            const float * inputBuffer,
+            float * sum,
+            amf_size countOfComplexNumbers);
+
+        // Mixed layouts: a buffer with planeSpacing 0 is interleaved, any other is planar with the
+        // imaginary plane planeSpacing floats after the real one. accumBuffer += inputBuffer1 * inputBuffer2.
+        void (*MixedComplexMultiplyAccumulate)(
+            const float * inputBuffer1,
+            amf_size planeSpacing1,
+            const float * inputBuffer2,
+            amf_size planeSpacing2,
+            float * accumBuffer,
+            amf_size accumPlaneSpacing,
+            amf_size countOfComplexNumbers);
+
+        // outputBuffer = inputBuffer rewritten in another layout, the buffers must not overlap.
+        void (*ConvertComplexLayout)(
+            const float * inputBuffer,
+            amf_size inputPlaneSpacing,
+            float * outputBuffer,
+            amf_size outputPlaneSpacing,
+            amf_size countOfComplexNumbers);
+
+        // Real vectors from here on, output may alias input.
+
+        // outputBuffer[i] = (gain + gainStep * i) * inputBuffer[i]
+        void (*GainLinear)(
+            const float * inputBuffer,
+            float * outputBuffer,
+            float gain,
+            float gainStep,
+            amf_size count);
+
+        // outputBuffer[i] = gain * gainRatio^i * inputBuffer[i]
+        void (*GainExponential)(
+            const float * inputBuffer,
+            float * outputBuffer,
+            float gain,
+            float gainRatio,
+            amf_size count);
+
+        // accumBuffer[i] += gain * inputBuffer[i]
+        void (*AccumulateWithGain)(
+            const float * inputBuffer,
+            float * accumBuffer,
+            float gain,
+            amf_size count);
+
+        float (*DotProduct)(
+            const float * inputBuffer1,
+            const float * inputBuffer2,
+            amf_size count);
+
+        // *peak = max |inputBuffer[i]|, *sumOfSquares = sum inputBuffer[i]^2
+        void (*PeakSumOfSquares)(
+            const float * inputBuffer,
+            float * peak,
+            float * sumOfSquares,
+            amf_size count);
+    };
+
+    // Lower bound of |b|^2 in ComplexDivision, same as EPS in VectorComplexDivision.cl.
+    const float ComplexDivisionMinDenominator = 1e-10f;
+
+    // Float offset of the real part of complex number id, and from a real part to its imaginary
+    // part, in the planeSpacing convention of the mixed layout kernels.
+    inline amf_size ComplexRealOffset(amf_size id, amf_size planeSpacing)
+    {
+        return planeSpacing ? id : 2 * id;
+    }
+
+    inline amf_size ComplexImagOffset(amf_size planeSpacing)
+    {
+        return planeSpacing ? planeSpacing : 1;
+    }
+
+    // Kernel sets, see MathKernels*.cpp.
+    extern const TANMathKernels TANMathKernelsSSE2;
+    extern const TANMathKernels TANMathKernelsAVX2;
+#ifdef AVX512SUPPORT
+    extern const TANMathKernels TANMathKernelsAVX512;
+#endif
+
+    // The table for the running CPU, see TANGetKernels.
+    const TANMathKernels & GetTANMathKernels();
+}
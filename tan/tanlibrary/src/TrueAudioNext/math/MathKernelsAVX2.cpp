@@ -0,0 +1,585 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AVX2 + FMA kernels, this file is built with -mavx2 -mfma (/arch:AVX2).
+//
+
+#include "MathKernels.h"
+
+#include <immintrin.h>
+
+using namespace amf;
+
+namespace
+{
+    const amf_int32 TailMaskTable[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    // Lanes [0, floats) enabled, for the maskload / maskstore of the last partial register.
+    inline __m256i TailMask(amf_size floats)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(TailMaskTable + 8 - floats));
+    }
+
+    // (ar, ai) * (br, bi) for the four complex numbers of a register.
+    inline __m256 ComplexMul4(__m256 a, __m256 b)
+    {
+        __m256 aRe = _mm256_moveldup_ps(a);
+        __m256 aIm = _mm256_movehdup_ps(a);
+        __m256 bSwap = _mm256_permute_ps(b, _MM_SHUFFLE(2, 3, 0, 1));
+
+        // even lanes ar*br - ai*bi, odd lanes ar*bi + ai*br
+        return _mm256_fmaddsub_ps(aRe, b, _mm256_mul_ps(aIm, bSwap));
+    }
+
+    void ComplexMultiplicationAVX2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * outputBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 4 <= countOfComplexNumbers; id += 4)
+        {
+            __m256 a = _mm256_loadu_ps(inputBuffer1 + 2 * id);
+            __m256 b = _mm256_loadu_ps(inputBuffer2 + 2 * id);
+
+            _mm256_storeu_ps(outputBuffer + 2 * id, ComplexMul4(a, b));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __m256i mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            __m256 a = _mm256_maskload_ps(inputBuffer1 + 2 * id, mask);
+            __m256 b = _mm256_maskload_ps(inputBuffer2 + 2 * id, mask);
+
+            _mm256_maskstore_ps(outputBuffer + 2 * id, mask, ComplexMul4(a, b));
+        }
+    }
+
+    void ComplexMultiplyAccumulateAVX2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * accumBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 4 <= countOfComplexNumbers; id += 4)
+        {
+            __m256 a = _mm256_loadu_ps(inputBuffer1 + 2 * id);
+            __m256 b = _mm256_loadu_ps(inputBuffer2 + 2 * id);
+            __m256 c = _mm256_loadu_ps(accumBuffer + 2 * id);
+
+            _mm256_storeu_ps(accumBuffer + 2 * id, _mm256_add_ps(c, ComplexMul4(a, b)));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __m256i mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            __m256 a = _mm256_maskload_ps(inputBuffer1 + 2 * id, mask);
+            __m256 b = _mm256_maskload_ps(inputBuffer2 + 2 * id, mask);
+            __m256 c = _mm256_maskload_ps(accumBuffer + 2 * id, mask);
+
+            _mm256_maskstore_ps(accumBuffer + 2 * id, mask, _mm256_add_ps(c, ComplexMul4(a, b)));
+        }
+    }
+
+    void PlanarComplexMultiplyAccumulateAVX2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * accumBuffer,
+        amf_size countOfComplexNumbers,
+        amf_size riPlaneSpacing)
+    {
+        const float *ar = inputBuffer1, *ai = inputBuffer1 + riPlaneSpacing;
+        const float *br = inputBuffer2, *bi = inputBuffer2 + riPlaneSpacing;
+        float *cr = accumBuffer, *ci = accumBuffer + riPlaneSpacing;
+
+        amf_size id = 0;
+
+        for (; id + 8 <= countOfComplexNumbers; id += 8)
+        {
+            __m256 arReg = _mm256_loadu_ps(ar + id);
+            __m256 aiReg = _mm256_loadu_ps(ai + id);
+            __m256 brReg = _mm256_loadu_ps(br + id);
+            __m256 biReg = _mm256_loadu_ps(bi + id);
+
+            __m256 re = _mm256_fmsub_ps(arReg, brReg, _mm256_mul_ps(aiReg, biReg));
+            __m256 im = _mm256_fmadd_ps(arReg, biReg, _mm256_mul_ps(aiReg, brReg));
+
+            _mm256_storeu_ps(cr + id, _mm256_add_ps(_mm256_loadu_ps(cr + id), re));
+            _mm256_storeu_ps(ci + id, _mm256_add_ps(_mm256_loadu_ps(ci + id), im));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __m256i mask = TailMask(countOfComplexNumbers - id);
+
+            __m256 arReg = _mm256_maskload_ps(ar + id, mask);
+            __m256 aiReg = _mm256_maskload_ps(ai + id, mask);
+            __m256 brReg = _mm256_maskload_ps(br + id, mask);
+            __m256 biReg = _mm256_maskload_ps(bi + id, mask);
+
+            __m256 re = _mm256_fmsub_ps(arReg, brReg, _mm256_mul_ps(aiReg, biReg));
+            __m256 im = _mm256_fmadd_ps(arReg, biReg, _mm256_mul_ps(aiReg, brReg));
+
+            _mm256_maskstore_ps(cr + id, mask, _mm256_add_ps(_mm256_maskload_ps(cr + id, mask), re));
+            _mm256_maskstore_ps(ci + id, mask, _mm256_add_ps(_mm256_maskload_ps(ci + id, mask), im));
+        }
+    }
+
+    // a / b for the four complex numbers of a register.
+    inline __m256 ComplexDiv4(__m256 a, __m256 b)
+    {
+        __m256 aRe = _mm256_moveldup_ps(a);
+        __m256 aIm = _mm256_movehdup_ps(a);
+        __m256 bSwap = _mm256_permute_ps(b, _MM_SHUFFLE(2, 3, 0, 1));
+
+        // a * conj(b): even lanes ai*bi + ar*br, odd lanes ai*br - ar*bi
+        __m256 num = _mm256_fmsubadd_ps(aIm, bSwap, _mm256_mul_ps(aRe, b));
+
+        // |b|^2 in both lanes of each complex number
+        __m256 d = _mm256_mul_ps(b, b);
+        d = _mm256_add_ps(d, _mm256_permute_ps(d, _MM_SHUFFLE(2, 3, 0, 1)));
+        d = _mm256_max_ps(d, _mm256_set1_ps(ComplexDivisionMinDenominator));
+
+        return _mm256_div_ps(num, d);
+    }
+
+    void ComplexDivisionAVX2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * outputBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 4 <= countOfComplexNumbers; id += 4)
+        {
+            __m256 a = _mm256_loadu_ps(inputBuffer1 + 2 * id);
+            __m256 b = _mm256_loadu_ps(inputBuffer2 + 2 * id);
+
+            _mm256_storeu_ps(outputBuffer + 2 * id, ComplexDiv4(a, b));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __m256i mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            __m256 a = _mm256_maskload_ps(inputBuffer1 + 2 * id, mask);
+            __m256 b = _mm256_maskload_ps(inputBuffer2 + 2 * id, mask);
+
+            _mm256_maskstore_ps(outputBuffer + 2 * id, mask, ComplexDiv4(a, b));
+        }
+    }
+
+    void ComplexSumAVX2(
+        const float * inputBuffer,
+        float * sum,
+        amf_size countOfComplexNumbers)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 8 <= countOfComplexNumbers; id += 8)
+        {
+            acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(inputBuffer + 2 * id));
+            acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(inputBuffer + 2 * id + 8));
+        }
+
+        if (id + 4 <= countOfComplexNumbers)
+        {
+            acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(inputBuffer + 2 * id));
+            id += 4;
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __m256i mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            acc1 = _mm256_add_ps(acc1, _mm256_maskload_ps(inputBuffer + 2 * id, mask));
+        }
+
+        acc0 = _mm256_add_ps(acc0, acc1);
+
+        // four complex numbers -> two -> one
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+
+        sum[0] = _mm_cvtss_f32(half);
+        sum[1] = _mm_cvtss_f32(_mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+
+    inline float HorizontalSum(__m256 v)
+    {
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 1, 1, 1)));
+
+        return _mm_cvtss_f32(half);
+    }
+
+    inline float HorizontalMax(__m256 v)
+    {
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 1, 1, 1)));
+
+        return _mm_cvtss_f32(half);
+    }
+
+    // Eight complex numbers of a buffer as a real and an imaginary register, planeSpacing 0 is interleaved.
+    inline void LoadComplex8(const float * p, amf_size planeSpacing, __m256 & re, __m256 & im)
+    {
+        if (planeSpacing)
+        {
+            re = _mm256_loadu_ps(p);
+            im = _mm256_loadu_ps(p + planeSpacing);
+        }
+        else
+        {
+            __m256 lo = _mm256_loadu_ps(p);
+            __m256 hi = _mm256_loadu_ps(p + 8);
+
+            // the in-lane shuffles give the order 0 1 4 5 2 3 6 7, the permute restores it
+            re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+                _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+            im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+                _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+    }
+
+    // The first count (< 8) complex numbers only, the other lanes are zero.
+    inline void LoadComplex8(const float * p, amf_size planeSpacing, amf_size count, __m256 & re, __m256 & im)
+    {
+        if (planeSpacing)
+        {
+            __m256i mask = TailMask(count);
+
+            re = _mm256_maskload_ps(p, mask);
+            im = _mm256_maskload_ps(p + planeSpacing, mask);
+        }
+        else
+        {
+            __m256 lo = _mm256_maskload_ps(p, TailMask(count >= 4 ? 8 : 2 * count));
+            __m256 hi = count > 4 ? _mm256_maskload_ps(p + 8, TailMask(2 * count - 8)) : _mm256_setzero_ps();
+
+            re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+                _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+            im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+                _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+    }
+
+    inline void StoreComplex8(float * p, amf_size planeSpacing, __m256 re, __m256 im)
+    {
+        if (planeSpacing)
+        {
+            _mm256_storeu_ps(p, re);
+            _mm256_storeu_ps(p + planeSpacing, im);
+        }
+        else
+        {
+            __m256 lo = _mm256_unpacklo_ps(re, im);
+            __m256 hi = _mm256_unpackhi_ps(re, im);
+
+            _mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+    }
+
+    inline void StoreComplex8(float * p, amf_size planeSpacing, amf_size count, __m256 re, __m256 im)
+    {
+        if (planeSpacing)
+        {
+            __m256i mask = TailMask(count);
+
+            _mm256_maskstore_ps(p, mask, re);
+            _mm256_maskstore_ps(p + planeSpacing, mask, im);
+        }
+        else
+        {
+            __m256 lo = _mm256_unpacklo_ps(re, im);
+            __m256 hi = _mm256_unpackhi_ps(re, im);
+
+            _mm256_maskstore_ps(p, TailMask(count >= 4 ? 8 : 2 * count), _mm256_permute2f128_ps(lo, hi, 0x20));
+            if (count > 4)
+            {
+                _mm256_maskstore_ps(p + 8, TailMask(2 * count - 8), _mm256_permute2f128_ps(lo, hi, 0x31));
+            }
+        }
+    }
+
+    void MixedComplexMultiplyAccumulateAVX2(
+        const float * inputBuffer1,
+        amf_size planeSpacing1,
+        const float * inputBuffer2,
+        amf_size planeSpacing2,
+        float * accumBuffer,
+        amf_size accumPlaneSpacing,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 8 <= countOfComplexNumbers; id += 8)
+        {
+            __m256 ar, ai, br, bi, cr, ci;
+
+            LoadComplex8(inputBuffer1 + ComplexRealOffset(id, planeSpacing1), planeSpacing1, ar, ai);
+            LoadComplex8(inputBuffer2 + ComplexRealOffset(id, planeSpacing2), planeSpacing2, br, bi);
+            LoadComplex8(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, cr, ci);
+
+            cr = _mm256_add_ps(cr, _mm256_fmsub_ps(ar, br, _mm256_mul_ps(ai, bi)));
+            ci = _mm256_add_ps(ci, _mm256_fmadd_ps(ar, bi, _mm256_mul_ps(ai, br)));
+
+            StoreComplex8(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, cr, ci);
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            const amf_size count = countOfComplexNumbers - id;
+            __m256 ar, ai, br, bi, cr, ci;
+
+            LoadComplex8(inputBuffer1 + ComplexRealOffset(id, planeSpacing1), planeSpacing1, count, ar, ai);
+            LoadComplex8(inputBuffer2 + ComplexRealOffset(id, planeSpacing2), planeSpacing2, count, br, bi);
+            LoadComplex8(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, count, cr, ci);
+
+            cr = _mm256_add_ps(cr, _mm256_fmsub_ps(ar, br, _mm256_mul_ps(ai, bi)));
+            ci = _mm256_add_ps(ci, _mm256_fmadd_ps(ar, bi, _mm256_mul_ps(ai, br)));
+
+            StoreComplex8(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, count, cr, ci);
+        }
+    }
+
+    void ConvertComplexLayoutAVX2(
+        const float * inputBuffer,
+        amf_size inputPlaneSpacing,
+        float * outputBuffer,
+        amf_size outputPlaneSpacing,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 8 <= countOfComplexNumbers; id += 8)
+        {
+            __m256 re, im;
+
+            LoadComplex8(inputBuffer + ComplexRealOffset(id, inputPlaneSpacing), inputPlaneSpacing, re, im);
+            StoreComplex8(outputBuffer + ComplexRealOffset(id, outputPlaneSpacing), outputPlaneSpacing, re, im);
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            const amf_size count = countOfComplexNumbers - id;
+            __m256 re, im;
+
+            LoadComplex8(inputBuffer + ComplexRealOffset(id, inputPlaneSpacing), inputPlaneSpacing, count, re, im);
+            StoreComplex8(outputBuffer + ComplexRealOffset(id, outputPlaneSpacing), outputPlaneSpacing, count, re, im);
+        }
+    }
+
+    void GainLinearAVX2(
+        const float * inputBuffer,
+        float * outputBuffer,
+        float gain,
+        float gainStep,
+        amf_size count)
+    {
+        const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256 g = _mm256_set1_ps(gain);
+        const __m256 step = _mm256_set1_ps(gainStep);
+
+        amf_size id = 0;
+
+        for (; id + 8 <= count; id += 8)
+        {
+            // from the index every time, no drift over long blocks
+            __m256 gains = _mm256_fmadd_ps(step, _mm256_add_ps(_mm256_set1_ps(float(id)), lanes), g);
+
+            _mm256_storeu_ps(outputBuffer + id, _mm256_mul_ps(gains, _mm256_loadu_ps(inputBuffer + id)));
+        }
+
+        if (id < count)
+        {
+            __m256i mask = TailMask(count - id);
+            __m256 gains = _mm256_fmadd_ps(step, _mm256_add_ps(_mm256_set1_ps(float(id)), lanes), g);
+
+            _mm256_maskstore_ps(outputBuffer + id, mask, _mm256_mul_ps(gains, _mm256_maskload_ps(inputBuffer + id, mask)));
+        }
+    }
+
+    void GainExponentialAVX2(
+        const float * inputBuffer,
+        float * outputBuffer,
+        float gain,
+        float gainRatio,
+        amf_size count)
+    {
+        float lanes[8];
+
+        lanes[0] = gain;
+        for (int lane = 1; lane < 8; lane++)
+        {
+            lanes[lane] = lanes[lane - 1] * gainRatio;
+        }
+
+        const float ratio2 = gainRatio * gainRatio;
+        const float ratio4 = ratio2 * ratio2;
+        const __m256 ratio8 = _mm256_set1_ps(ratio4 * ratio4);
+
+        __m256 gains = _mm256_loadu_ps(lanes);
+
+        amf_size id = 0;
+
+        for (; id + 8 <= count; id += 8)
+        {
+            _mm256_storeu_ps(outputBuffer + id, _mm256_mul_ps(gains, _mm256_loadu_ps(inputBuffer + id)));
+
+            gains = _mm256_mul_ps(gains, ratio8);
+        }
+
+        if (id < count)
+        {
+            __m256i mask = TailMask(count - id);
+
+            _mm256_maskstore_ps(outputBuffer + id, mask, _mm256_mul_ps(gains, _mm256_maskload_ps(inputBuffer + id, mask)));
+        }
+    }
+
+    void AccumulateWithGainAVX2(
+        const float * inputBuffer,
+        float * accumBuffer,
+        float gain,
+        amf_size count)
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+
+        amf_size id = 0;
+
+        for (; id + 8 <= count; id += 8)
+        {
+            __m256 acc = _mm256_loadu_ps(accumBuffer + id);
+
+            _mm256_storeu_ps(accumBuffer + id, _mm256_fmadd_ps(g, _mm256_loadu_ps(inputBuffer + id), acc));
+        }
+
+        if (id < count)
+        {
+            __m256i mask = TailMask(count - id);
+            __m256 acc = _mm256_maskload_ps(accumBuffer + id, mask);
+
+            _mm256_maskstore_ps(accumBuffer + id, mask, _mm256_fmadd_ps(g, _mm256_maskload_ps(inputBuffer + id, mask), acc));
+        }
+    }
+
+    float DotProductAVX2(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        amf_size count)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 16 <= count; id += 16)
+        {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(inputBuffer1 + id), _mm256_loadu_ps(inputBuffer2 + id), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(inputBuffer1 + id + 8), _mm256_loadu_ps(inputBuffer2 + id + 8), acc1);
+        }
+
+        if (id + 8 <= count)
+        {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(inputBuffer1 + id), _mm256_loadu_ps(inputBuffer2 + id), acc0);
+            id += 8;
+        }
+
+        if (id < count)
+        {
+            __m256i mask = TailMask(count - id);
+
+            acc1 = _mm256_fmadd_ps(_mm256_maskload_ps(inputBuffer1 + id, mask), _mm256_maskload_ps(inputBuffer2 + id, mask), acc1);
+        }
+
+        return HorizontalSum(_mm256_add_ps(acc0, acc1));
+    }
+
+    void PeakSumOfSquaresAVX2(
+        const float * inputBuffer,
+        float * peak,
+        float * sumOfSquares,
+        amf_size count)
+    {
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+        __m256 maxAbs = _mm256_setzero_ps();
+        __m256 acc = _mm256_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 8 <= count; id += 8)
+        {
+            __m256 x = _mm256_loadu_ps(inputBuffer + id);
+
+            maxAbs = _mm256_max_ps(maxAbs, _mm256_and_ps(x, absMask));
+            acc = _mm256_fmadd_ps(x, x, acc);
+        }
+
+        if (id < count)
+        {
+            // masked lanes load as zero, neutral for both
+            __m256 x = _mm256_maskload_ps(inputBuffer + id, TailMask(count - id));
+
+            maxAbs = _mm256_max_ps(maxAbs, _mm256_and_ps(x, absMask));
+            acc = _mm256_fmadd_ps(x, x, acc);
+        }
+
+        *peak = HorizontalMax(maxAbs);
+        *sumOfSquares = HorizontalSum(acc);
+    }
+}
+
+namespace amf
+{
+    const TANMathKernels TANMathKernelsAVX2 =
+    {
+        L"AVX2",
+        ComplexMultiplicationAVX2,
+        ComplexMultiplyAccumulateAVX2,
+        PlanarComplexMultiplyAccumulateAVX2,
+        ComplexDivisionAVX2,
+        ComplexSumAVX2,
+        MixedComplexMultiplyAccumulateAVX2,
+        ConvertComplexLayoutAVX2,
+        GainLinearAVX2,
+        GainExponentialAVX2,
+        AccumulateWithGainAVX2,
+        DotProductAVX2,
+        PeakSumOfSquaresAVX2
+    };
+}
@@ -0,0 +1,514 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AVX-512F kernels, this file is built with -mavx512f (/arch:AVX512) and only
+// when the compiler supports it (AVX512SUPPORT).
+//
+
+#include "MathKernels.h"
+
+#include <immintrin.h>
+
+using namespace amf;
+
+namespace
+{
+    // Lanes [0, floats) enabled, for the last partial register.
+    inline __mmask16 TailMask(amf_size floats)
+    {
+        return static_cast<__mmask16>((1u << floats) - 1);
+    }
+
+    // (ar, ai) * (br, bi) for the eight complex numbers of a register.
+    inline __m512 ComplexMul8(__m512 a, __m512 b)
+    {
+        __m512 aRe = _mm512_moveldup_ps(a);
+        __m512 aIm = _mm512_movehdup_ps(a);
+        __m512 bSwap = _mm512_permute_ps(b, _MM_SHUFFLE(2, 3, 0, 1));
+
+        // even lanes ar*br - ai*bi, odd lanes ar*bi + ai*br
+        return _mm512_fmaddsub_ps(aRe, b, _mm512_mul_ps(aIm, bSwap));
+    }
+
+    void ComplexMultiplicationAVX512(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * outputBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 8 <= countOfComplexNumbers; id += 8)
+        {
+            __m512 a = _mm512_loadu_ps(inputBuffer1 + 2 * id);
+            __m512 b = _mm512_loadu_ps(inputBuffer2 + 2 * id);
+
+            _mm512_storeu_ps(outputBuffer + 2 * id, ComplexMul8(a, b));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __mmask16 mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            __m512 a = _mm512_maskz_loadu_ps(mask, inputBuffer1 + 2 * id);
+            __m512 b = _mm512_maskz_loadu_ps(mask, inputBuffer2 + 2 * id);
+
+            _mm512_mask_storeu_ps(outputBuffer + 2 * id, mask, ComplexMul8(a, b));
+        }
+    }
+
+    void ComplexMultiplyAccumulateAVX512(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * accumBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 8 <= countOfComplexNumbers; id += 8)
+        {
+            __m512 a = _mm512_loadu_ps(inputBuffer1 + 2 * id);
+            __m512 b = _mm512_loadu_ps(inputBuffer2 + 2 * id);
+            __m512 c = _mm512_loadu_ps(accumBuffer + 2 * id);
+
+            _mm512_storeu_ps(accumBuffer + 2 * id, _mm512_add_ps(c, ComplexMul8(a, b)));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __mmask16 mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            __m512 a = _mm512_maskz_loadu_ps(mask, inputBuffer1 + 2 * id);
+            __m512 b = _mm512_maskz_loadu_ps(mask, inputBuffer2 + 2 * id);
+            __m512 c = _mm512_maskz_loadu_ps(mask, accumBuffer + 2 * id);
+
+            _mm512_mask_storeu_ps(accumBuffer + 2 * id, mask, _mm512_add_ps(c, ComplexMul8(a, b)));
+        }
+    }
+
+    void PlanarComplexMultiplyAccumulateAVX512(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * accumBuffer,
+        amf_size countOfComplexNumbers,
+        amf_size riPlaneSpacing)
+    {
+        const float *ar = inputBuffer1, *ai = inputBuffer1 + riPlaneSpacing;
+        const float *br = inputBuffer2, *bi = inputBuffer2 + riPlaneSpacing;
+        float *cr = accumBuffer, *ci = accumBuffer + riPlaneSpacing;
+
+        amf_size id = 0;
+
+        for (; id + 16 <= countOfComplexNumbers; id += 16)
+        {
+            __m512 arReg = _mm512_loadu_ps(ar + id);
+            __m512 aiReg = _mm512_loadu_ps(ai + id);
+            __m512 brReg = _mm512_loadu_ps(br + id);
+            __m512 biReg = _mm512_loadu_ps(bi + id);
+
+            __m512 re = _mm512_fmsub_ps(arReg, brReg, _mm512_mul_ps(aiReg, biReg));
+            __m512 im = _mm512_fmadd_ps(arReg, biReg, _mm512_mul_ps(aiReg, brReg));
+
+            _mm512_storeu_ps(cr + id, _mm512_add_ps(_mm512_loadu_ps(cr + id), re));
+            _mm512_storeu_ps(ci + id, _mm512_add_ps(_mm512_loadu_ps(ci + id), im));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __mmask16 mask = TailMask(countOfComplexNumbers - id);
+
+            __m512 arReg = _mm512_maskz_loadu_ps(mask, ar + id);
+            __m512 aiReg = _mm512_maskz_loadu_ps(mask, ai + id);
+            __m512 brReg = _mm512_maskz_loadu_ps(mask, br + id);
+            __m512 biReg = _mm512_maskz_loadu_ps(mask, bi + id);
+
+            __m512 re = _mm512_fmsub_ps(arReg, brReg, _mm512_mul_ps(aiReg, biReg));
+            __m512 im = _mm512_fmadd_ps(arReg, biReg, _mm512_mul_ps(aiReg, brReg));
+
+            _mm512_mask_storeu_ps(cr + id, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, cr + id), re));
+            _mm512_mask_storeu_ps(ci + id, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, ci + id), im));
+        }
+    }
+
+    // a / b for the eight complex numbers of a register.
+    inline __m512 ComplexDiv8(__m512 a, __m512 b)
+    {
+        __m512 aRe = _mm512_moveldup_ps(a);
+        __m512 aIm = _mm512_movehdup_ps(a);
+        __m512 bSwap = _mm512_permute_ps(b, _MM_SHUFFLE(2, 3, 0, 1));
+
+        // a * conj(b): even lanes ai*bi + ar*br, odd lanes ai*br - ar*bi
+        __m512 num = _mm512_fmsubadd_ps(aIm, bSwap, _mm512_mul_ps(aRe, b));
+
+        // |b|^2 in both lanes of each complex number
+        __m512 d = _mm512_mul_ps(b, b);
+        d = _mm512_add_ps(d, _mm512_permute_ps(d, _MM_SHUFFLE(2, 3, 0, 1)));
+        d = _mm512_max_ps(d, _mm512_set1_ps(ComplexDivisionMinDenominator));
+
+        return _mm512_div_ps(num, d);
+    }
+
+    void ComplexDivisionAVX512(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        float * outputBuffer,
+        amf_size countOfComplexNumbers)
+    {
+        amf_size id = 0;
+
+        for (; id + 8 <= countOfComplexNumbers; id += 8)
+        {
+            __m512 a = _mm512_loadu_ps(inputBuffer1 + 2 * id);
+            __m512 b = _mm512_loadu_ps(inputBuffer2 + 2 * id);
+
+            _mm512_storeu_ps(outputBuffer + 2 * id, ComplexDiv8(a, b));
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __mmask16 mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            __m512 a = _mm512_maskz_loadu_ps(mask, inputBuffer1 + 2 * id);
+            __m512 b = _mm512_maskz_loadu_ps(mask, inputBuffer2 + 2 * id);
+
+            _mm512_mask_storeu_ps(outputBuffer + 2 * id, mask, ComplexDiv8(a, b));
+        }
+    }
+
+    void ComplexSumAVX512(
+        const float * inputBuffer,
+        float * sum,
+        amf_size countOfComplexNumbers)
+    {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 16 <= countOfComplexNumbers; id += 16)
+        {
+            acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(inputBuffer + 2 * id));
+            acc1 = _mm512_add_ps(acc1, _mm512_loadu_ps(inputBuffer + 2 * id + 16));
+        }
+
+        if (id + 8 <= countOfComplexNumbers)
+        {
+            acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(inputBuffer + 2 * id));
+            id += 8;
+        }
+
+        if (id < countOfComplexNumbers)
+        {
+            __mmask16 mask = TailMask(2 * (countOfComplexNumbers - id));
+
+            acc1 = _mm512_add_ps(acc1, _mm512_maskz_loadu_ps(mask, inputBuffer + 2 * id));
+        }
+
+        acc0 = _mm512_add_ps(acc0, acc1);
+
+        // eight complex numbers -> four -> two -> one
+        __m256 quarter = _mm256_add_ps(
+            _mm512_castps512_ps256(acc0),
+            _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(acc0), 1)));
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(quarter), _mm256_extractf128_ps(quarter, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+
+        sum[0] = _mm_cvtss_f32(half);
+        sum[1] = _mm_cvtss_f32(_mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+
+    // Index vectors of _mm512_permutex2var_ps between interleaved pairs and planes, 16+ picks the second register.
+    const amf_int32 DeinterleaveRe[16] = { 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30 };
+    const amf_int32 DeinterleaveIm[16] = { 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31 };
+    const amf_int32 InterleaveLo[16] = { 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23 };
+    const amf_int32 InterleaveHi[16] = { 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31 };
+
+    inline __m512i Indices(const amf_int32 * table)
+    {
+        return _mm512_loadu_si512(table);
+    }
+
+    // Sixteen complex numbers of a buffer as a real and an imaginary register, planeSpacing 0 is
+    // interleaved. count < 16 loads only the first count numbers, the other lanes are zero.
+    inline void LoadComplex16(const float * p, amf_size planeSpacing, amf_size count, __m512 & re, __m512 & im)
+    {
+        if (planeSpacing)
+        {
+            __mmask16 mask = TailMask(count);
+
+            re = _mm512_maskz_loadu_ps(mask, p);
+            im = _mm512_maskz_loadu_ps(mask, p + planeSpacing);
+        }
+        else
+        {
+            __m512 lo = _mm512_maskz_loadu_ps(TailMask(count >= 8 ? 16 : 2 * count), p);
+            __m512 hi = count > 8 ? _mm512_maskz_loadu_ps(TailMask(2 * count - 16), p + 16) : _mm512_setzero_ps();
+
+            re = _mm512_permutex2var_ps(lo, Indices(DeinterleaveRe), hi);
+            im = _mm512_permutex2var_ps(lo, Indices(DeinterleaveIm), hi);
+        }
+    }
+
+    inline void StoreComplex16(float * p, amf_size planeSpacing, amf_size count, __m512 re, __m512 im)
+    {
+        if (planeSpacing)
+        {
+            __mmask16 mask = TailMask(count);
+
+            _mm512_mask_storeu_ps(p, mask, re);
+            _mm512_mask_storeu_ps(p + planeSpacing, mask, im);
+        }
+        else
+        {
+            _mm512_mask_storeu_ps(p, TailMask(count >= 8 ? 16 : 2 * count), _mm512_permutex2var_ps(re, Indices(InterleaveLo), im));
+            if (count > 8)
+            {
+                _mm512_mask_storeu_ps(p + 16, TailMask(2 * count - 16), _mm512_permutex2var_ps(re, Indices(InterleaveHi), im));
+            }
+        }
+    }
+
+    void MixedComplexMultiplyAccumulateAVX512(
+        const float * inputBuffer1,
+        amf_size planeSpacing1,
+        const float * inputBuffer2,
+        amf_size planeSpacing2,
+        float * accumBuffer,
+        amf_size accumPlaneSpacing,
+        amf_size countOfComplexNumbers)
+    {
+        // full registers take the same masked path with an all ones mask, as cheap as a plain one on AVX-512
+        for (amf_size id = 0; id < countOfComplexNumbers; id += 16)
+        {
+            const amf_size count = countOfComplexNumbers - id < 16 ? countOfComplexNumbers - id : 16;
+            __m512 ar, ai, br, bi, cr, ci;
+
+            LoadComplex16(inputBuffer1 + ComplexRealOffset(id, planeSpacing1), planeSpacing1, count, ar, ai);
+            LoadComplex16(inputBuffer2 + ComplexRealOffset(id, planeSpacing2), planeSpacing2, count, br, bi);
+            LoadComplex16(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, count, cr, ci);
+
+            cr = _mm512_add_ps(cr, _mm512_fmsub_ps(ar, br, _mm512_mul_ps(ai, bi)));
+            ci = _mm512_add_ps(ci, _mm512_fmadd_ps(ar, bi, _mm512_mul_ps(ai, br)));
+
+            StoreComplex16(accumBuffer + ComplexRealOffset(id, accumPlaneSpacing), accumPlaneSpacing, count, cr, ci);
+        }
+    }
+
+    void ConvertComplexLayoutAVX512(
+        const float * inputBuffer,
+        amf_size inputPlaneSpacing,
+        float * outputBuffer,
+        amf_size outputPlaneSpacing,
+        amf_size countOfComplexNumbers)
+    {
+        for (amf_size id = 0; id < countOfComplexNumbers; id += 16)
+        {
+            const amf_size count = countOfComplexNumbers - id < 16 ? countOfComplexNumbers - id : 16;
+            __m512 re, im;
+
+            LoadComplex16(inputBuffer + ComplexRealOffset(id, inputPlaneSpacing), inputPlaneSpacing, count, re, im);
+            StoreComplex16(outputBuffer + ComplexRealOffset(id, outputPlaneSpacing), outputPlaneSpacing, count, re, im);
+        }
+    }
+
+    void GainLinearAVX512(
+        const float * inputBuffer,
+        float * outputBuffer,
+        float gain,
+        float gainStep,
+        amf_size count)
+    {
+        const __m512 lanes = _mm512_setr_ps(
+            0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+            8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+        const __m512 g = _mm512_set1_ps(gain);
+        const __m512 step = _mm512_set1_ps(gainStep);
+
+        amf_size id = 0;
+
+        for (; id + 16 <= count; id += 16)
+        {
+            // from the index every time, no drift over long blocks
+            __m512 gains = _mm512_fmadd_ps(step, _mm512_add_ps(_mm512_set1_ps(float(id)), lanes), g);
+
+            _mm512_storeu_ps(outputBuffer + id, _mm512_mul_ps(gains, _mm512_loadu_ps(inputBuffer + id)));
+        }
+
+        if (id < count)
+        {
+            __mmask16 mask = TailMask(count - id);
+            __m512 gains = _mm512_fmadd_ps(step, _mm512_add_ps(_mm512_set1_ps(float(id)), lanes), g);
+
+            _mm512_mask_storeu_ps(outputBuffer + id, mask, _mm512_mul_ps(gains, _mm512_maskz_loadu_ps(mask, inputBuffer + id)));
+        }
+    }
+
+    void GainExponentialAVX512(
+        const float * inputBuffer,
+        float * outputBuffer,
+        float gain,
+        float gainRatio,
+        amf_size count)
+    {
+        float lanes[16];
+
+        lanes[0] = gain;
+        for (int lane = 1; lane < 16; lane++)
+        {
+            lanes[lane] = lanes[lane - 1] * gainRatio;
+        }
+
+        const float ratio2 = gainRatio * gainRatio;
+        const float ratio4 = ratio2 * ratio2;
+        const float ratio8 = ratio4 * ratio4;
+        const __m512 ratio16 = _mm512_set1_ps(ratio8 * ratio8);
+
+        __m512 gains = _mm512_loadu_ps(lanes);
+
+        amf_size id = 0;
+
+        for (; id + 16 <= count; id += 16)
+        {
+            _mm512_storeu_ps(outputBuffer + id, _mm512_mul_ps(gains, _mm512_loadu_ps(inputBuffer + id)));
+
+            gains = _mm512_mul_ps(gains, ratio16);
+        }
+
+        if (id < count)
+        {
+            __mmask16 mask = TailMask(count - id);
+
+            _mm512_mask_storeu_ps(outputBuffer + id, mask, _mm512_mul_ps(gains, _mm512_maskz_loadu_ps(mask, inputBuffer + id)));
+        }
+    }
+
+    void AccumulateWithGainAVX512(
+        const float * inputBuffer,
+        float * accumBuffer,
+        float gain,
+        amf_size count)
+    {
+        const __m512 g = _mm512_set1_ps(gain);
+
+        amf_size id = 0;
+
+        for (; id + 16 <= count; id += 16)
+        {
+            __m512 acc = _mm512_loadu_ps(accumBuffer + id);
+
+            _mm512_storeu_ps(accumBuffer + id, _mm512_fmadd_ps(g, _mm512_loadu_ps(inputBuffer + id), acc));
+        }
+
+        if (id < count)
+        {
+            __mmask16 mask = TailMask(count - id);
+            __m512 acc = _mm512_maskz_loadu_ps(mask, accumBuffer + id);
+
+            _mm512_mask_storeu_ps(accumBuffer + id, mask, _mm512_fmadd_ps(g, _mm512_maskz_loadu_ps(mask, inputBuffer + id), acc));
+        }
+    }
+
+    float DotProductAVX512(
+        const float * inputBuffer1,
+        const float * inputBuffer2,
+        amf_size count)
+    {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 32 <= count; id += 32)
+        {
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(inputBuffer1 + id), _mm512_loadu_ps(inputBuffer2 + id), acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(inputBuffer1 + id + 16), _mm512_loadu_ps(inputBuffer2 + id + 16), acc1);
+        }
+
+        if (id + 16 <= count)
+        {
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(inputBuffer1 + id), _mm512_loadu_ps(inputBuffer2 + id), acc0);
+            id += 16;
+        }
+
+        if (id < count)
+        {
+            __mmask16 mask = TailMask(count - id);
+
+            acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, inputBuffer1 + id), _mm512_maskz_loadu_ps(mask, inputBuffer2 + id), acc1);
+        }
+
+        return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+    }
+
+    void PeakSumOfSquaresAVX512(
+        const float * inputBuffer,
+        float * peak,
+        float * sumOfSquares,
+        amf_size count)
+    {
+        __m512 maxAbs = _mm512_setzero_ps();
+        __m512 acc = _mm512_setzero_ps();
+
+        amf_size id = 0;
+
+        for (; id + 16 <= count; id += 16)
+        {
+            __m512 x = _mm512_loadu_ps(inputBuffer + id);
+
+            maxAbs = _mm512_max_ps(maxAbs, _mm512_abs_ps(x));
+            acc = _mm512_fmadd_ps(x, x, acc);
+        }
+
+        if (id < count)
+        {
+            // masked lanes load as zero, neutral for both
+            __m512 x = _mm512_maskz_loadu_ps(TailMask(count - id), inputBuffer + id);
+
+            maxAbs = _mm512_max_ps(maxAbs, _mm512_abs_ps(x));
+            acc = _mm512_fmadd_ps(x, x, acc);
+        }
+
+        *peak = _mm512_reduce_max_ps(maxAbs);
+        *sumOfSquares = _mm512_reduce_add_ps(acc);
+    }
+}
+
+namespace amf
+{
+    const TANMathKernels TANMathKernelsAVX512 =
+    {
+        L"AVX512",
+        ComplexMultiplicationAVX512,
+        ComplexMultiplyAccumulateAVX512,
+        PlanarComplexMultiplyAccumulateAVX512,
+        ComplexDivisionAVX512,
+        ComplexSumAVX512,
+        MixedComplexMultiplyAccumulateAVX512,
+        ConvertComplexLayoutAVX512,
+        GainLinearAVX512,
+        GainExponentialAVX512,
+        AccumulateWithGainAVX512,
+        DotProductAVX512,
+        PeakSumOfSquaresAVX512
+    };
+}
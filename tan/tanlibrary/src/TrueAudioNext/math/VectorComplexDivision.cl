@@ -63,7 +63,7 @@ void VectorComplexDiv(
     float4 inB = pInputB[x];
 
     float2 d = inB.xz * inB.xz + inB.yw * inB.yw;
-    d = (d == 0.0f) ? EPS : d;
+    d = fmax(d, EPS);
 
     pResult[x].xz = (inA.xz * inB.xz + inA.yw * inB.yw)/d;
     pResult[x].yw = (-inA.xz * inB.yw + inA.yw * inB.xz)/d;
@@ -0,0 +1,120 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#define Lx        64
+
+// Every row of the grid is a channel: pOut[i] = gain(i) * pIn[i], plus the previous pOut[i]
+// when accumulate is set. gain(i) = gain + gainStep * i, or gain * gainStep^i when exponential
+// is set. Channel c reads its input and output offsets from pOffsets[2 * c], its gain and
+// gainStep from pGains[2 * c], c counts from firstChannel.
+__kernel
+__attribute__((reqd_work_group_size(Lx, 1, 1)))
+void VectorGain(
+    __global const float* pIn,      ///< [in ] 0
+    __global float* pOut,           ///< [out] 1
+    __global const ulong* pOffsets, ///< [in ] 2
+    __global const float* pGains,   ///< [in ] 3
+    int firstChannel,               ///< [in ] 4
+    int exponential,                ///< [in ] 5
+    int accumulate,                 ///< [in ] 6
+    int count                       ///< [in ] 7
+)
+{
+    int x = get_global_id(0);
+    int channel = firstChannel + get_global_id(1);
+    if (x >= count)
+        return;
+
+    pIn += pOffsets[2 * channel];
+    pOut += pOffsets[2 * channel + 1];
+
+    float gain = pGains[2 * channel];
+    float gainStep = pGains[2 * channel + 1];
+    float g = exponential ? gain * pow(gainStep, (float)x) : gain + gainStep * (float)x;
+    float value = g * pIn[x];
+
+    if (accumulate)
+        value += pOut[x];
+
+    pOut[x] = value;
+}
+
+// Every row of the grid is a channel, its offsets in pA and pB are pOffsets[2 * c] and
+// pOffsets[2 * c + 1], c counts from firstChannel. Partial sum(pA[i] * pB[i]) and max |pA[i]|
+// of every work group are written to pPartials[2 * (c * groups + group)] and the float after
+// it; the host adds up the groups.
+__kernel
+__attribute__((reqd_work_group_size(Lx, 1, 1)))
+void VectorDotPeak(
+    __global const float* pA,       ///< [in ] 0
+    __global const float* pB,       ///< [in ] 1
+    __global const ulong* pOffsets, ///< [in ] 2
+    __global float* pPartials,      ///< [out] 3
+    int firstChannel,               ///< [in ] 4
+    int count                       ///< [in ] 5
+)
+{
+    __local float sums[Lx];
+    __local float peaks[Lx];
+
+    int localID = get_local_id(0);
+    int channel = firstChannel + get_global_id(1);
+
+    pA += pOffsets[2 * channel];
+    pB += pOffsets[2 * channel + 1];
+
+    // the grid is capped, each work item strides over the whole vector
+    float sum = 0.0f;
+    float peak = 0.0f;
+
+    for (int i = get_global_id(0); i < count; i += get_global_size(0))
+    {
+        float a = pA[i];
+
+        sum += a * pB[i];
+        peak = fmax(peak, fabs(a));
+    }
+
+    sums[localID] = sum;
+    peaks[localID] = peak;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int offset = Lx >> 1; offset > 0; offset >>= 1)
+    {
+        if (localID < offset)
+        {
+            sums[localID] += sums[localID + offset];
+            peaks[localID] = fmax(peaks[localID], peaks[localID + offset]);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (localID == 0)
+    {
+        int partial = channel * get_num_groups(0) + get_group_id(0);
+
+        pPartials[2 * partial] = sums[0];
+        pPartials[2 * partial + 1] = peaks[0];
+    }
+}
@@ -39,4 +39,38 @@ __kernel void Mixer(
     }
 
     outputBuffer[sampId] = sum;
-}
\ No newline at end of file
+}
+// Matrix mixing, one work item per sample of one output.
+// gains holds numOfGains start gains followed by as many end gains, the gains of this output's
+// routes from gainOffset on. The gain ramps linearly from start to end over blockLength samples,
+// routes that are 0 at both ends are skipped.
+__kernel void MatrixMixer(
+    __global	const float*	inputBuffer,	///< [in]
+    int inputStride,
+    int numOfInputs,
+    __global	const float*	gains,	///< [in]
+    int numOfGains,
+    int gainOffset,
+    int blockLength,
+    __global	float*	outputBuffer	///< [out]
+    )
+{
+    int sampId = get_global_id(0);
+    float t = (float)sampId / (float)blockLength;
+
+    float sum = 0;
+    for (int i = 0; i < numOfInputs; i++)
+    {
+        float g0 = gains[gainOffset + i];
+        float g1 = gains[numOfGains + gainOffset + i];
+
+        if (g0 == 0.0f && g1 == 0.0f)
+        {
+            continue;
+        }
+
+        sum += (g0 + (g1 - g0) * t) * inputBuffer[i*inputStride + sampId];
+    }
+
+    outputBuffer[sampId] = sum;
+}
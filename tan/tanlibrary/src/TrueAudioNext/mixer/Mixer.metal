@@ -46,4 +46,41 @@ kernel void Mixer(
     }
 
     outputBuffer[sampId] = sum;
-}
\ No newline at end of file
+}
+// Matrix mixing, one thread per sample of one output, see Mixer.cl.
+kernel void MatrixMixer(
+    device const float*	inputBuffer,	///< [in]
+    constant int &      inputStride,
+    constant int &      numOfInputs,
+    device const float*	gains,	///< [in]
+    constant int &      numOfGains,
+    constant int &      gainOffset,
+    constant int &      blockLength,
+    device	float*	    outputBuffer,	///< [out]
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+    )
+{
+    int sampId = global_id.x;
+    float t = (float)sampId / (float)blockLength;
+
+    float sum = 0;
+    for (int i = 0; i < numOfInputs; i++)
+    {
+        float g0 = gains[gainOffset + i];
+        float g1 = gains[numOfGains + gainOffset + i];
+
+        if (g0 == 0.0f && g1 == 0.0f)
+        {
+            continue;
+        }
+
+        sum += (g0 + (g1 - g0) * t) * inputBuffer[i*inputStride + sampId];
+    }
+
+    outputBuffer[sampId] = sum;
+}
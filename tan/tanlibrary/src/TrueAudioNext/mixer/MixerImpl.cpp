@@ -23,6 +23,7 @@
 //
 
 #include "MixerImpl.h"
+#include "MixerKernels.h"
 #include "../core/TANContextImpl.h"
 #include "public/common/AMFFactoryHelper.h"
 #include "OCLHelper.h"
@@ -30,6 +31,7 @@
 #include "cpucaps.h"
 
 #include <math.h>
+#include <algorithm>
 
 #ifdef ENABLE_METAL
   #include "MetalKernel_Mixer.h"
@@ -39,13 +41,51 @@
 
 #define AMF_FACILITY L"TANMixerImpl"
 
-#ifndef _WIN32
-#include <immintrin.h>
-#endif
-
 using namespace amf;
 
-bool TANMixerImpl::useSSE2 = true; // InstructionSet::SSE2();
+// Host mixes run in tiles of one output and at most this many samples, short enough for the
+// tile to stay in L1 while its routes are added and for many outputs to spread over all threads.
+static const amf_size MixTileSize = 2048;
+
+// Fewer route samples than this are mixed on the calling thread, the dispatch to the workers
+// would cost more than it saves.
+static const amf_size MixParallelWork = 1 << 18;
+
+// Mixes output o from its routeCounts[o] routes, routeStride entries apart, tile by tile.
+static void MixTiles(
+    TANThreadPool * pool,
+    const TANMixerKernels & kernels,
+    const float * const * routeInputs,
+    const float * routeGains,
+    const float * routeGainSteps,
+    amf_size routeStride,
+    const amf_size * routeCounts,
+    float * const * outputs,
+    int numOutputs,
+    amf_size count,
+    bool accumulate)
+{
+    const amf_size tilesPerOutput = (count + MixTileSize - 1) / MixTileSize;
+    const amf_size tiles = numOutputs * tilesPerOutput;
+
+    amf_size work = 0;
+    for (int o = 0; o < numOutputs; o++)
+    {
+        work += routeCounts[o] * count;
+    }
+
+    const amf_uint32 threads = work >= MixParallelWork ? TANThreadBudget(pool, TAN_THREAD_BUDGET_MIXER) : 1;
+
+    TANParallelFor(pool, threads, tiles, [&](amf_size tile)
+    {
+        const amf_size o = tile / tilesPerOutput;
+        const amf_size first = (tile % tilesPerOutput) * MixTileSize;
+        const amf_size routes = o * routeStride;
+
+        kernels.MixRoutes(routeInputs + routes, routeGains + routes, routeGainSteps + routes,
+            routeCounts[o], outputs[o], first, std::min(MixTileSize, count - first), accumulate);
+    });
+}
 
 //-------------------------------------------------------------------------------------------------
 TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateMixer(
@@ -61,7 +101,8 @@ TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateMixer(
 //-------------------------------------------------------------------------------------------------
 TANMixerImpl::TANMixerImpl(TANContext *pContextTAN, AMFContext* pContextAMF) :
     m_pContextTAN(pContextTAN),
-    m_pContextAMF(pContextAMF)
+    m_pContextAMF(pContextAMF),
+    m_pThreadPool(&TANContextImplPtr(pContextTAN)->GetThreadPool())
 {
 #ifndef TAN_NO_OPENCL
     printf("TODO: implement this?\n");
@@ -88,11 +129,43 @@ AMF_RESULT  AMF_STD_CALL TANMixerImpl::Init(
     int num_channels
 	)
 {
+    AMF_RETURN_IF_FAILED(Init(buffer_size, num_channels, 1));
+
     AMFLock lock(&m_sect);
+    std::fill(m_gains.begin(), m_gains.end(), 1.0f);
+    m_targetGains = m_gains;
+    m_deviceGainsStale = true;
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANMixerImpl::Init(
+    amf_size buffer_size,
+    int num_inputs,
+    int num_outputs
+    )
+{
+    AMFLock lock(&m_sect);
+    AMF_RETURN_IF_FALSE(buffer_size > 0 && num_inputs > 0 && num_outputs > 0, AMF_INVALID_ARG,
+        L"Empty mixer");
+
     m_bufferSize = buffer_size;
-    m_numChannels = num_channels;
+    m_numChannels = num_inputs;
+    m_numOutputs = num_outputs;
     AMF_RETURN_IF_FALSE(!mAMFCompute, AMF_ALREADY_INITIALIZED, L"Already initialized");
 
+    m_gains.assign(amf_size(num_inputs) * num_outputs, 0.0f);
+    m_targetGains = m_gains;
+    m_gainRamp = false;
+    m_deviceGainsStale = true;
+
+    m_routeInputs.assign(m_gains.size(), nullptr);
+    m_routeGains.assign(m_gains.size(), 0.0f);
+    m_routeGainSteps.assign(m_gains.size(), 0.0f);
+    m_routeCounts.assign(num_outputs, 0);
+    m_unitGains.assign(num_inputs, 1.0f);
+    m_noGainSteps.assign(num_inputs, 0.0f);
+
 #ifndef TAN_NO_OPENCL
     AMF_RETURN_IF_FALSE(!m_pCommandQueueCl, AMF_ALREADY_INITIALIZED, L"Already initialized");
 #else
@@ -119,7 +192,10 @@ AMF_RESULT  AMF_STD_CALL TANMixerImpl::Init(
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL TANMixerImpl::InitCpu()
 {
-    // No device setup needs to occur here; we're done!
+    // No device setup needs to occur here, only the workers of the context to start
+    AMF_RETURN_IF_FAILED(m_pThreadPool->Start());
+
+    mInitialized = true;
     return AMF_OK;
 }
 
@@ -161,6 +237,12 @@ AMF_RESULT  AMF_STD_CALL TANMixerImpl::InitGpu()
     bool OCLKenel_Err = false;
     OCLKenel_Err = GetOclKernel(m_clMix, mAMFCompute, contextImpl->GetOpenCLConvQueue(), "Mixer", Mixer, MixerCount, "Mixer", "");
     if (!OCLKenel_Err){ printf("Failed to compile Mixer Kernel"); return AMF_FAIL; }
+
+    // start and end gains of the matrix
+    m_clGains = clCreateBuffer(m_pContextTAN->GetOpenCLContext(), CL_MEM_READ_ONLY, 2 * m_gains.size() * sizeof(float), nullptr, &ret);
+    AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create CL buffer");
+    OCLKenel_Err = GetOclKernel(m_clMatrixMix, mAMFCompute, contextImpl->GetOpenCLConvQueue(), "Mixer", Mixer, MixerCount, "MatrixMixer", "");
+    if (!OCLKenel_Err){ printf("Failed to compile MatrixMixer Kernel"); return AMF_FAIL; }
 	mInitialized = true;
     return res;
 
@@ -195,6 +277,30 @@ AMF_RESULT  AMF_STD_CALL TANMixerImpl::InitGpu()
             ),
         AMF_FAIL
         );
+
+    // start and end gains of the matrix
+    AMF_RETURN_IF_FAILED(
+        m_pContextAMF->AllocBuffer(
+            mAMFCompute->GetMemoryType(),
+            2 * m_gains.size() * sizeof(float),
+            &mGainsBufferAMF
+            )
+        );
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mMatrixMixKernel,
+            mAMFCompute,
+
+            "Mixer",
+            (const char *)Mixer,
+            MixerCount,
+            "MatrixMixer",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
     mInitialized = true;
 
     return AMF_OK;
@@ -214,6 +320,16 @@ AMF_RESULT  AMF_STD_CALL TANMixerImpl::Terminate()
 
         m_clMix = nullptr;
 
+        if (m_clMatrixMix)
+        {
+            AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clMatrixMix), L"Failed to release cl kernel");
+            m_clMatrixMix = nullptr;
+        }
+        if (m_clGains)
+        {
+            AMF_RETURN_IF_CL_FAILED(clReleaseMemObject(m_clGains), L"Failed to release cl buffer");
+            m_clGains = nullptr;
+        }
     }
     m_pDeviceCl = NULL;
     if (m_pCommandQueueCl)
@@ -223,6 +339,8 @@ AMF_RESULT  AMF_STD_CALL TANMixerImpl::Terminate()
     m_pCommandQueueCl = NULL;
     m_pContextAMF = NULL;
     m_pContextTAN = NULL;
+    m_pThreadPool = nullptr;
+    mInitialized = false;
 
 #else
 
@@ -230,11 +348,15 @@ AMF_RESULT  AMF_STD_CALL TANMixerImpl::Terminate()
 
     mAMFCompute = nullptr;
     mMixKernel = nullptr;
+    mMatrixMixKernel = nullptr;
 
     mInternalBufferAMF = nullptr;
+    mGainsBufferAMF = nullptr;
 
     m_pContextAMF = nullptr;
     m_pContextTAN = nullptr;
+    m_pThreadPool = nullptr;
+    mInitialized = false;
 
 #endif
 
@@ -246,28 +368,104 @@ AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
     float* ppBufferOutput
     )
 {
-	amf_size numOfSamplesToProcess = m_bufferSize;
-	int numChannels = m_numChannels;
-    for (int idx = 0; idx <numChannels; idx++)
+    return Mix(ppBufferInput, ppBufferOutput, m_bufferSize, false);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
+    float* ppBufferInput[],
+    float* ppBufferOutput,
+    amf_size count,
+    bool accumulate
+    )
+{
+    if (!mInitialized) return AMF_FAIL;
+    AMF_RETURN_IF_FALSE(ppBufferInput != NULL && ppBufferOutput != NULL, AMF_INVALID_POINTER);
+
+    const amf_size routes = m_numChannels;
+
+    MixTiles(m_pThreadPool, GetTANMixerKernels(), ppBufferInput, m_unitGains.data(), m_noGainSteps.data(),
+        0, &routes, &ppBufferOutput, 1, count, accumulate);
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANMixerImpl::SetGains(const float * gains)
+{
+    AMFLock lock(&m_sect);
+    AMF_RETURN_IF_FALSE(gains != NULL, AMF_INVALID_POINTER, L"gains == NULL");
+    AMF_RETURN_IF_FALSE(mInitialized, AMF_NOT_INITIALIZED, L"Not initialized");
+
+    m_targetGains.assign(gains, gains + m_targetGains.size());
+    m_gainRamp = m_targetGains != m_gains;
+    m_deviceGainsStale = true;
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void TANMixerImpl::EndGainRamp()
+{
+    if (m_gainRamp)
     {
-        int k = 0;
-        int n = numOfSamplesToProcess;
-        while (n >= 8 && useSSE2)
-        {
-            register __m256 *out((__m256 *)&ppBufferOutput[k]);
-            register __m256 *in((__m256 *)&ppBufferInput[idx][k]);
+        m_gains = m_targetGains;
+        m_gainRamp = false;
+        m_deviceGainsStale = true;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
+    float* ppBufferInput[],
+    float* ppBufferOutput[]
+    )
+{
+    return Mix(ppBufferInput, ppBufferOutput, m_bufferSize, false);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
+    float* ppBufferInput[],
+    float* ppBufferOutput[],
+    amf_size count,
+    bool accumulate
+    )
+{
+    AMFLock lock(&m_sect);
+    if (!mInitialized) return AMF_FAIL;
+    AMF_RETURN_IF_FALSE(ppBufferInput != NULL && ppBufferOutput != NULL, AMF_INVALID_POINTER);
 
-            *out = (idx == 0) ? *in : _mm256_add_ps(*out, *in);
+    if (!count)
+    {
+        return AMF_OK;
+    }
 
-            k += 8;
-            n -= 8;
-        }
-        while (n > 0) {
-            ppBufferOutput[k] = (idx == 0) ? ppBufferInput[idx][k] : (ppBufferOutput[k] + ppBufferInput[idx][k]);
-            k++;
-            n--;
+    const float rampScale = 1.0f / float(count);
+
+    for (int out = 0; out < m_numOutputs; out++)
+    {
+        const amf_size first = amf_size(out) * m_numChannels;
+        const float * gains = &m_gains[first];
+        const float * targetGains = &m_targetGains[first];
+        amf_size routes = first;
+
+        for (int in = 0; in < m_numChannels; in++)
+        {
+            if (gains[in] == 0.0f && targetGains[in] == 0.0f)
+            {
+                continue;
+            }
+
+            m_routeInputs[routes] = ppBufferInput[in];
+            m_routeGains[routes] = gains[in];
+            m_routeGainSteps[routes] = (targetGains[in] - gains[in]) * rampScale;
+            routes++;
         }
+
+        m_routeCounts[out] = routes - first;
     }
+
+    MixTiles(m_pThreadPool, GetTANMixerKernels(), m_routeInputs.data(), m_routeGains.data(), m_routeGainSteps.data(),
+        m_numChannels, m_routeCounts.data(), ppBufferOutput, m_numOutputs, count, accumulate);
+
+    EndGainRamp();
+
     return AMF_OK;
 }
 
@@ -346,6 +544,88 @@ AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
 	return ret;
 }
 
+// Matrix mix of disjoint cl_mem buffers
+AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
+    cl_mem pBufferInput[],
+    cl_mem pBufferOutput[]
+    )
+{
+    AMFLock lock(&m_sect);
+    if (!mInitialized) return AMF_FAIL;
+    AMF_RETURN_IF_FALSE(pBufferInput != NULL && pBufferOutput != NULL, AMF_INVALID_POINTER);
+
+    cl_command_queue queue = m_pContextTAN->GetOpenCLConvQueue();
+    amf_size numOfGains = m_gains.size();
+
+    // Copy the inputs with a nonzero route into the internal contiguous buffer
+    for (int i = 0; i < m_numChannels; i++)
+    {
+        bool routed = false;
+        for (int out = 0; out < m_numOutputs && !routed; out++)
+        {
+            amf_size g = amf_size(out) * m_numChannels + i;
+            routed = m_gains[g] != 0.0f || m_targetGains[g] != 0.0f;
+        }
+        if (!routed)
+        {
+            continue;
+        }
+
+        int status = clEnqueueCopyBuffer(queue, pBufferInput[i], m_internalBuff,
+            0, i * m_bufferSize * sizeof(float), m_bufferSize * sizeof(float), 0, NULL, NULL);
+        AMF_RETURN_IF_CL_FAILED(status, L"Failed to enqueue OCL copy");
+    }
+
+    if (m_deviceGainsStale)
+    {
+        int status = clEnqueueWriteBuffer(queue, m_clGains, CL_TRUE,
+            0, numOfGains * sizeof(float), m_gains.data(), 0, NULL, NULL);
+        AMF_RETURN_IF_CL_FAILED(status, L"Failed to write mixer gains");
+        status = clEnqueueWriteBuffer(queue, m_clGains, CL_TRUE,
+            numOfGains * sizeof(float), numOfGains * sizeof(float), m_targetGains.data(), 0, NULL, NULL);
+        AMF_RETURN_IF_CL_FAILED(status, L"Failed to write mixer gains");
+        m_deviceGainsStale = false;
+    }
+
+    int input_stride = int(m_bufferSize);
+    int num_inputs = m_numChannels;
+    int num_gains = int(numOfGains);
+    int block_length = int(m_bufferSize);
+
+    int argIndex = 0;
+    cl_int clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(cl_mem), &m_internalBuff);
+    if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+    clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(int), &input_stride);
+    if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+    clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(int), &num_inputs);
+    if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+    clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(cl_mem), &m_clGains);
+    if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+    clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(int), &num_gains);
+    if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+
+    for (int out = 0; out < m_numOutputs; out++)
+    {
+        int gain_offset = out * m_numChannels;
+
+        argIndex = 5;
+        clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(int), &gain_offset);
+        if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+        clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(int), &block_length);
+        if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+        clErr = clSetKernelArg(m_clMatrixMix, argIndex++, sizeof(cl_mem), &pBufferOutput[out]);
+        if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument\n"); return AMF_FAIL; }
+
+        amf_size global[3] = { m_bufferSize, 0, 0 };
+        int status = clEnqueueNDRangeKernel(queue, m_clMatrixMix, 1, NULL, global, NULL, 0, NULL, NULL);
+        AMF_RETURN_IF_CL_FAILED(status, L"Failed to enqueue OCL kernel");
+    }
+
+    EndGainRamp();
+
+    return AMF_OK;
+}
+
 #else
 
 AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
@@ -424,4 +704,89 @@ AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
     return ret;
 }
 
+// Matrix mix of disjoint buffers
+AMF_RESULT  AMF_STD_CALL    TANMixerImpl::Mix(
+    AMFBuffer * pBufferInput[],
+    AMFBuffer * pBufferOutput[]
+    )
+{
+    AMFLock lock(&m_sect);
+    if (!mInitialized) return AMF_FAIL;
+    AMF_RETURN_IF_FALSE(pBufferInput != NULL && pBufferOutput != NULL, AMF_INVALID_POINTER);
+
+    amf_size numOfGains = m_gains.size();
+
+    // Copy the inputs with a nonzero route into the internal contiguous buffer
+    for (int i = 0; i < m_numChannels; i++)
+    {
+        bool routed = false;
+        for (int out = 0; out < m_numOutputs && !routed; out++)
+        {
+            amf_size g = amf_size(out) * m_numChannels + i;
+            routed = m_gains[g] != 0.0f || m_targetGains[g] != 0.0f;
+        }
+        if (!routed)
+        {
+            continue;
+        }
+
+        AMF_RETURN_IF_FAILED(
+            mAMFCompute->CopyBuffer(
+                pBufferInput[i],
+                0,
+                m_bufferSize * sizeof(float),
+                mInternalBufferAMF,
+                i * m_bufferSize * sizeof(float)
+                )
+            );
+    }
+
+    if (m_deviceGainsStale)
+    {
+        AMF_RETURN_IF_FAILED(
+            mAMFCompute->CopyBufferFromHost(
+                m_gains.data(),
+                numOfGains * sizeof(float),
+                mGainsBufferAMF,
+                0,
+                true
+                )
+            );
+        AMF_RETURN_IF_FAILED(
+            mAMFCompute->CopyBufferFromHost(
+                m_targetGains.data(),
+                numOfGains * sizeof(float),
+                mGainsBufferAMF,
+                numOfGains * sizeof(float),
+                true
+                )
+            );
+        m_deviceGainsStale = false;
+    }
+
+    for (int out = 0; out < m_numOutputs; out++)
+    {
+        int argIndex = 0;
+
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgBuffer(argIndex++, mInternalBufferAMF, AMF_ARGUMENT_ACCESS_READWRITE));
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgInt32(argIndex++, amf_int32(m_bufferSize)));
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgInt32(argIndex++, m_numChannels));
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgBuffer(argIndex++, mGainsBufferAMF, AMF_ARGUMENT_ACCESS_READWRITE));
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgInt32(argIndex++, amf_int32(numOfGains)));
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgInt32(argIndex++, out * m_numChannels));
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgInt32(argIndex++, amf_int32(m_bufferSize)));
+        AMF_RETURN_IF_FAILED(mMatrixMixKernel->SetArgBuffer(argIndex++, pBufferOutput[out], AMF_ARGUMENT_ACCESS_READWRITE));
+
+        amf_size global[3] = { m_bufferSize, 0, 0 };
+
+        AMF_RETURN_IF_FAILED(
+            mMatrixMixKernel->Enqueue(1, nullptr, global, nullptr)
+            );
+    }
+
+    EndGainRamp();
+
+    return AMF_OK;
+}
+
 #endif
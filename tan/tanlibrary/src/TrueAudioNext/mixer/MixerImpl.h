@@ -27,6 +27,9 @@
 #include "public/include/core/Context.h"        //AMF
 #include "public/include/components/Component.h"//AMF
 #include "public/common/PropertyStorageExImpl.h"//AMF
+#include "../core/ThreadPool.h"
+
+#include <vector>
 
 namespace amf
 {
@@ -79,11 +82,45 @@ namespace amf
                                         ) override;
 #endif
 
+        AMF_RESULT  AMF_STD_CALL Init(
+            amf_size buffer_size,
+            int num_inputs,
+            int num_outputs
+            ) override;
+        AMF_RESULT  AMF_STD_CALL    SetGains(const float * gains) override;
+
+        AMF_RESULT  AMF_STD_CALL    Mix(float* ppBufferInput[],
+                                        float* ppBufferOutput[]
+                                        ) override;
+#ifndef TAN_NO_OPENCL
+        AMF_RESULT  AMF_STD_CALL    Mix(cl_mem pBufferInput[],
+                                        cl_mem pBufferOutput[]
+                                        ) override;
+#else
+        AMF_RESULT  AMF_STD_CALL    Mix(AMFBuffer * pBufferInput[],
+                                        AMFBuffer * pBufferOutput[]
+                                        ) override;
+#endif
+
+        AMF_RESULT  AMF_STD_CALL    Mix(float* ppBufferInput[],
+                                        float* ppBufferOutput,
+                                        amf_size count,
+                                        bool accumulate
+                                        ) override;
+        AMF_RESULT  AMF_STD_CALL    Mix(float* ppBufferInput[],
+                                        float* ppBufferOutput[],
+                                        amf_size count,
+                                        bool accumulate
+                                        ) override;
+
     protected:
         TANContextPtr               m_pContextTAN;
         AMFContextPtr               m_pContextAMF;
         AMFComputePtr               mAMFCompute;
 
+        // host mixes run on the workers of the context
+        TANThreadPool *             m_pThreadPool = nullptr;
+
         AMF_MEMORY_TYPE             m_eOutputMemoryType = AMF_MEMORY_HOST;
         AMFCriticalSection          m_sect;
 
@@ -93,25 +130,52 @@ namespace amf
         cl_device_id				m_pDeviceCl = nullptr;
 
         cl_kernel					m_clMix = nullptr;
+        cl_kernel					m_clMatrixMix = nullptr;
 #else
         AMFComputeKernelPtr         mMixKernel;
+        AMFComputeKernelPtr         mMatrixMixKernel;
 #endif
 
         /// It defines how many channels can be mixed together by a single call into the MixerMultiBuffer kernel
         const static int            MAX_CHANNELS_TO_MIX_PER_KERNEL_CALL = 16;
     private:
-        static bool useSSE2;
         AMF_RESULT	AMF_STD_CALL InitCpu();
         AMF_RESULT	AMF_STD_CALL InitGpu();
+
+        // Finishes the gain ramp of a matrix Mix.
+        void        EndGainRamp();
+
 		amf_size m_bufferSize = 0;
 
 #ifndef TAN_NO_OPENCL
 		cl_mem m_internalBuff = nullptr;
+        cl_mem m_clGains = nullptr;
 #else
         AMFBufferPtr mInternalBufferAMF;
+        AMFBufferPtr mGainsBufferAMF;
 #endif
 
 		int m_numChannels = 0;
+        int m_numOutputs = 0;
+
+        // Current and target gains of the matrix, output major, the target is reached at the
+        // end of the next matrix Mix.
+        std::vector<float>          m_gains;
+        std::vector<float>          m_targetGains;
+        bool                        m_gainRamp = false;
+
+        // Both gain sets as last copied to the device, stale once either changes.
+        bool                        m_deviceGainsStale = true;
+
+        // Nonzero routes of every output, num_inputs entries per output, rebuilt by every host
+        // matrix Mix.
+        std::vector<const float *>  m_routeInputs;
+        std::vector<float>          m_routeGains;
+        std::vector<float>          m_routeGainSteps;
+        std::vector<amf_size>       m_routeCounts;
+        // All 1 and all 0, the routes of the summing Mix.
+        std::vector<float>          m_unitGains;
+        std::vector<float>          m_noGainSteps;
 
         bool mInitialized = false;
     };
@@ -0,0 +1,178 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// SSE2 kernels and GetTANMixerKernels(), built for plain x86-64, see core/KernelDispatch.h.
+//
+
+#include "MixerKernels.h"
+
+#include "../core/KernelDispatch.h"
+
+#include <emmintrin.h>
+#include <string.h>
+
+#define AMF_FACILITY L"TANMixerKernels"
+
+using namespace amf;
+
+namespace
+{
+    // Samples first <= n < end one at a time, for the unaligned head and the tail.
+    template<int K, bool Ramp>
+    inline void MixScalar(
+        const float * const * inputs,
+        const float * gains,
+        const float * gainSteps,
+        float * output,
+        amf_size first,
+        amf_size end,
+        bool accumulate)
+    {
+        for (amf_size n = first; n < end; n++)
+        {
+            float sum = accumulate ? output[n] : 0.0f;
+
+            for (int k = 0; k < K; k++)
+            {
+                float g = Ramp ? gains[k] + gainSteps[k] * float(n) : gains[k];
+
+                sum += g * inputs[k][n];
+            }
+
+            output[n] = sum;
+        }
+    }
+
+    // output (+)= K routes, Ramp is false when none of their gains change over the block.
+    template<int K, bool Ramp>
+    inline void MixGroup(
+        const float * const * inputs,
+        const float * gains,
+        const float * gainSteps,
+        float * output,
+        amf_size first,
+        amf_size count,
+        bool accumulate)
+    {
+        __m128 gain[K];
+        __m128 step[K];
+
+        for (int k = 0; k < K; k++)
+        {
+            gain[k] = _mm_set1_ps(gains[k]);
+            step[k] = _mm_set1_ps(gainSteps[k]);
+        }
+
+        const __m128 ramp = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+        const amf_size end = first + count;
+
+        // step to an aligned output, the inputs stay unaligned in general
+        amf_size n = first;
+        amf_size head = ((16 - (reinterpret_cast<amf_size>(output + n) & 15)) & 15) / sizeof(float);
+        head = (head < count) ? head : count;
+
+        MixScalar<K, Ramp>(inputs, gains, gainSteps, output, n, n + head, accumulate);
+        n += head;
+
+        for (; n + 4 <= end; n += 4)
+        {
+            __m128 t = _mm_add_ps(_mm_set1_ps(float(n)), ramp);
+            __m128 sum = accumulate ? _mm_load_ps(output + n) : _mm_setzero_ps();
+
+            for (int k = 0; k < K; k++)
+            {
+                __m128 g = Ramp ? _mm_add_ps(gain[k], _mm_mul_ps(step[k], t)) : gain[k];
+
+                sum = _mm_add_ps(sum, _mm_mul_ps(g, _mm_loadu_ps(inputs[k] + n)));
+            }
+
+            _mm_store_ps(output + n, sum);
+        }
+
+        MixScalar<K, Ramp>(inputs, gains, gainSteps, output, n, end, accumulate);
+    }
+
+    void MixRoutesSSE2(
+        const float * const * inputs,
+        const float * gains,
+        const float * gainSteps,
+        amf_size routes,
+        float * output,
+        amf_size first,
+        amf_size count,
+        bool accumulate)
+    {
+        if (!routes)
+        {
+            if (!accumulate)
+            {
+                memset(output + first, 0, count * sizeof(float));
+            }
+
+            return;
+        }
+
+        for (amf_size r = 0; r < routes; r += 4)
+        {
+            amf_size k = (routes - r < 4) ? routes - r : 4;
+            bool ramp = false;
+
+            for (amf_size i = 0; i < k; i++)
+            {
+                ramp |= gainSteps[r + i] != 0.0f;
+            }
+
+            // only the first group overwrites
+            bool add = accumulate || r > 0;
+
+            switch (k * 2 + (ramp ? 1 : 0))
+            {
+            case 2: MixGroup<1, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 3: MixGroup<1, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 4: MixGroup<2, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 5: MixGroup<2, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 6: MixGroup<3, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 7: MixGroup<3, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 8: MixGroup<4, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            default: MixGroup<4, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            }
+        }
+    }
+}
+
+namespace amf
+{
+    const TANMixerKernels TANMixerKernelsSSE2 =
+    {
+        L"SSE2",
+        MixRoutesSSE2,
+    };
+
+    const TANMixerKernels & GetTANMixerKernels()
+    {
+        const TANKernelSets<TANMixerKernels> sets = { &TANMixerKernelsSSE2, &TANMixerKernelsAVX2, true, NULL };
+
+        return TANGetKernels(AMF_FACILITY, sets);
+    }
+}
@@ -0,0 +1,66 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   MixerKernels.h
+///  @brief  CPU kernels of TANMixer, one set per instruction set
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    // CPU kernels behind TANMixer. A route is one input with its gain, the gain of route r at
+    // sample n is gains[r] + gainSteps[r] * n, so a block ramps linearly from one gain to the
+    // next without steps. Routes are summed four at a time so the output is loaded and stored
+    // once per four inputs.
+    // Any count and any alignment is accepted, nothing past the last sample is read or written.
+    //
+    // One table per instruction set, see core/KernelDispatch.h.
+    struct TANMixerKernels
+    {
+        const wchar_t * name;
+
+        // output[n] = sum of the routes, or output[n] += sum of the routes if accumulate, for
+        // first <= n < first + count. n counts from the start of the block in the gain ramp too,
+        // so a block can be mixed in tiles. With no routes the output is cleared, or left alone
+        // if accumulate. output must not be one of the inputs.
+        void (*MixRoutes)(
+            const float * const * inputs,
+            const float * gains,
+            const float * gainSteps,
+            amf_size routes,
+            float * output,
+            amf_size first,
+            amf_size count,
+            bool accumulate);
+    };
+
+    // Kernel sets, see MixerKernels*.cpp.
+    extern const TANMixerKernels TANMixerKernelsSSE2;
+    extern const TANMixerKernels TANMixerKernelsAVX2;
+
+    // The table for the running CPU, see TANGetKernels.
+    const TANMixerKernels & GetTANMixerKernels();
+}
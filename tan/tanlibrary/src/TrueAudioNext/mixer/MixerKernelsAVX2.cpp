@@ -0,0 +1,167 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AVX2 + FMA kernels, this file is built with -mavx2 -mfma (/arch:AVX2).
+//
+
+#include "MixerKernels.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+using namespace amf;
+
+namespace
+{
+    // Samples first <= n < end one at a time, for the unaligned head and the tail.
+    template<int K, bool Ramp>
+    inline void MixScalar(
+        const float * const * inputs,
+        const float * gains,
+        const float * gainSteps,
+        float * output,
+        amf_size first,
+        amf_size end,
+        bool accumulate)
+    {
+        for (amf_size n = first; n < end; n++)
+        {
+            float sum = accumulate ? output[n] : 0.0f;
+
+            for (int k = 0; k < K; k++)
+            {
+                float g = Ramp ? gains[k] + gainSteps[k] * float(n) : gains[k];
+
+                sum += g * inputs[k][n];
+            }
+
+            output[n] = sum;
+        }
+    }
+
+    // output (+)= K routes, Ramp is false when none of their gains change over the block.
+    template<int K, bool Ramp>
+    inline void MixGroup(
+        const float * const * inputs,
+        const float * gains,
+        const float * gainSteps,
+        float * output,
+        amf_size first,
+        amf_size count,
+        bool accumulate)
+    {
+        __m256 gain[K];
+        __m256 step[K];
+
+        for (int k = 0; k < K; k++)
+        {
+            gain[k] = _mm256_set1_ps(gains[k]);
+            step[k] = _mm256_set1_ps(gainSteps[k]);
+        }
+
+        const __m256 ramp = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+        const amf_size end = first + count;
+
+        // step to an aligned output, the inputs stay unaligned in general
+        amf_size n = first;
+        amf_size head = ((32 - (reinterpret_cast<amf_size>(output + n) & 31)) & 31) / sizeof(float);
+        head = (head < count) ? head : count;
+
+        MixScalar<K, Ramp>(inputs, gains, gainSteps, output, n, n + head, accumulate);
+        n += head;
+
+        for (; n + 8 <= end; n += 8)
+        {
+            __m256 t = _mm256_add_ps(_mm256_set1_ps(float(n)), ramp);
+            __m256 sum = accumulate ? _mm256_load_ps(output + n) : _mm256_setzero_ps();
+
+            for (int k = 0; k < K; k++)
+            {
+                __m256 g = Ramp ? _mm256_fmadd_ps(step[k], t, gain[k]) : gain[k];
+
+                sum = _mm256_fmadd_ps(g, _mm256_loadu_ps(inputs[k] + n), sum);
+            }
+
+            _mm256_store_ps(output + n, sum);
+        }
+
+        MixScalar<K, Ramp>(inputs, gains, gainSteps, output, n, end, accumulate);
+    }
+
+    void MixRoutesAVX2(
+        const float * const * inputs,
+        const float * gains,
+        const float * gainSteps,
+        amf_size routes,
+        float * output,
+        amf_size first,
+        amf_size count,
+        bool accumulate)
+    {
+        if (!routes)
+        {
+            if (!accumulate)
+            {
+                memset(output + first, 0, count * sizeof(float));
+            }
+
+            return;
+        }
+
+        for (amf_size r = 0; r < routes; r += 4)
+        {
+            amf_size k = (routes - r < 4) ? routes - r : 4;
+            bool ramp = false;
+
+            for (amf_size i = 0; i < k; i++)
+            {
+                ramp |= gainSteps[r + i] != 0.0f;
+            }
+
+            // only the first group overwrites
+            bool add = accumulate || r > 0;
+
+            switch (k * 2 + (ramp ? 1 : 0))
+            {
+            case 2: MixGroup<1, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 3: MixGroup<1, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 4: MixGroup<2, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 5: MixGroup<2, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 6: MixGroup<3, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 7: MixGroup<3, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            case 8: MixGroup<4, false>(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            default: MixGroup<4, true >(inputs + r, gains + r, gainSteps + r, output, first, count, add); break;
+            }
+        }
+    }
+}
+
+namespace amf
+{
+    const TANMixerKernels TANMixerKernelsAVX2 =
+    {
+        L"AVX2",
+        MixRoutesAVX2,
+    };
+}
@@ -0,0 +1,89 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Polyphase resampling of one channel, one work item per output sample.
+// history holds the taps - 1 samples of filter history of the channel followed by its new input,
+// output n is the dot product of one row of taps coefficients with the window starting at
+// the read position of n.
+
+__kernel void resampleFixed(
+	__global	const float*	history,		///< [in]
+				long	historyOffset,	///< [in]
+	__global	const float*	coefficients,	///< [in] phases rows of taps
+				int		taps,			///< [in]
+				int		phases,			///< [in]
+				int		step,			///< [in]
+				long	index,			///< [in] window start of output 0
+				int		phase,			///< [in] row of output 0
+	__global	float*	outputBuffer	///< [out]
+	)
+{
+	long gid = get_global_id(0);
+	long p = phase + gid * step;
+
+	__global const float* x = history + historyOffset + index + p / phases;
+	__global const float* h = coefficients + (p % phases) * taps;
+
+	float sum = 0.0f;
+	for (int k = 0; k < taps; k++)
+	{
+		sum = mad(h[k], x[k], sum);
+	}
+
+	outputBuffer[gid] = sum;
+}
+
+__kernel void resampleVariable(
+	__global	const float*	history,		///< [in]
+				long	historyOffset,	///< [in]
+	__global	const float*	coefficients,	///< [in] (1 << phaseBits) + 1 rows of taps
+				int		taps,			///< [in]
+				int		phaseBits,		///< [in]
+				ulong	position,		///< [in] 32.32 fixed point read position of output 0
+				ulong	step,			///< [in]
+	__global	float*	outputBuffer	///< [out]
+	)
+{
+	long gid = get_global_id(0);
+	ulong pos = position + gid * step;
+	uint fraction = (uint)pos;
+	int fractionBits = 32 - phaseBits;
+
+	__global const float* x = history + historyOffset + (long)(pos >> 32);
+	__global const float* h0 = coefficients + (fraction >> fractionBits) * taps;
+	__global const float* h1 = h0 + taps;
+
+	// the row is interpolated linearly between two rows of the filter bank
+	float weight = (float)(fraction & ((1u << fractionBits) - 1)) / (float)(1u << fractionBits);
+
+	float sum0 = 0.0f;
+	float sum1 = 0.0f;
+	for (int k = 0; k < taps; k++)
+	{
+		sum0 = mad(h0[k], x[k], sum0);
+		sum1 = mad(h1[k], x[k], sum1);
+	}
+
+	outputBuffer[gid] = sum0 + weight * (sum1 - sum0);
+}
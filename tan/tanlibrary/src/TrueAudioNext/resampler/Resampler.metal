@@ -0,0 +1,100 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <metal_stdlib>
+
+// Polyphase resampling of one channel, one thread per output sample, see Resampler.cl.
+
+kernel void resampleFixed(
+	device	const float*	history,			///< [in]
+	constant int64_t &		historyOffset,		///< [in]
+	device	const float*	coefficients,		///< [in] phases rows of taps
+	constant int32_t &		taps,				///< [in]
+	constant int32_t &		phases,				///< [in]
+	constant int32_t &		step,				///< [in]
+	constant int64_t &		index,				///< [in] window start of output 0
+	constant int32_t &		phase,				///< [in] row of output 0
+	device	float*			outputBuffer		///< [out]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	int64_t gid = global_id.x;
+	int64_t p = phase + gid * step;
+
+	device const float* x = history + historyOffset + index + p / phases;
+	device const float* h = coefficients + (p % phases) * taps;
+
+	float sum = 0.0f;
+	for (int k = 0; k < taps; k++)
+	{
+		sum = metal::fma(h[k], x[k], sum);
+	}
+
+	outputBuffer[gid] = sum;
+}
+
+kernel void resampleVariable(
+	device	const float*	history,			///< [in]
+	constant int64_t &		historyOffset,		///< [in]
+	device	const float*	coefficients,		///< [in] (1 << phaseBits) + 1 rows of taps
+	constant int32_t &		taps,				///< [in]
+	constant int32_t &		phaseBits,			///< [in]
+	constant uint64_t &		position,			///< [in] 32.32 fixed point read position of output 0
+	constant uint64_t &		step,				///< [in]
+	device	float*			outputBuffer		///< [out]
+	,
+
+	uint2 				global_id 			[[thread_position_in_grid]],
+	uint2 				local_id 			[[thread_position_in_threadgroup]],
+	uint2 				group_id 			[[threadgroup_position_in_grid]],
+	uint2 				group_size 			[[threads_per_threadgroup]],
+	uint2 				grid_size 			[[threads_per_grid]]
+	)
+{
+	uint64_t gid = global_id.x;
+	uint64_t pos = position + gid * step;
+	uint32_t fraction = (uint32_t)pos;
+	int fractionBits = 32 - phaseBits;
+
+	device const float* x = history + historyOffset + (int64_t)(pos >> 32);
+	device const float* h0 = coefficients + (fraction >> fractionBits) * taps;
+	device const float* h1 = h0 + taps;
+
+	float weight = (float)(fraction & ((1u << fractionBits) - 1)) / (float)(1u << fractionBits);
+
+	float sum0 = 0.0f;
+	float sum1 = 0.0f;
+	for (int k = 0; k < taps; k++)
+	{
+		sum0 = metal::fma(h0[k], x[k], sum0);
+		sum1 = metal::fma(h1[k], x[k], sum1);
+	}
+
+	outputBuffer[gid] = sum0 + weight * (sum1 - sum0);
+}
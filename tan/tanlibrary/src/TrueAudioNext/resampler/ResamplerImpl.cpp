@@ -0,0 +1,823 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//
+#include "ResamplerImpl.h"
+#include "ResamplerKernels.h"
+#include "../core/TANContextImpl.h"
+#include "public/common/AMFFactoryHelper.h"
+#include "OCLHelper.h"
+#include "Debug.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef ENABLE_METAL
+  #include "MetalKernel_Resampler.h"
+#else
+  #include "CLKernel_Resampler.h"
+#endif
+
+#define AMF_FACILITY L"TANResamplerImpl"
+
+
+using namespace amf;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    // Half the filter length in input samples when upsampling, stretched by the ratio when
+    // downsampling. The passband ends at Cutoff of the lower Nyquist frequency, the Kaiser
+    // window gives about 80 dB of stopband attenuation.
+    const double HalfLength = 32.0;
+    const double Cutoff = 0.92;
+    const double KaiserBeta = 8.0;
+
+    // Rates further apart need impractically long filters.
+    const double MaxRateRatio = 32.0;
+
+    amf_uint32 GreatestCommonDivisor(amf_uint32 a, amf_uint32 b)
+    {
+        while (b != 0)
+        {
+            amf_uint32 r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+
+    // Zeroth order modified Bessel function of the first kind.
+    double BesselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+
+        for (int k = 1; k < 64 && term > sum * 1e-17; k++)
+        {
+            double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    // Coefficients of the output fraction of an input sample past the window center, normalized
+    // to unity gain at DC. cutoff is relative to the input Nyquist frequency.
+    void DesignRow(float * row, amf_size taps, double fraction, double cutoff)
+    {
+        const double halfTaps = double(taps / 2);
+        const double delay = halfTaps - 1.0;
+        const double windowScale = 1.0 / BesselI0(KaiserBeta);
+
+        double sum = 0.0;
+        std::vector<double> h(taps);
+
+        for (amf_size k = 0; k < taps; k++)
+        {
+            double x = fraction + delay - double(k);
+            double u = x / halfTaps;
+            double window = (u > -1.0 && u < 1.0) ? BesselI0(KaiserBeta * sqrt(1.0 - u * u)) * windowScale : 0.0;
+            double sinc = (x == 0.0) ? 1.0 : sin(Pi * cutoff * x) / (Pi * cutoff * x);
+
+            h[k] = cutoff * sinc * window;
+            sum += h[k];
+        }
+
+        for (amf_size k = 0; k < taps; k++)
+        {
+            row[k] = float(h[k] / sum);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+TAN_SDK_LINK AMF_RESULT AMF_CDECL_CALL TANCreateResampler(
+    amf::TANContext* pContext,
+    amf::TANResampler** ppComponent
+    )
+{
+    TANContextImplPtr contextImpl(pContext);
+    *ppComponent = new TANResamplerImpl(pContext, NULL);
+    (*ppComponent)->Acquire();
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+TANResamplerImpl::TANResamplerImpl(TANContext *pContextTAN, AMFContext* pContextAMF) :
+    m_pContextTAN(pContextTAN),
+    m_pContextAMF(pContextAMF)
+{
+}
+//-------------------------------------------------------------------------------------------------
+TANResamplerImpl::~TANResamplerImpl(void)
+{
+    Terminate();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::Init(
+    amf_uint32 inputRate,
+    amf_uint32 outputRate,
+    amf_uint32 channels,
+    amf_size maxInputSamples
+    )
+{
+    AMF_RETURN_IF_FALSE(inputRate > 0 && outputRate > 0, AMF_INVALID_ARG, L"sample rate == 0");
+    AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"channels == 0");
+    AMF_RETURN_IF_FALSE(maxInputSamples > 0, AMF_INVALID_ARG, L"maxInputSamples == 0");
+    // the integer part of the 32.32 read position addresses the working buffer
+    AMF_RETURN_IF_FALSE(maxInputSamples < 0x40000000, AMF_INVALID_ARG, L"maxInputSamples too large");
+
+    const double ratio = double(outputRate) / inputRate;
+    AMF_RETURN_IF_FALSE(ratio <= MaxRateRatio && ratio * MaxRateRatio >= 1.0, AMF_INVALID_ARG, L"sample rates too far apart");
+
+    AMFLock lock(&m_sect);
+
+    AMF_RETURN_IF_FALSE(m_taps == 0, AMF_ALREADY_INITIALIZED, L"Already initialized");
+    AMF_RETURN_IF_FALSE((NULL != m_pContextTAN), AMF_WRONG_STATE, L"Cannot initialize after termination");
+
+    m_inputRate = inputRate;
+    m_outputRate = outputRate;
+    m_channels = channels;
+    m_maxInputSamples = maxInputSamples;
+
+    amf_uint32 divisor = GreatestCommonDivisor(inputRate, outputRate);
+    m_phases = outputRate / divisor;
+    m_step = inputRate / divisor;
+
+    // the filter keeps the band below the lower Nyquist frequency
+    const double bandwidth = (std::min)(ratio, 1.0);
+    const double cutoff = Cutoff * bandwidth;
+    const amf_size halfTaps = amf_size(ceil(HalfLength / bandwidth));
+
+    m_taps = (2 * halfTaps + ResamplerTapMultiple - 1) / ResamplerTapMultiple * ResamplerTapMultiple;
+    m_historySize = m_taps - 1;
+    m_stride = (m_historySize + maxInputSamples + 15) & ~amf_size(15);
+
+    m_fixedCoefficients.clear();
+    if (m_phases <= ResamplerMaxFixedPhases)
+    {
+        m_fixedCoefficients.resize(m_phases * m_taps);
+        for (amf_uint32 p = 0; p < m_phases; p++)
+        {
+            DesignRow(&m_fixedCoefficients[p * m_taps], m_taps, double(p) / m_phases, cutoff);
+        }
+    }
+
+    const amf_uint32 rows = 1u << ResamplerPhaseBits;
+    m_variableCoefficients.resize((rows + 1) * m_taps);
+    for (amf_uint32 r = 0; r <= rows; r++)
+    {
+        DesignRow(&m_variableCoefficients[r * m_taps], m_taps, double(r) / rows, cutoff);
+    }
+
+    m_work.resize(m_channels * m_stride);
+    m_workChannels.resize(m_channels);
+    for (amf_uint32 c = 0; c < m_channels; c++)
+    {
+        m_workChannels[c] = &m_work[c * m_stride];
+    }
+
+    Restart();
+
+    // Determine how to initialize based on context, CPU for CPU and GPU for GPU
+#ifndef TAN_NO_OPENCL
+    if(m_pContextTAN->GetOpenCLContext())
+#else
+    if(m_pContextTAN->GetAMFConvQueue() || m_pContextTAN->GetAMFGeneralQueue())
+#endif
+    {
+        return InitGpu();
+    }
+    else
+    {
+        return InitCpu();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::InitCpu()
+{
+    // The host buffers are all there is; we're done!
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::InitGpu()
+{
+    const amf_size workSize = m_channels * m_stride * sizeof(float);
+
+#ifndef TAN_NO_OPENCL
+    cl_int ret;
+
+    // Given some command queue, retrieve the cl_context...
+    m_pQueueCl = m_pContextTAN->GetOpenCLConvQueue();
+    ret = clGetCommandQueueInfo(m_pQueueCl, CL_QUEUE_CONTEXT, sizeof(cl_context),
+        &m_pContextCl, NULL);
+    AMF_RETURN_IF_CL_FAILED(ret, L"Cannot retrieve cl_context from cl_command_queue.");
+
+    // ...and cl_device from it
+    ret = clGetCommandQueueInfo(m_pQueueCl, CL_QUEUE_DEVICE, sizeof(cl_device_id),
+        &m_pDeviceCl, NULL);
+    AMF_RETURN_IF_CL_FAILED(ret, L"Cannot retrieve cl_device_id from cl_command_queue.");
+
+    // Retain the queue for use
+    ret = clRetainCommandQueue(m_pQueueCl);
+    CLQUEUE_REFCOUNT(m_pQueueCl);
+    AMF_RETURN_IF_CL_FAILED(ret, L"Failed to retain command queue.");
+
+    TANContextImplPtr contextImpl(m_pContextTAN);
+    m_pDeviceAMF = contextImpl->GetConvolutionCompute();
+
+    if (!m_fixedCoefficients.empty())
+    {
+        m_clFixedCoefficients = clCreateBuffer(m_pContextCl, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+            m_fixedCoefficients.size() * sizeof(float), &m_fixedCoefficients[0], &ret);
+        AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+    }
+
+    m_clVariableCoefficients = clCreateBuffer(m_pContextCl, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        m_variableCoefficients.size() * sizeof(float), &m_variableCoefficients[0], &ret);
+    AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+
+    for (int i = 0; i < 2; i++)
+    {
+        m_clWork[i] = clCreateBuffer(m_pContextCl, CL_MEM_READ_WRITE, workSize, NULL, &ret);
+        AMF_RETURN_IF_CL_FAILED(ret, L"Failed to create buffer");
+    }
+
+    //... Preparing OCL Kernel
+    bool OCLKenel_Err = false;
+    OCLKenel_Err = GetOclKernel(m_clkResampleFixed, m_pDeviceAMF, m_pQueueCl, "resampleFixed", Resampler, ResamplerCount, "resampleFixed", "");
+    if (!OCLKenel_Err){ printf("Failed to compile Resampler Kernel resampleFixed"); return AMF_FAIL; }
+    OCLKenel_Err = GetOclKernel(m_clkResampleVariable, m_pDeviceAMF, m_pQueueCl, "resampleVariable", Resampler, ResamplerCount, "resampleVariable", "");
+    if (!OCLKenel_Err){ printf("Failed to compile Resampler Kernel resampleVariable"); return AMF_FAIL; }
+
+#else
+
+    mQueueAMF = m_pContextTAN->GetAMFConvQueue();
+
+    TANContextImplPtr contextImpl(m_pContextTAN);
+    m_pDeviceAMF = contextImpl->GetConvolutionCompute();
+
+    if (!m_fixedCoefficients.empty())
+    {
+        AMF_RETURN_IF_FAILED(
+            m_pContextTAN->GetAMFContext()->CreateBufferFromHostNative(
+                &m_fixedCoefficients[0],
+                m_fixedCoefficients.size() * sizeof(float),
+                &mFixedCoefficients,
+                nullptr
+                )
+            );
+        AMF_RETURN_IF_FAILED(mFixedCoefficients->Convert(mQueueAMF->GetMemoryType()));
+    }
+
+    AMF_RETURN_IF_FAILED(
+        m_pContextTAN->GetAMFContext()->CreateBufferFromHostNative(
+            &m_variableCoefficients[0],
+            m_variableCoefficients.size() * sizeof(float),
+            &mVariableCoefficients,
+            nullptr
+            )
+        );
+    AMF_RETURN_IF_FAILED(mVariableCoefficients->Convert(mQueueAMF->GetMemoryType()));
+
+    for (int i = 0; i < 2; i++)
+    {
+        AMF_RETURN_IF_FAILED(
+            m_pContextTAN->GetAMFContext()->AllocBuffer(
+                mQueueAMF->GetMemoryType(),
+                workSize,
+                &mWork[i]
+                )
+            );
+    }
+
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mResampleFixed,
+            m_pDeviceAMF,
+
+            "resampleFixed",
+            (const char *)Resampler,
+            ResamplerCount,
+            "resampleFixed",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
+    AMF_RETURN_IF_FALSE(
+        GetOclKernel(
+            mResampleVariable,
+            m_pDeviceAMF,
+
+            "resampleVariable",
+            (const char *)Resampler,
+            ResamplerCount,
+            "resampleVariable",
+
+            "",
+            TANContextImplPtr(m_pContextTAN)->GetFactory()
+            ),
+        AMF_FAIL
+        );
+
+#endif
+
+    return ClearGpuHistory();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::Terminate()
+{
+    AMFLock lock(&m_sect);
+
+    m_pDeviceAMF = NULL;
+
+#ifndef TAN_NO_OPENCL
+    if (m_clkResampleFixed)
+    {
+        AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkResampleFixed), L"Failed to release cl kernel");
+        m_clkResampleFixed = nullptr;
+    }
+    if (m_clkResampleVariable)
+    {
+        AMF_RETURN_IF_CL_FAILED(clReleaseKernel(m_clkResampleVariable), L"Failed to release cl kernel");
+        m_clkResampleVariable = nullptr;
+    }
+
+    cl_mem * buffers[] = { &m_clFixedCoefficients, &m_clVariableCoefficients, &m_clWork[0], &m_clWork[1] };
+    for (cl_mem * buffer : buffers)
+    {
+        if (*buffer)
+        {
+            cl_int clErr = clReleaseMemObject(*buffer);
+            AMF_RETURN_IF_CL_FAILED(clErr, L"Failed to release buffer.");
+            *buffer = nullptr;
+        }
+    }
+
+    m_pDeviceCl = NULL;
+    m_pContextCl = NULL;
+
+    if (m_pQueueCl)
+    {
+        DBG_CLRELEASE_QUEUE(m_pQueueCl,"m_pQueueCl");
+    }
+    m_pQueueCl = NULL;
+
+#else
+
+    mResampleFixed = nullptr;
+    mResampleVariable = nullptr;
+
+    mFixedCoefficients = nullptr;
+    mVariableCoefficients = nullptr;
+    mWork[0] = nullptr;
+    mWork[1] = nullptr;
+
+    mQueueAMF = nullptr;
+
+#endif
+
+    m_taps = 0;
+    m_fixedCoefficients.clear();
+    m_variableCoefficients.clear();
+    m_work.clear();
+    m_workChannels.clear();
+
+    m_pContextAMF = NULL;
+    m_pContextTAN = NULL;
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void TANResamplerImpl::Restart()
+{
+    std::fill(m_work.begin(), m_work.end(), 0.0f);
+
+    // output 0 is at input sample 0, the middle of the first window
+    m_index = m_taps / 2;
+    m_phase = 0;
+
+    m_variable = m_fixedCoefficients.empty();
+    m_position = amf_uint64(m_index) << 32;
+    m_positionStep = amf_uint64(double(m_step) / m_phases * 4294967296.0 + 0.5);
+
+    m_currentWork = 0;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT TANResamplerImpl::ClearGpuHistory()
+{
+    const amf_size workSize = m_channels * m_stride * sizeof(float);
+
+#ifndef TAN_NO_OPENCL
+    if (m_pQueueCl)
+    {
+        const float zero = 0.0f;
+
+        for (int i = 0; i < 2; i++)
+        {
+            cl_int clErr = FixedEnqueueFillBuffer(m_pContextCl, m_pQueueCl, m_clWork[i], &zero, sizeof(zero), 0, workSize);
+            AMF_RETURN_IF_CL_FAILED(clErr, L"Failed to clear buffer");
+        }
+    }
+#else
+    if (mQueueAMF)
+    {
+        // m_work has just been cleared
+        for (int i = 0; i < 2; i++)
+        {
+            AMF_RETURN_IF_FAILED(mQueueAMF->CopyBufferFromHost(&m_work[0], workSize, mWork[i], 0, true));
+        }
+    }
+#endif
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+amf_size TANResamplerImpl::OutputCount(amf_size numOfInputSamples) const
+{
+    // outputs whose window ends inside the history and the new input, i.e. starts before
+    // numOfInputSamples
+    if (m_variable)
+    {
+        const amf_uint64 end = amf_uint64(numOfInputSamples) << 32;
+
+        return m_position < end ? amf_size((end - m_position + m_positionStep - 1) / m_positionStep) : 0;
+    }
+
+    const amf_uint64 end = amf_uint64(numOfInputSamples) * m_phases;
+    const amf_uint64 start = amf_uint64(m_index) * m_phases + m_phase;
+
+    return start < end ? amf_size((end - start + m_step - 1) / m_step) : 0;
+}
+//-------------------------------------------------------------------------------------------------
+void TANResamplerImpl::Advance(amf_size numOfOutputSamples)
+{
+    if (m_variable)
+    {
+        m_position += numOfOutputSamples * m_positionStep;
+    }
+    else
+    {
+        const amf_uint64 phase = m_phase + amf_uint64(numOfOutputSamples) * m_step;
+
+        m_index += amf_size(phase / m_phases);
+        m_phase = amf_uint32(phase % m_phases);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void TANResamplerImpl::Rebase(amf_size numOfInputSamples)
+{
+    // the last m_historySize samples become the start of the next working buffer
+    if (m_variable)
+    {
+        m_position -= amf_uint64(numOfInputSamples) << 32;
+    }
+    else
+    {
+        m_index -= numOfInputSamples;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::Reset()
+{
+    AMFLock lock(&m_sect);
+
+    AMF_RETURN_IF_FALSE(m_taps != 0, AMF_NOT_INITIALIZED, L"Not initialized");
+
+    Restart();
+
+    return ClearGpuHistory();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::SetRatio(double ratio)
+{
+    AMFLock lock(&m_sect);
+
+    AMF_RETURN_IF_FALSE(m_taps != 0, AMF_NOT_INITIALIZED, L"Not initialized");
+
+    const double nominal = double(m_outputRate) / m_inputRate;
+    AMF_RETURN_IF_FALSE(ratio >= 0.5 * nominal && ratio <= 2.0 * nominal, AMF_INVALID_ARG, L"ratio out of range");
+
+    if (!m_variable)
+    {
+        m_position = (amf_uint64(m_index) << 32) + (amf_uint64(m_phase) << 32) / m_phases;
+        m_variable = true;
+    }
+
+    m_positionStep = amf_uint64(4294967296.0 / ratio + 0.5);
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+amf_size AMF_STD_CALL TANResamplerImpl::GetLatency()
+{
+    AMFLock lock(&m_sect);
+
+    return m_taps / 2;
+}
+//-------------------------------------------------------------------------------------------------
+amf_size AMF_STD_CALL TANResamplerImpl::GetOutputSampleCount(amf_size numOfInputSamples)
+{
+    AMFLock lock(&m_sect);
+
+    return m_taps != 0 ? OutputCount(numOfInputSamples) : 0;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::Process(
+    float* ppBufferInput[],
+    amf_size numOfInputSamples,
+    float* ppBufferOutput[],
+    amf_size outputCapacity,
+    amf_size *pNumOfOutputSamples
+    )
+{
+    AMF_RETURN_IF_FALSE(ppBufferInput != NULL, AMF_INVALID_ARG, L"ppBufferInput == NULL");
+    AMF_RETURN_IF_FALSE(ppBufferOutput != NULL, AMF_INVALID_ARG, L"ppBufferOutput == NULL");
+
+    AMFLock lock(&m_sect);
+
+    AMF_RETURN_IF_FALSE(m_taps != 0, AMF_NOT_INITIALIZED, L"Not initialized");
+    AMF_RETURN_IF_FALSE(numOfInputSamples <= m_maxInputSamples, AMF_INVALID_ARG, L"numOfInputSamples > maxInputSamples");
+
+    const amf_size count = OutputCount(numOfInputSamples);
+    AMF_RETURN_IF_FALSE(count <= outputCapacity, AMF_INVALID_ARG, L"outputCapacity too small");
+
+    for (amf_uint32 c = 0; c < m_channels; c++)
+    {
+        AMF_RETURN_IF_FALSE(ppBufferInput[c] != NULL, AMF_INVALID_ARG, L"ppBufferInput[c] == NULL");
+        AMF_RETURN_IF_FALSE(ppBufferOutput[c] != NULL, AMF_INVALID_ARG, L"ppBufferOutput[c] == NULL");
+
+        memcpy(m_workChannels[c] + m_historySize, ppBufferInput[c], numOfInputSamples * sizeof(float));
+    }
+
+    const TANResamplerKernels & kernels = GetTANResamplerKernels();
+
+    if (m_variable)
+    {
+        kernels.ResampleVariable(&m_workChannels[0], ppBufferOutput, m_channels,
+            &m_variableCoefficients[0], m_taps, m_position, m_positionStep, count);
+    }
+    else
+    {
+        kernels.ResampleFixed(&m_workChannels[0], ppBufferOutput, m_channels,
+            &m_fixedCoefficients[0], m_taps, m_phases, m_step, m_index, m_phase, count);
+    }
+
+    for (amf_uint32 c = 0; c < m_channels; c++)
+    {
+        memmove(m_workChannels[c], m_workChannels[c] + numOfInputSamples, m_historySize * sizeof(float));
+    }
+
+    Rebase(numOfInputSamples);
+
+    if (pNumOfOutputSamples != NULL)
+    {
+        *pNumOfOutputSamples = count;
+    }
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+#ifndef TAN_NO_OPENCL
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::Process(
+    cl_mem ppBufferInput[],
+    amf_size numOfInputSamples,
+    cl_mem ppBufferOutput[],
+    amf_size outputCapacity,
+    amf_size *pNumOfOutputSamples
+    )
+{
+    AMF_RETURN_IF_FALSE(ppBufferInput != NULL, AMF_INVALID_ARG, L"ppBufferInput == NULL");
+    AMF_RETURN_IF_FALSE(ppBufferOutput != NULL, AMF_INVALID_ARG, L"ppBufferOutput == NULL");
+
+    AMFLock lock(&m_sect);
+
+    AMF_RETURN_IF_FALSE(m_pQueueCl != nullptr, AMF_WRONG_STATE, L"Not initialized for OpenCL");
+    AMF_RETURN_IF_FALSE(numOfInputSamples <= m_maxInputSamples, AMF_INVALID_ARG, L"numOfInputSamples > maxInputSamples");
+
+    const amf_size count = OutputCount(numOfInputSamples);
+    AMF_RETURN_IF_FALSE(count <= outputCapacity, AMF_INVALID_ARG, L"outputCapacity too small");
+
+    cl_int clErr = CL_SUCCESS;
+    cl_mem work = m_clWork[m_currentWork];
+    cl_mem next = m_clWork[1 - m_currentWork];
+
+    cl_kernel clKernel = m_variable ? m_clkResampleVariable : m_clkResampleFixed;
+    cl_mem coefficients = m_variable ? m_clVariableCoefficients : m_clFixedCoefficients;
+    cl_int taps = cl_int(m_taps);
+
+    for (amf_uint32 c = 0; c < m_channels; c++)
+    {
+        AMF_RETURN_IF_FALSE(ppBufferInput[c] != NULL, AMF_INVALID_ARG, L"ppBufferInput[c] == NULL");
+        AMF_RETURN_IF_FALSE(ppBufferOutput[c] != NULL, AMF_INVALID_ARG, L"ppBufferOutput[c] == NULL");
+
+        cl_long offset = cl_long(c * m_stride);
+
+        if (numOfInputSamples > 0)
+        {
+            clErr = clEnqueueCopyBuffer(m_pQueueCl, ppBufferInput[c], work,
+                0, (offset + m_historySize) * sizeof(float), numOfInputSamples * sizeof(float), 0, NULL, NULL);
+            AMF_RETURN_IF_CL_FAILED(clErr, L"Failed to copy input");
+        }
+
+        if (count > 0)
+        {
+            cl_uint index = 0;
+
+            clErr = clSetKernelArg(clKernel, index++, sizeof(cl_mem), &work);
+            if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+            clErr = clSetKernelArg(clKernel, index++, sizeof(cl_long), &offset);
+            if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+            clErr = clSetKernelArg(clKernel, index++, sizeof(cl_mem), &coefficients);
+            if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+            clErr = clSetKernelArg(clKernel, index++, sizeof(cl_int), &taps);
+            if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+
+            if (m_variable)
+            {
+                cl_int phaseBits = ResamplerPhaseBits;
+                cl_ulong position = m_position;
+                cl_ulong step = m_positionStep;
+
+                clErr = clSetKernelArg(clKernel, index++, sizeof(cl_int), &phaseBits);
+                if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+                clErr = clSetKernelArg(clKernel, index++, sizeof(cl_ulong), &position);
+                if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+                clErr = clSetKernelArg(clKernel, index++, sizeof(cl_ulong), &step);
+                if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+            }
+            else
+            {
+                cl_int phases = cl_int(m_phases);
+                cl_int step = cl_int(m_step);
+                cl_long windowIndex = cl_long(m_index);
+                cl_int phase = cl_int(m_phase);
+
+                clErr = clSetKernelArg(clKernel, index++, sizeof(cl_int), &phases);
+                if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+                clErr = clSetKernelArg(clKernel, index++, sizeof(cl_int), &step);
+                if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+                clErr = clSetKernelArg(clKernel, index++, sizeof(cl_long), &windowIndex);
+                if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+                clErr = clSetKernelArg(clKernel, index++, sizeof(cl_int), &phase);
+                if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+            }
+
+            clErr = clSetKernelArg(clKernel, index++, sizeof(cl_mem), &ppBufferOutput[c]);
+            if (clErr != CL_SUCCESS) { printf("Failed to set OpenCL argument"); return AMF_FAIL; }
+
+            // one work item per output sample
+            amf_size global[3] = { count, 0, 0 };
+            clErr = clEnqueueNDRangeKernel(
+                m_pQueueCl, clKernel, 1, NULL, global, NULL, 0, NULL, NULL);
+            if (clErr != CL_SUCCESS) { printf("Failed to enqueue OpenCL kernel\n"); return AMF_FAIL; }
+        }
+
+        // the buffers are swapped, source and destination of the history never overlap
+        clErr = clEnqueueCopyBuffer(m_pQueueCl, work, next,
+            (offset + numOfInputSamples) * sizeof(float), offset * sizeof(float), m_historySize * sizeof(float), 0, NULL, NULL);
+        AMF_RETURN_IF_CL_FAILED(clErr, L"Failed to copy history");
+    }
+
+    m_currentWork = 1 - m_currentWork;
+
+    Advance(count);
+    Rebase(numOfInputSamples);
+
+    if (pNumOfOutputSamples != NULL)
+    {
+        *pNumOfOutputSamples = count;
+    }
+
+    return AMF_OK;
+}
+#else
+AMF_RESULT  AMF_STD_CALL TANResamplerImpl::Process(
+    AMFBuffer * ppBufferInput[],
+    amf_size numOfInputSamples,
+    AMFBuffer * ppBufferOutput[],
+    amf_size outputCapacity,
+    amf_size *pNumOfOutputSamples
+    )
+{
+    AMF_RETURN_IF_FALSE(ppBufferInput != NULL, AMF_INVALID_ARG, L"ppBufferInput == NULL");
+    AMF_RETURN_IF_FALSE(ppBufferOutput != NULL, AMF_INVALID_ARG, L"ppBufferOutput == NULL");
+
+    AMFLock lock(&m_sect);
+
+    AMF_RETURN_IF_FALSE(mQueueAMF != nullptr, AMF_WRONG_STATE, L"Not initialized for a device");
+    AMF_RETURN_IF_FALSE(numOfInputSamples <= m_maxInputSamples, AMF_INVALID_ARG, L"numOfInputSamples > maxInputSamples");
+
+    const amf_size count = OutputCount(numOfInputSamples);
+    AMF_RETURN_IF_FALSE(count <= outputCapacity, AMF_INVALID_ARG, L"outputCapacity too small");
+
+    AMFBuffer * work = mWork[m_currentWork];
+    AMFBuffer * next = mWork[1 - m_currentWork];
+
+    AMFComputeKernel * kernel = m_variable ? mResampleVariable : mResampleFixed;
+    AMFBuffer * coefficients = m_variable ? mVariableCoefficients : mFixedCoefficients;
+
+    for (amf_uint32 c = 0; c < m_channels; c++)
+    {
+        AMF_RETURN_IF_FALSE(ppBufferInput[c] != NULL, AMF_INVALID_ARG, L"ppBufferInput[c] == NULL");
+        AMF_RETURN_IF_FALSE(ppBufferOutput[c] != NULL, AMF_INVALID_ARG, L"ppBufferOutput[c] == NULL");
+
+        const amf_size offset = c * m_stride;
+
+        if (numOfInputSamples > 0)
+        {
+            AMF_RETURN_IF_FAILED(
+                mQueueAMF->CopyBuffer(
+                    ppBufferInput[c],
+                    0,
+                    numOfInputSamples * sizeof(float),
+                    work,
+                    (offset + m_historySize) * sizeof(float)
+                    )
+                );
+        }
+
+        if (count > 0)
+        {
+            unsigned index = 0;
+
+            AMF_RETURN_IF_FAILED(kernel->SetArgBuffer(index++, work, AMF_ARGUMENT_ACCESS_READWRITE));
+            AMF_RETURN_IF_FAILED(kernel->SetArgInt64(index++, offset));
+            AMF_RETURN_IF_FAILED(kernel->SetArgBuffer(index++, coefficients, AMF_ARGUMENT_ACCESS_READWRITE));
+            AMF_RETURN_IF_FAILED(kernel->SetArgInt32(index++, amf_int32(m_taps)));
+
+            if (m_variable)
+            {
+                AMF_RETURN_IF_FAILED(kernel->SetArgInt32(index++, amf_int32(ResamplerPhaseBits)));
+                AMF_RETURN_IF_FAILED(kernel->SetArgInt64(index++, amf_int64(m_position)));
+                AMF_RETURN_IF_FAILED(kernel->SetArgInt64(index++, amf_int64(m_positionStep)));
+            }
+            else
+            {
+                AMF_RETURN_IF_FAILED(kernel->SetArgInt32(index++, amf_int32(m_phases)));
+                AMF_RETURN_IF_FAILED(kernel->SetArgInt32(index++, amf_int32(m_step)));
+                AMF_RETURN_IF_FAILED(kernel->SetArgInt64(index++, amf_int64(m_index)));
+                AMF_RETURN_IF_FAILED(kernel->SetArgInt32(index++, amf_int32(m_phase)));
+            }
+
+            AMF_RETURN_IF_FAILED(kernel->SetArgBuffer(index++, ppBufferOutput[c], AMF_ARGUMENT_ACCESS_READWRITE));
+
+            // one work item per output sample
+            amf_size global[3] = { count, 0, 0 };
+
+            AMF_RETURN_IF_FAILED(
+                kernel->Enqueue(1, nullptr, global, nullptr)
+                );
+        }
+
+        // the buffers are swapped, source and destination of the history never overlap
+        AMF_RETURN_IF_FAILED(
+            mQueueAMF->CopyBuffer(
+                work,
+                (offset + numOfInputSamples) * sizeof(float),
+                m_historySize * sizeof(float),
+                next,
+                offset * sizeof(float)
+                )
+            );
+    }
+
+    m_currentWork = 1 - m_currentWork;
+
+    Advance(count);
+    Rebase(numOfInputSamples);
+
+    if (pNumOfOutputSamples != NULL)
+    {
+        *pNumOfOutputSamples = count;
+    }
+
+    return AMF_OK;
+}
+#endif
@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+///-------------------------------------------------------------------------
+///  @file   ResamplerImpl.h
+///  @brief  TANResampler interface implementation
+///-------------------------------------------------------------------------
+#pragma once
+#include "TrueAudioNext.h"   //TAN
+#include "public/include/core/Context.h"        //AMF
+#include "public/include/components/Component.h"//AMF
+#include "public/common/PropertyStorageExImpl.h"//AMF
+
+#include <vector>
+
+namespace amf
+{
+    class TANResamplerImpl
+        : public virtual AMFInterfaceImpl < AMFPropertyStorageExImpl< TANResampler> >
+    {
+    public:
+        typedef AMFInterfacePtr_T<TANResamplerImpl> Ptr;
+
+        TANResamplerImpl(TANContext *pContextTAN, AMFContext* pContextAMF);
+        virtual ~TANResamplerImpl(void);
+
+// interface access
+        AMF_BEGIN_INTERFACE_MAP
+            AMF_INTERFACE_CHAIN_ENTRY(AMFInterfaceImpl< AMFPropertyStorageExImpl <TANResampler> >)
+        AMF_END_INTERFACE_MAP
+
+//TANResampler interface
+        AMF_RESULT  AMF_STD_CALL Init(amf_uint32 inputRate, amf_uint32 outputRate,
+                                      amf_uint32 channels, amf_size maxInputSamples) override;
+        AMF_RESULT  AMF_STD_CALL Terminate() override;
+        TANContext* AMF_STD_CALL GetContext() override { return m_pContextTAN; }
+
+        AMF_RESULT  AMF_STD_CALL Reset() override;
+        AMF_RESULT  AMF_STD_CALL SetRatio(double ratio) override;
+        amf_size    AMF_STD_CALL GetLatency() override;
+        amf_size    AMF_STD_CALL GetOutputSampleCount(amf_size numOfInputSamples) override;
+
+        AMF_RESULT  AMF_STD_CALL Process(float* ppBufferInput[], amf_size numOfInputSamples,
+                                         float* ppBufferOutput[], amf_size outputCapacity,
+                                         amf_size *pNumOfOutputSamples) override;
+
+#ifndef TAN_NO_OPENCL
+        AMF_RESULT  AMF_STD_CALL Process(cl_mem ppBufferInput[], amf_size numOfInputSamples,
+                                         cl_mem ppBufferOutput[], amf_size outputCapacity,
+                                         amf_size *pNumOfOutputSamples) override;
+#else
+        AMF_RESULT  AMF_STD_CALL Process(AMFBuffer * ppBufferInput[], amf_size numOfInputSamples,
+                                         AMFBuffer * ppBufferOutput[], amf_size outputCapacity,
+                                         amf_size *pNumOfOutputSamples) override;
+#endif
+
+    protected:
+        TANContextPtr               m_pContextTAN;
+        AMFContextPtr               m_pContextAMF;
+        AMFComputePtr               m_pDeviceAMF;
+        AMFCriticalSection          m_sect;
+
+        amf_uint32                  m_inputRate = 0;
+        amf_uint32                  m_outputRate = 0;
+        amf_uint32                  m_channels = 0;
+        amf_size                    m_maxInputSamples = 0;
+
+        amf_size                    m_taps = 0;         // filter length, 0 until initialized
+        amf_size                    m_historySize = 0;  // taps - 1 samples kept from call to call
+        amf_size                    m_stride = 0;       // floats per channel of the working buffers
+
+        // Fixed ratio outputRate / inputRate = m_phases / m_step, m_fixedCoefficients is empty
+        // when there are more than ResamplerMaxFixedPhases phases.
+        amf_uint32                  m_phases = 0;
+        amf_uint32                  m_step = 0;
+        std::vector<float>          m_fixedCoefficients;
+        std::vector<float>          m_variableCoefficients;
+
+        // Read position of the next output in the working buffers: m_index and m_phase for the
+        // fixed ratio, m_position in 32.32 fixed point once m_variable is set.
+        bool                        m_variable = false;
+        amf_size                    m_index = 0;
+        amf_uint32                  m_phase = 0;
+        amf_uint64                  m_position = 0;
+        amf_uint64                  m_positionStep = 0;
+
+        std::vector<float>          m_work;             // host history and input of every channel
+        std::vector<float *>        m_workChannels;
+
+#ifndef TAN_NO_OPENCL
+        cl_command_queue            m_pQueueCl = nullptr;
+        cl_context                  m_pContextCl = nullptr;
+        cl_device_id                m_pDeviceCl = nullptr;
+
+        cl_kernel                   m_clkResampleFixed = nullptr;
+        cl_kernel                   m_clkResampleVariable = nullptr;
+
+        cl_mem                      m_clFixedCoefficients = nullptr;
+        cl_mem                      m_clVariableCoefficients = nullptr;
+        cl_mem                      m_clWork[2] = { nullptr, nullptr };    // swapped every call
+#else
+        amf::AMFComputePtr          mQueueAMF;
+
+        amf::AMFComputeKernelPtr    mResampleFixed;
+        amf::AMFComputeKernelPtr    mResampleVariable;
+
+        amf::AMFBufferPtr           mFixedCoefficients;
+        amf::AMFBufferPtr           mVariableCoefficients;
+        amf::AMFBufferPtr           mWork[2];                           // swapped every call
+#endif
+        int                         m_currentWork = 0;
+
+    private:
+        AMF_RESULT	AMF_STD_CALL InitCpu();
+        AMF_RESULT	AMF_STD_CALL InitGpu();
+
+        void                        Restart();
+        AMF_RESULT                  ClearGpuHistory();
+        amf_size                    OutputCount(amf_size numOfInputSamples) const;
+        void                        Advance(amf_size numOfOutputSamples);
+        void                        Rebase(amf_size numOfInputSamples);
+    };
+} //amf
@@ -0,0 +1,101 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   ResamplerKernels.h
+///  @brief  CPU kernels of TANResampler, one set per instruction set
+///-------------------------------------------------------------------------
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    // CPU kernels behind TANResampler. inputs[c] is the working buffer of channel c, the filter
+    // history followed by the new input, outputs[c] receives count samples. Output sample n is
+    // the dot product of one row of taps coefficients with inputs[c][index(n) ...], every channel
+    // uses the same row, so a row is loaded once per output for all channels.
+    // taps must be a multiple of ResamplerTapMultiple, any alignment is accepted.
+    //
+    // One table per instruction set, see core/KernelDispatch.h.
+    struct TANResamplerKernels
+    {
+        const wchar_t * name;
+
+        // Exact rational ratio: row phase of the phases rows, after each output
+        // phase += step, index += phase / phases, phase %= phases.
+        void (*ResampleFixed)(
+            const float * const * inputs,
+            float * const * outputs,
+            amf_size channels,
+            const float * coefficients,
+            amf_size taps,
+            amf_uint32 phases,
+            amf_uint32 step,
+            amf_size & index,
+            amf_uint32 & phase,
+            amf_size count);
+
+        // Any ratio: position is 32.32 fixed point in input samples and advances by step after
+        // each output. The row is interpolated linearly between rows r and r + 1 of the
+        // (1 << ResamplerPhaseBits) + 1 rows, r being the top bits of the fraction.
+        void (*ResampleVariable)(
+            const float * const * inputs,
+            float * const * outputs,
+            amf_size channels,
+            const float * coefficients,
+            amf_size taps,
+            amf_uint64 & position,
+            amf_uint64 step,
+            amf_size count);
+    };
+
+    // Filter lengths are rounded up to whole AVX2 vectors.
+    const amf_size ResamplerTapMultiple = 8;
+
+    // Rows of the variable ratio filter bank, plus one.
+    const amf_uint32 ResamplerPhaseBits = 8;
+
+    // Rate pairs reducing to more phases than this use the variable ratio filter bank.
+    const amf_uint32 ResamplerMaxFixedPhases = 512;
+
+    // Row and interpolation weight of a 32.32 read position.
+    inline amf_uint32 ResamplerRow(amf_uint64 position)
+    {
+        return amf_uint32(position & 0xFFFFFFFFu) >> (32 - ResamplerPhaseBits);
+    }
+
+    inline float ResamplerWeight(amf_uint64 position)
+    {
+        const amf_uint32 fractionBits = 32 - ResamplerPhaseBits;
+
+        return float(amf_uint32(position) & ((1u << fractionBits) - 1)) * (1.0f / float(1u << fractionBits));
+    }
+
+    // Kernel sets, see ResamplerKernels*.cpp.
+    extern const TANResamplerKernels TANResamplerKernelsSSE2;
+    extern const TANResamplerKernels TANResamplerKernelsAVX2;
+
+    // The table for the running CPU, see TANGetKernels.
+    const TANResamplerKernels & GetTANResamplerKernels();
+}
@@ -0,0 +1,203 @@
+//
+// MIT license
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AVX2 + FMA kernels, this file is built with -mavx2 -mfma (/arch:AVX2).
+//
+
+#include "ResamplerKernels.h"
+
+#include <immintrin.h>
+
+using namespace amf;
+
+namespace
+{
+    // Row of the fixed ratio filter bank.
+    struct FixedRow
+    {
+        const float * row;
+
+        inline __m256 Load(amf_size k) const
+        {
+            return _mm256_loadu_ps(row + k);
+        }
+    };
+
+    // Row of the variable ratio filter bank, interpolated between row and the one after it.
+    struct InterpolatedRow
+    {
+        const float * row;
+        const float * next;
+        __m256 weight;
+
+        inline __m256 Load(amf_size k) const
+        {
+            __m256 h0 = _mm256_loadu_ps(row + k);
+            __m256 h1 = _mm256_loadu_ps(next + k);
+
+            return _mm256_fmadd_ps(weight, _mm256_sub_ps(h1, h0), h0);
+        }
+    };
+
+    // outputs[c][n] = row . inputs[c][index ... index + taps - 1] for every channel, four
+    // channels at a time so each row load and interpolation is shared.
+    template<class Row>
+    inline void FilterChannels(
+        const float * const * inputs,
+        float * const * outputs,
+        amf_size channels,
+        const Row & row,
+        amf_size taps,
+        amf_size index,
+        amf_size n)
+    {
+        amf_size c = 0;
+
+        for (; c + 4 <= channels; c += 4)
+        {
+            const float * x0 = inputs[c] + index;
+            const float * x1 = inputs[c + 1] + index;
+            const float * x2 = inputs[c + 2] + index;
+            const float * x3 = inputs[c + 3] + index;
+
+            __m256 s0 = _mm256_setzero_ps();
+            __m256 s1 = _mm256_setzero_ps();
+            __m256 s2 = _mm256_setzero_ps();
+            __m256 s3 = _mm256_setzero_ps();
+
+            for (amf_size k = 0; k < taps; k += 8)
+            {
+                __m256 h = row.Load(k);
+
+                s0 = _mm256_fmadd_ps(h, _mm256_loadu_ps(x0 + k), s0);
+                s1 = _mm256_fmadd_ps(h, _mm256_loadu_ps(x1 + k), s1);
+                s2 = _mm256_fmadd_ps(h, _mm256_loadu_ps(x2 + k), s2);
+                s3 = _mm256_fmadd_ps(h, _mm256_loadu_ps(x3 + k), s3);
+            }
+
+            // lane c of each half ends up holding that half's sum of channel c
+            __m256 s = _mm256_hadd_ps(_mm256_hadd_ps(s0, s1), _mm256_hadd_ps(s2, s3));
+
+            alignas(16) float sums[4];
+            _mm_store_ps(sums, _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1)));
+
+            outputs[c][n] = sums[0];
+            outputs[c + 1][n] = sums[1];
+            outputs[c + 2][n] = sums[2];
+            outputs[c + 3][n] = sums[3];
+        }
+
+        for (; c < channels; c++)
+        {
+            const float * x = inputs[c] + index;
+
+            // two accumulators hide the FMA latency, taps may be an odd number of vectors
+            __m256 s0 = _mm256_setzero_ps();
+            __m256 s1 = _mm256_setzero_ps();
+            amf_size k = 0;
+
+            for (; k + 16 <= taps; k += 16)
+            {
+                s0 = _mm256_fmadd_ps(row.Load(k), _mm256_loadu_ps(x + k), s0);
+                s1 = _mm256_fmadd_ps(row.Load(k + 8), _mm256_loadu_ps(x + k + 8), s1);
+            }
+
+            if (k < taps)
+            {
+                s0 = _mm256_fmadd_ps(row.Load(k), _mm256_loadu_ps(x + k), s0);
+            }
+
+            __m256 s8 = _mm256_add_ps(s0, s1);
+            __m128 s = _mm_add_ps(_mm256_castps256_ps128(s8), _mm256_extractf128_ps(s8, 1));
+            s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+            s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+
+            outputs[c][n] = _mm_cvtss_f32(s);
+        }
+    }
+
+    void ResampleFixedAVX2(
+        const float * const * inputs,
+        float * const * outputs,
+        amf_size channels,
+        const float * coefficients,
+        amf_size taps,
+        amf_uint32 phases,
+        amf_uint32 step,
+        amf_size & index,
+        amf_uint32 & phase,
+        amf_size count)
+    {
+        amf_size i = index;
+        amf_uint32 p = phase;
+
+        for (amf_size n = 0; n < count; n++)
+        {
+            FixedRow row = { coefficients + p * taps };
+
+            FilterChannels(inputs, outputs, channels, row, taps, i, n);
+
+            p += step;
+            i += p / phases;
+            p %= phases;
+        }
+
+        index = i;
+        phase = p;
+    }
+
+    void ResampleVariableAVX2(
+        const float * const * inputs,
+        float * const * outputs,
+        amf_size channels,
+        const float * coefficients,
+        amf_size taps,
+        amf_uint64 & position,
+        amf_uint64 step,
+        amf_size count)
+    {
+        amf_uint64 pos = position;
+
+        for (amf_size n = 0; n < count; n++)
+        {
+            const float * h = coefficients + ResamplerRow(pos) * taps;
+            InterpolatedRow row = { h, h + taps, _mm256_set1_ps(ResamplerWeight(pos)) };
+
+            FilterChannels(inputs, outputs, channels, row, taps, amf_size(pos >> 32), n);
+
+            pos += step;
+        }
+
+        position = pos;
+    }
+}
+
+namespace amf
+{
+    const TANResamplerKernels TANResamplerKernelsAVX2 =
+    {
+        L"AVX2",
+        ResampleFixedAVX2,
+        ResampleVariableAVX2,
+    };
+}
@@ -1,6 +1,2324 @@
+// TanCPUTest.cpp : CPU only checks and timings of the TANMath, TANConverter, TANResampler, TANMixer,
+// TANIIRfilter, TANFilter, TANFFT and TANConvolution kernels, one function per component.
+//
+// Copyright (c) 2019 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
 #include "cpucaps.h"
 
+#include "TrueAudioNext.h"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace amf;
+
+// sweep deconvolution sized work: 64 microphones, 64k point spectra
+static const amf_uint32 Channels = 64;
+static const amf_size   Bins = 32769;
+static const int        Runs = 20;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double MsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / Runs;
+}
+
+// the per element loops TANMath used to run
+static void ReferenceDivision(const float * a, const float * b, float * out, amf_size count)
+{
+    for (amf_size i = 0; i < count; i++)
+    {
+        float d = b[2 * i] * b[2 * i] + b[2 * i + 1] * b[2 * i + 1];
+
+        out[2 * i] = (a[2 * i] * b[2 * i] + a[2 * i + 1] * b[2 * i + 1]) / d;
+        out[2 * i + 1] = (-a[2 * i] * b[2 * i + 1] + a[2 * i + 1] * b[2 * i]) / d;
+    }
+}
+
+static void ReferenceSum(const float * a, float * sum, amf_size count)
+{
+    sum[0] = sum[1] = 0.0f;
+
+    for (amf_size i = 0; i < count; i++)
+    {
+        sum[0] += a[2 * i];
+        sum[1] += a[2 * i + 1];
+    }
+}
+
+// float to short as the converter defines it: round to nearest, saturate
+static short ReferenceToShort(float value)
+{
+    value = value > -32768.0f ? value : -32768.0f;
+    value = value < 32767.0f ? value : 32767.0f;
+
+    return short(std::lrint(value));
+}
+
+// a voice of the TANIIRfilter taps mode and the whole stream it has seen, for the direct form
+// y[n] = sum b[k] x[n - k] + sum a[l] y[n - 1 - l]
+struct ReferenceVoice
+{
+    std::vector<float> b, a;
+    std::vector<float> in, out;
+};
+
+static float ReferenceTapsNext(ReferenceVoice & voice, float input)
+{
+    voice.in.push_back(input);
+
+    const amf_size n = voice.in.size() - 1;
+    double sample = 0.0;
+
+    for (amf_size k = 0; k < voice.b.size() && k <= n; k++)
+    {
+        sample += voice.b[k] * voice.in[n - k];
+    }
+    for (amf_size l = 0; l < voice.a.size() && l < n; l++)
+    {
+        sample += voice.a[l] * voice.out[n - 1 - l];
+    }
+
+    voice.out.push_back(float(sample));
+    return float(sample);
+}
+
+// RBJ cookbook peaking EQ as a b0, b1, b2, a0, a1, a2 row
+static void PeakingSection(double frequency, double q, double gainDb, double sampleRate, float * sos)
+{
+    const double Pi = 3.14159265358979323846;
+    double a = pow(10.0, gainDb / 40);
+    double w = 2 * Pi * frequency / sampleRate;
+    double alpha = sin(w) / (2 * q);
+
+    sos[0] = float(1 + alpha * a);
+    sos[1] = float(-2 * cos(w));
+    sos[2] = float(1 - alpha * a);
+    sos[3] = float(1 + alpha / a);
+    sos[4] = float(-2 * cos(w));
+    sos[5] = float(1 - alpha / a);
+}
+
+// one channel of a biquad cascade in transposed direct form II, in double
+static void ReferenceSections(const float * sos, amf_uint32 sections, double * state,
+    const float * input, float * output, amf_size count)
+{
+    for (amf_size n = 0; n < count; n++)
+    {
+        double x = input[n];
+
+        for (amf_uint32 s = 0; s < sections; s++)
+        {
+            const float * c = sos + 6 * s;
+            double * z = state + 2 * s;
+            double y = c[0] / c[3] * x + z[0];
+
+            z[0] = c[1] / c[3] * x - c[4] / c[3] * y + z[1];
+            z[1] = c[2] / c[3] * x - c[5] / c[3] * y;
+            x = y;
+        }
+
+        output[n] = float(x);
+    }
+}
+
+// response of an RBJ cookbook peaking EQ at w radians per sample, in double all the way
+static std::complex<double> PeakingResponse(double frequency, double q, double gainDb, double sampleRate, double w)
+{
+    const double Pi = 3.14159265358979323846;
+    double a = pow(10.0, gainDb / 40);
+    double w0 = 2 * Pi * frequency / sampleRate;
+    double alpha = sin(w0) / (2 * q);
+    std::complex<double> z1 = std::polar(1.0, -w);
+
+    return (1 + alpha * a - 2 * cos(w0) * z1 + (1 - alpha * a) * z1 * z1) /
+        (1 + alpha / a - 2 * cos(w0) * z1 + (1 - alpha / a) * z1 * z1);
+}
+
+// two automated sections per voice, swept on with the block
+static void SweepSections(int block, std::vector<std::vector<float>> & sos)
+{
+    for (size_t v = 0; v < sos.size(); v++)
+    {
+        const double phase = 0.05 * block + 0.1 * v;
+
+        PeakingSection(1000.0 * pow(2.0, 3.0 * sin(phase)), 0.7 + 3.0 * (0.5 + 0.5 * sin(1.3 * phase)),
+            12.0 * sin(0.7 * phase), 48000, &sos[v][0]);
+        PeakingSection(200.0 * pow(2.0, 2.0 * cos(phase)), 2.0, -12.0 * cos(1.1 * phase), 48000, &sos[v][6]);
+    }
+}
+
+// a CPU TANConvolution fed with noise block by block, with all of its input and output so far
+struct ConvolutionStream
+{
+    TANConvolutionPtr convolution;
+    amf_uint32 blockLength = 0;
+    std::vector<std::vector<float>> input, output;
+};
+
+static AMF_RESULT InitConvolutionStream(ConvolutionStream & stream, TANContextPtr context,
+    TAN_CONVOLUTION_METHOD method, bool overlapSave, amf_uint32 responseLength, amf_uint32 blockLength,
+    amf_uint32 channels)
+{
+    AMF_RESULT res = TANCreateConvolution(context, &stream.convolution);
+
+    if (res == AMF_OK)
+    {
+        res = stream.convolution->SetProperty(TAN_CONVOLUTION_OVERLAP_SAVE, overlapSave);
+    }
+    if (res == AMF_OK)
+    {
+        res = stream.convolution->Init(method, responseLength, blockLength, channels);
+    }
+
+    stream.blockLength = blockLength;
+    stream.input.assign(channels, std::vector<float>());
+    stream.output.assign(channels, std::vector<float>());
+
+    return res;
+}
+
+static AMF_RESULT ProcessStream(ConvolutionStream & stream, amf_size blocks)
+{
+    const amf_size channels = stream.input.size();
+    std::vector<float *> inPtr(channels), outPtr(channels);
+
+    for (amf_size block = 0; block < blocks; block++)
+    {
+        const amf_size start = stream.input[0].size();
+
+        for (amf_size c = 0; c < channels; c++)
+        {
+            stream.input[c].resize(start + stream.blockLength);
+            stream.output[c].resize(start + stream.blockLength);
+
+            for (amf_size n = start; n < start + stream.blockLength; n++)
+            {
+                stream.input[c][n] = float(rand()) / RAND_MAX - 0.5f;
+            }
+            inPtr[c] = &stream.input[c][start];
+            outPtr[c] = &stream.output[c][start];
+        }
+
+        amf_size processed = 0;
+        AMF_RESULT res = stream.convolution->Process(inPtr.data(), outPtr.data(), stream.blockLength, NULL, &processed);
+
+        if (res != AMF_OK)
+        {
+            return res;
+        }
+        if (processed != stream.blockLength)
+        {
+            return AMF_FAIL;
+        }
+    }
+
+    return AMF_OK;
+}
+
+// Updates the responses and processes blocks until the convolution starts the crossfade to
+// them, the update thread takes them a few blocks later.
+static AMF_RESULT SwitchStream(ConvolutionStream & stream, std::vector<std::vector<float>> & responses)
+{
+    std::vector<float *> responsePtr(responses.size());
+    amf_int64 crossfades = 0, started = 0;
+
+    for (size_t c = 0; c < responses.size(); c++)
+    {
+        responsePtr[c] = responses[c].data();
+    }
+
+    AMF_RESULT res = stream.convolution->GetProperty(TAN_STATS_CROSSFADES, &crossfades);
+    if (res == AMF_OK)
+    {
+        res = stream.convolution->UpdateResponseTD(responsePtr.data(), responses[0].size(), NULL, 0);
+    }
+
+    for (int wait = 0; res == AMF_OK && wait < 1000; wait++)
+    {
+        res = ProcessStream(stream, 1);
+        if (res == AMF_OK)
+        {
+            res = stream.convolution->GetProperty(TAN_STATS_CROSSFADES, &started);
+        }
+        if (res == AMF_OK && started > crossfades)
+        {
+            return AMF_OK;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return res == AMF_OK ? AMF_FAIL : res;
+}
+
+// Largest difference of the output samples [from, to) to the direct convolution of the input,
+// relative to peak, the largest sample of the direct convolution.
+static float StreamError(const ConvolutionStream & stream, const std::vector<std::vector<float>> & responses,
+    amf_size from, amf_size to, float & peak)
+{
+    std::vector<std::vector<double>> expected(stream.input.size(), std::vector<double>(to - from));
+    double largest = 0.0, error = 0.0;
+
+    for (size_t c = 0; c < stream.input.size(); c++)
+    {
+        for (amf_size n = from; n < to; n++)
+        {
+            double sum = 0.0;
+            for (amf_size k = 0; k < responses[c].size() && k <= n; k++)
+            {
+                sum += double(responses[c][k]) * stream.input[c][n - k];
+            }
+            expected[c][n - from] = sum;
+            largest = std::fmax(largest, std::fabs(sum));
+        }
+    }
+
+    for (size_t c = 0; c < stream.input.size(); c++)
+    {
+        for (amf_size n = from; n < to; n++)
+        {
+            error = std::fmax(error, std::fabs(stream.output[c][n] - expected[c][n - from]));
+        }
+    }
+
+    peak = float(largest);
+    return float(error / std::fmax(largest, 1e-6));
+}
+
+// sweep deconvolution sized spectra, a divided by b is ref, out takes what TANMath computes
+struct Spectra
+{
+    std::vector<std::vector<float>> a, b, out, ref;
+    std::vector<float *> aPtr, bPtr, outPtr, refPtr;
+};
+
+static void InitSpectra(Spectra & spectra)
+{
+    spectra.a.resize(Channels);
+    spectra.b.resize(Channels);
+    spectra.out.resize(Channels);
+    spectra.ref.resize(Channels);
+    spectra.aPtr.resize(Channels);
+    spectra.bPtr.resize(Channels);
+    spectra.outPtr.resize(Channels);
+    spectra.refPtr.resize(Channels);
+
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        spectra.a[c].resize(2 * Bins);
+        spectra.b[c].resize(2 * Bins);
+        spectra.out[c].resize(2 * Bins);
+        spectra.ref[c].resize(2 * Bins);
+
+        for (amf_size i = 0; i < 2 * Bins; i++)
+        {
+            spectra.a[c][i] = float(rand()) / RAND_MAX - 0.5f;
+            spectra.b[c][i] = float(rand()) / RAND_MAX + 0.1f;
+        }
+
+        spectra.aPtr[c] = spectra.a[c].data();
+        spectra.bPtr[c] = spectra.b[c].data();
+        spectra.outPtr[c] = spectra.out[c].data();
+        spectra.refPtr[c] = spectra.ref[c].data();
+    }
+}
+
+// ComplexDivision, ComplexSum and the mixed layout multiply accumulate against scalar loops
+static int TestMath(TANMathPtr math, Spectra & spectra)
+{
+    std::vector<std::vector<float>> & b = spectra.b, & out = spectra.out, & ref = spectra.ref;
+    std::vector<float *> & aPtr = spectra.aPtr, & bPtr = spectra.bPtr, & outPtr = spectra.outPtr, & refPtr = spectra.refPtr;
+
+    int failures = 0;
+
+    // division
+    Clock::time_point start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        for (amf_uint32 c = 0; c < Channels; c++)
+        {
+            ReferenceDivision(aPtr[c], bPtr[c], refPtr[c], Bins);
+        }
+    }
+    double refMs = MsSince(start);
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        math->ComplexDivision(aPtr.data(), bPtr.data(), outPtr.data(), Channels, Bins);
+    }
+    double tanMs = MsSince(start);
+
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        for (amf_size i = 0; i < 2 * Bins; i++)
+        {
+            if (std::fabs(out[c][i] - ref[c][i]) > 1e-4f * std::fmax(1.0f, std::fabs(ref[c][i])))
+            {
+                failures++;
+            }
+        }
+    }
+
+    printf("ComplexDivision %u x %u: scalar %.3f ms, TANMath %.3f ms, %.1fx\n",
+        Channels, unsigned(Bins), refMs, tanMs, refMs / tanMs);
+
+    // sum
+    std::vector<float> sums(2 * Channels), refSums(2 * Channels);
+    std::vector<float *> sumPtr(Channels);
+
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        sumPtr[c] = sums.data() + 2 * c;
+    }
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        for (amf_uint32 c = 0; c < Channels; c++)
+        {
+            ReferenceSum(aPtr[c], refSums.data() + 2 * c, Bins);
+        }
+    }
+    refMs = MsSince(start);
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        math->ComplexSum(aPtr.data(), sumPtr.data(), Channels, Bins);
+    }
+    tanMs = MsSince(start);
+
+    for (amf_size i = 0; i < 2 * Channels; i++)
+    {
+        if (std::fabs(sums[i] - refSums[i]) > 1e-2f * std::fmax(1.0f, std::fabs(refSums[i])))
+        {
+            failures++;
+        }
+    }
+
+    printf("ComplexSum      %u x %u: scalar %.3f ms, TANMath %.3f ms, %.1fx\n",
+        Channels, unsigned(Bins), refMs, tanMs, refMs / tanMs);
+
+    // multiply accumulate of interleaved data with planar filters, in one pass and with a conversion first
+    std::vector<std::vector<float>> planar(Channels), converted(Channels), acc(Channels), accRef(Channels);
+    std::vector<float *> planarPtr(Channels), convertedPtr(Channels), accPtr(Channels), accRefPtr(Channels);
+    const TANComplexLayout planarLayout = TANPlanarLayout(Bins + 8);
+
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        planar[c].resize(Bins + 8 + Bins);
+        converted[c].resize(2 * Bins);
+        acc[c].assign(2 * Bins, 0.0f);
+        accRef[c].assign(2 * Bins, 0.0f);
+
+        for (amf_size i = 0; i < Bins; i++)
+        {
+            planar[c][i] = b[c][2 * i];
+            planar[c][Bins + 8 + i] = b[c][2 * i + 1];
+        }
+
+        planarPtr[c] = planar[c].data();
+        convertedPtr[c] = converted[c].data();
+        accPtr[c] = acc[c].data();
+        accRefPtr[c] = accRef[c].data();
+    }
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        math->ConvertComplexLayout(planarPtr.data(), planarLayout, convertedPtr.data(), TANInterleavedLayout(), Channels, Bins);
+        math->ComplexMultiplyAccumulate(aPtr.data(), convertedPtr.data(), accRefPtr.data(), Channels, Bins);
+    }
+    refMs = MsSince(start);
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        math->ComplexMultiplyAccumulate(aPtr.data(), TANInterleavedLayout(), planarPtr.data(), planarLayout,
+            accPtr.data(), TANInterleavedLayout(), Channels, Bins);
+    }
+    tanMs = MsSince(start);
+
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        for (amf_size i = 0; i < 2 * Bins; i++)
+        {
+            if (std::fabs(acc[c][i] - accRef[c][i]) > 1e-3f * std::fmax(1.0f, std::fabs(accRef[c][i])))
+            {
+                failures++;
+            }
+        }
+    }
+
+    printf("Mixed layout MAC %u x %u: convert + MAC %.3f ms, one pass %.3f ms, %.1fx\n",
+        Channels, unsigned(Bins), refMs, tanMs, refMs / tanMs);
+
+    return failures;
+}
+
+// Scale, GainRamp, AccumulateWithGain, DotProduct and PeakRms against double precision loops
+// over the real samples of the spectra
+static int TestRealOps(TANMathPtr math, Spectra & spectra)
+{
+    std::vector<std::vector<float>> & a = spectra.a, & b = spectra.b, & out = spectra.out;
+    std::vector<float *> & aPtr = spectra.aPtr, & bPtr = spectra.bPtr, & outPtr = spectra.outPtr;
+    const amf_size samples = 2 * Bins;
+
+    int failures = 0;
+
+    std::vector<float> gains(Channels), endGains(Channels);
+
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        gains[c] = 0.25f + 0.5f * float(c) / Channels;
+        endGains[c] = 2.0f - gains[c];
+    }
+
+    // gain(i) of a channel, computed in double from the ramp definition
+    auto expect = [&](amf_uint32 c, amf_size i, int ramp) -> double
+    {
+        const double start = gains[c], end = endGains[c], t = double(i) / double(samples);
+
+        switch (ramp)
+        {
+        case 0:
+            return start;
+        case 1:
+            return start + (end - start) * t;
+        default:
+            return start * std::pow(end / start, t);
+        }
+    };
+
+    const char * names[] = { "Scale", "GainRamp linear", "GainRamp exponential" };
+
+    for (int ramp = 0; ramp < 3; ramp++)
+    {
+        AMF_RESULT res = ramp == 0 ?
+            math->Scale(aPtr.data(), outPtr.data(), gains.data(), Channels, samples) :
+            math->GainRamp(aPtr.data(), outPtr.data(), gains.data(), endGains.data(),
+                ramp == 1 ? TAN_GAIN_RAMP_LINEAR : TAN_GAIN_RAMP_EXPONENTIAL, Channels, samples);
+
+        // the exponential ramp multiplies a rounded ratio along each work item
+        const double tolerance = ramp == 2 ? 2e-3 : 1e-5;
+        int mismatches = res == AMF_OK ? 0 : 1;
+
+        for (amf_uint32 c = 0; c < Channels && res == AMF_OK; c++)
+        {
+            for (amf_size i = 0; i < samples; i++)
+            {
+                const double ref = expect(c, i, ramp) * a[c][i];
+
+                if (std::fabs(out[c][i] - ref) > tolerance * std::fmax(1.0, std::fabs(ref)))
+                {
+                    mismatches++;
+                }
+            }
+        }
+
+        printf("%-20s %u x %u: %s\n", names[ramp], Channels, unsigned(samples), mismatches ? "FAILED" : "ok");
+        failures += mismatches;
+    }
+
+    // out = b, then out += gains * a in place
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        out[c] = b[c];
+    }
+
+    int mismatches = math->AccumulateWithGain(aPtr.data(), outPtr.data(), gains.data(), Channels, samples) == AMF_OK ? 0 : 1;
+
+    for (amf_uint32 c = 0; c < Channels && !mismatches; c++)
+    {
+        for (amf_size i = 0; i < samples; i++)
+        {
+            const double ref = double(b[c][i]) + double(gains[c]) * a[c][i];
+
+            if (std::fabs(out[c][i] - ref) > 1e-5 * std::fmax(1.0, std::fabs(ref)))
+            {
+                mismatches++;
+            }
+        }
+    }
+
+    printf("%-20s %u x %u: %s\n", "AccumulateWithGain", Channels, unsigned(samples), mismatches ? "FAILED" : "ok");
+    failures += mismatches;
+
+    // reductions, accumulated in double for the reference
+    std::vector<float> dots(Channels), peaks(Channels), rms(Channels), peaksOnly(Channels);
+
+    mismatches =
+        math->DotProduct(aPtr.data(), bPtr.data(), dots.data(), Channels, samples) != AMF_OK ||
+        math->PeakRms(aPtr.data(), peaks.data(), rms.data(), Channels, samples) != AMF_OK ||
+        math->PeakRms(aPtr.data(), peaksOnly.data(), nullptr, Channels, samples) != AMF_OK ||
+        math->PeakRms(aPtr.data(), nullptr, nullptr, Channels, samples) == AMF_OK ||
+        math->DotProduct(aPtr.data(), bPtr.data(), dots.data(), Channels, 0) == AMF_OK ? 1 : 0;
+
+    for (amf_uint32 c = 0; c < Channels && !mismatches; c++)
+    {
+        double dot = 0.0, peak = 0.0, energy = 0.0;
+
+        for (amf_size i = 0; i < samples; i++)
+        {
+            dot += double(a[c][i]) * b[c][i];
+            peak = std::fmax(peak, std::fabs(a[c][i]));
+            energy += double(a[c][i]) * a[c][i];
+        }
+
+        const double level = std::sqrt(energy / double(samples));
+
+        if (std::fabs(dots[c] - dot) > 1e-4 * std::sqrt(double(samples)) ||
+            peaks[c] != float(peak) || peaksOnly[c] != float(peak) ||
+            std::fabs(rms[c] - level) > 1e-4 * level)
+        {
+            mismatches++;
+        }
+    }
+
+    printf("%-20s %u x %u: %s\n", "DotProduct, PeakRms", Channels, unsigned(samples), mismatches ? "FAILED" : "ok");
+    failures += mismatches;
+
+    return failures;
+}
+
+// device formats, interleaving and dither, the planes are the first spectra
+static int TestConverter(TANContextPtr context, TANConverterPtr converter, Spectra & spectra)
+{
+    std::vector<std::vector<float>> & a = spectra.a, & out = spectra.out;
+
+    int failures = 0;
+
+    Clock::time_point start;
+    double refMs = 0.0, tanMs = 0.0;
+
+    // device write and read: 8 float planes to and from one interleaved short buffer
+    const int DeviceChannels = 8;
+    const amf_size Frames = 2 * Bins;
+    std::vector<short> device(DeviceChannels * Frames), deviceRef(DeviceChannels * Frames);
+    std::vector<float *> planes(DeviceChannels), planesBack(DeviceChannels);
+    std::vector<short *> slots(DeviceChannels);
+    bool clipped = false;
+
+    for (int c = 0; c < DeviceChannels; c++)
+    {
+        planes[c] = a[c].data();
+        planesBack[c] = out[c].data();
+        slots[c] = device.data() + c;
+    }
+
+    // one sample past full scale, which has to be reported
+    planes[3][Frames / 2] = 1.5f;
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        for (int c = 0; c < DeviceChannels; c++)
+        {
+            for (amf_size i = 0; i < Frames; i++)
+            {
+                deviceRef[i * DeviceChannels + c] = ReferenceToShort(planes[c][i] * 32767.0f);
+            }
+        }
+    }
+    refMs = MsSince(start);
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        converter->Convert(planes.data(), 1, Frames, slots.data(), DeviceChannels, 1.0f, DeviceChannels, &clipped);
+    }
+    tanMs = MsSince(start);
+
+    if (!clipped || device != deviceRef)
+    {
+        failures++;
+    }
+
+    printf("float to short  %d x %u: scalar %.3f ms, TANConverter %.3f ms, %.1fx\n",
+        DeviceChannels, unsigned(Frames), refMs, tanMs, refMs / tanMs);
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        converter->Convert(slots.data(), DeviceChannels, Frames, planesBack.data(), 1, 1.0f, DeviceChannels);
+    }
+    tanMs = MsSince(start);
+
+    for (int c = 0; c < DeviceChannels; c++)
+    {
+        for (amf_size i = 0; i < Frames; i++)
+        {
+            if (std::fabs(planesBack[c][i] - deviceRef[i * DeviceChannels + c] / 32767.0f) > 1e-6f)
+            {
+                failures++;
+            }
+        }
+    }
+
+    printf("short to float  %d x %u: TANConverter %.3f ms\n", DeviceChannels, unsigned(Frames), tanMs);
+
+    // the same buffers in a single pass over the interleaved data
+    std::vector<short> interleaved(DeviceChannels * Frames);
+    double stridedMs = tanMs;
+
+    clipped = false;
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        converter->ConvertInterleaved(planes.data(), DeviceChannels, Frames, interleaved.data(),
+            TAN_SAMPLE_TYPE_SHORT, 1.0f, &clipped);
+    }
+    tanMs = MsSince(start);
+
+    if (!clipped || interleaved != deviceRef)
+    {
+        failures++;
+    }
+
+    printf("interleave      %d x %u: TANConverter %.3f ms\n", DeviceChannels, unsigned(Frames), tanMs);
+    double interleaveMs = tanMs;
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        converter->ConvertInterleaved(interleaved.data(), TAN_SAMPLE_TYPE_SHORT, DeviceChannels, Frames,
+            planesBack.data(), 1.0f);
+    }
+    tanMs = MsSince(start);
+
+    for (int c = 0; c < DeviceChannels; c++)
+    {
+        for (amf_size i = 0; i < Frames; i++)
+        {
+            if (std::fabs(planesBack[c][i] - deviceRef[i * DeviceChannels + c] / 32767.0f) > 1e-6f)
+            {
+                failures++;
+            }
+        }
+    }
+
+    printf("deinterleave    %d x %u: strided %.3f ms, one pass %.3f ms, %.1fx\n",
+        DeviceChannels, unsigned(Frames), stridedMs, tanMs, stridedMs / tanMs);
+
+    // noise shaped dither in the same interleaving pass: every sample stays within the
+    // fed back error, the dither and the rounding of the exact value
+    TANConverterPtr ditherConverter;
+
+    if (TANCreateConverter(context, &ditherConverter) != AMF_OK ||
+        ditherConverter->SetProperty(TAN_CONVERTER_DITHER, amf_int64(TAN_DITHER_NOISE_SHAPED)) != AMF_OK ||
+        ditherConverter->Init() != AMF_OK)
+    {
+        printf("Failed to create the dithering TANConverter\n");
+        return 1;
+    }
+
+    clipped = false;
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        ditherConverter->ConvertInterleaved(planes.data(), DeviceChannels, Frames, interleaved.data(),
+            TAN_SAMPLE_TYPE_SHORT, 1.0f, &clipped);
+    }
+    double ditherMs = MsSince(start);
+
+    if (!clipped)
+    {
+        failures++;
+    }
+
+    for (int c = 0; c < DeviceChannels; c++)
+    {
+        for (amf_size i = 0; i < Frames; i++)
+        {
+            float exact = std::fmax(-32768.0f, std::fmin(32767.0f, planes[c][i] * 32767.0f));
+
+            if (std::fabs(interleaved[i * DeviceChannels + c] - exact) > 3.0f)
+            {
+                failures++;
+            }
+        }
+    }
+
+    printf("noise shaped    %d x %u: rounded %.3f ms, dithered %.3f ms\n",
+        DeviceChannels, unsigned(Frames), interleaveMs, ditherMs);
+
+    // 24 bit capture formats: float to integer and back has to round trip within one step
+    const TAN_SAMPLE_TYPE wideTypes[] = { TAN_SAMPLE_TYPE_INT32, TAN_SAMPLE_TYPE_INT24_IN_32, TAN_SAMPLE_TYPE_INT24 };
+    const char * wideNames[] = { "int32", "int24 in 32", "packed int24" };
+    std::vector<amf_int32> wide(Frames);
+
+    for (int t = 0; t < 3; t++)
+    {
+        start = Clock::now();
+        for (int run = 0; run < Runs; run++)
+        {
+            converter->Convert(planes[3], 1, TAN_SAMPLE_TYPE_FLOAT, Frames, wide.data(), 1, wideTypes[t], 1.0f, &clipped);
+            converter->Convert(wide.data(), 1, wideTypes[t], Frames, planesBack[3], 1, TAN_SAMPLE_TYPE_FLOAT, 1.0f);
+        }
+        tanMs = MsSince(start);
+
+        if (!clipped)
+        {
+            failures++;
+        }
+
+        for (amf_size i = 0; i < Frames; i++)
+        {
+            float expected = std::fmax(-1.0f, std::fmin(1.0f, planes[3][i]));
+
+            if (std::fabs(planesBack[3][i] - expected) > 1.0f / 8388607)
+            {
+                failures++;
+            }
+        }
+
+        printf("%-12s    1 x %u: TANConverter round trip %.3f ms\n", wideNames[t], unsigned(Frames), tanMs);
+    }
+
+    // full scale is in range for every integer type, not a clip
+    const float fullScale[] = { 1.0f, -1.0f };
+
+    for (int t = 0; t < 3; t++)
+    {
+        clipped = false;
+
+        if (converter->Convert(fullScale, 1, TAN_SAMPLE_TYPE_FLOAT, 2, wide.data(), 1, wideTypes[t], 1.0f, &clipped) != AMF_OK ||
+            clipped || (wideTypes[t] == TAN_SAMPLE_TYPE_INT32 && (wide[0] <= 0 || wide[1] >= 0)))
+        {
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+static int TestResampler(TANContextPtr context)
+{
+    int failures = 0;
+
+    Clock::time_point start;
+    double tanMs = 0.0;
+
+    // 44.1 kHz to 48 kHz in 10 ms blocks: a sine has to come out at the output rate, and one
+    // second of audio gives the channels a core can resample in real time
+    const amf_uint32 ResampleChannels = 32;
+    const amf_size ResampleBlock = 441;
+    const int ResampleBlocks = 100;
+    const double Pi = 3.14159265358979323846;
+
+    TANResamplerPtr resampler;
+
+    if (TANCreateResampler(context, &resampler) != AMF_OK ||
+        resampler->Init(44100, 48000, ResampleChannels, ResampleBlock) != AMF_OK)
+    {
+        printf("Failed to create the TANResampler\n");
+        return 1;
+    }
+
+    std::vector<std::vector<float>> resampleIn(ResampleChannels, std::vector<float>(ResampleBlock));
+    std::vector<std::vector<float>> resampleOut(ResampleChannels, std::vector<float>(2 * ResampleBlock));
+    std::vector<float *> resampleInPtr(ResampleChannels), resampleOutPtr(ResampleChannels);
+
+    for (amf_uint32 c = 0; c < ResampleChannels; c++)
+    {
+        resampleInPtr[c] = resampleIn[c].data();
+        resampleOutPtr[c] = resampleOut[c].data();
+    }
+
+    // the start is a step from silence, check from a few filter lengths on
+    const amf_size settled = 8 * resampler->GetLatency();
+    amf_size outputs = 0;
+    float resampleError = 0.0f;
+
+    for (int block = 0; block < ResampleBlocks; block++)
+    {
+        for (amf_uint32 c = 0; c < ResampleChannels; c++)
+        {
+            double frequency = 1000.0 + 500.0 * c;
+
+            for (amf_size i = 0; i < ResampleBlock; i++)
+            {
+                resampleIn[c][i] = float(0.5 * sin(2 * Pi * frequency * (block * ResampleBlock + i) / 44100));
+            }
+        }
+
+        amf_size count = 0;
+        resampler->Process(resampleInPtr.data(), ResampleBlock, resampleOutPtr.data(), 2 * ResampleBlock, &count);
+
+        for (amf_uint32 c = 0; c < ResampleChannels; c++)
+        {
+            double frequency = 1000.0 + 500.0 * c;
+
+            for (amf_size i = 0; i < count; i++)
+            {
+                if (outputs + i >= settled)
+                {
+                    float expected = float(0.5 * sin(2 * Pi * frequency * (outputs + i) / 48000));
+                    resampleError = std::fmax(resampleError, std::fabs(resampleOut[c][i] - expected));
+                }
+            }
+        }
+
+        outputs += count;
+    }
+
+    // all but the latency has come out
+    if (resampleError > 1e-3f || outputs + 2 * resampler->GetLatency() < 48000)
+    {
+        failures++;
+    }
+
+    resampler->Reset();
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        for (int block = 0; block < ResampleBlocks; block++)
+        {
+            resampler->Process(resampleInPtr.data(), ResampleBlock, resampleOutPtr.data(), 2 * ResampleBlock, NULL);
+        }
+    }
+    tanMs = MsSince(start);
+
+    printf("resample 44.1k to 48k %u x 1 s: TANResampler %.3f ms, %.0f channels per core in real time, max error %g\n",
+        ResampleChannels, tanMs, ResampleChannels * 1000.0 / tanMs, resampleError);
+
+    return failures;
+}
+
+static int TestMixer(TANContextPtr context)
+{
+    int failures = 0;
+
+    Clock::time_point start;
+    double tanMs = 0.0;
+
+    // 64 sources to 8 buses, each source feeds a quarter of them: the gains change every
+    // block and have to ramp from the last block's gains, skipped routes must stay silent
+    const int MixInputs = 64;
+    const int MixOutputs = 8;
+    const amf_size MixBlock = 1024;
+    const int MixBlocks = 100;
+
+    TANMixerPtr mixer;
+
+    if (TANCreateMixer(context, &mixer) != AMF_OK ||
+        mixer->Init(MixBlock, MixInputs, MixOutputs) != AMF_OK)
+    {
+        printf("Failed to create the TANMixer\n");
+        return 1;
+    }
+
+    std::vector<std::vector<float>> mixIn(MixInputs, std::vector<float>(MixBlock));
+    std::vector<std::vector<float>> mixOut(MixOutputs, std::vector<float>(MixBlock));
+    std::vector<float *> mixInPtr(MixInputs), mixOutPtr(MixOutputs);
+    std::vector<float> gains(MixInputs * MixOutputs, 0.0f), lastGains(gains);
+
+    for (int i = 0; i < MixInputs; i++)
+    {
+        for (amf_size n = 0; n < MixBlock; n++)
+        {
+            mixIn[i][n] = float(rand()) / RAND_MAX - 0.5f;
+        }
+        mixInPtr[i] = mixIn[i].data();
+    }
+    for (int o = 0; o < MixOutputs; o++)
+    {
+        mixOutPtr[o] = mixOut[o].data();
+    }
+
+    float mixError = 0.0f;
+
+    for (int block = 0; block < MixBlocks; block++)
+    {
+        for (int o = 0; o < MixOutputs; o++)
+        {
+            for (int i = 0; i < MixInputs; i++)
+            {
+                gains[o * MixInputs + i] = ((i + o) % 4) ? 0.0f : float(rand()) / RAND_MAX;
+            }
+        }
+
+        mixer->SetGains(gains.data());
+        mixer->Mix(mixInPtr.data(), mixOutPtr.data());
+
+        for (int o = 0; o < MixOutputs; o++)
+        {
+            for (amf_size n = 0; n < MixBlock; n++)
+            {
+                float expected = 0.0f;
+
+                for (int i = 0; i < MixInputs; i++)
+                {
+                    float g0 = lastGains[o * MixInputs + i];
+                    float g1 = gains[o * MixInputs + i];
+
+                    expected += (g0 + (g1 - g0) * n / MixBlock) * mixIn[i][n];
+                }
+
+                mixError = std::fmax(mixError, std::fabs(mixOut[o][n] - expected));
+            }
+        }
+
+        lastGains = gains;
+    }
+
+    // the summing mix is the N x 1 matrix with unit gains
+    TANMixerPtr summer;
+    std::vector<float> sum(MixBlock);
+
+    if (TANCreateMixer(context, &summer) != AMF_OK ||
+        summer->Init(MixBlock, MixInputs) != AMF_OK ||
+        summer->Mix(mixInPtr.data(), sum.data()) != AMF_OK)
+    {
+        printf("Failed to create the TANMixer\n");
+        return 1;
+    }
+
+    for (amf_size n = 0; n < MixBlock; n++)
+    {
+        float expected = 0.0f;
+
+        for (int i = 0; i < MixInputs; i++)
+        {
+            expected += mixIn[i][n];
+        }
+
+        mixError = std::fmax(mixError, std::fabs(sum[n] - expected));
+    }
+
+    // an odd count at odd offsets, added on top of what the outputs already hold, and enough
+    // of it to be split into tiles
+    const amf_size MixCount = 3 * MixBlock + 5;
+    std::vector<std::vector<float>> longIn(MixInputs, std::vector<float>(MixCount + 1));
+    std::vector<std::vector<float>> longOut(MixOutputs, std::vector<float>(MixCount + 2, 1.0f));
+    std::vector<float *> longInPtr(MixInputs), longOutPtr(MixOutputs);
+
+    for (int i = 0; i < MixInputs; i++)
+    {
+        for (amf_size n = 0; n <= MixCount; n++)
+        {
+            longIn[i][n] = float(rand()) / RAND_MAX - 0.5f;
+        }
+        longInPtr[i] = longIn[i].data() + 1;
+    }
+    for (int o = 0; o < MixOutputs; o++)
+    {
+        longOutPtr[o] = longOut[o].data() + 1;
+    }
+
+    if (mixer->Mix(longInPtr.data(), longOutPtr.data(), MixCount, true) != AMF_OK)
+    {
+        failures++;
+    }
+
+    for (int o = 0; o < MixOutputs; o++)
+    {
+        for (amf_size n = 0; n < MixCount; n++)
+        {
+            float expected = 1.0f;
+
+            for (int i = 0; i < MixInputs; i++)
+            {
+                expected += gains[o * MixInputs + i] * longInPtr[i][n];
+            }
+
+            mixError = std::fmax(mixError, std::fabs(longOutPtr[o][n] - expected));
+        }
+
+        // nothing around the output is touched
+        if (longOut[o][0] != 1.0f || longOut[o][MixCount + 1] != 1.0f)
+        {
+            failures++;
+        }
+    }
+
+    if (mixError > 1e-5f)
+    {
+        failures++;
+    }
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        for (int block = 0; block < MixBlocks; block++)
+        {
+            gains[block % gains.size()] += 1.0f / MixBlocks;
+            mixer->SetGains(gains.data());
+            mixer->Mix(mixInPtr.data(), mixOutPtr.data());
+        }
+    }
+    tanMs = MsSince(start);
+
+    printf("mix %d to %d, 1 in 4 routes x %d x %u: TANMixer %.3f ms, max error %g\n",
+        MixInputs, MixOutputs, MixBlocks, unsigned(MixBlock), tanMs, mixError);
+
+    return failures;
+}
+
+// TANIIRfilter second order sections: channel groups, block parallel and gliding updates
+static int TestSections(TANContextPtr context)
+{
+    int failures = 0;
+
+    Clock::time_point start;
+    double tanMs = 0.0;
+
+    // a 10 band parametric EQ on every channel of a 32 channel stream, 48 kHz in 10 ms blocks;
+    // 32 channels are two full groups of SIMD lanes, 35 leave a partial one
+    const amf_uint32 EqChannels[] = { 32, 35 };
+    const amf_uint32 EqSections = 10;
+    const amf_size EqBlock = 480;
+    const int EqBlocks = 100;
+
+    for (amf_uint32 eqChannels : EqChannels)
+    {
+        TANIIRfilterPtr eq;
+
+        if (TANCreateIIRfilter(context, &eq) != AMF_OK ||
+            eq->InitSections(EqSections, EqBlock, eqChannels) != AMF_OK)
+        {
+            printf("Failed to create the TANIIRfilter\n");
+            return 1;
+        }
+
+        std::vector<std::vector<float>> sos(eqChannels, std::vector<float>(6 * EqSections));
+        std::vector<std::vector<double>> eqState(eqChannels, std::vector<double>(2 * EqSections, 0.0));
+        std::vector<std::vector<float>> eqIn(eqChannels, std::vector<float>(EqBlock));
+        std::vector<std::vector<float>> eqOut(eqChannels, std::vector<float>(EqBlock));
+        std::vector<float> expected(EqBlock);
+        std::vector<float *> sosPtr(eqChannels), eqInPtr(eqChannels), eqOutPtr(eqChannels);
+
+        for (amf_uint32 c = 0; c < eqChannels; c++)
+        {
+            for (amf_uint32 s = 0; s < EqSections; s++)
+            {
+                PeakingSection(31.25 * pow(2.0, s) * (1 + 0.01 * c), 1.4, (s % 2 ? -6.0 : 6.0), 48000, &sos[c][6 * s]);
+            }
+            sosPtr[c] = sos[c].data();
+            eqInPtr[c] = eqIn[c].data();
+            eqOutPtr[c] = eqOut[c].data();
+        }
+
+        if (eq->UpdateSections(sosPtr.data()) != AMF_OK)
+        {
+            failures++;
+        }
+
+        float eqError = 0.0f;
+
+        for (int block = 0; block < EqBlocks; block++)
+        {
+            for (amf_uint32 c = 0; c < eqChannels; c++)
+            {
+                for (amf_size n = 0; n < EqBlock; n++)
+                {
+                    eqIn[c][n] = float(rand()) / RAND_MAX - 0.5f;
+                }
+            }
+
+            eq->Process(eqInPtr.data(), eqOutPtr.data(), EqBlock, NULL, NULL);
+
+            for (amf_uint32 c = 0; c < eqChannels; c++)
+            {
+                ReferenceSections(sos[c].data(), EqSections, eqState[c].data(), eqIn[c].data(), expected.data(), EqBlock);
+
+                for (amf_size n = 0; n < EqBlock; n++)
+                {
+                    eqError = std::fmax(eqError, std::fabs(eqOut[c][n] - expected[n]));
+                }
+            }
+        }
+
+        if (eqError > 1e-3f)
+        {
+            failures++;
+        }
+
+        start = Clock::now();
+        for (int run = 0; run < Runs; run++)
+        {
+            for (int block = 0; block < EqBlocks; block++)
+            {
+                eq->Process(eqInPtr.data(), eqOutPtr.data(), EqBlock, NULL, NULL);
+            }
+        }
+        tanMs = MsSince(start);
+
+        printf("EQ %u sections x %u x 1 s: TANIIRfilter %.3f ms, max error %g\n",
+            EqSections, eqChannels, tanMs, eqError);
+    }
+
+    // an offline stereo stem through the same EQ in 1 s buffers, chunked and block parallel;
+    // the buffers are not a multiple of the chunks, the rest is filtered serially
+    const amf_uint32 StemChannels = 2;
+    const amf_size StemBuffer = 48000 + 7;
+    const int StemBuffers = 4;
+
+    TANIIRfilterPtr stemEq;
+
+    if (TANCreateIIRfilter(context, &stemEq) != AMF_OK ||
+        stemEq->InitSections(EqSections, amf_uint32(StemBuffer), StemChannels) != AMF_OK ||
+        stemEq->SetBlockParallel(true) != AMF_OK)
+    {
+        printf("Failed to create the TANIIRfilter\n");
+        return 1;
+    }
+
+    std::vector<std::vector<float>> stemSos(StemChannels, std::vector<float>(6 * EqSections));
+    std::vector<std::vector<double>> stemState(StemChannels, std::vector<double>(2 * EqSections, 0.0));
+    std::vector<std::vector<float>> stem(StemChannels, std::vector<float>(StemBuffer)), stemIn(stem);
+    std::vector<float> stemExpected(StemBuffer);
+    std::vector<float *> stemSosPtr(StemChannels), stemPtr(StemChannels);
+
+    for (amf_uint32 c = 0; c < StemChannels; c++)
+    {
+        for (amf_uint32 s = 0; s < EqSections; s++)
+        {
+            PeakingSection(31.25 * pow(2.0, s) * (1 + 0.1 * c), 0.7, (s % 2 ? 6.0 : -6.0), 48000, &stemSos[c][6 * s]);
+        }
+        stemSosPtr[c] = stemSos[c].data();
+        stemPtr[c] = stem[c].data();
+    }
+
+    if (stemEq->UpdateSections(stemSosPtr.data()) != AMF_OK)
+    {
+        failures++;
+    }
+
+    float stemError = 0.0f;
+
+    for (int buffer = 0; buffer < StemBuffers; buffer++)
+    {
+        for (amf_uint32 c = 0; c < StemChannels; c++)
+        {
+            for (amf_size n = 0; n < StemBuffer; n++)
+            {
+                stemIn[c][n] = float(rand()) / RAND_MAX - 0.5f;
+            }
+        }
+        stem = stemIn;
+
+        // in place
+        stemEq->Process(stemPtr.data(), stemPtr.data(), StemBuffer, NULL, NULL);
+
+        for (amf_uint32 c = 0; c < StemChannels; c++)
+        {
+            ReferenceSections(stemSos[c].data(), EqSections, stemState[c].data(), stemIn[c].data(), stemExpected.data(), StemBuffer);
+
+            for (amf_size n = 0; n < StemBuffer; n++)
+            {
+                stemError = std::fmax(stemError, std::fabs(stem[c][n] - stemExpected[n]));
+            }
+        }
+    }
+
+    if (stemError > 1e-3f)
+    {
+        failures++;
+    }
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        stemEq->Process(stemPtr.data(), stemPtr.data(), StemBuffer, NULL, NULL);
+    }
+    double blockMs = MsSince(start);
+
+    stemEq->SetBlockParallel(false);
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        stemEq->Process(stemPtr.data(), stemPtr.data(), StemBuffer, NULL, NULL);
+    }
+    tanMs = MsSince(start);
+
+    printf("EQ %u sections x %u x 1 s: serial %.3f ms, block parallel %.3f ms, %.1fx, max error %g\n",
+        EqSections, StemChannels, tanMs, blockMs, tanMs / blockMs, stemError);
+
+    // per block automation of 128 voices with 2 sections each, swept every 10 ms block and
+    // gliding to the new sections instead of switching; a glide to the sections already set
+    // must change nothing
+    const amf_uint32 AutoVoices = 128;
+    const amf_uint32 AutoSections = 2;
+
+    TANIIRfilterPtr autoEq, holdEq;
+
+    if (TANCreateIIRfilter(context, &autoEq) != AMF_OK ||
+        TANCreateIIRfilter(context, &holdEq) != AMF_OK ||
+        autoEq->InitSections(AutoSections, EqBlock, AutoVoices) != AMF_OK ||
+        holdEq->InitSections(AutoSections, EqBlock, AutoVoices) != AMF_OK)
+    {
+        printf("Failed to create the TANIIRfilter\n");
+        return 1;
+    }
+
+    std::vector<std::vector<float>> autoSos(AutoVoices, std::vector<float>(6 * AutoSections));
+    std::vector<std::vector<float>> autoIn(AutoVoices, std::vector<float>(EqBlock));
+    std::vector<std::vector<float>> autoOut(AutoVoices, std::vector<float>(EqBlock)), holdOut(autoOut);
+    std::vector<float *> autoSosPtr(AutoVoices), autoInPtr(AutoVoices), autoOutPtr(AutoVoices), holdOutPtr(AutoVoices);
+
+    for (amf_uint32 v = 0; v < AutoVoices; v++)
+    {
+        autoSosPtr[v] = autoSos[v].data();
+        autoInPtr[v] = autoIn[v].data();
+        autoOutPtr[v] = autoOut[v].data();
+        holdOutPtr[v] = holdOut[v].data();
+    }
+
+    SweepSections(0, autoSos);
+
+    if (autoEq->UpdateSections(autoSosPtr.data()) != AMF_OK ||
+        holdEq->UpdateSections(autoSosPtr.data()) != AMF_OK)
+    {
+        failures++;
+    }
+
+    float glideError = 0.0f;
+
+    for (int block = 0; block < 4; block++)
+    {
+        for (amf_uint32 v = 0; v < AutoVoices; v++)
+        {
+            for (amf_size n = 0; n < EqBlock; n++)
+            {
+                autoIn[v][n] = float(rand()) / RAND_MAX - 0.5f;
+            }
+        }
+
+        if (block == 2 && autoEq->RampSections(autoSosPtr.data()) != AMF_OK)
+        {
+            failures++;
+        }
+
+        autoEq->Process(autoInPtr.data(), autoOutPtr.data(), EqBlock, NULL, NULL);
+        holdEq->Process(autoInPtr.data(), holdOutPtr.data(), EqBlock, NULL, NULL);
+
+        for (amf_uint32 v = 0; v < AutoVoices; v++)
+        {
+            for (amf_size n = 0; n < EqBlock; n++)
+            {
+                glideError = std::fmax(glideError, std::fabs(autoOut[v][n] - holdOut[v][n]));
+            }
+        }
+    }
+
+    if (glideError > 1e-4f)
+    {
+        failures++;
+    }
+
+    float autoPeak = 0.0f;
+
+    start = Clock::now();
+    for (int block = 1; block <= EqBlocks; block++)
+    {
+        SweepSections(block, autoSos);
+        autoEq->RampSections(autoSosPtr.data());
+        autoEq->Process(autoInPtr.data(), autoOutPtr.data(), EqBlock, NULL, NULL);
+
+        for (amf_uint32 v = 0; v < AutoVoices; v++)
+        {
+            for (amf_size n = 0; n < EqBlock; n++)
+            {
+                // NaN output fails the check below
+                autoPeak = (std::fabs(autoOut[v][n]) <= autoPeak) ? autoPeak : std::fabs(autoOut[v][n]);
+            }
+        }
+    }
+    tanMs = MsSince(start);
+
+    if (!(autoPeak < 100.0f))
+    {
+        failures++;
+    }
+
+    printf("EQ %u sections x %u automated every block x 1 s: TANIIRfilter %.3f ms, glide error %g, peak %g\n",
+        AutoSections, AutoVoices, tanMs, glideError, autoPeak);
+
+    return failures;
+}
+
+static int TestTaps(TANContextPtr context)
+{
+    int failures = 0;
+
+    // taps mode voices come and go between blocks, each with its own tap counts: 128 air
+    // absorption style one pole filters plus a few longer ones, some voices leave on the way
+    const amf_uint32 Voices = 128;
+    const amf_size VoiceBlock = 256;
+    const int VoiceBlocks = 9;
+
+    TANIIRfilterPtr voiceFilter;
+
+    if (TANCreateIIRfilter(context, &voiceFilter) != AMF_OK ||
+        voiceFilter->Init(1, 1, VoiceBlock, 0) != AMF_OK)
+    {
+        printf("Failed to create the TANIIRfilter\n");
+        return 1;
+    }
+
+    std::vector<ReferenceVoice> voices;
+    std::vector<std::vector<float>> voiceIn, voiceOut;
+    float voiceError = 0.0f;
+
+    for (int block = 0; block < VoiceBlocks; block++)
+    {
+        // half of the voices arrive in the first block, the rest spread over the others
+        amf_uint32 arriving = block ? Voices / 2 / (VoiceBlocks - 1) : Voices / 2;
+
+        for (amf_uint32 v = 0; v < arriving; v++)
+        {
+            ReferenceVoice voice;
+            amf_uint32 inputTaps = (v % 8) ? 1 : 1 + rand() % 8;
+            amf_uint32 outputTaps = (v % 8) ? 1 : rand() % 5;
+
+            for (amf_uint32 k = 0; k < inputTaps; k++)
+            {
+                voice.b.push_back(float(rand()) / RAND_MAX);
+            }
+            // sum |a| < 1 keeps it stable
+            for (amf_uint32 l = 0; l < outputTaps; l++)
+            {
+                voice.a.push_back((float(rand()) / RAND_MAX - 0.5f) * 1.8f / outputTaps);
+            }
+
+            if (voiceFilter->AddChannel(inputTaps, outputTaps) != AMF_OK)
+            {
+                failures++;
+            }
+            voices.push_back(voice);
+        }
+
+        // the last voice and one in the middle leave
+        if (block == 3)
+        {
+            for (amf_uint32 leaving : { amf_uint32(voices.size() - 1), amf_uint32(voices.size() / 2) })
+            {
+                if (voiceFilter->RemoveChannel(leaving) != AMF_OK)
+                {
+                    failures++;
+                }
+                voices.erase(voices.begin() + leaving);
+            }
+        }
+
+        if (voiceFilter->GetChannelCount() != voices.size())
+        {
+            failures++;
+        }
+
+        // only the new voices need their responses, the others are skipped by NULL
+        std::vector<float *> inputResponses(voices.size(), NULL), outputResponses(voices.size(), NULL);
+
+        for (amf_size v = 0; v < voices.size(); v++)
+        {
+            if (voices[v].in.empty())
+            {
+                inputResponses[v] = voices[v].b.data();
+                outputResponses[v] = voices[v].a.data();
+            }
+        }
+
+        if (voiceFilter->UpdateIIRResponses(inputResponses.data(), outputResponses.data(), 8, 4, NULL, 0) != AMF_OK)
+        {
+            failures++;
+        }
+
+        voiceIn.assign(voices.size(), std::vector<float>(VoiceBlock));
+        voiceOut.assign(voices.size(), std::vector<float>(VoiceBlock));
+        std::vector<float *> voiceInPtr(voices.size()), voiceOutPtr(voices.size());
+
+        for (amf_size v = 0; v < voices.size(); v++)
+        {
+            for (amf_size n = 0; n < VoiceBlock; n++)
+            {
+                voiceIn[v][n] = float(rand()) / RAND_MAX - 0.5f;
+            }
+            voiceInPtr[v] = voiceIn[v].data();
+            voiceOutPtr[v] = voiceOut[v].data();
+        }
+
+        voiceFilter->Process(voiceInPtr.data(), voiceOutPtr.data(), VoiceBlock, NULL, NULL);
+
+        for (amf_size v = 0; v < voices.size(); v++)
+        {
+            for (amf_size n = 0; n < VoiceBlock; n++)
+            {
+                float expected = ReferenceTapsNext(voices[v], voiceIn[v][n]);
+                voiceError = std::fmax(voiceError, std::fabs(voiceOut[v][n] - expected));
+            }
+        }
+    }
+
+    if (voiceError > 1e-4f)
+    {
+        failures++;
+    }
+
+    printf("IIR taps, %u voices added and removed over %d blocks: max error %g\n",
+        unsigned(voices.size()), VoiceBlocks, voiceError);
+
+    return failures;
+}
+
+static int TestParametricEq(TANContextPtr context)
+{
+    int failures = 0;
+
+    Clock::time_point start;
+    double tanMs = 0.0;
+
+    // per voice parametric EQs straight into partitioned convolution spectra: 64 voices of 6
+    // peaking bands, 2048 point transforms in 4 planar partitions, then folded in once more;
+    // shelves and passes are checked at 0 Hz and half the sample rate
+    const amf_uint32 EqVoices = 64;
+    const amf_uint32 EqBands = 6;
+    const amf_uint32 SpectrumLog2 = 11;
+    const amf_uint32 SpectrumPartitions = 4;
+    const amf_size SpectrumBins = (amf_size(1) << (SpectrumLog2 - 1)) + 1;
+    const amf_size PlaneSpacing = (amf_size(1) << (SpectrumLog2 - 1)) + 8;
+    const amf_size PartitionStride = (amf_size(1) << SpectrumLog2) + 16;
+
+    TANFilterPtr eqGenerator;
+
+    if (TANCreateFilter(context, &eqGenerator) != AMF_OK)
+    {
+        printf("Failed to create the TANFilter\n");
+        return 1;
+    }
+
+    std::vector<std::vector<TANEQBand>> voiceBands(EqVoices, std::vector<TANEQBand>(EqBands));
+    std::vector<std::vector<float>> spectra(EqVoices, std::vector<float>(SpectrumPartitions * PartitionStride));
+    std::vector<const TANEQBand *> voiceBandPtr(EqVoices);
+    std::vector<amf_uint32> bandCounts(EqVoices, EqBands);
+    std::vector<float *> spectraPtr(EqVoices);
+
+    for (amf_uint32 v = 0; v < EqVoices; v++)
+    {
+        for (amf_uint32 b = 0; b < EqBands; b++)
+        {
+            TANEQBand band = { TAN_EQ_BAND_PEAKING, float(40.0 * pow(3.0, b) * (1 + 0.01 * v)), 0.7f + 0.3f * b, (b % 2) ? -9.0f : 9.0f };
+            voiceBands[v][b] = band;
+        }
+        voiceBandPtr[v] = voiceBands[v].data();
+        spectraPtr[v] = spectra[v].data();
+    }
+
+    start = Clock::now();
+    for (int run = 0; run < Runs; run++)
+    {
+        if (eqGenerator->generateParametricEQ(SpectrumLog2, 48000, EqVoices, voiceBandPtr.data(), bandCounts.data(),
+                spectraPtr.data(), TANPlanarLayout(PlaneSpacing), SpectrumPartitions, PartitionStride, false) != AMF_OK)
+        {
+            failures++;
+        }
+    }
+    tanMs = MsSince(start);
+
+    std::vector<std::vector<float>> generated(spectra);
+
+    if (eqGenerator->generateParametricEQ(SpectrumLog2, 48000, EqVoices, voiceBandPtr.data(), bandCounts.data(),
+            spectraPtr.data(), TANPlanarLayout(PlaneSpacing), SpectrumPartitions, PartitionStride, true) != AMF_OK)
+    {
+        failures++;
+    }
+
+    double responseError = 0.0;
+
+    for (amf_uint32 v = 0; v < EqVoices; v++)
+    {
+        for (amf_size k = 0; k < SpectrumBins; k++)
+        {
+            const double w = 3.14159265358979323846 * k / (SpectrumBins - 1);
+            std::complex<double> expected = 1.0;
+
+            for (const TANEQBand & band : voiceBands[v])
+            {
+                expected *= PeakingResponse(band.frequency, band.q, band.gainDb, 48000, w);
+            }
+
+            for (amf_uint32 p = 0; p < SpectrumPartitions; p++)
+            {
+                const float * once = &generated[v][p * PartitionStride];
+                const float * twice = &spectra[v][p * PartitionStride];
+
+                responseError = std::fmax(responseError,
+                    std::abs(std::complex<double>(once[k], once[PlaneSpacing + k]) - expected) / std::abs(expected));
+                responseError = std::fmax(responseError,
+                    std::abs(std::complex<double>(twice[k], twice[PlaneSpacing + k]) - expected * expected) / std::norm(expected));
+            }
+        }
+    }
+
+    // low shelf +6 dB, high shelf -6 dB, low pass, high pass; interleaved, one spectrum each
+    const TANEQBand edgeBands[] =
+    {
+        { TAN_EQ_BAND_LOW_SHELF, 200.0f, 0.7071f, 6.0f },
+        { TAN_EQ_BAND_HIGH_SHELF, 5000.0f, 0.7071f, -6.0f },
+        { TAN_EQ_BAND_LOW_PASS, 1000.0f, 0.7071f, 0.0f },
+        { TAN_EQ_BAND_HIGH_PASS, 1000.0f, 0.7071f, 0.0f },
+    };
+    const double edgeGains[][2] = { { pow(10.0, 6.0 / 20), 1.0 }, { 1.0, pow(10.0, -6.0 / 20) }, { 1.0, 0.0 }, { 0.0, 1.0 } };
+    std::vector<std::vector<float>> edgeSpectra(4, std::vector<float>(2 * SpectrumBins));
+    std::vector<const TANEQBand *> edgeBandPtr(4);
+    std::vector<amf_uint32> edgeCounts(4, 1);
+    std::vector<float *> edgeSpectraPtr(4);
+
+    for (int e = 0; e < 4; e++)
+    {
+        edgeBandPtr[e] = &edgeBands[e];
+        edgeSpectraPtr[e] = edgeSpectra[e].data();
+    }
+
+    if (eqGenerator->generateParametricEQ(SpectrumLog2, 48000, 4, edgeBandPtr.data(), edgeCounts.data(),
+            edgeSpectraPtr.data(), TANInterleavedLayout(), 1, 0, false) != AMF_OK)
+    {
+        failures++;
+    }
+
+    for (int e = 0; e < 4; e++)
+    {
+        const float * dc = &edgeSpectra[e][0];
+        const float * nyquist = &edgeSpectra[e][2 * (SpectrumBins - 1)];
+
+        responseError = std::fmax(responseError, std::fabs(std::hypot(dc[0], dc[1]) - edgeGains[e][0]));
+        responseError = std::fmax(responseError, std::fabs(std::hypot(nyquist[0], nyquist[1]) - edgeGains[e][1]));
+    }
+
+    if (responseError > 1e-4)
+    {
+        failures++;
+    }
+
+    printf("parametric EQ %u bands x %u into %u partitions of %u bins: TANFilter %.3f ms, max error %g\n",
+        EqBands, EqVoices, SpectrumPartitions, unsigned(SpectrumBins), tanMs, responseError);
+
+    return failures;
+}
+
+// TransformPruned of zero padded blocks against Transform of the whole frame, and the real
+// transforms against a direct DFT; the timings show what the pruning saves
+static int TestPrunedFFT(TANContextPtr context)
+{
+    const amf_uint32 FftLog2 = 12;
+    const amf_size FftLength = amf_size(1) << FftLog2;
+    const amf_uint32 FftChannels = 8;
+
+    int failures = 0;
+
+    TANFFTPtr fft;
+
+    if (TANCreateFFT(context, &fft) != AMF_OK ||
+        fft->Init() != AMF_OK)
+    {
+        printf("Failed to create the TANFFT\n");
+        return 1;
+    }
+
+    // a quarter of the frame non-zero, half of the output needed
+    std::vector<std::vector<float>> fftIn(FftChannels, std::vector<float>(2 * FftLength, 0.0f));
+    std::vector<std::vector<float>> full(FftChannels, std::vector<float>(2 * FftLength));
+    std::vector<std::vector<float>> pruned(FftChannels, std::vector<float>(2 * FftLength));
+    std::vector<float *> fftInPtr(FftChannels), fullPtr(FftChannels), prunedPtr(FftChannels);
+
+    for (amf_uint32 c = 0; c < FftChannels; c++)
+    {
+        for (amf_size i = 0; i < 2 * (FftLength / 4); i++)
+        {
+            fftIn[c][i] = float(rand()) / RAND_MAX - 0.5f;
+        }
+        fftInPtr[c] = fftIn[c].data();
+        fullPtr[c] = full[c].data();
+        prunedPtr[c] = pruned[c].data();
+    }
+
+    float fftError = 0.0f;
+    double fullMs[2], prunedMs[2];
+
+    for (int backward = 0; backward < 2; backward++)
+    {
+        const TAN_FFT_TRANSFORM_DIRECTION direction =
+            backward ? TAN_FFT_TRANSFORM_DIRECTION_BACKWARD : TAN_FFT_TRANSFORM_DIRECTION_FORWARD;
+
+        if (fft->Transform(direction, FftLog2, FftChannels, fftInPtr.data(), fullPtr.data()) != AMF_OK ||
+            fft->TransformPruned(direction, FftLog2, FftChannels, fftInPtr.data(), prunedPtr.data(),
+                amf_uint32(FftLength / 4), amf_uint32(FftLength / 2)) != AMF_OK)
+        {
+            failures++;
+        }
+
+        for (amf_uint32 c = 0; c < FftChannels; c++)
+        {
+            for (amf_size i = 0; i < FftLength; i++)
+            {
+                fftError = std::fmax(fftError, std::fabs(pruned[c][i] - full[c][i]) / std::fmax(1.0f, std::fabs(full[c][i])));
+            }
+        }
+
+        Clock::time_point start = Clock::now();
+        for (int run = 0; run < Runs; run++)
+        {
+            fft->Transform(direction, FftLog2, FftChannels, fftInPtr.data(), fullPtr.data());
+        }
+        fullMs[backward] = MsSince(start);
+
+        start = Clock::now();
+        for (int run = 0; run < Runs; run++)
+        {
+            fft->TransformPruned(direction, FftLog2, FftChannels, fftInPtr.data(), prunedPtr.data(),
+                amf_uint32(FftLength / 4), amf_uint32(FftLength / 2));
+        }
+        prunedMs[backward] = MsSince(start);
+    }
+
+    // R2C of a quarter non-zero frame, interleaved and planar, and C2R of the spectrum back to
+    // the first half of the samples
+    const amf_uint32 RealLog2 = 10;
+    const amf_size RealLength = amf_size(1) << RealLog2;
+    const amf_size RealBins = RealLength / 2 + 1;
+    const amf_size RealPlaneSpacing = RealLength / 2 + 8;
+    const double Pi = 3.14159265358979323846;
+
+    std::vector<float> samples(RealLength, 0.0f), spectrum(2 * RealPlaneSpacing), samplesBack(RealLength);
+    std::vector<std::complex<double>> expected(RealBins);
+    float * samplesPtr = samples.data();
+    float * spectrumPtr = spectrum.data();
+    float * samplesBackPtr = samplesBack.data();
+
+    for (amf_size n = 0; n < RealLength / 4; n++)
+    {
+        samples[n] = float(rand()) / RAND_MAX - 0.5f;
+    }
+    for (amf_size k = 0; k < RealBins; k++)
+    {
+        for (amf_size n = 0; n < RealLength / 4; n++)
+        {
+            expected[k] += double(samples[n]) * std::polar(1.0, -2 * Pi * double(k * n % RealLength) / RealLength);
+        }
+    }
+
+    for (int planarSpectrum = 0; planarSpectrum < 2; planarSpectrum++)
+    {
+        const TAN_FFT_TRANSFORM_DIRECTION forward = planarSpectrum ?
+            TAN_FFT_R2C_PLANAR_TRANSFORM_DIRECTION_FORWARD : TAN_FFT_R2C_TRANSFORM_DIRECTION_FORWARD;
+        const TAN_FFT_TRANSFORM_DIRECTION backward = planarSpectrum ?
+            TAN_FFT_C2R_PLANAR_TRANSFORM_DIRECTION_BACKWARD : TAN_FFT_C2R_TRANSFORM_DIRECTION_BACKWARD;
+
+        if (fft->TransformPruned(forward, RealLog2, 1, &samplesPtr, &spectrumPtr, amf_uint32(RealLength / 4), 0) != AMF_OK ||
+            fft->TransformPruned(backward, RealLog2, 1, &spectrumPtr, &samplesBackPtr, 0, amf_uint32(RealLength / 2)) != AMF_OK)
+        {
+            failures++;
+        }
+
+        for (amf_size k = 0; k < RealBins; k++)
+        {
+            const std::complex<double> bin = planarSpectrum ?
+                std::complex<double>(spectrum[k], spectrum[RealPlaneSpacing + k]) :
+                std::complex<double>(spectrum[2 * k], spectrum[2 * k + 1]);
+
+            fftError = std::fmax(fftError, float(std::abs(bin - expected[k]) / std::fmax(1.0, std::abs(expected[k]))));
+        }
+        for (amf_size n = 0; n < RealLength / 2; n++)
+        {
+            fftError = std::fmax(fftError, std::fabs(samplesBack[n] - samples[n]));
+        }
+    }
+
+    if (fftError > 1e-3f)
+    {
+        failures++;
+    }
+
+    printf("FFT %u x %u, a quarter in, half out: forward full %.3f ms, pruned %.3f ms, backward full %.3f ms, pruned %.3f ms, max error %g\n",
+        FftChannels, unsigned(FftLength), fullMs[0], prunedMs[0], fullMs[1], prunedMs[1], fftError);
+
+    return failures;
+}
+
+// overlap-add and overlap-save of both CPU partitioned methods against the direct convolution,
+// before and after a response update
+static int TestOverlapSave(TANContextPtr context)
+{
+    const amf_uint32 OlsLength = 4096;
+    const amf_uint32 OlsBlock = 128;
+    const amf_uint32 OlsChannels = 2;
+    const amf_size SettleBlocks = 2 * OlsLength / OlsBlock;
+    const amf_size WindowBlocks = 16;
+
+    int failures = 0;
+
+    std::vector<std::vector<float>> responses[2];
+
+    for (int r = 0; r < 2; r++)
+    {
+        responses[r].assign(OlsChannels, std::vector<float>(OlsLength));
+        for (amf_uint32 c = 0; c < OlsChannels; c++)
+        {
+            for (amf_uint32 k = 0; k < OlsLength; k++)
+            {
+                responses[r][c][k] = (float(rand()) / RAND_MAX - 0.5f) * std::exp(-4.0f * k / OlsLength);
+            }
+        }
+    }
+
+    const TAN_CONVOLUTION_METHOD methods[] = {
+        TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM, TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM };
+    const char * methodNames[] = { "uniform", "non-uniform" };
+
+    for (int m = 0; m < 2; m++)
+    {
+        for (int overlapSave = 0; overlapSave < 2; overlapSave++)
+        {
+            ConvolutionStream stream;
+            float error[2] = { 0.0f, 0.0f }, peak = 0.0f;
+
+            if (InitConvolutionStream(stream, context, methods[m], overlapSave != 0, OlsLength, OlsBlock, OlsChannels) != AMF_OK)
+            {
+                printf("Failed to create the %s TANConvolution\n", methodNames[m]);
+                failures++;
+                continue;
+            }
+
+            for (int r = 0; r < 2; r++)
+            {
+                if (SwitchStream(stream, responses[r]) != AMF_OK ||
+                    ProcessStream(stream, SettleBlocks) != AMF_OK)
+                {
+                    error[r] = 1.0f;
+                    break;
+                }
+
+                const amf_size from = stream.output[0].size();
+
+                if (ProcessStream(stream, WindowBlocks) != AMF_OK)
+                {
+                    error[r] = 1.0f;
+                    break;
+                }
+                error[r] = StreamError(stream, responses[r], from, stream.output[0].size(), peak);
+            }
+
+            if (error[0] > 1e-4f || error[1] > 1e-4f)
+            {
+                failures++;
+            }
+
+            printf("%-11s %s %u taps, %u blocks: max error %g, after the update %g\n",
+                methodNames[m], overlapSave ? "overlap-save" : "overlap-add ", OlsLength, OlsBlock, error[0], error[1]);
+        }
+    }
+
+    return failures;
+}
+
+static int TestLadder(TANContextPtr context)
+{
+    // a response long enough for three ladder levels, then a response update: both have to
+    // match the direct convolution once every level runs them
+    const amf_uint32 LadderLength = 16384;
+    const amf_uint32 LadderBlock = 64;
+    const amf_uint32 LadderChannels = 2;
+    const amf_size SettleBlocks = 2 * LadderLength / LadderBlock;
+    const amf_size WindowBlocks = 16;
+
+    int failures = 0;
+
+    std::vector<std::vector<float>> responses[2];
+
+    for (int r = 0; r < 2; r++)
+    {
+        responses[r].assign(LadderChannels, std::vector<float>(LadderLength));
+        for (amf_uint32 c = 0; c < LadderChannels; c++)
+        {
+            for (amf_uint32 k = 0; k < LadderLength; k++)
+            {
+                responses[r][c][k] = (float(rand()) / RAND_MAX - 0.5f) * std::exp(-4.0f * k / LadderLength);
+            }
+        }
+    }
+
+    ConvolutionStream stream;
+
+    if (InitConvolutionStream(stream, context, TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_NONUNIFORM, false,
+            LadderLength, LadderBlock, LadderChannels) != AMF_OK)
+    {
+        printf("Failed to create the TANConvolution\n");
+        return 1;
+    }
+
+    float ladderError[2] = { 0.0f, 0.0f }, peak[2] = { 0.0f, 0.0f };
+    amf_size switchStart = 0, switchEnd = 0;
+
+    for (int r = 0; r < 2; r++)
+    {
+        switchStart = stream.output[0].size();
+
+        if (SwitchStream(stream, responses[r]) != AMF_OK ||
+            ProcessStream(stream, SettleBlocks) != AMF_OK)
+        {
+            printf("Ladder convolution failed\n");
+            return failures + 1;
+        }
+
+        switchEnd = stream.output[0].size();
+
+        if (ProcessStream(stream, WindowBlocks) != AMF_OK)
+        {
+            failures++;
+        }
+        ladderError[r] = StreamError(stream, responses[r], switchEnd, stream.output[0].size(), peak[r]);
+    }
+
+    // the levels switch to the new response one after the other, none of them may jump
+    float switchPeak = 0.0f;
+
+    for (amf_uint32 c = 0; c < LadderChannels; c++)
+    {
+        for (amf_size n = switchStart; n < switchEnd; n++)
+        {
+            switchPeak = std::fmax(switchPeak, std::fabs(stream.output[c][n]));
+        }
+    }
+
+    if (ladderError[0] > 1e-4f || ladderError[1] > 1e-4f ||
+        switchPeak > 2.0f * std::fmax(peak[0], peak[1]))
+    {
+        failures++;
+    }
+
+    printf("Ladder convolution %u taps, %u blocks: max error %g, after the update %g, peak while switching %.3f of %.3f\n",
+        LadderLength, LadderBlock, ladderError[0], ladderError[1], switchPeak, std::fmax(peak[0], peak[1]));
+
+    return failures;
+}
+
+// Init of a convolution applies the thread properties of the context or its own ones; real time
+// classes may be denied to an unprivileged process, anything else has to work or be rejected
+static int TestThreadScheduling(TANContextPtr context)
+{
+    const amf_uint32 SchedulingLength = 1024;
+    const amf_uint32 SchedulingBlock = 64;
+    const amf_uint32 SchedulingChannels = 2;
+
+    struct SchedulingCase
+    {
+        const char *                name;
+        bool                        onContext;
+        TAN_THREAD_SCHEDULING_CLASS schedulingClass;
+        amf_int64                   priority;
+        amf_int64                   affinity;
+        AMF_RESULT                  expected;   // AMF_ACCESS_DENIED allows AMF_OK as well
+    };
+
+    const SchedulingCase cases[] = {
+        { "context normal",            true,  TAN_THREAD_SCHEDULING_NORMAL,  0,  0, AMF_OK },
+        { "own normal on processor 0", false, TAN_THREAD_SCHEDULING_NORMAL,  0,  1, AMF_OK },
+        { "own FIFO",                  false, TAN_THREAD_SCHEDULING_FIFO,    0,  0, AMF_ACCESS_DENIED },
+        { "context round robin 10",    true,  TAN_THREAD_SCHEDULING_RR,      10, 0, AMF_ACCESS_DENIED },
+        { "context of the context",    true,  TAN_THREAD_SCHEDULING_CONTEXT, 0,  0, AMF_INVALID_ARG },
+        { "missing processor",         false, TAN_THREAD_SCHEDULING_NORMAL,  0,  amf_int64(amf_uint64(1) << 63), AMF_INVALID_ARG },
+    };
+
+    int failures = 0;
+
+    for (const SchedulingCase & test : cases)
+    {
+        // a 64 processor machine has the processor of the last case
+        if (test.affinity < 0 && std::thread::hardware_concurrency() >= 64)
+        {
+            continue;
+        }
+
+        ConvolutionStream stream;
+        AMFPropertyStorage * storage = nullptr;
+        AMF_RESULT res = TANCreateConvolution(context, &stream.convolution);
+
+        if (res == AMF_OK)
+        {
+            storage = test.onContext ? static_cast<AMFPropertyStorage *>(context) : stream.convolution;
+
+            res = storage->SetProperty(TAN_THREAD_SCHEDULING, amf_int64(test.schedulingClass));
+        }
+        if (res == AMF_OK)
+        {
+            res = storage->SetProperty(TAN_THREAD_PRIORITY, test.priority);
+        }
+        if (res == AMF_OK)
+        {
+            res = storage->SetProperty(TAN_THREAD_AFFINITY, test.affinity);
+        }
+        if (res == AMF_OK)
+        {
+            res = stream.convolution->Init(TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM,
+                SchedulingLength, SchedulingBlock, SchedulingChannels);
+        }
+
+        const bool expected = res == test.expected || (res == AMF_OK && test.expected == AMF_ACCESS_DENIED);
+
+        // the convolution has to run with the scheduling it accepted
+        stream.blockLength = SchedulingBlock;
+        stream.input.assign(SchedulingChannels, std::vector<float>());
+        stream.output.assign(SchedulingChannels, std::vector<float>());
+
+        const bool processed = res != AMF_OK || ProcessStream(stream, 16) == AMF_OK;
+
+        if (!expected || !processed)
+        {
+            failures++;
+        }
+
+        printf("Thread scheduling, %s: Init %s%s\n", test.name,
+            res == AMF_OK ? "applied" : res == AMF_ACCESS_DENIED ? "denied" : res == AMF_INVALID_ARG ? "rejected" : "failed",
+            expected && processed ? "" : ", FAILED");
+
+        if (test.onContext)
+        {
+            context->SetProperty(TAN_THREAD_SCHEDULING, amf_int64(TAN_THREAD_SCHEDULING_NORMAL));
+            context->SetProperty(TAN_THREAD_PRIORITY, amf_int64(0));
+            context->SetProperty(TAN_THREAD_AFFINITY, amf_int64(0));
+        }
+    }
+
+    // priorities are 0..99, out of range is refused when set or at Init
+    TANConvolutionPtr convolution;
+
+    if (TANCreateConvolution(context, &convolution) != AMF_OK ||
+        (convolution->SetProperty(TAN_THREAD_SCHEDULING, amf_int64(TAN_THREAD_SCHEDULING_NORMAL)) == AMF_OK &&
+         convolution->SetProperty(TAN_THREAD_PRIORITY, amf_int64(100)) == AMF_OK &&
+         convolution->Init(TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM,
+            SchedulingLength, SchedulingBlock, SchedulingChannels) == AMF_OK))
+    {
+        printf("Thread scheduling, priority 100: accepted, FAILED\n");
+        failures++;
+    }
+
+    // the workers of the context take its properties at InitThreadPool
+    for (const SchedulingCase & test : cases)
+    {
+        if (!test.onContext && test.affinity >= 0)
+        {
+            continue;
+        }
+
+        context->SetProperty(TAN_THREAD_SCHEDULING, amf_int64(test.schedulingClass));
+        context->SetProperty(TAN_THREAD_PRIORITY, test.priority);
+        context->SetProperty(TAN_THREAD_AFFINITY,
+            test.affinity < 0 && std::thread::hardware_concurrency() >= 64 ? amf_int64(0) : test.affinity);
+
+        const AMF_RESULT res = context->InitThreadPool(2, 0);
+        const bool expected = res == test.expected || (res == AMF_OK && test.expected == AMF_ACCESS_DENIED) ||
+            (test.affinity < 0 && std::thread::hardware_concurrency() >= 64 && res == AMF_OK);
+
+        if (!expected)
+        {
+            failures++;
+        }
+
+        printf("Thread scheduling, workers %s: InitThreadPool %s%s\n", test.name,
+            res == AMF_OK ? "applied" : res == AMF_ACCESS_DENIED ? "denied" : res == AMF_INVALID_ARG ? "rejected" : "failed",
+            expected ? "" : ", FAILED");
+
+        context->SetProperty(TAN_THREAD_SCHEDULING, amf_int64(TAN_THREAD_SCHEDULING_NORMAL));
+        context->SetProperty(TAN_THREAD_PRIORITY, amf_int64(0));
+        context->SetProperty(TAN_THREAD_AFFINITY, amf_int64(0));
+    }
+
+    if (context->InitThreadPool(0, 0) != AMF_OK)
+    {
+        printf("Thread scheduling, workers back to normal: failed, FAILED\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+// stage trace of a convolution with a response update, exported and read back; libraries built
+// without TAN_STAGE_TRACE only have to refuse both calls
+static int TestStageTrace(TANContextPtr context)
+{
+    const amf_uint32 TraceLength = 1024;
+    const amf_uint32 TraceBlock = 64;
+    const amf_uint32 TraceChannels = 2;
+    const wchar_t * TracePath = L"TanCPUTestStageTrace.json";
+    const char * TraceFile = "TanCPUTestStageTrace.json";
+
+    if (TANEnableStageTrace(true) == AMF_NOT_SUPPORTED)
+    {
+        const bool refused = TANExportStageTrace(TracePath) == AMF_NOT_SUPPORTED;
+
+        printf("Stage trace: not built with TAN_STAGE_TRACE%s\n", refused ? "" : ", export FAILED");
+        return refused ? 0 : 1;
+    }
+
+    std::vector<std::vector<float>> responses(TraceChannels, std::vector<float>(TraceLength));
+
+    for (amf_uint32 c = 0; c < TraceChannels; c++)
+    {
+        for (amf_uint32 k = 0; k < TraceLength; k++)
+        {
+            responses[c][k] = (float(rand()) / RAND_MAX - 0.5f) * std::exp(-4.0f * k / TraceLength);
+        }
+    }
+
+    ConvolutionStream stream;
+    AMF_RESULT res = InitConvolutionStream(stream, context, TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM, false,
+        TraceLength, TraceBlock, TraceChannels);
+
+    if (res == AMF_OK)
+    {
+        res = SwitchStream(stream, responses);
+    }
+    if (res == AMF_OK)
+    {
+        res = ProcessStream(stream, 32);
+    }
+
+    TANEnableStageTrace(false);
+
+    int failures = res == AMF_OK ? 0 : 1;
+
+    if (TANExportStageTrace(nullptr) != AMF_INVALID_ARG ||
+        TANExportStageTrace(TracePath) != AMF_OK)
+    {
+        failures++;
+    }
+
+    std::string trace;
+    FILE * file = fopen(TraceFile, "rb");
+
+    if (file != nullptr)
+    {
+        char chunk[4096];
+        size_t read = 0;
+
+        while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            trace.append(chunk, read);
+        }
+        fclose(file);
+        remove(TraceFile);
+    }
+
+    // a complete JSON object with every stage the block and the update run, and no end of a
+    // stage before its begin
+    const char * stages[] = { "process", "input FFT", "MAC", "IFFT", "crossfade", "IR update" };
+    const char * missing = nullptr;
+
+    for (const char * stage : stages)
+    {
+        if (trace.find(std::string("{\"name\":\"") + stage + "\",\"cat\":\"TAN\",\"ph\":\"B\"") == std::string::npos)
+        {
+            missing = stage;
+        }
+    }
+
+    size_t begins = 0, ends = 0;
+
+    for (size_t at = trace.find("\"ph\":\""); at != std::string::npos; at = trace.find("\"ph\":\"", at + 1))
+    {
+        begins += trace.compare(at, 8, "\"ph\":\"B\"") == 0;
+        ends += trace.compare(at, 8, "\"ph\":\"E\"") == 0;
+    }
+
+    const bool complete = trace.compare(0, 40, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n") == 0 &&
+        trace.size() > 44 && trace.compare(trace.size() - 4, 4, "\n]}\n") == 0;
+
+    if (!complete || missing != nullptr || ends > begins || begins > ends + 64)
+    {
+        failures++;
+    }
+
+    printf("Stage trace: %u bytes, %u begins, %u ends%s%s%s\n", unsigned(trace.size()), unsigned(begins), unsigned(ends),
+        complete ? "" : ", incomplete", missing ? ", no " : "", missing ? missing : "");
+
+    return failures;
+}
+
+static int TestThreadBudget(TANContextPtr context, TANMathPtr math, Spectra & spectra)
+{
+    std::vector<std::vector<float>> & out = spectra.out, & ref = spectra.ref;
+    std::vector<float *> & aPtr = spectra.aPtr, & bPtr = spectra.bPtr, & outPtr = spectra.outPtr, & refPtr = spectra.refPtr;
+
+    int failures = 0;
+
+    Clock::time_point start;
+
+    // division again on a pool of 4 threads, TANMath held to 2 of them, then on the calling thread only
+    if (context->InitThreadPool(4, 0) != AMF_OK ||
+        context->SetThreadBudget(TAN_THREAD_BUDGET_MATH, 2) != AMF_OK ||
+        context->GetThreadBudget(TAN_THREAD_BUDGET_MATH) != 2 ||
+        context->GetThreadBudget(TAN_THREAD_BUDGET_FFT) != 4 ||
+        context->SetThreadBudget(TAN_THREAD_BUDGET_COUNT, 1) == AMF_OK)
+    {
+        failures++;
+    }
+
+    for (amf_uint32 c = 0; c < Channels; c++)
+    {
+        ReferenceDivision(aPtr[c], bPtr[c], refPtr[c], Bins);
+    }
+
+    double budgetMs[2];
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass)
+        {
+            context->SetThreadBudget(TAN_THREAD_BUDGET_MATH, 1);
+        }
+
+        start = Clock::now();
+        for (int run = 0; run < Runs; run++)
+        {
+            math->ComplexDivision(aPtr.data(), bPtr.data(), outPtr.data(), Channels, Bins);
+        }
+        budgetMs[pass] = MsSince(start);
+
+        for (amf_uint32 c = 0; c < Channels; c++)
+        {
+            for (amf_size i = 0; i < 2 * Bins; i++)
+            {
+                if (std::fabs(out[c][i] - ref[c][i]) > 1e-4f * std::fmax(1.0f, std::fabs(ref[c][i])))
+                {
+                    failures++;
+                }
+            }
+        }
+    }
+
+    printf("ComplexDivision %u x %u: 2 threads %.3f ms, 1 thread %.3f ms\n",
+        Channels, unsigned(Bins), budgetMs[0], budgetMs[1]);
+
+    return failures;
+}
+
+static int TestStats(TANContextPtr context, TANMathPtr math, Spectra & spectra)
+{
+    std::vector<float *> & aPtr = spectra.aPtr, & bPtr = spectra.bPtr, & outPtr = spectra.outPtr;
+
+    int failures = 0;
+
+    // statistics of Runs divisions, each one block, then of none after a reset
+    amf_int64 blocks = 0, medianNs = 0, longestNs = 0;
+
+    if (math->SetProperty(TAN_STATS_RESET, true) != AMF_OK)
+    {
+        failures++;
+    }
+
+    for (int run = 0; run < Runs; run++)
+    {
+        math->ComplexDivision(aPtr.data(), bPtr.data(), outPtr.data(), Channels, Bins);
+    }
+
+    if (math->GetProperty(TAN_STATS_BLOCKS, &blocks) != AMF_OK ||
+        math->GetProperty(TAN_STATS_BLOCK_TIME_P50, &medianNs) != AMF_OK ||
+        math->GetProperty(TAN_STATS_BLOCK_TIME_MAX, &longestNs) != AMF_OK ||
+        blocks != Runs || medianNs <= 0 || medianNs > longestNs ||
+        math->SetProperty(TAN_STATS_BLOCKS, amf_int64(0)) == AMF_OK ||
+        math->SetProperty(TAN_STATS_RESET, true) != AMF_OK ||
+        math->GetProperty(TAN_STATS_BLOCKS, &blocks) != AMF_OK || blocks != 0)
+    {
+        failures++;
+    }
+
+    printf("ComplexDivision %u x %u: median %.3f ms, longest %.3f ms\n",
+        Channels, unsigned(Bins), medianNs / 1e6, longestNs / 1e6);
+
+    // the stages of a convolution are timed only once asked to
+    ConvolutionStream stream;
+    amf_int64 untimedNs = -1, timedNs = 0;
+
+    if (InitConvolutionStream(stream, context, TAN_CONVOLUTION_METHOD_FFT_PARTITIONED_UNIFORM, false, 1024, 64, 2) != AMF_OK ||
+        ProcessStream(stream, 16) != AMF_OK ||
+        stream.convolution->GetProperty(TAN_STATS_STAGE_TIME(L"InputFFT", L"Max"), &untimedNs) != AMF_OK ||
+        stream.convolution->SetProperty(TAN_STATS_STAGE_TIMES, true) != AMF_OK ||
+        ProcessStream(stream, 16) != AMF_OK ||
+        stream.convolution->GetProperty(TAN_STATS_STAGE_TIME(L"InputFFT", L"Max"), &timedNs) != AMF_OK ||
+        untimedNs != 0 || timedNs <= 0)
+    {
+        failures++;
+    }
+
+    printf("Convolution input FFT: longest %.3f ms untimed, %.3f ms timed\n", untimedNs / 1e6, timedNs / 1e6);
+
+    return failures;
+}
+
 int main(int argc, char* argv[])
 {
-    return 0;
-}
\ No newline at end of file
+    printf("CPU: SSE4.2 %d, AVX2 %d, FMA %d, AVX512F %d\n",
+        InstructionSet::SSE42(), InstructionSet::AVX2(), InstructionSet::FMA(), InstructionSet::AVX512F());
+
+    TANContextPtr context;
+    TANMathPtr math;
+    TANConverterPtr converter;
+
+    if (TANCreateContext(TAN_FULL_VERSION, &context, nullptr) != AMF_OK ||
+        TANCreateMath(context, &math) != AMF_OK ||
+        math->Init() != AMF_OK ||
+        TANCreateConverter(context, &converter) != AMF_OK ||
+        converter->Init() != AMF_OK)
+    {
+        printf("failed to create a CPU TANMath and TANConverter\n");
+        return 1;
+    }
+
+    Spectra spectra;
+    InitSpectra(spectra);
+
+    int failures = 0;
+
+    failures += TestMath(math, spectra);
+    failures += TestRealOps(math, spectra);
+    failures += TestConverter(context, converter, spectra);
+    failures += TestResampler(context);
+    failures += TestMixer(context);
+    failures += TestSections(context);
+    failures += TestTaps(context);
+    failures += TestParametricEq(context);
+    failures += TestPrunedFFT(context);
+    failures += TestOverlapSave(context);
+    failures += TestLadder(context);
+    failures += TestThreadScheduling(context);
+    failures += TestStageTrace(context);
+    failures += TestThreadBudget(context, math, spectra);
+    failures += TestStats(context, math, spectra);
+
+    if (failures)
+    {
+        printf("%d mismatches\n", failures);
+    }
+
+    return failures ? 1 : 0;
+}
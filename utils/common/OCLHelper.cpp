@@ -24,8 +24,183 @@
 #include "OCLHelper.h"
 #include "StringUtility.h"
 
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
 #ifndef TAN_NO_OPENCL
 
+static std::string GetOclDeviceString(cl_device_id device_id, cl_device_info param)
+{
+    size_t size = 0;
+    if(CL_SUCCESS != clGetDeviceInfo(device_id, param, 0, nullptr, &size) || !size)
+    {
+        return std::string();
+    }
+
+    std::vector<char> value(size, 0);
+    clGetDeviceInfo(device_id, param, size, &value.front(), nullptr);
+
+    return std::string(&value.front());
+}
+
+static void HashFNV1a(amf_uint64 & hash, const std::string & value)
+{
+    for(size_t i = 0; i < value.size(); ++i)
+    {
+        hash ^= amf_uint8(value[i]);
+        hash *= 0x100000001B3ull;
+    }
+
+    //separator, so that ("ab", "c") and ("a", "bc") differ
+    hash ^= 0xFF;
+    hash *= 0x100000001B3ull;
+}
+
+//returns the file the program binary is cached in, or an empty string when
+//no cache folder has been set with TANSetCacheFolder
+static std::string GetOclProgramBinaryPath
+(
+    cl_device_id                device_id,
+    const std::string &         kernelID,
+    const std::string &         kernelSource,
+    const std::string &         comp_options
+)
+{
+    amf::AMFFactory *factory = g_AMFFactory.GetFactory();
+    const wchar_t *cacheFolder = factory ? factory->GetCacheFolder() : nullptr;
+
+    if(!cacheFolder || !cacheFolder[0])
+    {
+        return std::string();
+    }
+
+    //binaries are only valid for the exact device, driver, source and options
+    amf_uint64 hash = 0xCBF29CE484222325ull;
+    HashFNV1a(hash, GetOclDeviceString(device_id, CL_DEVICE_VENDOR));
+    HashFNV1a(hash, GetOclDeviceString(device_id, CL_DEVICE_NAME));
+    HashFNV1a(hash, GetOclDeviceString(device_id, CL_DRIVER_VERSION));
+    HashFNV1a(hash, comp_options);
+    HashFNV1a(hash, kernelSource);
+
+    char name[32] = {0};
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+
+    std::string folder(toString(cacheFolder));
+    if(folder.back() != '/' && folder.back() != '\\')
+    {
+        folder += '/';
+    }
+
+    return folder + kernelID + "." + name + ".clbin";
+}
+
+static cl_program LoadOclProgramBinary
+(
+    cl_context                  context,
+    cl_device_id                device_id,
+    const std::string &         binaryPath,
+    const std::string &         comp_options
+)
+{
+    if(binaryPath.empty())
+    {
+        return nullptr;
+    }
+
+    std::ifstream file(binaryPath, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+    {
+        return nullptr;
+    }
+
+    size_t size = size_t(file.tellg());
+    if(!size)
+    {
+        return nullptr;
+    }
+
+    std::vector<unsigned char> binary(size);
+    file.seekg(0);
+    if(!file.read(reinterpret_cast<char *>(&binary.front()), size))
+    {
+        return nullptr;
+    }
+
+    const unsigned char *binaryData = &binary.front();
+    cl_int binaryStatus = CL_SUCCESS;
+    cl_int status = CL_SUCCESS;
+
+    cl_program program = clCreateProgramWithBinary(
+        context,
+        1,
+        &device_id,
+        &size,
+        &binaryData,
+        &binaryStatus,
+        &status
+        );
+
+    if(CL_SUCCESS != status || CL_SUCCESS != binaryStatus)
+    {
+        if(program)
+        {
+            clReleaseProgram(program);
+        }
+
+        return nullptr;
+    }
+
+    //a stale or foreign binary is not an error, the caller rebuilds from source
+    if(CL_SUCCESS != clBuildProgram(program, 1, &device_id, comp_options.c_str(), NULL, NULL))
+    {
+        clReleaseProgram(program);
+
+        return nullptr;
+    }
+
+    return program;
+}
+
+static void StoreOclProgramBinary
+(
+    cl_program                  program,
+    const std::string &         binaryPath
+)
+{
+    if(binaryPath.empty())
+    {
+        return;
+    }
+
+    size_t size = 0;
+    if(CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, nullptr) || !size)
+    {
+        return;
+    }
+
+    std::vector<unsigned char> binary(size);
+    unsigned char *binaryData = &binary.front();
+
+    if(CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaryData), &binaryData, nullptr))
+    {
+        return;
+    }
+
+    //write aside and rename, so a concurrent reader never sees a partial file
+    const std::string tempPath(binaryPath + ".tmp");
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if(!file.is_open() || !file.write(reinterpret_cast<const char *>(binaryData), size))
+        {
+            return;
+        }
+    }
+
+    std::remove(binaryPath.c_str());
+    std::rename(tempPath.c_str(), binaryPath.c_str());
+}
+
 bool GetOclKernel
 (
     cl_kernel &                 resultKernel,
@@ -82,80 +257,92 @@ bool GetOclKernel
     //second: try to load kernel via OpenCL interface
     if(c_queue)
     {
-        cl_kernel ret = 0;
-
-        std::string key = kernelID + "." + comp_options;
-
         cl_context context = nullptr;
+        cl_device_id device_id = 0;
         size_t param_value_size_ret = 0;
         clGetCommandQueueInfo(c_queue, CL_QUEUE_CONTEXT, sizeof(context), &context, &param_value_size_ret);
 
-        const char *source = &kernelSource.front();
-
-        cl_int status = CL_SUCCESS;
-        cl_program program = clCreateProgramWithSource(
-            context,
-            1,
-            &source,
-            &kernelSourceSize,
-            &status
+        cl_int status = clGetCommandQueueInfo(
+            c_queue,
+            CL_QUEUE_DEVICE,
+            sizeof(device_id),
+            &device_id,
+            &param_value_size_ret
             );
 
-        if(CL_SUCCESS == status)
+        if(CL_SUCCESS != status)
         {
-            cl_device_id device_id = 0;
-            status = clGetCommandQueueInfo(
-                c_queue,
-                CL_QUEUE_DEVICE,
-                sizeof(device_id),
-                &device_id,
-                &param_value_size_ret
+            return false;
+        }
+
+        //a previously built binary for this device/driver skips the compiler
+        const std::string binaryPath(GetOclProgramBinaryPath(device_id, kernelID, kernelSource, comp_options));
+        cl_program program = LoadOclProgramBinary(context, device_id, binaryPath, comp_options);
+        bool fromBinary = program != nullptr;
+
+        if(!fromBinary)
+        {
+            const char *source = &kernelSource.front();
+
+            program = clCreateProgramWithSource(
+                context,
+                1,
+                &source,
+                &kernelSourceSize,
+                &status
                 );
 
-            if(CL_SUCCESS == status)
+            if(CL_SUCCESS != status)
             {
-                status = clBuildProgram(program, 1, &device_id, comp_options.c_str(), NULL, NULL);
+                return false;
+            }
 
-                if(CL_SUCCESS == status)
-                {
-                    resultKernel = clCreateKernel(program, kernelName.c_str(), &status);
+            status = clBuildProgram(program, 1, &device_id, comp_options.c_str(), NULL, NULL);
+        }
 
-                    if((CL_SUCCESS == status) && resultKernel)
-                    {
-                        return true;
-                    }
-                }
-                else
-                {
-                    if(CL_BUILD_PROGRAM_FAILURE == status)
-                    {
-                        cl_int logStatus(0);
-                        char *buildLog = nullptr;
-                        size_t buildLogSize = 0;
-
-                        logStatus = clGetProgramBuildInfo(
-                            program,
-                            device_id,
-                            CL_PROGRAM_BUILD_LOG,
-                            buildLogSize,
-                            buildLog,
-                            &buildLogSize
-                            );
-
-                        buildLog = (char*)malloc(buildLogSize);
-                        memset(buildLog, 0, buildLogSize);
-                        logStatus = clGetProgramBuildInfo(
-                            program,
-                            device_id,
-                            CL_PROGRAM_BUILD_LOG,
-                            buildLogSize,
-                            buildLog,
-                            &buildLogSize
-                            );
-                        fprintf(stderr, buildLog);
-                        free(buildLog);
-                    }
-                }
+        if(CL_SUCCESS == status)
+        {
+            if(!fromBinary)
+            {
+                StoreOclProgramBinary(program, binaryPath);
+            }
+
+            resultKernel = clCreateKernel(program, kernelName.c_str(), &status);
+
+            if((CL_SUCCESS == status) && resultKernel)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            if(CL_BUILD_PROGRAM_FAILURE == status)
+            {
+                cl_int logStatus(0);
+                char *buildLog = nullptr;
+                size_t buildLogSize = 0;
+
+                logStatus = clGetProgramBuildInfo(
+                    program,
+                    device_id,
+                    CL_PROGRAM_BUILD_LOG,
+                    buildLogSize,
+                    buildLog,
+                    &buildLogSize
+                    );
+
+                buildLog = (char*)malloc(buildLogSize);
+                memset(buildLog, 0, buildLogSize);
+                logStatus = clGetProgramBuildInfo(
+                    program,
+                    device_id,
+                    CL_PROGRAM_BUILD_LOG,
+                    buildLogSize,
+                    buildLog,
+                    &buildLogSize
+                    );
+                fprintf(stderr, buildLog);
+                free(buildLog);
             }
         }
     }
@@ -102,6 +102,10 @@ public:
 	static bool _3DNOWEXT(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[30]; }
 	static bool _3DNOW(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[31]; }
 
+	// the OS saves YMM / ZMM registers on context switches, required on top of AVX / AVX512F
+	static bool OSAVX(void) { return OSXSAVE() && (CPU_Rep.xcr0_ & 0x06) == 0x06; }
+	static bool OSAVX512(void) { return OSXSAVE() && (CPU_Rep.xcr0_ & 0xE6) == 0xE6; }
+
 private:
 	static const InstructionSet_Internal CPU_Rep;
 
@@ -139,6 +143,25 @@ private:
 
 		#endif
 		}
+
+		uint64_t GetXCR0()
+		{
+		#ifdef _WIN32
+			return _xgetbv(0);
+		#else
+			uint32_t eax = 0, edx = 0;
+
+			asm volatile
+			(
+				"xgetbv":
+				"=a" (eax),
+				"=d" (edx):
+				"c" (0)
+			);
+
+			return (uint64_t(edx) << 32) | eax;
+		#endif
+		}
 	public:
 		InstructionSet_Internal()
 			: nIds_( 0 ),
@@ -150,7 +173,8 @@ private:
 			f_7_EBX_( 0 ),
 			f_7_ECX_( 0 ),
 			f_81_ECX_( 0 ),
-			f_81_EDX_( 0 )
+			f_81_EDX_( 0 ),
+			xcr0_( 0 )
 		{
 			//int cpuInfo[4] = {-1};
 			std::array<int, 4> cpui;
@@ -196,6 +220,12 @@ private:
 				f_1_EDX_ = data_[1][3];
 			}
 
+			// xgetbv is only available when the OS enabled XSAVE
+			if (f_1_ECX_[27])
+			{
+				xcr0_ = GetXCR0();
+			}
+
 			// load bitset with flags for function 0x00000007
 			if (nIds_ >= 7)
 			{
@@ -258,6 +288,7 @@ private:
 		std::bitset<32> f_7_ECX_;
 		std::bitset<32> f_81_ECX_;
 		std::bitset<32> f_81_EDX_;
+		uint64_t xcr0_;
 		std::vector<std::array<int, 4>> data_;
 		std::vector<std::array<int, 4>> extdata_;
 	};